@@ -0,0 +1,106 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench.cpp" - Overlap test module benchmark and self-check entry point file */
+
+#include <cstring>
+
+#include "bench_def.h"
+#include "bench_axes.hpp"
+#include "bench_isa.hpp"
+#include "bench_indexed.hpp"
+#include "bench_quantized.hpp"
+#include "bench_bvh.hpp"
+#include "bench_bvh8.hpp"
+#include "bench_grid.hpp"
+#include "bench_mesh_file.hpp"
+#include "bench_order.hpp"
+#include "bench_import.hpp"
+#include "bench_stream.hpp"
+
+/* Benchmark cases, in running order */
+static const bench::bench_case Cases[]
+{
+  {"isa", bench::IsaCheck, nullptr},
+  {"axes", nullptr, bench::AxesBench},
+  {"indexed", nullptr, bench::IndexedBench},
+  {"order", bench::OrderCheck, nullptr},
+  {"quantized", bench::QuantizedCheck, bench::QuantizedBench},
+  {"bvh", bench::BvhCheck, nullptr},
+  {"bvh8", bench::Bvh8Check, bench::Bvh8Bench},
+  {"grid", bench::TriangleGridCheck, nullptr},
+  {"sparse_grid", bench::SparseGridCheck, nullptr},
+  {"voxels", bench::VoxelGridCheck, nullptr},
+  {"mesh_file", bench::MeshFileCheck, nullptr},
+  {"import", bench::ImportCheck, nullptr},
+  {"stream", bench::StreamCheck, nullptr},
+};
+
+/* Program entry point.
+ * Usage: overlap_bench [check | bench] [case name ...]
+ * Without mode both self-checks and benchmarks are run, without names all cases are run.
+ * Exit code is 1 if any self-check fails.
+ */
+int main( int ArgC, char *ArgV[] )
+{
+  bool IsCheck {true}, IsBench {true};
+  int FirstName {1};
+
+  if (ArgC > 1 && std::strcmp(ArgV[1], "check") == 0)
+    IsBench = false, FirstName++;
+  else if (ArgC > 1 && std::strcmp(ArgV[1], "bench") == 0)
+    IsCheck = false, FirstName++;
+
+  auto IsSelected {[&]( const char *Name )
+    {
+      if (FirstName >= ArgC)
+        return true;
+      for (int i {FirstName}; i < ArgC; i++)
+        if (std::strcmp(ArgV[i], Name) == 0)
+          return true;
+      return false;
+    }};
+
+  try
+  {
+    bool IsPassed {true};
+
+    std::printf("Supported instruction set: %s\n", math::GetIsaName(math::GetSupportedIsa()));
+    for (const bench::bench_case &Case : Cases)
+      if (IsSelected(Case.Name))
+      {
+        if (IsCheck && Case.Check != nullptr)
+        {
+          const bool IsOk {Case.Check()};
+
+          std::printf("check '%s': %s\n", Case.Name, IsOk ? "passed" : "FAILED");
+          IsPassed = IsPassed && IsOk;
+        }
+        if (IsBench && Case.Bench != nullptr)
+        {
+          std::printf("\nbench '%s':\n", Case.Name);
+          Case.Bench();
+        }
+      }
+    return IsPassed ? 0 : 1;
+  }
+  catch (std::exception &Error)
+  {
+    std::printf("Error: %s\n", Error.what());
+    return -1;
+  }
+} /* End of 'main' function */
+
+/* END OF 'bench.cpp' FILE */
@@ -0,0 +1,135 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_axes.hpp" - Separating axes evaluation orders benchmark */
+
+#ifndef __bench_axes_hpp__
+#define __bench_axes_hpp__
+
+#include "bench_def.h"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Box against triangles workload */
+  struct axes_dataset
+  {
+    const char *Name;               // Workload description
+    triangle_soa Tris;              // Triangles
+    std::vector<aabb<float>> Boxes; // Query boxes
+  }; /* end of 'axes_dataset' structure */
+
+  /* Axes orders benchmark workloads creation function.
+   * ARGUMENTS:
+   *   - Triangles count in every workload:
+   *       size_t TrisCount;
+   *   - Query boxes count in every workload:
+   *       size_t BoxesCount;
+   * RETURNS:
+   *   (std::vector<axes_dataset>) Workloads: mostly rejected by box faces, mixed and mostly rejected by triangle plane.
+   */
+  inline std::vector<axes_dataset> MakeAxesDatasets( size_t TrisCount, size_t BoxesCount )
+  {
+    random Rand {8};
+    std::vector<axes_dataset> Datasets(3);
+    auto MakeSmall {[&]( float Domain, float Size ) -> triangle<float>
+      {
+        const vec3<float> P {Rand.Point(0, Domain)};
+
+        return {P, P + Rand.Point(0, Size), P + Rand.Point(0, Size)};
+      }};
+
+    Datasets[0].Name = "scattered mesh, small boxes";
+    Datasets[1].Name = "local mesh, boxes within bounds";
+    Datasets[2].Name = "big slanted triangles, boxes near";
+    for (size_t i {0}; i < TrisCount; i++)
+    {
+      const triangle<float> Tris[3]
+      {
+        MakeSmall(100, 1),
+        MakeSmall(4, 3),
+        [&]() -> triangle<float>
+        {
+          const vec3<float> P {Rand.Point(0, 2)};
+
+          return {P + vec3<float> {-20, -20, 0}, P + vec3<float> {20, -20, 30}, P + vec3<float> {0, 20, -30}};
+        }(),
+      };
+
+      for (size_t k {0}; k < 3; k++)
+        Datasets[k].Tris.Append(std::span {&Tris[k], 1});
+    }
+    for (size_t i {0}; i < BoxesCount; i++)
+    {
+      Datasets[0].Boxes.push_back({Rand.Point(0, 100), {2, 2, 2}});
+      Datasets[1].Boxes.push_back({Rand.Point(0, 6), {0.3f, 0.3f, 0.3f}});
+      Datasets[2].Boxes.push_back({Rand.Point(0, 4), {0.2f, 0.2f, 0.2f}});
+    }
+    return Datasets;
+  } /* End of 'MakeAxesDatasets' function */
+
+  /* Axes orders benchmark function: raw and prepared triangles, every explicit order and instruction set.
+   * ARGUMENTS: None.
+   * RETURNS: None.
+   */
+  inline void AxesBench( void )
+  {
+    const size_t TrisCount {1 << 14}, BoxesCount {256};
+    const axes_order SavedOrder {GetAxesOrder()};
+
+    for (const axes_dataset &Dataset : MakeAxesDatasets(TrisCount, BoxesCount))
+    {
+      const triangles_soa_view<float> Tris {Dataset.Tris.GetView()};
+      const prepared_mesh Prepared {Tris};
+      axes_stats Stats;
+      std::vector<uint8_t> Masks((TrisCount + 7) / 8);
+
+      for (const aabb<float> &Box : Dataset.Boxes)
+        Stats.Add(Box, Tris, 61);
+      std::printf("\n%s: rejected by edges %.0f%%, box %.0f%%, plane %.0f%%, estimated best order: %s\n", Dataset.Name,
+        100.0 * Stats.GetRejections(axes_group::eEdges) / Stats.GetCount(),
+        100.0 * Stats.GetRejections(axes_group::eBox) / Stats.GetCount(),
+        100.0 * Stats.GetRejections(axes_group::ePlane) / Stats.GetCount(), GetAxesOrderName(Stats.GetBestOrder()));
+      std::printf("  %-8s %-12s %14s %14s %10s\n", "isa", "order", "raw, ns/pair", "prep, ns/pair", "est. cost");
+      ForEachIsa([&]( isa Isa )
+        {
+          for (size_t Order {(size_t)axes_order::eEdgesFirst}; Order < (size_t)axes_order::_LastValue; Order++)
+          {
+            SetAxesOrder((axes_order)Order);
+
+            const double Pairs {(double)TrisCount * Dataset.Boxes.size()};
+            const double Raw {MeasureNs([&]
+              {
+                for (const aabb<float> &Box : Dataset.Boxes)
+                  BoxTrianglesOverlapTest(Box, Tris, Masks);
+              }) / Pairs};
+            const double Prep {MeasureNs([&]
+              {
+                for (const aabb<float> &Box : Dataset.Boxes)
+                  BoxTrianglesOverlapTest(Box, Prepared.GetView(), Masks);
+              }) / Pairs};
+
+            std::printf("  %-8s %-12s %14.3f %14.3f %10.2f\n", GetIsaName(Isa), GetAxesOrderName((axes_order)Order),
+              Raw, Prep, Stats.GetCost((axes_order)Order));
+          }
+        });
+    }
+    SetAxesOrder(SavedOrder);
+  } /* End of 'AxesBench' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_axes_hpp__ */
+
+/* END OF 'bench_axes.hpp' FILE */
@@ -0,0 +1,173 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_bvh.hpp" - Binary hierarchy refitting self-check */
+
+#ifndef __bench_bvh_hpp__
+#define __bench_bvh_hpp__
+
+#include <cmath>
+#include <limits>
+
+#include "bench_def.h"
+#include "bench_bvh8.hpp"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Binary hierarchy structure validation function: every node is reachable exactly once (so compacting
+   * left no dropped nodes), leaves cover every triangle exactly once and bounds contain children and triangles.
+   * ARGUMENTS:
+   *   - Hierarchy:
+   *       const bvh &Bvh;
+   * RETURNS:
+   *   (bool) true if hierarchy is consistent.
+   */
+  inline bool IsBvhValid( const bvh &Bvh )
+  {
+    const std::span<const bvh_node> Nodes {Bvh.GetNodes()};
+    const triangles_soa_view<float> Tris {Bvh.GetTriangles()};
+    std::vector<uint8_t> IsVisited(Nodes.size()), IsCovered(Tris.Count);
+    std::vector<uint32_t> Stack {};
+    const auto IsInside {[]( const bvh_node &Node, const vec3<float> &Min, const vec3<float> &Max )
+      {
+        return
+          Node.Min.X <= Min.X && Node.Min.Y <= Min.Y && Node.Min.Z <= Min.Z &&
+          Node.Max.X >= Max.X && Node.Max.Y >= Max.Y && Node.Max.Z >= Max.Z;
+      }};
+
+    if (Nodes.empty())
+      return Tris.Count == 0;
+    for (Stack.push_back(0); !Stack.empty(); )
+    {
+      const uint32_t Index {Stack.back()};
+      const bvh_node &Node {Nodes[Index]};
+
+      Stack.pop_back();
+      if (IsVisited[Index]++ != 0)
+        return false;
+      if (Node.Count == 0)
+      {
+        if ((size_t)Node.Index + 1 >= Nodes.size() || Node.Index <= Index)
+          return false;
+        for (const uint32_t Child : {Node.Index, Node.Index + 1})
+          if (!IsInside(Node, Nodes[Child].Min, Nodes[Child].Max))
+            return false;
+          else
+            Stack.push_back(Child);
+        continue;
+      }
+      if ((size_t)Node.Index + Node.Count > Tris.Count)
+        return false;
+      for (size_t i {Node.Index}; i < Node.Index + Node.Count; i++)
+      {
+        bvh_bounds Bounds {};
+
+        Bounds.Extend(Tris[i].V0), Bounds.Extend(Tris[i].V1), Bounds.Extend(Tris[i].V2);
+        if (IsCovered[i]++ != 0 || !IsInside(Node, Bounds.Min, Bounds.Max))
+          return false;
+      }
+    }
+    return std::count(IsVisited.begin(), IsVisited.end(), 0) == 0 && std::count(IsCovered.begin(), IsCovered.end(), 0) == 0;
+  } /* End of 'IsBvhValid' function */
+
+  /* Binary hierarchy refitting self-check function.
+   * A sphere mesh is deformed frame by frame (twisted, and from the second frame on some triangles jump
+   * far away, so SAH cost grows). Two hierarchies are refit on every frame: with a small cost growth
+   * (subtrees are rebuilt and nodes compacted) and with infinite one (bounds only). Both must stay consistent,
+   * single box and batch queries must match the batch kernel on all deformed triangles.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if all hierarchies are valid and all queries match.
+   */
+  inline bool BvhCheck( void )
+  {
+    random Rand {21};
+    size_t Mismatches {0}, Queries {0}, Rebuilt {0};
+
+    for (size_t Count : {1, 100, 20000})
+      for (size_t ThreadsCount : {1, 4})
+      {
+        const triangle_soa Original {MakeSphereMesh(Rand, Count)};
+        bvh Rebuilding {Original.GetView(), ThreadsCount}, Refitting {Original.GetView(), ThreadsCount};
+        triangle_soa Deformed;
+
+        Deformed.Expand(Count);
+        for (size_t Frame {1}; Frame <= 4; Frame++)
+        {
+          /* Twist around Z, jumps are kept for later frames */
+          for (size_t i {0}; i < Count; i++)
+          {
+            const triangle<float> Tri {Original[i]};
+            vec3<float> V[3] {Tri.V0, Tri.V1, Tri.V2};
+
+            for (vec3<float> &P : V)
+            {
+              const float Angle {0.3f * (float)Frame * P.Z}, C {std::cos(Angle)}, S {std::sin(Angle)};
+
+              P = {P.X * C - P.Y * S, P.X * S + P.Y * C, P.Z * (1 + 0.1f * (float)Frame)};
+            }
+            if (Frame >= 2 && i % 20 == Frame % 20)
+            {
+              const vec3<float> Shift {Rand.Point(-3, 3)};
+
+              V[0] = V[0] + Shift, V[1] = V[1] + Shift, V[2] = V[2] + Shift;
+            }
+            Deformed.Set(i, V[0], V[1], V[2]);
+          }
+
+          const triangles_soa_view<float> View {Deformed.GetView()};
+
+          Rebuilt += Rebuilding.Refit(View, 1.05f, ThreadsCount);
+          Mismatches += Refitting.Refit(View, std::numeric_limits<float>::infinity(), ThreadsCount) != 0;
+          Mismatches += !IsBvhValid(Rebuilding) || !IsBvhValid(Refitting);
+          Mismatches += Rebuilding.GetNodes().size() > 2 * Count || Refitting.GetNodes().size() > 2 * Count;
+
+          /* Single box queries against the batch kernel, then the same boxes as a batch */
+          std::vector<aabb<float>> Boxes;
+          std::vector<std::pair<uint32_t, uint32_t>> Expected;
+          std::vector<uint32_t> Hits(Count);
+
+          for (size_t k {0}; k < 20; k++)
+          {
+            const float Half {k % 2 == 0 ? 0.05f : 0.5f};
+            const aabb<float> Box {k % 4 == 0 ? Deformed[Rand.Index(Count)].V1 : Rand.Point(-1.5f, 1.5f), {Half, Half * 0.7f, Half * 1.3f}};
+            const std::vector<uint32_t> Reference(Hits.begin(), Hits.begin() + BoxTrianglesOverlapTest(Box, View, std::span<uint32_t> {Hits}, 0));
+
+            for (const bvh *Hierarchy : {&Rebuilding, &Refitting})
+              Mismatches += GetQueryHits(*Hierarchy, Box) != Reference;
+            for (const uint32_t Triangle : Reference)
+              Expected.push_back({(uint32_t)Boxes.size(), Triangle});
+            Boxes.push_back(Box);
+            Queries++;
+          }
+          for (const bvh *Hierarchy : {&Rebuilding, &Refitting})
+          {
+            std::vector<std::pair<uint32_t, uint32_t>> Pairs;
+
+            Hierarchy->Query(std::span<const aabb<float>> {Boxes}, [&]( uint32_t Box, uint32_t Triangle ) { Pairs.push_back({Box, Triangle}); });
+            std::sort(Pairs.begin(), Pairs.end());
+            Mismatches += Pairs != Expected;
+          }
+        }
+      }
+    std::printf("  %zu queries, %zu triangles in rebuilt subtrees, %zu mismatches\n", Queries, Rebuilt, Mismatches);
+    return Mismatches == 0 && Rebuilt != 0;
+  } /* End of 'BvhCheck' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_bvh_hpp__ */
+
+/* END OF 'bench_bvh.hpp' FILE */
@@ -0,0 +1,161 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_bvh8.hpp" - Full precision against quantized 8-ary hierarchy self-check and benchmark */
+
+#ifndef __bench_bvh8_hpp__
+#define __bench_bvh8_hpp__
+
+#include <cmath>
+
+#include "bench_def.h"
+#include "overlap/overlap_bvh8.hpp"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Unit sphere mesh creation function: small random triangles around random points of the sphere.
+   * ARGUMENTS:
+   *   - Generator:
+   *       random &Rand;
+   *   - Triangles count:
+   *       size_t Count;
+   * RETURNS:
+   *   (triangle_soa) Triangles.
+   */
+  inline triangle_soa MakeSphereMesh( random &Rand, size_t Count )
+  {
+    const float Size {2 / std::sqrt((float)Count) + 0.001f};
+    triangle_soa Tris;
+
+    Tris.Expand(Count);
+    for (size_t i {0}; i < Count; i++)
+    {
+      const float U {Rand(-3.14159265f, 3.14159265f)}, V {Rand(-1.5f, 1.5f)};
+      const vec3<float> C {std::cos(U) * std::cos(V), std::sin(U) * std::cos(V), std::sin(V)};
+
+      Tris.Set(i, C, C + Rand.Point(-Size, Size), C + Rand.Point(-Size, Size));
+    }
+    return Tris;
+  } /* End of 'MakeSphereMesh' function */
+
+  /* Query hits collection function, hits are sorted.
+   * ARGUMENTS:
+   *   - Hierarchy:
+   *       const hierarchy &Hierarchy;
+   *   - Box:
+   *       const aabb<float> &Box;
+   * RETURNS:
+   *   (std::vector<uint32_t>) Sorted original indices of overlapping triangles.
+   */
+  template<class hierarchy>
+    std::vector<uint32_t> GetQueryHits( const hierarchy &Hierarchy, const aabb<float> &Box )
+    {
+      std::vector<uint32_t> Hits;
+
+      Hierarchy.Query(Box, [&]( uint32_t Index ) { Hits.push_back(Index); });
+      std::sort(Hits.begin(), Hits.end());
+      return Hits;
+    } /* End of 'GetQueryHits' function */
+
+  /* Quantized against full precision hierarchy self-check function.
+   * Both are queried by random boxes of three sizes on every instruction set, hit sets must be identical.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if all hit sets match.
+   */
+  inline bool Bvh8Check( void )
+  {
+    random Rand {20};
+    size_t Mismatches {0}, Queries {0};
+
+    for (size_t Count : {1, 2, 9, 100, 5000, 100000})
+    {
+      const triangle_soa Tris {MakeSphereMesh(Rand, Count)};
+      const bvh8 Wide {Tris.GetView()};
+      const quantized_bvh8 Quantized {Wide};
+
+      for (size_t k {0}; k < 30; k++)
+      {
+        const float Half {k % 3 == 0 ? 0.02f : k % 3 == 1 ? 0.2f : 1.f};
+        const aabb<float> Box {Rand.Point(-1.2f, 1.2f), {Half, Half * 0.7f, Half * 1.3f}};
+
+        ForEachIsa([&]( isa )
+          {
+            const std::vector<uint32_t> Hits {GetQueryHits(Wide, Box)};
+
+            Mismatches += Hits != GetQueryHits(Quantized, Box) || std::adjacent_find(Hits.begin(), Hits.end()) != Hits.end();
+            Queries++;
+          });
+      }
+    }
+    std::printf("  %zu queries, %zu mismatches\n", Queries, Mismatches);
+    return Mismatches == 0;
+  } /* End of 'Bvh8Check' function */
+
+  /* Quantized against full precision hierarchy benchmark function: nodes memory and query time on a 1M triangles sphere.
+   * ARGUMENTS: None.
+   * RETURNS: None.
+   */
+  inline void Bvh8Bench( void )
+  {
+    random Rand {20};
+    const triangle_soa Tris {MakeSphereMesh(Rand, 1 << 20)};
+    const bvh8 Wide {Tris.GetView()};
+    const quantized_bvh8 Quantized {Wide};
+
+    std::printf("  %zu triangles, bvh8 nodes %zu x %zu = %.1f MB, quantized_bvh8 nodes %zu x %zu = %.1f MB\n", Tris.GetCount(),
+      Wide.GetNodes().size(), sizeof(bvh8_node), Wide.GetNodes().size() * sizeof(bvh8_node) / 1e6,
+      Quantized.GetNodes().size(), sizeof(quantized_bvh8_node), Quantized.GetNodes().size() * sizeof(quantized_bvh8_node) / 1e6);
+    std::printf("  %-6s %-8s %14s %14s %10s %8s\n", "half", "isa", "bvh8, us/q", "quant., us/q", "hits/q", "same");
+    for (float Half : {0.001f, 0.01f, 0.05f, 0.2f})
+    {
+      std::vector<aabb<float>> Boxes(Half < 0.1f ? 4000 : 200);
+
+      for (aabb<float> &Box : Boxes)
+      {
+        const float U {Rand(-3.14159265f, 3.14159265f)}, V {Rand(-1.5f, 1.5f)};
+
+        Box = {{std::cos(U) * std::cos(V), std::sin(U) * std::cos(V), std::sin(V)}, {Half, Half, Half}};
+      }
+      ForEachIsa([&]( isa Isa )
+        {
+          size_t WideHits {0}, QuantizedHits {0};
+          const double WideNs {MeasureNs([&]
+            {
+              WideHits = 0;
+              for (const aabb<float> &Box : Boxes)
+                Wide.Query(Box, [&]( uint32_t ) { WideHits++; });
+            }, 3) / Boxes.size()};
+          const double QuantizedNs {MeasureNs([&]
+            {
+              QuantizedHits = 0;
+              for (const aabb<float> &Box : Boxes)
+                Quantized.Query(Box, [&]( uint32_t ) { QuantizedHits++; });
+            }, 3) / Boxes.size()};
+          bool IsSame {true};
+
+          for (size_t i {0}; i < Boxes.size() && IsSame; i += 37)
+            IsSame = GetQueryHits(Wide, Boxes[i]) == GetQueryHits(Quantized, Boxes[i]);
+          std::printf("  %-6.3f %-8s %14.2f %14.2f %10.1f %8s\n", Half, GetIsaName(Isa), WideNs / 1e3, QuantizedNs / 1e3,
+            (double)WideHits / Boxes.size(), IsSame && WideHits == QuantizedHits ? "yes" : "NO");
+        });
+    }
+  } /* End of 'Bvh8Bench' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_bvh8_hpp__ */
+
+/* END OF 'bench_bvh8.hpp' FILE */
@@ -0,0 +1,167 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_def.h" - Overlap benchmark and self-check common definitions file */
+
+#ifndef __bench_def_h__
+#define __bench_def_h__
+
+#include <cstdio>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "box_triangle_overlap_test.hpp"
+
+/* Benchmark namespace */
+namespace bench
+{
+  using namespace math;
+
+  /* Benchmark case */
+  struct bench_case
+  {
+    const char *Name;      // Case name, selects it from command line
+    bool (*Check)( void ); // Self-check function, returns false on failure (may be nullptr)
+    void (*Bench)( void ); // Benchmark function, prints results table (may be nullptr)
+  }; /* end of 'bench_case' structure */
+
+  /* Random numbers generator, fixed seed keeps runs comparable */
+  class random
+  {
+  private:
+    std::mt19937 Engine; // Generator engine
+
+  public:
+    /* Generator construction function.
+     * ARGUMENTS:
+     *   - Seed:
+     *       uint32_t Seed;
+     */
+    random( uint32_t Seed = 30 ) : Engine {Seed}
+    {
+    } /* End of 'random' function */
+
+    /* Uniform number getting function.
+     * ARGUMENTS:
+     *   - Range:
+     *       float Min, Max;
+     * RETURNS:
+     *   (float) Number in [Min, Max).
+     */
+    float operator()( float Min = 0, float Max = 1 )
+    {
+      return std::uniform_real_distribution<float> {Min, Max}(Engine);
+    } /* End of 'operator()' function */
+
+    /* Uniform point getting function.
+     * ARGUMENTS:
+     *   - Range of every component:
+     *       float Min, Max;
+     * RETURNS:
+     *   (vec3<float>) Point.
+     */
+    vec3<float> Point( float Min = 0, float Max = 1 )
+    {
+      const float X {(*this)(Min, Max)}, Y {(*this)(Min, Max)};
+
+      return {X, Y, (*this)(Min, Max)};
+    } /* End of 'Point' function */
+
+    /* Integer getting function.
+     * ARGUMENTS:
+     *   - Values count:
+     *       size_t Count;
+     * RETURNS:
+     *   (size_t) Number in [0, Count).
+     */
+    size_t Index( size_t Count )
+    {
+      return std::uniform_int_distribution<size_t> {0, Count - 1}(Engine);
+    } /* End of 'Index' function */
+
+    /* Generator engine getting function (for 'std::shuffle').
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::mt19937 &) Engine.
+     */
+    std::mt19937 &GetEngine( void ) noexcept
+    {
+      return Engine;
+    } /* End of 'GetEngine' function */
+  }; /* end of 'random' class */
+
+  /* Function time measurement function, the best of several runs is taken.
+   * ARGUMENTS:
+   *   - Measured function:
+   *       func_type &&Func;
+   *   - Repeats count:
+   *       size_t Repeats;
+   * RETURNS:
+   *   (double) Best run time in nanoseconds.
+   */
+  template<typename func_type>
+    double MeasureNs( func_type &&Func, size_t Repeats = 5 )
+    {
+      double Best {1e300};
+
+      for (size_t i {0}; i < Repeats; i++)
+      {
+        const auto Start {std::chrono::steady_clock::now()};
+
+        Func();
+        Best = std::min(Best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count());
+      }
+      return Best;
+    } /* End of 'MeasureNs' function */
+
+  /* Overlap mask bit getting function.
+   * ARGUMENTS:
+   *   - Masks:
+   *       std::span<const uint8_t> Masks;
+   *   - Element index:
+   *       size_t Index;
+   * RETURNS:
+   *   (bool) Bit value.
+   */
+  inline bool GetMaskBit( std::span<const uint8_t> Masks, size_t Index ) noexcept
+  {
+    return (Masks[Index / 8] >> Index % 8) & 1;
+  } /* End of 'GetMaskBit' function */
+
+  /* Supported instruction sets iteration function, the active one is restored afterwards.
+   * ARGUMENTS:
+   *   - Function called after every instruction set is applied:
+   *       func_type &&Func;
+   * RETURNS: None.
+   */
+  template<typename func_type>
+    void ForEachIsa( func_type &&Func )
+    {
+      const isa Saved {GetIsa()};
+
+      for (size_t i {0}; i <= (size_t)GetSupportedIsa(); i++)
+      {
+        SetIsa((isa)i);
+        Func((isa)i);
+      }
+      SetIsa(Saved);
+    } /* End of 'ForEachIsa' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_def_h__ */
+
+/* END OF 'bench_def.h' FILE */
@@ -0,0 +1,344 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_grid.hpp" - Triangle grids self-checks */
+
+#ifndef __bench_grid_hpp__
+#define __bench_grid_hpp__
+
+#include <cmath>
+#include <thread>
+#include <unordered_map>
+
+#include "bench_def.h"
+#include "overlap/overlap_sparse_grid.hpp"
+#include "overlap/overlap_voxelizer.hpp"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Grid test triangles creation function.
+   * Vertices are multiples of 1/16, so with cells of size 1/2 all separating axes arithmetic is exact and
+   * kernels of every instruction set agree with the scalar test, touching triangles included.
+   * Most triangles span a few cells, every 16th one spans many, some stick out of the grid.
+   * ARGUMENTS:
+   *   - Generator:
+   *       random &Rand;
+   *   - Triangles count:
+   *       size_t Count;
+   *   - Domain maximal corner (minimal one is zero):
+   *       const vec3<float> &Extent;
+   * RETURNS:
+   *   (triangle_soa) Triangles.
+   */
+  inline triangle_soa MakeGridMesh( random &Rand, size_t Count, const vec3<float> &Extent )
+  {
+    const auto Snap {[]( const vec3<float> &P ) -> vec3<float>
+      {
+        return {std::round(P.X * 16) / 16, std::round(P.Y * 16) / 16, std::round(P.Z * 16) / 16};
+      }};
+    triangle_soa Tris;
+
+    Tris.Expand(Count);
+    for (size_t i {0}; i < Count; i++)
+    {
+      const vec3<float> C {Rand(-0.5f, Extent.X + 0.5f), Rand(-0.5f, Extent.Y + 0.5f), Rand(-0.5f, Extent.Z + 0.5f)};
+      const float Size {i % 16 == 0 ? 3.f : 0.6f};
+
+      Tris.Set(i, Snap(C + Rand.Point(-Size, Size)), Snap(C + Rand.Point(-Size, Size)), Snap(C + Rand.Point(-Size, Size)));
+    }
+    return Tris;
+  } /* End of 'MakeGridMesh' function */
+
+  /* Reference overlapping cells enumeration function: every triangle is tested against all cells near its bounds by the scalar test.
+   * ARGUMENTS:
+   *   - Triangles:
+   *       const triangles_soa_view<float> &Tris;
+   *   - Grid descriptor:
+   *       const grid_desc &Desc;
+   *   - Cells range to enumerate in, inclusive:
+   *       const std::array<int32_t, 3> &Min, &Max;
+   *   - Overlapping cell processing function, called as Func(X, Y, Z, TriangleIndex) (triangles go in ascending order):
+   *       func &&Func;
+   * RETURNS: None.
+   */
+  template<class func>
+    void ForEachReferenceCell( const triangles_soa_view<float> &Tris, const grid_desc &Desc, const std::array<int32_t, 3> &Min, const std::array<int32_t, 3> &Max, func &&Func )
+    {
+      for (size_t i {0}; i < Tris.Count; i++)
+      {
+        const triangle<float> Tri {Tris[i]};
+        const triangle_cells_setup Setup {Tri, Desc};
+        const vec3<float> P[3] {Desc.ToCells(Tri.V0), Desc.ToCells(Tri.V1), Desc.ToCells(Tri.V2)};
+        std::array<int32_t, 3> Lo, Hi;
+
+        for (size_t a {0}; a < 3; a++)
+        {
+          Lo[a] = std::max((int32_t)std::floor(std::min({(&P[0].X)[a], (&P[1].X)[a], (&P[2].X)[a]})) - 1, Min[a]);
+          Hi[a] = std::min((int32_t)std::ceil(std::max({(&P[0].X)[a], (&P[1].X)[a], (&P[2].X)[a]})) + 1, Max[a]);
+        }
+        for (int32_t Z {Lo[2]}; Z <= Hi[2]; Z++)
+          for (int32_t Y {Lo[1]}; Y <= Hi[1]; Y++)
+            for (int32_t X {Lo[0]}; X <= Hi[0]; X++)
+              if (Setup.Test(X, Y, Z))
+                Func(X, Y, Z, (uint32_t)i);
+      }
+    } /* End of 'ForEachReferenceCell' function */
+
+  /* Reference dense grid cells building function.
+   * ARGUMENTS:
+   *   - Triangles:
+   *       const triangles_soa_view<float> &Tris;
+   *   - Grid descriptor:
+   *       const grid_desc &Desc;
+   *   - Cells count along every axis:
+   *       const std::array<uint32_t, 3> &Size;
+   * RETURNS:
+   *   (std::vector<std::vector<uint32_t>>) Ascending indices of overlapping triangles for every cell, X is the fastest changing coordinate.
+   */
+  inline std::vector<std::vector<uint32_t>> GetReferenceCells( const triangles_soa_view<float> &Tris, const grid_desc &Desc, const std::array<uint32_t, 3> &Size )
+  {
+    std::vector<std::vector<uint32_t>> Cells((size_t)Size[0] * Size[1] * Size[2]);
+
+    ForEachReferenceCell(Tris, Desc, {0, 0, 0}, {(int32_t)Size[0] - 1, (int32_t)Size[1] - 1, (int32_t)Size[2] - 1},
+      [&]( int32_t X, int32_t Y, int32_t Z, uint32_t Triangle )
+      {
+        Cells[((size_t)Z * Size[1] + Y) * Size[0] + X].push_back(Triangle);
+      });
+    return Cells;
+  } /* End of 'GetReferenceCells' function */
+
+  /* Uniform triangle grid self-check function.
+   * Grids are built on every instruction set with several threads counts, every cell span must equal
+   * the scalar reference. Sizes, whose cells count overflows, must be rejected.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if all cells match.
+   */
+  inline bool TriangleGridCheck( void )
+  {
+    random Rand {23};
+    const std::array<uint32_t, 3> Size {37, 21, 11};
+    const grid_desc Desc {{0, 0, 0}, {0.5f, 0.5f, 0.5f}};
+    size_t Mismatches {0}, Builds {0}, References {0};
+
+    for (size_t Count : {0, 1, 100, 20000})
+    {
+      const triangle_soa Tris {MakeGridMesh(Rand, Count, {Size[0] * 0.5f, Size[1] * 0.5f, Size[2] * 0.5f})};
+      const std::vector<std::vector<uint32_t>> Reference {GetReferenceCells(Tris.GetView(), Desc, Size)};
+
+      ForEachIsa([&]( isa )
+        {
+          for (size_t ThreadsCount : {1, 3, 0})
+          {
+            const triangle_grid Grid {Tris.GetView(), Desc, Size, ThreadsCount};
+
+            for (int32_t Z {0}; Z < (int32_t)Size[2]; Z++)
+              for (int32_t Y {0}; Y < (int32_t)Size[1]; Y++)
+                for (int32_t X {0}; X < (int32_t)Size[0]; X++)
+                {
+                  const std::span<const uint32_t> Cell {Grid.GetCell(X, Y, Z)};
+                  const std::vector<uint32_t> &Expected {Reference[Grid.GetCellIndex(X, Y, Z)]};
+
+                  Mismatches += !std::equal(Cell.begin(), Cell.end(), Expected.begin(), Expected.end());
+                }
+            References += Grid.GetIndices().size();
+            Builds++;
+          }
+        });
+    }
+
+    /* Cells count of 2^64 wraps to zero in 64-bit arithmetic */
+    for (const std::array<uint32_t, 3> &Huge : {std::array<uint32_t, 3> {1 << 24, 1 << 24, 1 << 16}, std::array<uint32_t, 3> {1 << 16, 1 << 16, 1}})
+      try
+      {
+        const triangle_soa Tris {MakeGridMesh(Rand, 1, {1, 1, 1})};
+
+        triangle_grid {Tris.GetView(), Desc, Huge};
+        Mismatches++;
+      }
+      catch (std::out_of_range &)
+      {
+      }
+    std::printf("  %zu builds, %zu references, %zu mismatches\n", Builds, References, Mismatches);
+    return Mismatches == 0;
+  } /* End of 'TriangleGridCheck' function */
+
+  /* Sparse triangle grid self-check function.
+   * Triangles go to the builder from several threads at once (single threaded calls on interleaved slices) or by one
+   * call split between threads. The table starts small, so it grows many times during insertion, and the frozen
+   * table is large enough to be rehashed by several threads. Every non-empty reference cell must have the same span.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if all cells match.
+   */
+  inline bool SparseGridCheck( void )
+  {
+    constexpr size_t Count {100000}, SlicesCount {16}, ThreadsCount {4};
+    random Rand {24};
+    const grid_desc Desc {{-16, -8, -4}, {0.5f, 0.5f, 0.5f}};
+    const triangle_soa Tris {MakeGridMesh(Rand, Count, {60, 30, 20})};
+    const triangles_soa_view<float> View {Tris.GetView()};
+    std::unordered_map<uint64_t, std::vector<uint32_t>> Reference;
+    size_t Mismatches {0}, Builds {0};
+
+    ForEachReferenceCell(View, Desc,
+      {sparse_grid_slot::MinCoord, sparse_grid_slot::MinCoord, sparse_grid_slot::MinCoord},
+      {sparse_grid_slot::MaxCoord, sparse_grid_slot::MaxCoord, sparse_grid_slot::MaxCoord},
+      [&]( int32_t X, int32_t Y, int32_t Z, uint32_t Triangle )
+      {
+        Reference[sparse_grid_slot::GetKey(X, Y, Z)].push_back(Triangle);
+      });
+
+    for (const bool IsConcurrent : {true, false})
+    {
+      sparse_triangle_grid_builder Builder {Desc};
+
+      if (IsConcurrent)
+      {
+        std::vector<std::thread> Threads;
+
+        for (size_t t {0}; t < ThreadsCount; t++)
+          Threads.emplace_back([&, t]
+            {
+              for (size_t s {t}; s < SlicesCount; s += ThreadsCount)
+              {
+                const size_t First {Count * s / SlicesCount}, End {Count * (s + 1) / SlicesCount};
+                triangles_soa_view<float> Slice {View};
+
+                for (size_t k {0}; k < 3; k++)
+                  Slice.X[k] += First, Slice.Y[k] += First, Slice.Z[k] += First;
+                Slice.Count = End - First;
+                Builder.Insert(Slice, (uint32_t)First, 1);
+              }
+            });
+        for (std::thread &Thread : Threads)
+          Thread.join();
+      }
+      else
+        Builder.Insert(View, 0, ThreadsCount);
+
+      Mismatches += Builder.GetCellsCount() != Reference.size();
+
+      const sparse_triangle_grid Grid {Builder.Freeze(ThreadsCount)};
+      size_t CellsCount {0};
+
+      Grid.ForEachCell([&]( int32_t X, int32_t Y, int32_t Z, std::span<const uint32_t> Cell )
+        {
+          const auto Expected {Reference.find(sparse_grid_slot::GetKey(X, Y, Z))};
+
+          Mismatches += Expected == Reference.end() || !std::equal(Cell.begin(), Cell.end(), Expected->second.begin(), Expected->second.end());
+          CellsCount++;
+        });
+      for (const auto &[Key, Expected] : Reference)
+      {
+        const sparse_grid_slot Slot {Key};
+        const std::array<int32_t, 3> Coords {Slot.GetCoords()};
+        const std::span<const uint32_t> Cell {Grid.GetCell(Coords[0], Coords[1], Coords[2])};
+
+        Mismatches += !std::equal(Cell.begin(), Cell.end(), Expected.begin(), Expected.end());
+      }
+      Mismatches += CellsCount != Reference.size() || Grid.GetCellsCount() != Reference.size();
+      Builds++;
+    }
+    std::printf("  %zu builds, %zu cells, %zu mismatches\n", Builds, Reference.size(), Mismatches);
+    return Mismatches == 0;
+  } /* End of 'SparseGridCheck' function */
+
+  /* Voxel grid self-check function.
+   * Grid sizes are not multiples of the tile size and voxels are small: some triangles lie inside one voxel,
+   * most span a few voxels across tile borders, some span many tiles. Grids are built on every instruction set
+   * with 1 and 3 threads, every voxel must equal triangle_cells_setup::Test of triangles near it.
+   * Sizes, whose words count overflows, must be rejected.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if all voxels match.
+   */
+  inline bool VoxelGridCheck( void )
+  {
+    random Rand {25};
+    const std::array<uint32_t, 3> Size {150, 70, 67};
+    const grid_desc Desc {{0, 0, 0}, {0.125f, 0.125f, 0.125f}};
+    const vec3<float> Extent {Size[0] * 0.125f, Size[1] * 0.125f, Size[2] * 0.125f};
+    triangle_soa Tris {MakeGridMesh(Rand, 3000, Extent)};
+
+    /* Triangles inside one voxel (vertices within a quarter voxel of its center) and triangles across the grid */
+    for (size_t i {0}; i < 300; i++)
+    {
+      const vec3<float> C {(float)Rand.Index(Size[0]) + 0.5f, (float)Rand.Index(Size[1]) + 0.5f, (float)Rand.Index(Size[2]) + 0.5f};
+      const auto Vertex {[&]( void ) -> vec3<float>
+        {
+          return {(C.X + (float)Rand.Index(3) * 0.25f - 0.25f) * 0.125f, (C.Y + (float)Rand.Index(3) * 0.25f - 0.25f) * 0.125f, (C.Z + (float)Rand.Index(3) * 0.25f - 0.25f) * 0.125f};
+        }};
+      const vec3<float> V[3] {Vertex(), Vertex(), Vertex()};
+
+      Tris.Append(std::span<const vec3<float>> {V});
+    }
+    for (size_t i {0}; i < 10; i++)
+    {
+      const auto Vertex {[&]( void ) -> vec3<float>
+        {
+          return {std::round(Rand(0, Extent.X) * 16) / 16, std::round(Rand(0, Extent.Y) * 16) / 16, std::round(Rand(0, Extent.Z) * 16) / 16};
+        }};
+      const vec3<float> V[3] {Vertex(), Vertex(), Vertex()};
+
+      Tris.Append(std::span<const vec3<float>> {V});
+    }
+
+    std::vector<uint8_t> Reference((size_t)Size[0] * Size[1] * Size[2]);
+    size_t Mismatches {0}, Builds {0}, SetCount {0};
+
+    ForEachReferenceCell(Tris.GetView(), Desc, {0, 0, 0}, {(int32_t)Size[0] - 1, (int32_t)Size[1] - 1, (int32_t)Size[2] - 1},
+      [&]( int32_t X, int32_t Y, int32_t Z, uint32_t )
+      {
+        Reference[((size_t)Z * Size[1] + Y) * Size[0] + X] = 1;
+      });
+    for (const uint8_t Voxel : Reference)
+      SetCount += Voxel;
+
+    ForEachIsa([&]( isa )
+      {
+        for (size_t ThreadsCount : {1, 3})
+        {
+          const voxel_grid Grid {Tris.GetView(), Desc, Size, ThreadsCount};
+
+          for (int32_t Z {0}; Z < (int32_t)Size[2]; Z++)
+            for (int32_t Y {0}; Y < (int32_t)Size[1]; Y++)
+              for (int32_t X {0}; X < (int32_t)Size[0]; X++)
+                Mismatches += Grid.IsSet(X, Y, Z) != (Reference[((size_t)Z * Size[1] + Y) * Size[0] + X] != 0);
+
+          /* Bits past the row end must stay clear */
+          Mismatches += Grid.GetSetCount() != SetCount;
+          Builds++;
+        }
+      });
+
+    /* Words count of 2^18 x 2^24 x 2^24 wraps to zero in 64-bit arithmetic */
+    try
+    {
+      voxel_grid {Tris.GetView(), Desc, {voxel_grid::MaxSize, voxel_grid::MaxSize, voxel_grid::MaxSize}};
+      Mismatches++;
+    }
+    catch (std::out_of_range &)
+    {
+    }
+    std::printf("  %zu builds, %zu set voxels, %zu mismatches\n", Builds, SetCount, Mismatches);
+    return Mismatches == 0;
+  } /* End of 'VoxelGridCheck' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_grid_hpp__ */
+
+/* END OF 'bench_grid.hpp' FILE */
@@ -0,0 +1,320 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_import.hpp" - Mesh import round-trip and error handling self-check */
+
+#ifndef __bench_import_hpp__
+#define __bench_import_hpp__
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "bench_def.h"
+#include "bench_mesh_file.hpp"
+#include "overlap/overlap_import.hpp"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Import test mesh: shared vertices and polygons (mostly triangles, some quads and pentagons) */
+  struct import_mesh
+  {
+    std::vector<vec3<float>> Vertices;        // Vertices
+    std::vector<std::vector<uint32_t>> Faces; // Polygons vertex indices
+
+    /* Triangles, polygons are fan triangulated around their first vertex, getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::vector<triangle<float>>) Triangles.
+     */
+    std::vector<triangle<float>> GetTriangles( void ) const
+    {
+      std::vector<triangle<float>> Tris;
+
+      for (const std::vector<uint32_t> &Face : Faces)
+        for (size_t k {2}; k < Face.size(); k++)
+          Tris.push_back({Vertices[Face[0]], Vertices[Face[k - 1]], Vertices[Face[k]]});
+      return Tris;
+    } /* End of 'GetTriangles' function */
+  }; /* end of 'import_mesh' structure */
+
+  /* Binary value appending function.
+   * ARGUMENTS:
+   *   - Bytes:
+   *       std::string &Bytes;
+   *   - Value:
+   *       type Value;
+   *   - Big endian order flag:
+   *       bool IsBigEndian;
+   * RETURNS: None.
+   */
+  template<class type>
+    void AppendBinary( std::string &Bytes, type Value, bool IsBigEndian = false )
+    {
+      char Data[sizeof(type)];
+
+      std::memcpy(Data, &Value, sizeof Data);
+      if (IsBigEndian)
+        std::reverse(Data, Data + sizeof Data);
+      Bytes.append(Data, sizeof Data);
+    } /* End of 'AppendBinary' function */
+
+  /* Float exact text representation appending function.
+   * ARGUMENTS:
+   *   - Text:
+   *       std::string &Text;
+   *   - Prefix and vector:
+   *       const char *Prefix; const vec3<float> &V;
+   * RETURNS: None.
+   */
+  inline void AppendVector( std::string &Text, const char *Prefix, const vec3<float> &V )
+  {
+    char Line[128];
+
+    std::snprintf(Line, sizeof Line, "%s %.9g %.9g %.9g\n", Prefix, V.X, V.Y, V.Z);
+    Text += Line;
+  } /* End of 'AppendVector' function */
+
+  /* Binary STL writing function, header starts with 'solid' as many exporters write it.
+   * ARGUMENTS:
+   *   - Triangles:
+   *       const std::vector<triangle<float>> &Tris;
+   *   - Trailing bytes count after records:
+   *       size_t TrailingCount;
+   * RETURNS:
+   *   (std::string) File bytes.
+   */
+  inline std::string WriteStlBinary( const std::vector<triangle<float>> &Tris, size_t TrailingCount )
+  {
+    std::string Bytes {"solid exported by overlap_bench"};
+
+    Bytes.resize(80, ' ');
+    AppendBinary(Bytes, (uint32_t)Tris.size());
+    for (const triangle<float> &Tri : Tris)
+    {
+      for (const float Value : {0.f, 0.f, 1.f, Tri.V0.X, Tri.V0.Y, Tri.V0.Z, Tri.V1.X, Tri.V1.Y, Tri.V1.Z, Tri.V2.X, Tri.V2.Y, Tri.V2.Z})
+        AppendBinary(Bytes, Value);
+      AppendBinary(Bytes, uint16_t {0});
+    }
+    Bytes.append(TrailingCount, '\0');
+    return Bytes;
+  } /* End of 'WriteStlBinary' function */
+
+  /* ASCII STL writing function.
+   * ARGUMENTS:
+   *   - Triangles:
+   *       const std::vector<triangle<float>> &Tris;
+   * RETURNS:
+   *   (std::string) File text.
+   */
+  inline std::string WriteStlAscii( const std::vector<triangle<float>> &Tris )
+  {
+    std::string Text {"solid mesh\n"};
+
+    for (const triangle<float> &Tri : Tris)
+    {
+      Text += "  facet normal 0 0 1\n    outer loop\n";
+      for (const vec3<float> &V : {Tri.V0, Tri.V1, Tri.V2})
+        AppendVector(Text, "      vertex", V);
+      Text += "    endloop\n  endfacet\n";
+    }
+    return Text + "endsolid mesh\n";
+  } /* End of 'WriteStlAscii' function */
+
+  /* OBJ writing function: faces use all reference forms (plain, with texture and normal, relative).
+   * ARGUMENTS:
+   *   - Mesh:
+   *       const import_mesh &Mesh;
+   * RETURNS:
+   *   (std::string) File text.
+   */
+  inline std::string WriteObj( const import_mesh &Mesh )
+  {
+    std::string Text {"# overlap_bench\nvt 0 0\nvn 0 0 1\n"};
+
+    for (const vec3<float> &V : Mesh.Vertices)
+      AppendVector(Text, "v", V);
+    for (size_t f {0}; f < Mesh.Faces.size(); f++)
+    {
+      Text += f % 4 == 0 ? "f" : "f ";
+      for (const uint32_t Ref : Mesh.Faces[f])
+        switch (f % 4)
+        {
+        case 0:
+          Text += " " + std::to_string(Ref + 1);
+          break;
+        case 1:
+          Text += std::to_string(Ref + 1) + "/1 ";
+          break;
+        case 2:
+          Text += std::to_string(Ref + 1) + "/1/1\t";
+          break;
+        default:
+          Text += std::to_string((int64_t)Ref - (int64_t)Mesh.Vertices.size()) + "//1 ";
+          break;
+        }
+      Text += f % 8 == 0 ? " # comment\r\n" : "\n";
+    }
+    return Text;
+  } /* End of 'WriteObj' function */
+
+  /* Binary PLY writing function: vertices have an extra property, faces have an extra property after the list.
+   * ARGUMENTS:
+   *   - Mesh:
+   *       const import_mesh &Mesh;
+   *   - Big endian data with double coordinates flag:
+   *       bool IsBigEndian;
+   * RETURNS:
+   *   (std::string) File bytes.
+   */
+  inline std::string WritePly( const import_mesh &Mesh, bool IsBigEndian )
+  {
+    const char *Type {IsBigEndian ? "double" : "float"};
+    std::string Bytes
+    {
+      std::string {"ply\nformat "} + (IsBigEndian ? "binary_big_endian" : "binary_little_endian") + " 1.0\ncomment overlap_bench\n"
+      "element vertex " + std::to_string(Mesh.Vertices.size()) + "\nproperty uchar flags\n"
+      "property " + Type + " x\nproperty " + Type + " y\nproperty " + Type + " z\n"
+      "element face " + std::to_string(Mesh.Faces.size()) + "\nproperty list uchar int vertex_indices\nproperty ushort material\nend_header\n"
+    };
+
+    for (const vec3<float> &V : Mesh.Vertices)
+    {
+      AppendBinary(Bytes, uint8_t {7});
+      for (const float Value : {V.X, V.Y, V.Z})
+        if (IsBigEndian)
+          AppendBinary(Bytes, (double)Value, true);
+        else
+          AppendBinary(Bytes, Value);
+    }
+    for (const std::vector<uint32_t> &Face : Mesh.Faces)
+    {
+      AppendBinary(Bytes, (uint8_t)Face.size());
+      for (const uint32_t Ref : Face)
+        AppendBinary(Bytes, (int32_t)Ref, IsBigEndian);
+      AppendBinary(Bytes, uint16_t {3}, IsBigEndian);
+    }
+    return Bytes;
+  } /* End of 'WritePly' function */
+
+  /* Mesh import self-check function.
+   * Random meshes are written in every format and imported with format detection by 1 and 3 threads (large
+   * texts are cut into several parts), triangles must be bit exact. Binary STL headers start with 'solid',
+   * one file has trailing bytes after records. Malformed files of every format must be rejected.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if all meshes match and all malformed files are rejected.
+   */
+  inline bool ImportCheck( void )
+  {
+    random Rand {16};
+    size_t Mismatches {0}, Imports {0}, Rejected {0};
+
+    const auto Compare {[&]( const std::string &Bytes, mesh_format Format, const std::vector<triangle<float>> &Expected )
+      {
+        Mismatches += DetectMeshFormat(Bytes) != Format;
+        for (size_t ThreadsCount : {1, 3})
+        {
+          const triangle_soa Tris {ImportMesh(std::span<const char> {Bytes}, ThreadsCount)};
+
+          Mismatches += Tris.GetCount() != Expected.size();
+          for (size_t i {0}; i < std::min(Tris.GetCount(), Expected.size()); i++)
+            Mismatches += Tris[i].V0 != Expected[i].V0 || Tris[i].V1 != Expected[i].V1 || Tris[i].V2 != Expected[i].V2;
+          Imports++;
+        }
+      }};
+
+    for (size_t FacesCount : {0, 5, 100000})
+    {
+      import_mesh Mesh;
+
+      for (size_t i {0}; i < FacesCount / 2 + 5; i++)
+        Mesh.Vertices.push_back(Rand.Point(-100, 100));
+      for (size_t f {0}; f < FacesCount; f++)
+      {
+        std::vector<uint32_t> &Face {Mesh.Faces.emplace_back(f % 16 == 0 ? 4 : f % 16 == 1 ? 5 : 3)};
+
+        for (uint32_t &Ref : Face)
+          Ref = (uint32_t)Rand.Index(Mesh.Vertices.size());
+      }
+
+      const std::vector<triangle<float>> Expected {Mesh.GetTriangles()};
+
+      Compare(WriteStlBinary(Expected, 0), mesh_format::eStlBinary, Expected);
+      Compare(WriteStlBinary(Expected, 100), mesh_format::eStlBinary, Expected);
+      Compare(WriteStlAscii(Expected), mesh_format::eStlAscii, Expected);
+      Compare(WriteObj(Mesh), mesh_format::eObj, Expected);
+      Compare(WritePly(Mesh, false), mesh_format::ePly, Expected);
+      Compare(WritePly(Mesh, true), mesh_format::ePly, Expected);
+
+      /* Mapped file import */
+      if (FacesCount == 5)
+      {
+        const std::filesystem::path Path {std::filesystem::temp_directory_path() / "overlap_bench_check.stl"};
+        const std::string Bytes {WriteStlBinary(Expected, 3)};
+
+        WriteBytes(Path, {reinterpret_cast<const uint8_t *>(Bytes.data()), Bytes.size()});
+        Mismatches += ImportMesh(Path).GetCount() != Expected.size();
+        std::filesystem::remove(Path);
+      }
+    }
+
+    /* Malformed files */
+    const auto Reject {[&]( const std::string &Bytes, std::optional<mesh_format> Format = std::nullopt )
+      {
+        try
+        {
+          if (Format)
+            ImportMesh(std::span<const char> {Bytes}, *Format);
+          else
+            ImportMesh(std::span<const char> {Bytes});
+          Mismatches++;
+        }
+        catch (std::runtime_error &)
+        {
+          Rejected++;
+        }
+      }};
+    const import_mesh Quad {{{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}}, {{0, 1, 2, 3}}};
+    const std::string Stl {WriteStlBinary(Quad.GetTriangles(), 0)}, Ply {WritePly(Quad, false)};
+
+    Reject(Stl.substr(0, Stl.size() - 1));
+    Reject(Stl.substr(0, Stl.size() - 1), mesh_format::eStlBinary);
+    Reject(Stl.substr(0, 60), mesh_format::eStlBinary);
+    Reject("solid mesh\n  facet normal 0 0 1\n    outer loop\n      vertex 0 0 0\n      vertex 1 0 0\n    endloop\n  endfacet\nendsolid mesh\n");
+    Reject("solid mesh\n  facet normal 0 0 1\n    outer loop\n      vertex 0 0 0\n      vertex 1 x 0\n      vertex 0 1 0\n");
+    Reject("solid mesh\n");
+    Reject(Stl, mesh_format::eStlAscii);
+    Reject("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2\n");
+    Reject("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n");
+    Reject("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 0 1 2\n");
+    Reject("v 0 0 0\nv 1 0 0\nv 0 1\nf 1 2 3\n");
+    Reject("v 0 0 0\nv 1 0 0\nv 0 1 0\nf -4 -2 -1\n");
+    Reject("ply\nformat ascii 1.0\nelement vertex 0\nproperty float x\nend_header\n");
+    Reject("ply\nformat binary_little_endian 1.0\nelement vertex 0\nproperty float x\n");
+    Reject(Ply.substr(0, Ply.size() - 3));
+    Reject(WritePly({Quad.Vertices, {{0, 1}}}, false));
+    Reject(WritePly({Quad.Vertices, {{0, 1, 4}}}, false));
+    Reject(std::string {"\x01\x02\0\x03", 4});
+
+    std::printf("  %zu imports, %zu malformed files rejected, %zu mismatches\n", Imports, Rejected, Mismatches);
+    return Mismatches == 0;
+  } /* End of 'ImportCheck' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_import_hpp__ */
+
+/* END OF 'bench_import.hpp' FILE */
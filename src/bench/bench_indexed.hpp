@@ -0,0 +1,96 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_indexed.hpp" - Indexed mesh against triangle soup benchmark */
+
+#ifndef __bench_indexed_hpp__
+#define __bench_indexed_hpp__
+
+#include "bench_def.h"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Indexed mesh against triangle soup benchmark function.
+   * Mesh is a 2048 x 2048 vertices height field, triangles go in rows order (neighbours share
+   * cache lines of the vertex buffer) and then shuffled (every gather misses cache).
+   * ARGUMENTS: None.
+   * RETURNS: None.
+   */
+  inline void IndexedBench( void )
+  {
+    const size_t Size {2048};
+    random Rand {12};
+    std::vector<float> Vertices;
+    std::vector<uint32_t> Indices;
+
+    Vertices.reserve(Size * Size * 3);
+    for (size_t y {0}; y < Size; y++)
+      for (size_t x {0}; x < Size; x++)
+        Vertices.insert(Vertices.end(), {(float)x / Size, (float)y / Size, 0.01f * std::sin(x * 0.1f + y * 0.07f)});
+    Indices.reserve((Size - 1) * (Size - 1) * 6);
+    for (uint32_t y {0}; y + 1 < Size; y++)
+      for (uint32_t x {0}; x + 1 < Size; x++)
+      {
+        const uint32_t A {y * (uint32_t)Size + x}, B {A + 1}, C {A + (uint32_t)Size}, D {C + 1};
+
+        Indices.insert(Indices.end(), {A, B, C, B, D, C});
+      }
+
+    const size_t TrisCount {Indices.size() / 3};
+    const aabb<float> Box {{0.5f, 0.5f, 0}, {0.1f, 0.1f, 0.1f}};
+    std::vector<uint8_t> Masks((TrisCount + 7) / 8);
+
+    std::printf("  %-9s %-8s %10s %14s %10s %14s\n", "layout", "isa", "soup, MB", "soup, ns/tri", "index, MB", "index, ns/tri");
+    for (const char *Layout : {"ordered", "shuffled"})
+    {
+      if (Layout[0] == 's')
+      {
+        std::vector<uint32_t> Order(TrisCount), Shuffled(Indices.size());
+
+        for (size_t i {0}; i < TrisCount; i++)
+          Order[i] = (uint32_t)i;
+        std::shuffle(Order.begin(), Order.end(), Rand.GetEngine());
+        for (size_t i {0}; i < TrisCount; i++)
+          for (size_t k {0}; k < 3; k++)
+            Shuffled[i * 3 + k] = Indices[Order[i] * 3 + k];
+        Indices.swap(Shuffled);
+      }
+
+      const indexed_triangles_view Indexed {Vertices.data(), 3, Size * Size, Indices.data(), TrisCount};
+      triangle_soa Soup;
+
+      Soup.Expand(TrisCount);
+      for (size_t i {0}; i < TrisCount; i++)
+      {
+        const triangle<float> Tri {Indexed[i]};
+
+        Soup.Set(i, Tri.V0, Tri.V1, Tri.V2);
+      }
+      ForEachIsa([&]( isa Isa )
+        {
+          const double SoupNs {MeasureNs([&] { BoxTrianglesOverlapTest(Box, Soup.GetView(), Masks); }, 3) / TrisCount};
+          const double IndexedNs {MeasureNs([&] { BoxTrianglesOverlapTest(Box, Indexed, Masks); }, 3) / TrisCount};
+
+          std::printf("  %-9s %-8s %10.0f %14.3f %10.0f %14.3f\n", Layout, GetIsaName(Isa),
+            TrisCount * 36 / 1e6, SoupNs, (TrisCount * 12 + Size * Size * 12) / 1e6, IndexedNs);
+        });
+    }
+  } /* End of 'IndexedBench' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_indexed_hpp__ */
+
+/* END OF 'bench_indexed.hpp' FILE */
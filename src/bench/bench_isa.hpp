@@ -0,0 +1,264 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_isa.hpp" - Instruction sets and axes orders dispatch self-check */
+
+#ifndef __bench_isa_hpp__
+#define __bench_isa_hpp__
+
+#include "bench_def.h"
+#include "overlap/overlap_buckets.hpp"
+#include "overlap/overlap_bvh8.hpp"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Masks against reference flags comparison function.
+   * ARGUMENTS:
+   *   - Masks:
+   *       std::span<const uint8_t> Masks;
+   *   - Reference flags:
+   *       const std::vector<bool> &Ref;
+   * RETURNS:
+   *   (bool) true if every bit matches its flag.
+   */
+  inline bool IsMasksMatch( std::span<const uint8_t> Masks, const std::vector<bool> &Ref )
+  {
+    for (size_t i {0}; i < Ref.size(); i++)
+      if (GetMaskBit(Masks, i) != Ref[i])
+        return false;
+    return true;
+  } /* End of 'IsMasksMatch' function */
+
+  /* Indices against reference flags comparison function, indices order is ignored.
+   * ARGUMENTS:
+   *   - Indices:
+   *       std::span<const uint32_t> Indices;
+   *   - Value added to every index:
+   *       uint32_t IndexBase;
+   *   - Reference flags:
+   *       const std::vector<bool> &Ref;
+   * RETURNS:
+   *   (bool) true if indices are exactly the set flags.
+   */
+  inline bool IsIndicesMatch( std::span<const uint32_t> Indices, uint32_t IndexBase, const std::vector<bool> &Ref )
+  {
+    std::vector<bool> Got(Ref.size());
+
+    for (uint32_t Index : Indices)
+    {
+      if (Index < IndexBase || Index - IndexBase >= Ref.size() || Got[Index - IndexBase])
+        return false;
+      Got[Index - IndexBase] = true;
+    }
+    return Got == Ref;
+  } /* End of 'IsIndicesMatch' function */
+
+  /* Instruction sets and axes orders dispatch self-check function.
+   * Every entry point is run for every supported instruction set and axes order and compared
+   * with scalar 'BoxTriangleOverlapTest'/'BoxTriangleClassify'. Coordinates lie on a 1/8 grid
+   * within [-2, 2], so all products are exact and kernels (FMA, prepared data, cells space)
+   * must match the reference bit for bit; quantized kernels are conservative, so only missed
+   * overlaps are failures for them.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if all results match.
+   */
+  inline bool IsaCheck( void )
+  {
+    const size_t TrisCount {203}, BoxesCount {64}, CentersCount {100};
+    random Rand {4};
+    auto Snap {[&]( float Min, float Max ) { return std::round(Rand(Min, Max) * 8) / 8; }};
+    auto SnapPoint {[&]( float Min, float Max ) -> vec3<float>
+      {
+        const float X {Snap(Min, Max)}, Y {Snap(Min, Max)};
+
+        return {X, Y, Snap(Min, Max)};
+      }};
+
+    /* Triangles: general, axis aligned, segments and points (bucketed kernels split them) */
+    triangle_soa Tris;
+
+    for (size_t i {0}; i < TrisCount; i++)
+    {
+      vec3<float> V[3] {SnapPoint(-2, 2), SnapPoint(-2, 2), SnapPoint(-2, 2)};
+      const size_t Kind {Rand.Index(6)};
+
+      if (Kind >= 1 && Kind <= 3)
+      {
+        const float W {Snap(-2, 2)};
+
+        for (vec3<float> &P : V)
+          (Kind == 1 ? P.X : Kind == 2 ? P.Y : P.Z) = W;
+      }
+      else if (Kind == 4)
+        V[2] = V[0] + (V[1] - V[0]) * 0.5f;
+      else if (Kind == 5)
+        V[1] = V[2] = V[0];
+      Tris.Append(std::span<const vec3<float>> {V});
+    }
+
+    /* Other storage formats of the same triangles: indexed with strided vertices in reversed order */
+    const triangles_soa_view<float> View {Tris.GetView()};
+    std::vector<float> Vertices(TrisCount * 3 * 4);
+    std::vector<uint32_t> Indices(TrisCount * 3);
+
+    for (size_t i {0}; i < TrisCount; i++)
+    {
+      const triangle<float> Tri {View[i]};
+      const vec3<float> V[3] {Tri.V0, Tri.V1, Tri.V2};
+
+      for (size_t k {0}; k < 3; k++)
+      {
+        const size_t Vertex {(TrisCount - 1 - i) * 3 + k};
+
+        Vertices[Vertex * 4] = V[k].X, Vertices[Vertex * 4 + 1] = V[k].Y, Vertices[Vertex * 4 + 2] = V[k].Z;
+        Indices[i * 3 + k] = (uint32_t)Vertex;
+      }
+    }
+
+    const indexed_triangles_view Indexed {Vertices.data(), 4, TrisCount * 3, Indices.data(), TrisCount};
+    const prepared_mesh Prepared {View};
+    const quantized_mesh Quantized {View};
+    const bucketed_mesh Bucketed {View};
+    const bvh Bvh {View};
+    const bvh8 Bvh8 {View};
+    const quantized_bvh8 QuantizedBvh8 {Bvh8};
+
+    /* Queries: boxes, equally sized boxes centers and grid cells */
+    std::vector<aabb<float>> Boxes;
+    std::vector<float> Centers[3];
+    std::vector<int32_t> Cells[3];
+    const vec3<float> CentersHalfSize {0.25f, 0.125f, 0.375f};
+    const grid_desc Grid {{-2, -2, -2}, {0.25f, 0.25f, 0.25f}};
+
+    for (size_t i {0}; i < BoxesCount; i++)
+      Boxes.push_back({SnapPoint(-1, 1), {Snap(0, 1), Snap(0, 1), Snap(0, 1)}});
+    for (size_t i {0}; i < CentersCount; i++)
+      for (size_t k {0}; k < 3; k++)
+      {
+        Centers[k].push_back(Snap(-2, 2));
+        Cells[k].push_back((int32_t)Rand.Index(18) - 1);
+      }
+
+    const box_centers_soa_view<float> CentersView {Centers[0].data(), Centers[1].data(), Centers[2].data(), CentersCount};
+    const cell_coords_soa_view CellsView {Cells[0].data(), Cells[1].data(), Cells[2].data(), CentersCount};
+
+    /* Reference results */
+    std::vector<std::vector<bool>> RefOverlap(BoxesCount), RefContained(BoxesCount), RefBoxes(TrisCount), RefCells(TrisCount);
+
+    for (size_t b {0}; b < BoxesCount; b++)
+      for (size_t i {0}; i < TrisCount; i++)
+      {
+        const overlap_class Class {BoxTriangleClassify(Boxes[b], View[i])};
+
+        RefOverlap[b].push_back(BoxTriangleOverlapTest(Boxes[b], View[i]));
+        RefContained[b].push_back(Class == overlap_class::eContained);
+      }
+    for (size_t i {0}; i < TrisCount; i++)
+      for (size_t c {0}; c < CentersCount; c++)
+      {
+        RefBoxes[i].push_back(BoxTriangleOverlapTest({{Centers[0][c], Centers[1][c], Centers[2][c]}, CentersHalfSize}, View[i]));
+        RefCells[i].push_back(BoxTriangleOverlapTest(Grid.GetCell(Cells[0][c], Cells[1][c], Cells[2][c]), View[i]));
+      }
+
+    /* Run every entry point for every instruction set and order */
+    const axes_order SavedOrder {GetAxesOrder()};
+    size_t Failures {0};
+    std::vector<uint8_t> Masks((std::max(TrisCount, CentersCount) + 7) / 8), Contained(Masks.size());
+    std::vector<uint32_t> Hits(std::max(TrisCount, CentersCount));
+    auto Expect {[&]( bool IsOk, const char *Entry )
+      {
+        if (!IsOk && Failures++ < 16)
+          std::printf("  %s, %s order: '%s' differs from reference\n", GetIsaName(GetIsa()), GetAxesOrderName(GetAxesOrder()), Entry);
+      }};
+
+    ForEachIsa([&]( isa )
+      {
+        for (size_t Order {0}; Order < (size_t)axes_order::_LastValue; Order++)
+        {
+          SetAxesOrder((axes_order)Order);
+          for (size_t b {0}; b < BoxesCount; b++)
+          {
+            const aabb<float> &Box {Boxes[b]};
+            const std::vector<bool> &Ref {RefOverlap[b]};
+
+            BoxTrianglesOverlapTest(Box, View, Masks);
+            Expect(IsMasksMatch(Masks, Ref), "soa masks");
+            Expect(IsIndicesMatch(std::span {Hits}.first(BoxTrianglesOverlapTest(Box, View, Hits, 5)), 5, Ref), "soa indices");
+            BoxTrianglesOverlapTest(Box, Prepared.GetView(), Masks);
+            Expect(IsMasksMatch(Masks, Ref), "prepared masks");
+            Expect(IsIndicesMatch(std::span {Hits}.first(BoxTrianglesOverlapTest(Box, Prepared.GetView(), Hits, 5)), 5, Ref), "prepared indices");
+            BoxTrianglesOverlapTest(Box, Indexed, Masks);
+            Expect(IsMasksMatch(Masks, Ref), "indexed masks");
+            Expect(IsIndicesMatch(std::span {Hits}.first(BoxTrianglesOverlapTest(Box, Indexed, Hits, 5)), 5, Ref), "indexed indices");
+            Expect(IsIndicesMatch(std::span {Hits}.first(BoxTrianglesOverlapTest(Box, Bucketed.GetView(), Hits, 5)), 5, Ref), "bucketed indices");
+
+            BoxTrianglesOverlapTest(Box, Quantized.GetView(), Masks);
+            for (size_t i {0}; i < TrisCount; i++)
+              Expect(!Ref[i] || GetMaskBit(Masks, i), "quantized masks");
+            std::vector<bool> Found(TrisCount);
+
+            for (uint32_t Index : std::span {Hits}.first(BoxTrianglesOverlapTest(Box, Quantized.GetView(), Hits)))
+              Found[Index] = true;
+            for (size_t i {0}; i < TrisCount; i++)
+              Expect(!Ref[i] || Found[i], "quantized indices");
+
+            BoxTrianglesClassify(Box, View, Masks, Contained);
+            Expect(IsMasksMatch(Masks, Ref) && IsMasksMatch(Contained, RefContained[b]), "classify");
+            BoxTrianglesClassify(Box, Prepared.GetView(), Masks, Contained);
+            Expect(IsMasksMatch(Masks, Ref) && IsMasksMatch(Contained, RefContained[b]), "prepared classify");
+
+            /* Hierarchies report original indices in no particular order */
+            std::vector<uint32_t> Bvh8Hits, QuantizedBvh8Hits;
+
+            Hits.clear();
+            Bvh.Query(Box, [&]( uint32_t Index ) { Hits.push_back(Index); });
+            Expect(IsIndicesMatch(Hits, 0, Ref), "bvh");
+            Bvh8.Query(Box, [&]( uint32_t Index ) { Bvh8Hits.push_back(Index); });
+            Expect(IsIndicesMatch(Bvh8Hits, 0, Ref), "bvh8");
+            QuantizedBvh8.Query(Box, [&]( uint32_t Index ) { QuantizedBvh8Hits.push_back(Index); });
+            Expect(IsIndicesMatch(QuantizedBvh8Hits, 0, Ref), "quantized bvh8");
+            Hits.resize(std::max(TrisCount, CentersCount));
+          }
+
+          std::vector<std::vector<uint32_t>> BatchHits(BoxesCount);
+
+          Bvh.Query(Boxes, [&]( uint32_t Box, uint32_t Index ) { BatchHits[Box].push_back(Index); });
+          for (size_t b {0}; b < BoxesCount; b++)
+            Expect(IsIndicesMatch(BatchHits[b], 0, RefOverlap[b]), "bvh batch");
+
+          for (size_t i {0}; i < TrisCount; i++)
+          {
+            const triangle_boxes_setup<float> Setup {View[i], CentersHalfSize};
+            const triangle_cells_setup CellsSetup {View[i], Grid};
+
+            TriangleBoxesOverlapTest(Setup, CentersView, Masks);
+            Expect(IsMasksMatch(Masks, RefBoxes[i]), "triangle boxes masks");
+            Expect(IsIndicesMatch(std::span {Hits}.first(TriangleBoxesOverlapTest(Setup, CentersView, Hits, 3)), 3, RefBoxes[i]), "triangle boxes indices");
+            TriangleCellsOverlapTest(CellsSetup, CellsView, Masks);
+            Expect(IsMasksMatch(Masks, RefCells[i]), "triangle cells masks");
+            Expect(IsIndicesMatch(std::span {Hits}.first(TriangleCellsOverlapTest(CellsSetup, CellsView, Hits, 3)), 3, RefCells[i]), "triangle cells indices");
+          }
+        }
+      });
+    SetAxesOrder(SavedOrder);
+    return Failures == 0;
+  } /* End of 'IsaCheck' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_isa_hpp__ */
+
+/* END OF 'bench_isa.hpp' FILE */
@@ -0,0 +1,259 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_mesh_file.hpp" - Mesh file round-trip and validation self-check */
+
+#ifndef __bench_mesh_file_hpp__
+#define __bench_mesh_file_hpp__
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "bench_def.h"
+#include "bench_bvh8.hpp"
+#include "overlap/overlap_mesh_file.hpp"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Whole file reading function.
+   * ARGUMENTS:
+   *   - File path:
+   *       const std::filesystem::path &Path;
+   * RETURNS:
+   *   (std::vector<uint8_t>) File bytes.
+   */
+  inline std::vector<uint8_t> ReadBytes( const std::filesystem::path &Path )
+  {
+    std::ifstream File {Path, std::ios::binary};
+
+    return {std::istreambuf_iterator<char> {File}, std::istreambuf_iterator<char> {}};
+  } /* End of 'ReadBytes' function */
+
+  /* Whole file writing function.
+   * ARGUMENTS:
+   *   - File path:
+   *       const std::filesystem::path &Path;
+   *   - File bytes:
+   *       std::span<const uint8_t> Bytes;
+   * RETURNS: None.
+   */
+  inline void WriteBytes( const std::filesystem::path &Path, std::span<const uint8_t> Bytes )
+  {
+    std::ofstream File {Path, std::ios::binary | std::ios::trunc};
+
+    File.write(reinterpret_cast<const char *>(Bytes.data()), (std::streamsize)Bytes.size());
+  } /* End of 'WriteBytes' function */
+
+  /* Mapped hierarchy query hits collection function, hits are mapped to original indices and sorted.
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Hierarchy view:
+   *       const view &View;
+   *   - Original index of every triangle in hierarchy order:
+   *       std::span<const uint32_t> Indices;
+   * RETURNS:
+   *   (std::vector<uint32_t>) Sorted original indices of overlapping triangles.
+   */
+  template<class view>
+    std::vector<uint32_t> GetViewQueryHits( const aabb<float> &Box, const view &View, std::span<const uint32_t> Indices )
+    {
+      std::pair<std::vector<uint32_t>, std::span<const uint32_t>> Context {{}, Indices};
+
+      BoxBvhTrianglesQuery(Box, View, []( void *Context, std::span<const uint32_t> Hits )
+        {
+          auto &[Result, Original] {*static_cast<std::pair<std::vector<uint32_t>, std::span<const uint32_t>> *>(Context)};
+
+          for (const uint32_t Hit : Hits)
+            Result.push_back(Original[Hit]);
+        }, &Context);
+      std::sort(Context.first.begin(), Context.first.end());
+      return Context.first;
+    } /* End of 'GetViewQueryHits' function */
+
+  /* Mesh file self-check function.
+   * Round-trip: random indexed meshes are written with all sections, every mapped view is queried by random
+   * boxes and must give the same hits as the in-memory data. Validation: corrupted headers and sections
+   * (counts, whose sizes wrap to the stored ones, truncation, mismatched counts) must be rejected on opening.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if all views match and all corrupted files are rejected.
+   */
+  inline bool MeshFileCheck( void )
+  {
+    const std::filesystem::path Path {std::filesystem::temp_directory_path() / "overlap_bench_check.ovlp"};
+    random Rand {15};
+    size_t Mismatches {0}, Queries {0}, Rejected {0};
+
+    for (size_t Count : {0, 1, 17, 3000})
+    {
+      std::vector<float> Vertices;
+      std::vector<uint32_t> Indices;
+
+      for (size_t i {0}; i < Count + 2; i++)
+      {
+        const vec3<float> P {Rand.Point(-1, 1)};
+
+        Vertices.insert(Vertices.end(), {P.X, P.Y, P.Z});
+      }
+      for (size_t i {0}; i < Count; i++)
+      {
+        const uint32_t First {(uint32_t)Rand.Index(Count)};
+
+        Indices.insert(Indices.end(), {First, First + 1, First + 2});
+      }
+
+      const indexed_triangles_view Indexed {Vertices.data(), 3, Count + 2, Indices.data(), Count};
+      triangle_soa Tris;
+
+      Tris.Expand(Count);
+      for (size_t i {0}; i < Count; i++)
+        Tris.Set(i, Indexed[i].V0, Indexed[i].V1, Indexed[i].V2);
+
+      const prepared_mesh Prepared {Tris.GetView()};
+      const bvh Binary {Tris.GetView()};
+      const bvh8 Wide {Tris.GetView()};
+      const quantized_bvh8 Quantized {Wide};
+
+      WriteMeshFile(Path,
+        {
+          .Triangles = Tris.GetView(),
+          .Indexed = Indexed,
+          .Prepared = Prepared.GetView(),
+          .Bvh = mesh_file_hierarchy<bvh_view> {Binary.GetView(), Binary.GetIndices()},
+          .Bvh8 = mesh_file_hierarchy<bvh8_view> {Wide.GetView(), Wide.GetIndices()},
+          .QuantizedBvh8 = mesh_file_hierarchy<quantized_bvh8_view> {Quantized.GetView(), Quantized.GetIndices()},
+        });
+
+      const mesh_file File {Path};
+      std::vector<uint8_t> Masks((Count + 7) / 8), FileMasks(Masks.size());
+      std::vector<aabb<float>> Boxes;
+
+      Mismatches += File.GetCount() != Count;
+      for (size_t k {0}; k < 40; k++)
+      {
+        const float Half {k % 2 == 0 ? 0.05f : 0.4f};
+        const aabb<float> Box {Rand.Point(-1, 1), {Half, Half * 0.7f, Half * 1.3f}};
+
+        BoxTrianglesOverlapTest(Box, Tris.GetView(), Masks);
+        BoxTrianglesOverlapTest(Box, File.GetTriangles(), FileMasks);
+        Mismatches += Masks != FileMasks;
+        BoxTrianglesOverlapTest(Box, Indexed, Masks);
+        BoxTrianglesOverlapTest(Box, File.GetIndexed(), FileMasks);
+        Mismatches += Masks != FileMasks;
+        BoxTrianglesOverlapTest(Box, Prepared.GetView(), Masks);
+        BoxTrianglesOverlapTest(Box, File.GetPrepared(), FileMasks);
+        Mismatches += Masks != FileMasks;
+        Mismatches += GetViewQueryHits(Box, File.GetBvh8(), File.GetHierarchyIndices(mesh_section::eBvh8)) != GetQueryHits(Wide, Box);
+        Mismatches += GetViewQueryHits(Box, File.GetQuantizedBvh8(), File.GetHierarchyIndices(mesh_section::eQuantizedBvh8)) != GetQueryHits(Quantized, Box);
+        Boxes.push_back(Box);
+        Queries++;
+      }
+
+      /* Binary hierarchy is queried by the whole batch */
+      using pairs = std::vector<std::pair<uint32_t, uint32_t>>;
+      std::pair<pairs, std::span<const uint32_t>> Context {{}, File.GetHierarchyIndices(mesh_section::eBvh)};
+      pairs Expected;
+
+      Binary.Query(Boxes, [&]( uint32_t Box, uint32_t Triangle ) { Expected.push_back({Box, Triangle}); });
+      BoxesBvhTrianglesQuery(Boxes, File.GetBvh(), []( void *Context, std::span<const bvh_pair> Pairs )
+        {
+          auto &[Result, Original] {*static_cast<std::pair<pairs, std::span<const uint32_t>> *>(Context)};
+
+          for (const bvh_pair &Pair : Pairs)
+            Result.push_back({Pair.Box, Original[Pair.Triangle]});
+        }, &Context);
+      std::sort(Expected.begin(), Expected.end());
+      std::sort(Context.first.begin(), Context.first.end());
+      Mismatches += Expected != Context.first;
+    }
+
+    /* Corrupted files, the last written one (3000 triangles) is the base */
+    const std::vector<uint8_t> Valid {ReadBytes(Path)};
+    const auto GetSection {[]( std::vector<uint8_t> &Bytes, mesh_section Type ) -> mesh_file_section *
+      {
+        const mesh_file_header *Header {reinterpret_cast<const mesh_file_header *>(Bytes.data())};
+        mesh_file_section *Table {reinterpret_cast<mesh_file_section *>(Bytes.data() + sizeof(mesh_file_header))};
+
+        for (size_t i {0}; i < Header->SectionsCount; i++)
+          if (Table[i].Type == (uint32_t)Type)
+            return &Table[i];
+        return nullptr;
+      }};
+    const auto Corrupt {[&]( auto &&Change )
+      {
+        std::vector<uint8_t> Bytes {Valid};
+
+        Change(Bytes, *reinterpret_cast<mesh_file_header *>(Bytes.data()));
+        WriteBytes(Path, Bytes);
+        try
+        {
+          mesh_file {Path};
+          Mismatches++;
+        }
+        catch (std::runtime_error &)
+        {
+          Rejected++;
+        }
+      }};
+
+    /* Triangles count of 2^64 - 8 pads to a zero stride, so an empty triangles section matches it */
+    Corrupt([]( std::vector<uint8_t> &Bytes, mesh_file_header &Header )
+      {
+        const mesh_file_section Section {(uint32_t)mesh_section::eTriangles, 0, 2 * MeshFileAlignment, 0, 0};
+
+        Bytes.resize(2 * MeshFileAlignment);
+        Header.SectionsCount = 1, Header.TrianglesCount = ~uint64_t {7}, Header.VerticesCount = 0, Header.FileSize = Bytes.size();
+        std::memcpy(Bytes.data() + sizeof(mesh_file_header), &Section, sizeof Section);
+      });
+    /* Vertices count of 2^62 wraps to zero size */
+    Corrupt([]( std::vector<uint8_t> &Bytes, mesh_file_header &Header )
+      {
+        const mesh_file_section Sections[2]
+        {
+          {(uint32_t)mesh_section::eVertices, 0, 2 * MeshFileAlignment, 0, 0},
+          {(uint32_t)mesh_section::eIndices, 0, 2 * MeshFileAlignment, 0, 0},
+        };
+
+        Bytes.resize(2 * MeshFileAlignment);
+        Header.SectionsCount = 2, Header.TrianglesCount = 0, Header.VerticesCount = uint64_t {1} << 62, Header.FileSize = Bytes.size();
+        std::memcpy(Bytes.data() + sizeof(mesh_file_header), Sections, sizeof Sections);
+      });
+    /* Hierarchy nodes count, whose nodes and subtrees sizes wrap */
+    for (const mesh_section Type : {mesh_section::eBvh, mesh_section::eBvh8, mesh_section::eQuantizedBvh8})
+      for (const uint64_t NodesCount : {~uint64_t {0} / 3, ~uint64_t {0} / 32 + 1, uint64_t {0}})
+        Corrupt([&]( std::vector<uint8_t> &Bytes, mesh_file_header & )
+          {
+            GetSection(Bytes, Type)->Stride = NodesCount;
+          });
+    /* Truncation, triangles count and section sizes changes */
+    Corrupt([]( std::vector<uint8_t> &Bytes, mesh_file_header & ) { Bytes.resize(Bytes.size() - MeshFileAlignment); });
+    Corrupt([]( std::vector<uint8_t> &, mesh_file_header &Header ) { Header.TrianglesCount += prepared_mesh::Padding; });
+    Corrupt([]( std::vector<uint8_t> &, mesh_file_header &Header ) { Header.VerticesCount++; });
+    Corrupt([&]( std::vector<uint8_t> &Bytes, mesh_file_header & ) { GetSection(Bytes, mesh_section::ePrepared)->Size -= sizeof(float); });
+    Corrupt([&]( std::vector<uint8_t> &Bytes, mesh_file_header & ) { GetSection(Bytes, mesh_section::eTriangles)->Offset += 8; });
+    Corrupt([&]( std::vector<uint8_t> &Bytes, mesh_file_header & ) { GetSection(Bytes, mesh_section::eIndices)->Type = 0; });
+
+    std::filesystem::remove(Path);
+    std::printf("  %zu queries, %zu corrupted files rejected, %zu mismatches\n", Queries, Rejected, Mismatches);
+    return Mismatches == 0;
+  } /* End of 'MeshFileCheck' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_mesh_file_hpp__ */
+
+/* END OF 'bench_mesh_file.hpp' FILE */
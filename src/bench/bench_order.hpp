@@ -0,0 +1,202 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_order.hpp" - Radix sort and spatial order self-check */
+
+#ifndef __bench_order_hpp__
+#define __bench_order_hpp__
+
+#include <cstdlib>
+
+#include "bench_def.h"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Permutation check function.
+   * ARGUMENTS:
+   *   - Order:
+   *       std::span<const uint32_t> Order;
+   * RETURNS:
+   *   (bool) true if every index below order size is met exactly once.
+   */
+  inline bool IsPermutation( std::span<const uint32_t> Order )
+  {
+    std::vector<uint8_t> IsMet(Order.size());
+
+    for (const uint32_t Index : Order)
+      if (Index >= Order.size() || IsMet[Index]++ != 0)
+        return false;
+    return true;
+  } /* End of 'IsPermutation' function */
+
+  /* Radix sort and spatial order self-check function.
+   * Radix sort must equal std::stable_sort on every threads count for key sets where passes are skipped
+   * (digits equal in all keys with odd and even numbers of scatter passes, all keys equal, one key differing,
+   * few distinct keys).
+   * Spatial orders must be permutations sorted by curve codes of centroid cells (ties by index) on every
+   * threads count, including flat meshes; the first Hilbert curve cells must be neighbours.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if all sorts and orders match.
+   */
+  inline bool OrderCheck( void )
+  {
+    random Rand {14};
+    std::uniform_int_distribution<uint64_t> Bits {};
+    size_t Mismatches {0}, Sorts {0}, Orders {0};
+
+    /* Parts are 1 << 16 keys at least, so only the largest count is split between threads */
+    for (size_t Count : {0, 1, 1000, 300000})
+      for (size_t Keys {0}; Keys < 6; Keys++)
+      {
+        std::vector<std::pair<uint64_t, uint32_t>> Source(Count);
+
+        for (size_t i {0}; i < Count; i++)
+        {
+          auto &[Key, Value] {Source[i]};
+          const uint64_t R {Bits(Rand.GetEngine())};
+
+          Key =
+            Keys == 0 ? R :                                                    // All passes
+            Keys == 1 ? (R & 0xFF00) | 0xAB0000000000ull :                     // One pass, result is copied back
+            Keys == 2 ? R & 0xFF000000000000FFull :                            // Two passes, the first and the last ones
+            Keys == 3 ? 0x0123456789ABCDEFull :                                // No passes
+            Keys == 4 ? (i == Count / 2 ? R : 0x0123456789ABCDEFull) :         // One key differs, no pass is skipped
+            0x0101010101010101ull * (R % 5);                                   // Few distinct keys, stability matters
+          Value = (uint32_t)(R >> 32);
+        }
+
+        std::vector<std::pair<uint64_t, uint32_t>> Reference {Source};
+
+        std::stable_sort(Reference.begin(), Reference.end(), []( const auto &A, const auto &B ) { return A.first < B.first; });
+        for (size_t ThreadsCount : {1, 3, 8})
+        {
+          std::vector<uint64_t> SortKeys(Count);
+          std::vector<uint32_t> SortValues(Count);
+
+          for (size_t i {0}; i < Count; i++)
+            SortKeys[i] = Source[i].first, SortValues[i] = Source[i].second;
+          RadixSort(SortKeys, SortValues, ThreadsCount);
+          for (size_t i {0}; i < Count; i++)
+            Mismatches += SortKeys[i] != Reference[i].first || SortValues[i] != Reference[i].second;
+          Sorts++;
+        }
+      }
+
+    /* Spatial orders against stable sort by codes of reference cells */
+    for (size_t Count : {0, 1, 1000, 200000})
+      for (bool IsFlat : {false, true})
+      {
+        triangle_soa Tris;
+        std::vector<vec3<float>> Centroids(Count);
+
+        Tris.Expand(Count);
+        for (size_t i {0}; i < Count; i++)
+        {
+          vec3<float> V[3] {Rand.Point(-1, 1)};
+
+          V[1] = V[0] + Rand.Point(-0.01f, 0.01f), V[2] = V[0] + Rand.Point(-0.01f, 0.01f);
+          if (IsFlat)
+            V[0].Z = V[1].Z = V[2].Z = 0.5f;
+          Tris.Set(i, V[0], V[1], V[2]);
+          Centroids[i] = (V[0] + V[1] + V[2]) * (1 / 3.f);
+        }
+
+        constexpr float Inf {std::numeric_limits<float>::infinity()}, MaxCell {(float)((1u << CurveBits) - 1)};
+        vec3<float> Min {Inf, Inf, Inf}, Max {-Inf, -Inf, -Inf};
+
+        for (const vec3<float> &C : Centroids)
+        {
+          Min = {std::min(Min.X, C.X), std::min(Min.Y, C.Y), std::min(Min.Z, C.Z)};
+          Max = {std::max(Max.X, C.X), std::max(Max.Y, C.Y), std::max(Max.Z, C.Z)};
+        }
+
+        const vec3<float> Size {Max - Min};
+        const vec3<float> Scale {Size.X > 0 ? MaxCell / Size.X : 0, Size.Y > 0 ? MaxCell / Size.Y : 0, Size.Z > 0 ? MaxCell / Size.Z : 0};
+
+        for (space_curve Curve : {space_curve::eMorton, space_curve::eHilbert})
+        {
+          std::vector<std::pair<uint64_t, uint32_t>> Reference(Count);
+
+          for (size_t i {0}; i < Count; i++)
+          {
+            const vec3<float> P {Centroids[i] - Min};
+            const uint32_t
+              X {(uint32_t)std::clamp(P.X * Scale.X, 0.f, MaxCell)},
+              Y {(uint32_t)std::clamp(P.Y * Scale.Y, 0.f, MaxCell)},
+              Z {(uint32_t)std::clamp(P.Z * Scale.Z, 0.f, MaxCell)};
+
+            Reference[i] = {Curve == space_curve::eMorton ? MortonCode(X, Y, Z) : HilbertCode(X, Y, Z), (uint32_t)i};
+          }
+          std::sort(Reference.begin(), Reference.end());
+          for (size_t ThreadsCount : {1, 3, 8})
+          {
+            const std::vector<uint32_t> Order {GetSpatialOrder(Tris.GetView(), Curve, ThreadsCount)};
+
+            Mismatches += Order.size() != Count || !IsPermutation(Order);
+            for (size_t i {0}; i < Order.size(); i++)
+              Mismatches += Order[i] != Reference[i].second;
+            Orders++;
+          }
+        }
+      }
+
+    /* Hilbert curve starts at the origin and fills aligned cubes one by one, moving to a neighbour cell every step */
+    std::vector<std::pair<uint64_t, uint32_t>> Cells;
+
+    for (uint32_t Cell {0}; Cell < 8 * 8 * 8; Cell++)
+      Cells.push_back({HilbertCode(Cell % 8, Cell / 8 % 8, Cell / 64), Cell});
+    std::sort(Cells.begin(), Cells.end());
+    for (size_t i {0}; i < Cells.size(); i++)
+    {
+      const uint32_t A {Cells[i].second}, B {Cells[i == 0 ? 0 : i - 1].second};
+      const int Distance
+      {
+        std::abs((int)(A % 8) - (int)(B % 8)) + std::abs((int)(A / 8 % 8) - (int)(B / 8 % 8)) + std::abs((int)(A / 64) - (int)(B / 64))
+      };
+
+      Mismatches += Cells[i].first != i || Distance != (i == 0 ? 0 : 1);
+    }
+
+    /* Mismatched keys and values, unknown curve */
+    std::vector<uint64_t> Keys(3);
+    std::vector<uint32_t> Values(2);
+    size_t Rejected {0};
+
+    try
+    {
+      RadixSort(Keys, Values);
+    }
+    catch (const std::out_of_range &)
+    {
+      Rejected++;
+    }
+    try
+    {
+      GetSpatialOrder({}, space_curve::_LastValue);
+    }
+    catch (const std::out_of_range &)
+    {
+      Rejected++;
+    }
+    std::printf("  %zu sorts, %zu orders, %zu mismatches\n", Sorts, Orders, Mismatches);
+    return Mismatches == 0 && Rejected == 2;
+  } /* End of 'OrderCheck' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_order_hpp__ */
+
+/* END OF 'bench_order.hpp' FILE */
@@ -0,0 +1,139 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_quantized.hpp" - Quantized mesh accuracy self-check and chunk skipping benchmark */
+
+#ifndef __bench_quantized_hpp__
+#define __bench_quantized_hpp__
+
+#include <bit>
+
+#include "bench_def.h"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Quantized mesh accuracy self-check function.
+   * Random boxes are tested against float and quantized triangles on every instruction set:
+   * any triangle, reported by the float kernel but not by the quantized one, is a failure.
+   * Two thirds of the boxes are centered at triangle vertices or touch them by a face, so many pairs barely touch.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if there are no false negatives.
+   */
+  inline bool QuantizedCheck( void )
+  {
+    random Rand {13};
+    size_t Pairs {0}, Hits {0}, Extra {0}, Missed {0};
+
+    for (size_t Count : {1, 7, 16, 255, 256, 257, 1000, 3001})
+    {
+      triangle_soa Tris;
+
+      for (size_t i {0}; i < Count; i++)
+      {
+        const vec3<float> C {Rand.Point(-4, 4)};
+        const float Size {Rand(0.05f, 0.55f)};
+        const vec3<float> V[3] {C + Rand.Point(-Size, Size), C + Rand.Point(-Size, Size), C + Rand.Point(-Size, Size)};
+
+        Tris.Append(std::span<const vec3<float>> {V});
+      }
+
+      const quantized_mesh Quantized {Tris.GetView()};
+      std::vector<uint8_t> Masks((Count + 7) / 8), QuantizedMasks(Masks.size());
+
+      for (size_t k {0}; k < 96; k++)
+      {
+        const float Half {k % 3 == 0 ? Rand(0, 2) : Rand(0, 0.1f)};
+        const vec3<float> Vertex {Tris[Rand.Index(Count)].V1};
+        const vec3<float> Center {k % 3 == 0 ? Rand.Point(-4, 4) : k % 3 == 1 ? Vertex : Vertex + vec3<float> {Half, 0, 0}};
+        const aabb<float> Box {Center, {Half, Half * 0.7f, Half * 1.3f}};
+
+        ForEachIsa([&]( isa Isa )
+          {
+            BoxTrianglesOverlapTest(Box, Tris.GetView(), Masks);
+            BoxTrianglesOverlapTest(Box, Quantized.GetView(), QuantizedMasks);
+            for (size_t i {0}; i < Masks.size(); i++)
+            {
+              Missed += std::popcount((uint8_t)(Masks[i] & ~QuantizedMasks[i]));
+              if (Isa == isa::eScalar)
+                Hits += std::popcount(Masks[i]), Extra += std::popcount((uint8_t)(QuantizedMasks[i] & ~Masks[i]));
+            }
+            Pairs += Isa == isa::eScalar ? Count : 0;
+          });
+      }
+    }
+    std::printf("  %zu pairs, %zu overlaps, quantized extra %zu (%.2f%%), missed %zu\n",
+      Pairs, Hits, Extra, Hits != 0 ? 100.0 * Extra / Hits : 0.0, Missed);
+    return Missed == 0;
+  } /* End of 'QuantizedCheck' function */
+
+  /* Quantized mesh throughput benchmark function.
+   * Mesh is a 2048 x 2048 vertices height field of 100 x 100 size, boxes are:
+   * small and medium ones (most chunks are skipped by bounds), a thin slab (every chunk
+   * is decoded, most triangles are rejected) and a box around the whole mesh.
+   * ARGUMENTS: None.
+   * RETURNS: None.
+   */
+  inline void QuantizedBench( void )
+  {
+    const size_t Size {2048};
+    triangle_soa Tris;
+    auto Vertex {[&]( size_t X, size_t Y ) -> vec3<float>
+      {
+        return {(float)X / Size * 100, (float)Y / Size * 100, std::sin(X * 0.1f + Y * 0.07f)};
+      }};
+
+    Tris.Expand((Size - 1) * (Size - 1) * 2);
+    for (size_t y {0}; y + 1 < Size; y++)
+      for (size_t x {0}; x + 1 < Size; x++)
+      {
+        const size_t Index {(y * (Size - 1) + x) * 2};
+
+        Tris.Set(Index, Vertex(x, y), Vertex(x + 1, y), Vertex(x, y + 1));
+        Tris.Set(Index + 1, Vertex(x + 1, y), Vertex(x + 1, y + 1), Vertex(x, y + 1));
+      }
+
+    const quantized_mesh Quantized {Tris.GetView()};
+    const size_t Count {Tris.GetCount()};
+    const std::pair<const char *, aabb<float>> Boxes[]
+    {
+      {"box 1^3", {{50, 50, 0}, {0.5f, 0.5f, 0.5f}}},
+      {"box 10^3", {{50, 50, 0}, {5, 5, 5}}},
+      {"slab", {{50, 50, 0.97f}, {60, 60, 0.02f}}},
+      {"whole mesh", {{50, 50, 0}, {60, 60, 60}}},
+    };
+    std::vector<uint8_t> Masks((Count + 7) / 8), QuantizedMasks(Masks.size());
+
+    std::printf("  %zu triangles, float %.0f MB, quantized %.0f MB\n", Count, Count * 36 / 1e6, Count * 18 / 1e6);
+    std::printf("  %-11s %-8s %14s %14s %10s %8s\n", "query", "isa", "float, ns/tri", "q16, ns/tri", "hits", "extra");
+    for (const auto &[Name, Box] : Boxes)
+      ForEachIsa([&]( isa Isa )
+        {
+          const double FloatNs {MeasureNs([&] { BoxTrianglesOverlapTest(Box, Tris.GetView(), Masks); }, 3) / Count};
+          const double QuantizedNs {MeasureNs([&] { BoxTrianglesOverlapTest(Box, Quantized.GetView(), QuantizedMasks); }, 3) / Count};
+          size_t Hits {0}, QuantizedHits {0};
+
+          for (size_t i {0}; i < Masks.size(); i++)
+            Hits += std::popcount(Masks[i]), QuantizedHits += std::popcount(QuantizedMasks[i]);
+          std::printf("  %-11s %-8s %14.3f %14.3f %10zu %7.3f%%\n", Name, GetIsaName(Isa), FloatNs, QuantizedNs,
+            Hits, Hits != 0 ? 100.0 * (QuantizedHits - Hits) / Hits : 0.0);
+        });
+  } /* End of 'QuantizedBench' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_quantized_hpp__ */
+
+/* END OF 'bench_quantized.hpp' FILE */
@@ -0,0 +1,224 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "bench_stream.hpp" - Out-of-core triangles streaming self-check */
+
+#ifndef __bench_stream_hpp__
+#define __bench_stream_hpp__
+
+#include <filesystem>
+#include <thread>
+
+#include "bench_def.h"
+#include "bench_import.hpp"
+#include "bench_mesh_file.hpp"
+#include "overlap/overlap_stream.hpp"
+
+/* Benchmark namespace */
+namespace bench
+{
+  /* Streamed chunks verification function: chunks go in order, hold file triangles and zero padding.
+   * Every chunk is checked after a pause, so a reader overwriting the held buffer is caught.
+   * ARGUMENTS:
+   *   - File path:
+   *       const std::filesystem::path &Path;
+   *   - Triangles placement:
+   *       const triangle_stream_layout &Layout;
+   *   - Buffers memory budget, bytes:
+   *       size_t MemoryBudget;
+   *   - Expected triangles:
+   *       const triangles_soa_view<float> &Tris;
+   * RETURNS:
+   *   (size_t) Mismatched chunks count.
+   */
+  inline size_t GetStreamChunksMismatches( const std::filesystem::path &Path, const triangle_stream_layout &Layout,
+                                           size_t MemoryBudget, const triangles_soa_view<float> &Tris )
+  {
+    triangle_stream Stream {Path, Layout, MemoryBudget};
+    const size_t ChunkSize {Stream.GetChunkSize()};
+    size_t Mismatches {0}, First {0};
+
+    while (const std::optional<triangle_stream_chunk> Chunk {Stream.Next()})
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds {2});
+      if (Chunk->First != First || Chunk->Tris.Count != std::min(ChunkSize, Tris.Count - First))
+        return Mismatches + 1;
+      for (size_t i {0}; i < ChunkSize; i++)
+        for (size_t k {0}; k < 3; k++)
+          for (const std::array<const float *, 3> *Streams : {&Chunk->Tris.X, &Chunk->Tris.Y, &Chunk->Tris.Z})
+          {
+            const size_t Axis {(size_t)(Streams - &Chunk->Tris.X)};
+            const float Expected {i < Chunk->Tris.Count ? (&Tris.X)[Axis][k][First + i] : 0.f};
+
+            Mismatches += (*Streams)[k][i] != Expected;
+          }
+      First += Chunk->Tris.Count;
+    }
+    return Mismatches + (First != Tris.Count) + (Stream.GetChunksCount() != (Tris.Count + ChunkSize - 1) / ChunkSize);
+  } /* End of 'GetStreamChunksMismatches' function */
+
+  /* Out-of-core triangles streaming self-check function.
+   * Random meshes are written as raw records (after a header, with trailing bytes), binary STL and mesh file,
+   * streamed with a budget of a few chunks and queried by random boxes: hits must match the batch kernel on
+   * in-memory triangles. Truncated files must raise errors from the reader thread, streams destroyed early
+   * (before reading, while holding a chunk, after an error) must stop.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (bool) true if all hits and chunks match and all errors are reported.
+   */
+  inline bool StreamCheck( void )
+  {
+    const std::filesystem::path Path {std::filesystem::temp_directory_path() / "overlap_bench_check.stream"};
+    constexpr size_t ChunkSize {800}, RawOffset {20};
+    random Rand {17};
+    size_t Mismatches {0}, Queries {0}, Chunks {0}, Errors {0};
+
+    for (size_t Count : {0, 1, 1600, 3001})
+    {
+      std::vector<triangle<float>> Records;
+      triangle_soa Tris;
+
+      Tris.Expand(Count);
+      for (size_t i {0}; i < Count; i++)
+      {
+        const vec3<float> P {Rand.Point(-1, 1)};
+
+        Records.push_back({P, P + Rand.Point(-0.1f, 0.1f), P + Rand.Point(-0.1f, 0.1f)});
+        Tris.Set(i, Records[i].V0, Records[i].V1, Records[i].V2);
+      }
+
+      std::vector<aabb<float>> Boxes;
+      std::vector<stream_hit> Expected;
+      std::vector<uint32_t> Indices(Count);
+
+      for (uint32_t b {0}; b < 30; b++)
+      {
+        const float Half {b % 2 == 0 ? 0.05f : 0.4f};
+        const aabb<float> &Box {Boxes.emplace_back(Rand.Point(-1, 1), vec3<float> {Half, Half * 0.7f, Half * 1.3f})};
+        const size_t HitsCount {BoxTrianglesOverlapTest(Box, Tris.GetView(), std::span<uint32_t> {Indices})};
+
+        for (size_t i {0}; i < HitsCount; i++)
+          Expected.push_back({Indices[i], b});
+      }
+
+      for (size_t Format {0}; Format < 3; Format++)
+      {
+        triangle_stream_layout Layout {};
+
+        if (Format == 0)
+        {
+          std::string Bytes(RawOffset, 'h');
+
+          for (const triangle<float> &Tri : Records)
+            for (const float Value : {Tri.V0.X, Tri.V0.Y, Tri.V0.Z, Tri.V1.X, Tri.V1.Y, Tri.V1.Z, Tri.V2.X, Tri.V2.Y, Tri.V2.Z})
+              AppendBinary(Bytes, Value);
+          Bytes.append(7, 't');
+          WriteBytes(Path, std::span {reinterpret_cast<const uint8_t *>(Bytes.data()), Bytes.size()});
+          Layout = GetRawStreamLayout(Path, RawOffset);
+        }
+        else if (Format == 1)
+        {
+          const std::string Bytes {WriteStlBinary(Records, 5)};
+
+          WriteBytes(Path, std::span {reinterpret_cast<const uint8_t *>(Bytes.data()), Bytes.size()});
+          Layout = GetStlStreamLayout(Path);
+        }
+        else
+        {
+          WriteMeshFile(Path, {.Triangles = Tris.GetView()});
+          Layout = GetMeshFileStreamLayout(Path);
+        }
+        Mismatches += Layout.Count != Count;
+
+        /* Budget of 'ChunkSize' triangles per chunk: two buffers, staging records and kernel indices */
+        const size_t Budget {ChunkSize * (2 * 9 * sizeof(float) + (Layout.Stride == 0 ? Layout.RecordSize : 0) + sizeof(uint32_t))};
+        std::vector<stream_hit> Hits;
+        const stream_stats Stats {StreamBoxesTrianglesOverlapTest(Path, Layout, Boxes, Hits, Budget)};
+
+        std::sort(Hits.begin(), Hits.end(), []( const stream_hit &A, const stream_hit &B )
+          {
+            return A.Box != B.Box ? A.Box < B.Box : A.Triangle < B.Triangle;
+          });
+        Mismatches += Hits.size() != Expected.size() ||
+          !std::equal(Hits.begin(), Hits.end(), Expected.begin(), []( const stream_hit &A, const stream_hit &B )
+            {
+              return A.Box == B.Box && A.Triangle == B.Triangle;
+            });
+        Mismatches += Stats.ChunksCount != (Count + ChunkSize - 1) / ChunkSize || (Count > 1 && Stats.ChunkSize != ChunkSize);
+        Mismatches += GetStreamChunksMismatches(Path, Layout, Budget, Tris.GetView());
+        Queries += Boxes.size(), Chunks += Stats.ChunksCount;
+        if (Count == 0)
+          continue;
+
+        /* Early destruction: before reading, while holding the first chunk */
+        {
+          triangle_stream Stream {Path, Layout, Budget};
+        }
+        {
+          triangle_stream Stream {Path, Layout, Budget};
+
+          Mismatches += !Stream.Next().has_value();
+        }
+
+        /* Truncated file: layout claims more triangles than there are */
+        triangle_stream_layout Truncated {Layout};
+
+        Truncated.Count += 3 * ChunkSize;
+        if (Truncated.Stride != 0)
+          Truncated.Stride += 3 * ChunkSize;
+        try
+        {
+          Hits.clear();
+          StreamBoxesTrianglesOverlapTest(Path, Truncated, Boxes, Hits, Budget);
+        }
+        catch (const std::runtime_error &)
+        {
+          Errors++;
+        }
+        {
+          triangle_stream Stream {Path, Truncated, Budget};
+
+          std::this_thread::sleep_for(std::chrono::milliseconds {5});
+        }
+      }
+    }
+
+    /* Invalid streams are rejected at once */
+    const auto IsRejected {[&]( const triangle_stream_layout &Layout, size_t Budget )
+      {
+        try
+        {
+          triangle_stream Stream {Path, Layout, Budget};
+        }
+        catch (const std::exception &)
+        {
+          return true;
+        }
+        return false;
+      }};
+
+    Errors += IsRejected({0, 100, 0, 30, 0}, DefaultStreamBudget);
+    Errors += IsRejected({0, 100, 50}, DefaultStreamBudget);
+    Errors += IsRejected({0, 100}, 100);
+    std::filesystem::remove(Path);
+    Errors += IsRejected({0, 100}, DefaultStreamBudget);
+    std::printf("  %zu queries over %zu chunks, %zu errors reported, %zu mismatches\n", Queries, Chunks, Errors, Mismatches);
+    return Mismatches == 0 && Errors == 3 * 3 + 4;
+  } /* End of 'StreamCheck' function */
+} /* end of 'bench' namespace */
+
+#endif /* __bench_stream_hpp__ */
+
+/* END OF 'bench_stream.hpp' FILE */
@@ -18,6 +18,933 @@
 #ifndef __box_triangle_overlap_test_hpp__
 #define __box_triangle_overlap_test_hpp__
 
+#include <atomic>
+
+/* Base types, scalar reference test and kernels table */
+#include "overlap/overlap_base.hpp"
+#include "overlap/overlap_prepared.hpp"
+#include "overlap/overlap_table.hpp"
+#include "overlap/overlap_stats.hpp"
+#include "overlap/overlap_soa.hpp"
+#include "overlap/overlap_order.hpp"
+
+/* SIMD kernels, all of them are compiled, the best one is selected at runtime */
+#include "overlap/overlap_sse.hpp"
+#include "overlap/overlap_avx2.hpp"
+/* GCC reports undefined intrinsic results ('_mm512_undefined_*'), inlined into AVX-512 kernels, as uninitialized */
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wuninitialized"
+#  pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include "overlap/overlap_avx512.hpp"
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic pop
+#endif
+
+/* Math namespace // scalar batch kernels, reference tests called for every element */
+namespace math::scalar
+{
+  /* Per element test results to bit masks storing function.
+   * ARGUMENTS:
+   *   - Elements count:
+   *       size_t Count;
+   *   - Overlap masks output, one bit per element:
+   *       std::span<uint8_t> Masks;
+   *   - Element test, taking element index:
+   *       test &&Test;
+   * RETURNS: None.
+   */
+  template<class test>
+    void StoreMasks( size_t Count, std::span<uint8_t> Masks, test &&Test ) noexcept
+    {
+      for (size_t i {0}; i < Count; i += 8)
+      {
+        uint8_t Bits {0};
+
+        for (size_t j {0}; j < 8 && i + j < Count; j++)
+          Bits |= (uint8_t)((uint8_t)Test(i + j) << j);
+        Masks[i / 8] = Bits;
+      }
+    } /* End of 'StoreMasks' function */
+
+  /* Per element test results to compacted indices storing function.
+   * ARGUMENTS:
+   *   - Elements count:
+   *       size_t Count;
+   *   - Overlapping elements indices output:
+   *       std::span<uint32_t> Indices;
+   *   - Value added to every written index:
+   *       uint32_t IndexBase;
+   *   - Element test, taking element index:
+   *       test &&Test;
+   * RETURNS:
+   *   (size_t) Written indices count.
+   */
+  template<class test>
+    size_t StoreIndices( size_t Count, std::span<uint32_t> Indices, uint32_t IndexBase, test &&Test ) noexcept
+    {
+      size_t Written {0};
+
+      for (size_t i {0}; i < Count; i++)
+        if (Test(i))
+          Indices[Written++] = IndexBase + (uint32_t)i;
+      return Written;
+    } /* End of 'StoreIndices' function */
+
+  /* Per element classification results to overlap and containment masks storing function.
+   * ARGUMENTS:
+   *   - Elements count:
+   *       size_t Count;
+   *   - Overlap and containment masks outputs, one bit per element:
+   *       std::span<uint8_t> Overlap, Contained;
+   *   - Element classification, taking element index:
+   *       classify &&Classify;
+   * RETURNS: None.
+   */
+  template<class classify>
+    void StoreClasses( size_t Count, std::span<uint8_t> Overlap, std::span<uint8_t> Contained, classify &&Classify ) noexcept
+    {
+      for (size_t i {0}; i < Count; i += 8)
+      {
+        uint8_t OverlapBits {0}, ContainedBits {0};
+
+        for (size_t j {0}; j < 8 && i + j < Count; j++)
+        {
+          const overlap_class Class {Classify(i + j)};
+
+          OverlapBits |= (uint8_t)((uint8_t)(Class != overlap_class::eOutside) << j);
+          ContainedBits |= (uint8_t)((uint8_t)(Class == overlap_class::eContained) << j);
+        }
+        Overlap[i / 8] = OverlapBits;
+        Contained[i / 8] = ContainedBits;
+      }
+    } /* End of 'StoreClasses' function */
+
+  /* Box against triangles set overlap test functions (see 'overlap_kernels').
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Triangles:
+   *       const triangles_soa_view<float> &Tris;
+   *   - Overlap masks output or indices output and index base:
+   *       std::span<uint8_t> Masks;
+   *       std::span<uint32_t> Indices; uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count for indices output.
+   */
+  inline void BoxTrianglesOverlapTest( const aabb<float> &Box, const triangles_soa_view<float> &Tris, std::span<uint8_t> Masks ) noexcept
+  {
+    StoreMasks(Tris.Count, Masks, [&]( size_t i ) { return BoxTriangleOverlapTest(Box, Tris[i]); });
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  inline size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const triangles_soa_view<float> &Tris, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    return StoreIndices(Tris.Count, Indices, IndexBase, [&]( size_t i ) { return BoxTriangleOverlapTest(Box, Tris[i]); });
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against prepared triangles set overlap test functions (see 'overlap_kernels').
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Prepared triangles:
+   *       const prepared_triangles_view &Tris;
+   *   - Overlap masks output or indices output and index base:
+   *       std::span<uint8_t> Masks;
+   *       std::span<uint32_t> Indices; uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count for indices output.
+   */
+  inline void BoxTrianglesOverlapTest( const aabb<float> &Box, const prepared_triangles_view &Tris, std::span<uint8_t> Masks ) noexcept
+  {
+    StoreMasks(Tris.Count, Masks, [&]( size_t i ) { return BoxPreparedTriangleOverlapTest(Box, Tris, i); });
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  inline size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const prepared_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    return StoreIndices(Tris.Count, Indices, IndexBase, [&]( size_t i ) { return BoxPreparedTriangleOverlapTest(Box, Tris, i); });
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against indexed triangles set overlap test functions (see 'overlap_kernels').
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Indexed triangles:
+   *       const indexed_triangles_view &Tris;
+   *   - Overlap masks output or indices output and index base:
+   *       std::span<uint8_t> Masks;
+   *       std::span<uint32_t> Indices; uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count for indices output.
+   */
+  inline void BoxTrianglesOverlapTest( const aabb<float> &Box, const indexed_triangles_view &Tris, std::span<uint8_t> Masks ) noexcept
+  {
+    StoreMasks(Tris.Count, Masks, [&]( size_t i ) { return BoxTriangleOverlapTest(Box, Tris[i]); });
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  inline size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const indexed_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    return StoreIndices(Tris.Count, Indices, IndexBase, [&]( size_t i ) { return BoxTriangleOverlapTest(Box, Tris[i]); });
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against quantized triangles set conservative overlap test functions (see 'overlap_kernels').
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Quantized triangles:
+   *       const quantized_triangles_view &Tris;
+   *   - Overlap masks output or indices output and index base:
+   *       std::span<uint8_t> Masks;
+   *       std::span<uint32_t> Indices; uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count for indices output.
+   */
+  inline void BoxTrianglesOverlapTest( const aabb<float> &Box, const quantized_triangles_view &Tris, std::span<uint8_t> Masks ) noexcept
+  {
+    StoreMasks(Tris.Count, Masks, [&]( size_t i ) { return BoxQuantizedTriangleOverlapTest(Box, Tris, i); });
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  inline size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const quantized_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    return StoreIndices(Tris.Count, Indices, IndexBase, [&]( size_t i ) { return BoxQuantizedTriangleOverlapTest(Box, Tris, i); });
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against bucketed triangles set overlap test function (see 'overlap_kernels').
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Bucketed triangles:
+   *       const bucketed_triangles_view &Tris;
+   *   - Overlapping triangles original indices output and index base:
+   *       std::span<uint32_t> Indices; uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count.
+   */
+  inline size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const bucketed_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    size_t Written {0};
+
+    for (size_t k {0}; k < Tris.Buckets.size(); k++)
+    {
+      const triangles_bucket_view &Bucket {Tris.Buckets[k]};
+
+      for (size_t i {0}; i < Bucket.Count; i++)
+        if (BoxBucketTriangleOverlapTest(Box, (triangle_kind)k, Bucket, i))
+          Indices[Written++] = IndexBase + Bucket.Ids[i];
+    }
+    return Written;
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Triangle against equally sized boxes set overlap test functions (see 'overlap_kernels').
+   * ARGUMENTS:
+   *   - Triangle, prepared for boxes size:
+   *       const triangle_boxes_setup<float> &Tri;
+   *   - Boxes centers:
+   *       const box_centers_soa_view<float> &Centers;
+   *   - Overlap masks output or indices output and index base:
+   *       std::span<uint8_t> Masks;
+   *       std::span<uint32_t> Indices; uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count for indices output.
+   */
+  inline void TriangleBoxesOverlapTest( const triangle_boxes_setup<float> &Tri, const box_centers_soa_view<float> &Centers, std::span<uint8_t> Masks ) noexcept
+  {
+    StoreMasks(Centers.Count, Masks, [&]( size_t i ) { return Tri.Test({Centers.X[i], Centers.Y[i], Centers.Z[i]}); });
+  } /* End of 'TriangleBoxesOverlapTest' function */
+
+  inline size_t TriangleBoxesOverlapTest( const triangle_boxes_setup<float> &Tri, const box_centers_soa_view<float> &Centers, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    return StoreIndices(Centers.Count, Indices, IndexBase, [&]( size_t i ) { return Tri.Test({Centers.X[i], Centers.Y[i], Centers.Z[i]}); });
+  } /* End of 'TriangleBoxesOverlapTest' function */
+
+  /* Triangle against uniform grid cells set overlap test functions (see 'overlap_kernels').
+   * ARGUMENTS:
+   *   - Triangle, prepared for grid cells:
+   *       const triangle_cells_setup &Tri;
+   *   - Cells integer coordinates:
+   *       const cell_coords_soa_view &Cells;
+   *   - Overlap masks output or indices output and index base:
+   *       std::span<uint8_t> Masks;
+   *       std::span<uint32_t> Indices; uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count for indices output.
+   */
+  inline void TriangleCellsOverlapTest( const triangle_cells_setup &Tri, const cell_coords_soa_view &Cells, std::span<uint8_t> Masks ) noexcept
+  {
+    StoreMasks(Cells.Count, Masks, [&]( size_t i ) { return Tri.Test(Cells.X[i], Cells.Y[i], Cells.Z[i]); });
+  } /* End of 'TriangleCellsOverlapTest' function */
+
+  inline size_t TriangleCellsOverlapTest( const triangle_cells_setup &Tri, const cell_coords_soa_view &Cells, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    return StoreIndices(Cells.Count, Indices, IndexBase, [&]( size_t i ) { return Tri.Test(Cells.X[i], Cells.Y[i], Cells.Z[i]); });
+  } /* End of 'TriangleCellsOverlapTest' function */
+
+  /* Box against triangles set classification functions (see 'overlap_kernels').
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Triangles or prepared triangles:
+   *       const triangles_soa_view<float> &Tris;
+   *       const prepared_triangles_view &Tris;
+   *   - Overlap and containment masks outputs:
+   *       std::span<uint8_t> Overlap, Contained;
+   * RETURNS: None.
+   */
+  inline void BoxTrianglesClassify( const aabb<float> &Box, const triangles_soa_view<float> &Tris, std::span<uint8_t> Overlap, std::span<uint8_t> Contained ) noexcept
+  {
+    StoreClasses(Tris.Count, Overlap, Contained, [&]( size_t i ) { return BoxTriangleClassify(Box, Tris[i]); });
+  } /* End of 'BoxTrianglesClassify' function */
+
+  inline void BoxTrianglesClassify( const aabb<float> &Box, const prepared_triangles_view &Tris, std::span<uint8_t> Overlap, std::span<uint8_t> Contained ) noexcept
+  {
+    StoreClasses(Tris.Count, Overlap, Contained, [&]( size_t i ) { return BoxPreparedTriangleClassify(Box, Tris, i); });
+  } /* End of 'BoxTrianglesClassify' function */
+
+  /* Box against 8-ary hierarchy triangles overlap query function (see 'overlap_kernels').
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Hierarchy:
+   *       const wide_bvh_view<node> &Bvh;
+   *   - Overlapping triangles (hierarchy order) receiver and its context:
+   *       bvh_hits_callback Callback; void *Context;
+   * RETURNS: None.
+   */
+  template<class node>
+    void BoxWideBvhTrianglesQuery( const aabb<float> &Box, const wide_bvh_view<node> &Bvh, bvh_hits_callback Callback, void *Context )
+    {
+      if (Bvh.NodesCount == 0)
+        return;
+
+      const bvh_query_bounds Query {Box};
+      uint32_t Stack[(node::Width - 1) * wide_bvh_view<node>::MaxDepth + 1], Hits[256];
+      size_t Top {0}, Written {0};
+
+      Stack[Top++] = 0;
+      while (Top > 0)
+      {
+        const node &Node {Bvh.Nodes[Stack[--Top]]};
+
+        for (size_t Slot {0}; Slot < node::Width; Slot++)
+        {
+          const bvh_bounds Bounds {Node.GetChildBounds(Slot)};
+          uint32_t First, Count;
+
+          if (!Query.Overlaps(Bounds.Min, Bounds.Max))
+            continue;
+          Node.GetChild(Slot, First, Count);
+          if (Query.Contains(Bounds.Min, Bounds.Max))
+          {
+            if (Count == 0)
+              Count = Bvh.Subtrees[First].Count, First = Bvh.Subtrees[First].First;
+            for (uint32_t i {0}; i < Count; i++)
+            {
+              if (Written == std::size(Hits))
+                Callback(Context, {Hits, Written}), Written = 0;
+              Hits[Written++] = First + i;
+            }
+            continue;
+          }
+          if (Count == 0)
+          {
+            Stack[Top++] = First;
+            continue;
+          }
+
+          const prepared_triangles_view Leaf {prepared_mesh::MakeView(Bvh.Leaves + (size_t)First * prepared_mesh::StreamsCount, Count, Count)};
+
+          for (uint32_t i {0}; i < Count; i++)
+          {
+            if (Written == std::size(Hits))
+              Callback(Context, {Hits, Written}), Written = 0;
+            if (BoxPreparedTriangleOverlapTest(Box, Leaf, i))
+              Hits[Written++] = First + i;
+          }
+        }
+      }
+      if (Written != 0)
+        Callback(Context, {Hits, Written});
+    } /* End of 'BoxWideBvhTrianglesQuery' function */
+
+  /* Boxes batch against binary hierarchy triangles overlap query function (see 'overlap_kernels').
+   * ARGUMENTS:
+   *   - Boxes:
+   *       std::span<const aabb<float>> Boxes;
+   *   - Hierarchy:
+   *       const bvh_view &Bvh;
+   *   - Overlapping pairs receiver and its context:
+   *       bvh_pairs_callback Callback; void *Context;
+   * RETURNS: None.
+   */
+  inline void BoxesBvhTrianglesQuery( std::span<const aabb<float>> Boxes, const bvh_view &Bvh, bvh_pairs_callback Callback, void *Context )
+  {
+    if (Bvh.NodesCount == 0)
+      return;
+
+    /* Pending node with its active boxes */
+    struct entry
+    {
+      uint32_t Node;
+      uint64_t Active;
+    };
+
+    entry Stack[bvh_view::MaxDepth + 1];
+    bvh_pair Pairs[256];
+    size_t Written {0};
+    std::vector<bvh_query_bounds> Queries {};
+
+    Queries.reserve(bvh_view::PacketSize);
+    for (size_t Base {0}; Base < Boxes.size(); Base += bvh_view::PacketSize)
+    {
+      const size_t Count {std::min(Boxes.size() - Base, bvh_view::PacketSize)};
+      size_t Top {0};
+
+      /* Active boxes, which may overlap node */
+      const auto NodeBoxes {[&]( const bvh_node &Node, uint64_t Active )
+        {
+          uint64_t Overlap {0};
+
+          for (; Active != 0; Active &= Active - 1)
+            if (const size_t i {(size_t)std::countr_zero(Active)}; Queries[i].Overlaps(Node.Min, Node.Max))
+              Overlap |= 1ull << i;
+          return Overlap;
+        }};
+
+      Queries.clear();
+      for (size_t i {0}; i < Count; i++)
+        Queries.emplace_back(Boxes[Base + i]);
+      if (const uint64_t Active {NodeBoxes(Bvh.Nodes[0], Count == bvh_view::PacketSize ? ~0ull : (1ull << Count) - 1)}; Active != 0)
+        Stack[Top++] = {0, Active};
+      while (Top > 0)
+      {
+        const entry Entry {Stack[--Top]};
+        const bvh_node &Node {Bvh.Nodes[Entry.Node]};
+
+        if (Node.Count == 0)
+        {
+          for (uint32_t Child {Node.Index}; Child < Node.Index + 2; Child++)
+            if (const uint64_t Active {NodeBoxes(Bvh.Nodes[Child], Entry.Active)}; Active != 0)
+              Stack[Top++] = {Child, Active};
+          continue;
+        }
+        for (uint32_t t {Node.Index}; t < Node.Index + Node.Count; t++)
+          for (uint64_t Rest {Entry.Active}; Rest != 0; Rest &= Rest - 1)
+          {
+            const size_t i {(size_t)std::countr_zero(Rest)};
+
+            if (Written == std::size(Pairs))
+              Callback(Context, {Pairs, Written}), Written = 0;
+            if (BoxTriangleOverlapTest(Boxes[Base + i], Bvh.Triangles[t]))
+              Pairs[Written++] = {(uint32_t)(Base + i), t};
+          }
+      }
+    }
+    if (Written != 0)
+      Callback(Context, {Pairs, Written});
+  } /* End of 'BoxesBvhTrianglesQuery' function */
+
+  /* Kernels table of the reference implementation creation function.
+   * Reference tests keep the classic order, so axes evaluation order is only recorded.
+   * ARGUMENTS:
+   *   - Axes groups evaluation order:
+   *       axes_order Order;
+   * RETURNS:
+   *   (overlap_kernels) Kernels table.
+   */
+  constexpr overlap_kernels MakeKernels( axes_order Order ) noexcept
+  {
+    return
+    {
+      .Isa = isa::eScalar,
+      .Order = Order,
+      .BoxTriangles = BoxTrianglesOverlapTest,
+      .BoxTrianglesIndices = BoxTrianglesOverlapTest,
+      .BoxPreparedTriangles = BoxTrianglesOverlapTest,
+      .BoxPreparedTrianglesIndices = BoxTrianglesOverlapTest,
+      .BoxIndexedTriangles = BoxTrianglesOverlapTest,
+      .BoxIndexedTrianglesIndices = BoxTrianglesOverlapTest,
+      .BoxQuantizedTriangles = BoxTrianglesOverlapTest,
+      .BoxQuantizedTrianglesIndices = BoxTrianglesOverlapTest,
+      .BoxBucketedTrianglesIndices = BoxTrianglesOverlapTest,
+      .TriangleBoxes = TriangleBoxesOverlapTest,
+      .TriangleBoxesIndices = TriangleBoxesOverlapTest,
+      .TriangleCells = TriangleCellsOverlapTest,
+      .TriangleCellsIndices = TriangleCellsOverlapTest,
+      .BoxTrianglesClasses = BoxTrianglesClassify,
+      .BoxPreparedTrianglesClasses = BoxTrianglesClassify,
+      .BoxBvh8Triangles = BoxWideBvhTrianglesQuery,
+      .BoxQuantizedBvh8Triangles = BoxWideBvhTrianglesQuery,
+      .BoxesBvhTriangles = BoxesBvhTrianglesQuery,
+    };
+  } /* End of 'MakeKernels' function */
+
+  /* Kernels tables of the reference implementation, indexed by 'axes_order' */
+  inline constexpr overlap_kernels Kernels[]
+  {
+    MakeKernels(axes_order::eDefault),
+    MakeKernels(axes_order::eEdgesFirst),
+    MakeKernels(axes_order::eBoxFirst),
+    MakeKernels(axes_order::ePlaneFirst),
+  };
+  static_assert(std::size(Kernels) == (size_t)axes_order::_LastValue);
+} /* end of 'math::scalar' namespace */
+
+/* Math namespace */
+namespace math
+{
+  /* Kernels tables for every instruction set, indexed by 'isa' and then by 'axes_order' */
+  inline constexpr const overlap_kernels *OverlapKernels[]
+  {
+    scalar::Kernels,
+    sse::Kernels,
+    avx2::Kernels,
+    avx512::Kernels,
+  };
+  static_assert(std::size(OverlapKernels) == (size_t)isa::_LastValue);
+
+  /* Best supported instruction set getting function, CPU is queried once.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (isa) Supported instruction set.
+   */
+  inline isa GetSupportedIsa( void ) noexcept
+  {
+    static const isa Supported {DetectIsa()};
+
+    return Supported;
+  } /* End of 'GetSupportedIsa' function */
+
+  /* Active kernels table reference getting function.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (std::atomic<const overlap_kernels *> &) Active kernels table pointer.
+   */
+  inline std::atomic<const overlap_kernels *> &GetActiveKernels( void ) noexcept
+  {
+    static std::atomic<const overlap_kernels *> Active {&OverlapKernels[(size_t)GetSupportedIsa()][(size_t)axes_order::eDefault]};
+
+    return Active;
+  } /* End of 'GetActiveKernels' function */
+
+  /* Active instruction set getting function.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (isa) Instruction set used by batch tests.
+   */
+  inline isa GetIsa( void ) noexcept
+  {
+    return GetActiveKernels().load(std::memory_order_relaxed)->Isa;
+  } /* End of 'GetIsa' function */
+
+  /* Instruction set forcing function (e.g. for benchmarking).
+   * ARGUMENTS:
+   *   - Instruction set to use by batch tests:
+   *       isa Isa;
+   * RETURNS: None.
+   */
+  inline void SetIsa( isa Isa )
+  {
+    if (Isa >= isa::_LastValue || Isa > GetSupportedIsa())
+      throw std::runtime_error {"Requested instruction set is not supported by CPU"};
+
+    std::atomic<const overlap_kernels *> &Active {GetActiveKernels()};
+
+    Active.store(&OverlapKernels[(size_t)Isa][(size_t)Active.load(std::memory_order_relaxed)->Order], std::memory_order_relaxed);
+  } /* End of 'SetIsa' function */
+
+  /* Active separating axes groups evaluation order getting function.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (axes_order) Order used by batch tests.
+   */
+  inline axes_order GetAxesOrder( void ) noexcept
+  {
+    return GetActiveKernels().load(std::memory_order_relaxed)->Order;
+  } /* End of 'GetAxesOrder' function */
+
+  /* Separating axes groups evaluation order setting function.
+   * Order may be chosen by workload statistics (see 'axes_stats::GetBestOrder').
+   * ARGUMENTS:
+   *   - Order to use by batch tests ('eDefault' restores per kernel tuned orders):
+   *       axes_order Order;
+   * RETURNS: None.
+   */
+  inline void SetAxesOrder( axes_order Order )
+  {
+    if (Order >= axes_order::_LastValue)
+      throw std::out_of_range {"Unknown axes evaluation order"};
+
+    std::atomic<const overlap_kernels *> &Active {GetActiveKernels()};
+
+    Active.store(&OverlapKernels[(size_t)Active.load(std::memory_order_relaxed)->Isa][(size_t)Order], std::memory_order_relaxed);
+  } /* End of 'SetAxesOrder' function */
+
+  /* Box against triangles set overlap test function (best instruction set).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Triangles:
+   *       const triangles_soa_view<float> &Tris;
+   *   - Overlap masks output, bit i of byte k is set if triangle 8 * k + i overlaps
+   *     (must hold at least (Tris.Count + 7) / 8 bytes):
+   *       std::span<uint8_t> Masks;
+   * RETURNS: None.
+   */
+  inline void BoxTrianglesOverlapTest( const aabb<float> &Box, const triangles_soa_view<float> &Tris, std::span<uint8_t> Masks )
+  {
+    if (Masks.size() < (Tris.Count + 7) / 8)
+      throw std::out_of_range {"Overlap masks span is too small"};
+
+    GetActiveKernels().load(std::memory_order_relaxed)->BoxTriangles(Box, Tris, Masks);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against triangles set overlap test function, compacted indices output (best instruction set).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Triangles:
+   *       const triangles_soa_view<float> &Tris;
+   *   - Overlapping elements indices output, sized by caller (at least Tris.Count long):
+   *       std::span<uint32_t> Indices;
+   *   - Value added to every written index (default: 0):
+   *       uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count.
+   */
+  inline size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const triangles_soa_view<float> &Tris, std::span<uint32_t> Indices, uint32_t IndexBase = 0 )
+  {
+    if (Indices.size() < Tris.Count)
+      throw std::out_of_range {"Overlap indices span is too small"};
+
+    return GetActiveKernels().load(std::memory_order_relaxed)->BoxTrianglesIndices(Box, Tris, Indices, IndexBase);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against prepared triangles set overlap test function (best instruction set).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Prepared triangles (see 'prepared_mesh'):
+   *       const prepared_triangles_view &Tris;
+   *   - Overlap masks output, bit i of byte k is set if triangle 8 * k + i overlaps
+   *     (must hold at least (Tris.Count + 7) / 8 bytes):
+   *       std::span<uint8_t> Masks;
+   * RETURNS: None.
+   */
+  inline void BoxTrianglesOverlapTest( const aabb<float> &Box, const prepared_triangles_view &Tris, std::span<uint8_t> Masks )
+  {
+    if (Masks.size() < (Tris.Count + 7) / 8)
+      throw std::out_of_range {"Overlap masks span is too small"};
+
+    GetActiveKernels().load(std::memory_order_relaxed)->BoxPreparedTriangles(Box, Tris, Masks);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against prepared triangles set overlap test function, compacted indices output (best instruction set).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Prepared triangles (see 'prepared_mesh'):
+   *       const prepared_triangles_view &Tris;
+   *   - Overlapping elements indices output, sized by caller (at least Tris.Count long):
+   *       std::span<uint32_t> Indices;
+   *   - Value added to every written index (default: 0):
+   *       uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count.
+   */
+  inline size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const prepared_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase = 0 )
+  {
+    if (Indices.size() < Tris.Count)
+      throw std::out_of_range {"Overlap indices span is too small"};
+
+    return GetActiveKernels().load(std::memory_order_relaxed)->BoxPreparedTrianglesIndices(Box, Tris, Indices, IndexBase);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Indexed triangles view validity check function.
+   * ARGUMENTS:
+   *   - Indexed triangles:
+   *       const indexed_triangles_view &Tris;
+   * RETURNS: None.
+   */
+  inline void CheckIndexedTriangles( const indexed_triangles_view &Tris )
+  {
+    if (Tris.VertexStride < 3)
+      throw std::out_of_range {"Vertex stride is less than 3 floats"};
+    if (Tris.VertexCount > (size_t)INT32_MAX / Tris.VertexStride)
+      throw std::out_of_range {"Vertex buffer is too large for 32-bit gather offsets"};
+  } /* End of 'CheckIndexedTriangles' function */
+
+  /* Box against indexed triangles set overlap test function (best instruction set).
+   * Vertices are gathered by index, triangle indices are not checked against vertices count.
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Indexed triangles:
+   *       const indexed_triangles_view &Tris;
+   *   - Overlap masks output, bit i of byte k is set if triangle 8 * k + i overlaps
+   *     (must hold at least (Tris.Count + 7) / 8 bytes):
+   *       std::span<uint8_t> Masks;
+   * RETURNS: None.
+   */
+  inline void BoxTrianglesOverlapTest( const aabb<float> &Box, const indexed_triangles_view &Tris, std::span<uint8_t> Masks )
+  {
+    CheckIndexedTriangles(Tris);
+    if (Masks.size() < (Tris.Count + 7) / 8)
+      throw std::out_of_range {"Overlap masks span is too small"};
+
+    GetActiveKernels().load(std::memory_order_relaxed)->BoxIndexedTriangles(Box, Tris, Masks);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against indexed triangles set overlap test function, compacted indices output (best instruction set).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Indexed triangles:
+   *       const indexed_triangles_view &Tris;
+   *   - Overlapping elements indices output, sized by caller (at least Tris.Count long):
+   *       std::span<uint32_t> Indices;
+   *   - Value added to every written index (default: 0):
+   *       uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count.
+   */
+  inline size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const indexed_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase = 0 )
+  {
+    CheckIndexedTriangles(Tris);
+    if (Indices.size() < Tris.Count)
+      throw std::out_of_range {"Overlap indices span is too small"};
+
+    return GetActiveKernels().load(std::memory_order_relaxed)->BoxIndexedTrianglesIndices(Box, Tris, Indices, IndexBase);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against quantized triangles set conservative overlap test function (best instruction set).
+   * Triangles overlapping box before quantization are always reported, close ones may be reported too.
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Quantized triangles (see 'quantized_mesh'):
+   *       const quantized_triangles_view &Tris;
+   *   - Overlap masks output, bit i of byte k is set if triangle 8 * k + i may overlap
+   *     (must hold at least (Tris.Count + 7) / 8 bytes):
+   *       std::span<uint8_t> Masks;
+   * RETURNS: None.
+   */
+  inline void BoxTrianglesOverlapTest( const aabb<float> &Box, const quantized_triangles_view &Tris, std::span<uint8_t> Masks )
+  {
+    if (Masks.size() < (Tris.Count + 7) / 8)
+      throw std::out_of_range {"Overlap masks span is too small"};
+
+    GetActiveKernels().load(std::memory_order_relaxed)->BoxQuantizedTriangles(Box, Tris, Masks);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against quantized triangles set conservative overlap test function, compacted indices output (best instruction set).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Quantized triangles (see 'quantized_mesh'):
+   *       const quantized_triangles_view &Tris;
+   *   - Overlapping elements indices output, sized by caller (at least Tris.Count long):
+   *       std::span<uint32_t> Indices;
+   *   - Value added to every written index (default: 0):
+   *       uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count.
+   */
+  inline size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const quantized_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase = 0 )
+  {
+    if (Indices.size() < Tris.Count)
+      throw std::out_of_range {"Overlap indices span is too small"};
+
+    return GetActiveKernels().load(std::memory_order_relaxed)->BoxQuantizedTrianglesIndices(Box, Tris, Indices, IndexBase);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Box against bucketed triangles set overlap test function, compacted indices output (best instruction set).
+   * Every bucket runs its own reduced kernel (see 'triangle_kind').
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Bucketed triangles (see 'bucketed_mesh'):
+   *       const bucketed_triangles_view &Tris;
+   *   - Overlapping triangles original indices output, grouped by bucket (at least Tris.Count long):
+   *       std::span<uint32_t> Indices;
+   *   - Value added to every written index (default: 0):
+   *       uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count.
+   */
+  inline size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const bucketed_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase = 0 )
+  {
+    if (Indices.size() < Tris.Count)
+      throw std::out_of_range {"Overlap indices span is too small"};
+
+    return GetActiveKernels().load(std::memory_order_relaxed)->BoxBucketedTrianglesIndices(Box, Tris, Indices, IndexBase);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+  /* Triangle against equally sized boxes set overlap test function (best instruction set).
+   * ARGUMENTS:
+   *   - Triangle, prepared for boxes size:
+   *       const triangle_boxes_setup<float> &Tri;
+   *   - Boxes centers:
+   *       const box_centers_soa_view<float> &Centers;
+   *   - Overlap masks output, bit i of byte k is set if box 8 * k + i overlaps
+   *     (must hold at least (Centers.Count + 7) / 8 bytes):
+   *       std::span<uint8_t> Masks;
+   * RETURNS: None.
+   */
+  inline void TriangleBoxesOverlapTest( const triangle_boxes_setup<float> &Tri, const box_centers_soa_view<float> &Centers, std::span<uint8_t> Masks )
+  {
+    if (Masks.size() < (Centers.Count + 7) / 8)
+      throw std::out_of_range {"Overlap masks span is too small"};
+
+    GetActiveKernels().load(std::memory_order_relaxed)->TriangleBoxes(Tri, Centers, Masks);
+  } /* End of 'TriangleBoxesOverlapTest' function */
+
+  /* Triangle against equally sized boxes set overlap test function, compacted indices output (best instruction set).
+   * ARGUMENTS:
+   *   - Triangle, prepared for boxes size:
+   *       const triangle_boxes_setup<float> &Tri;
+   *   - Boxes centers:
+   *       const box_centers_soa_view<float> &Centers;
+   *   - Overlapping elements indices output, sized by caller (at least Centers.Count long):
+   *       std::span<uint32_t> Indices;
+   *   - Value added to every written index (default: 0):
+   *       uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count.
+   */
+  inline size_t TriangleBoxesOverlapTest( const triangle_boxes_setup<float> &Tri, const box_centers_soa_view<float> &Centers, std::span<uint32_t> Indices, uint32_t IndexBase = 0 )
+  {
+    if (Indices.size() < Centers.Count)
+      throw std::out_of_range {"Overlap indices span is too small"};
+
+    return GetActiveKernels().load(std::memory_order_relaxed)->TriangleBoxesIndices(Tri, Centers, Indices, IndexBase);
+  } /* End of 'TriangleBoxesOverlapTest' function */
+
+  /* Triangle against uniform grid cells set overlap test function (best instruction set).
+   * ARGUMENTS:
+   *   - Triangle, prepared for grid cells:
+   *       const triangle_cells_setup &Tri;
+   *   - Cells integer coordinates:
+   *       const cell_coords_soa_view &Cells;
+   *   - Overlap masks output, bit i of byte k is set if cell 8 * k + i overlaps
+   *     (must hold at least (Cells.Count + 7) / 8 bytes):
+   *       std::span<uint8_t> Masks;
+   * RETURNS: None.
+   */
+  inline void TriangleCellsOverlapTest( const triangle_cells_setup &Tri, const cell_coords_soa_view &Cells, std::span<uint8_t> Masks )
+  {
+    if (Masks.size() < (Cells.Count + 7) / 8)
+      throw std::out_of_range {"Overlap masks span is too small"};
+
+    GetActiveKernels().load(std::memory_order_relaxed)->TriangleCells(Tri, Cells, Masks);
+  } /* End of 'TriangleCellsOverlapTest' function */
+
+  /* Triangle against uniform grid cells set overlap test function, compacted indices output (best instruction set).
+   * ARGUMENTS:
+   *   - Triangle, prepared for grid cells:
+   *       const triangle_cells_setup &Tri;
+   *   - Cells integer coordinates:
+   *       const cell_coords_soa_view &Cells;
+   *   - Overlapping elements indices output, sized by caller (at least Cells.Count long):
+   *       std::span<uint32_t> Indices;
+   *   - Value added to every written index (default: 0):
+   *       uint32_t IndexBase;
+   * RETURNS:
+   *   (size_t) Written indices count.
+   */
+  inline size_t TriangleCellsOverlapTest( const triangle_cells_setup &Tri, const cell_coords_soa_view &Cells, std::span<uint32_t> Indices, uint32_t IndexBase = 0 )
+  {
+    if (Indices.size() < Cells.Count)
+      throw std::out_of_range {"Overlap indices span is too small"};
+
+    return GetActiveKernels().load(std::memory_order_relaxed)->TriangleCellsIndices(Tri, Cells, Indices, IndexBase);
+  } /* End of 'TriangleCellsOverlapTest' function */
+
+  /* Box against triangles set classification function (best instruction set).
+   * Straddling triangles are the overlapping ones, which are not contained.
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Triangles:
+   *       const triangles_soa_view<float> &Tris;
+   *   - Overlap and containment masks outputs, bit i of byte k corresponds to triangle 8 * k + i
+   *     (each must hold at least (Tris.Count + 7) / 8 bytes):
+   *       std::span<uint8_t> Overlap, Contained;
+   * RETURNS: None.
+   */
+  inline void BoxTrianglesClassify( const aabb<float> &Box, const triangles_soa_view<float> &Tris, std::span<uint8_t> Overlap, std::span<uint8_t> Contained )
+  {
+    if (Overlap.size() < (Tris.Count + 7) / 8 || Contained.size() < (Tris.Count + 7) / 8)
+      throw std::out_of_range {"Classification masks span is too small"};
+
+    GetActiveKernels().load(std::memory_order_relaxed)->BoxTrianglesClasses(Box, Tris, Overlap, Contained);
+  } /* End of 'BoxTrianglesClassify' function */
+
+  /* Box against prepared triangles set classification function (best instruction set).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Prepared triangles (see 'prepared_mesh'):
+   *       const prepared_triangles_view &Tris;
+   *   - Overlap and containment masks outputs, bit i of byte k corresponds to triangle 8 * k + i
+   *     (each must hold at least (Tris.Count + 7) / 8 bytes):
+   *       std::span<uint8_t> Overlap, Contained;
+   * RETURNS: None.
+   */
+  inline void BoxTrianglesClassify( const aabb<float> &Box, const prepared_triangles_view &Tris, std::span<uint8_t> Overlap, std::span<uint8_t> Contained )
+  {
+    if (Overlap.size() < (Tris.Count + 7) / 8 || Contained.size() < (Tris.Count + 7) / 8)
+      throw std::out_of_range {"Classification masks span is too small"};
+
+    GetActiveKernels().load(std::memory_order_relaxed)->BoxPreparedTrianglesClasses(Box, Tris, Overlap, Contained);
+  } /* End of 'BoxTrianglesClassify' function */
+
+  /* Box against 8-ary hierarchy triangles overlap query function (best instruction set).
+   * Hierarchy may come from 'bvh8' or straight from a mapped mesh file ('mesh_file::GetBvh8').
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Hierarchy:
+   *       const bvh8_view &Bvh;
+   *   - Overlapping triangles (hierarchy order) receiver and its context:
+   *       bvh_hits_callback Callback; void *Context;
+   * RETURNS: None.
+   */
+  inline void BoxBvhTrianglesQuery( const aabb<float> &Box, const bvh8_view &Bvh, bvh_hits_callback Callback, void *Context )
+  {
+    GetActiveKernels().load(std::memory_order_relaxed)->BoxBvh8Triangles(Box, Bvh, Callback, Context);
+  } /* End of 'BoxBvhTrianglesQuery' function */
+
+  /* Box against quantized 8-ary hierarchy triangles overlap query function (best instruction set).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Hierarchy (from 'quantized_bvh8' or 'mesh_file::GetQuantizedBvh8'):
+   *       const quantized_bvh8_view &Bvh;
+   *   - Overlapping triangles (hierarchy order) receiver and its context:
+   *       bvh_hits_callback Callback; void *Context;
+   * RETURNS: None.
+   */
+  inline void BoxBvhTrianglesQuery( const aabb<float> &Box, const quantized_bvh8_view &Bvh, bvh_hits_callback Callback, void *Context )
+  {
+    GetActiveKernels().load(std::memory_order_relaxed)->BoxQuantizedBvh8Triangles(Box, Bvh, Callback, Context);
+  } /* End of 'BoxBvhTrianglesQuery' function */
+
+  /* Boxes batch against binary hierarchy triangles overlap query function (best instruction set), see 'bvh::Query'.
+   * ARGUMENTS:
+   *   - Boxes:
+   *       std::span<const aabb<float>> Boxes;
+   *   - Hierarchy (from 'bvh' or 'mesh_file::GetBvh'):
+   *       const bvh_view &Bvh;
+   *   - Overlapping pairs (hierarchy order triangles) receiver and its context:
+   *       bvh_pairs_callback Callback; void *Context;
+   * RETURNS: None.
+   */
+  inline void BoxesBvhTrianglesQuery( std::span<const aabb<float>> Boxes, const bvh_view &Bvh, bvh_pairs_callback Callback, void *Context )
+  {
+    GetActiveKernels().load(std::memory_order_relaxed)->BoxesBvhTriangles(Boxes, Bvh, Callback, Context);
+  } /* End of 'BoxesBvhTrianglesQuery' function */
+} /* end of 'math' namespace */
+
 #endif /* __box_triangle_overlap_test_hpp__ */
 
 /* END OF 'box_triangle_overlap_test.hpp' FILE */
@@ -0,0 +1,106 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_avx2.hpp" - AVX2 overlap kernels */
+
+#ifndef __overlap_avx2_hpp__
+#define __overlap_avx2_hpp__
+
+#include "overlap_table.hpp"
+
+OVERLAP_TARGET_PUSH(OVERLAP_TARGET_AVX2)
+
+/* Math namespace // AVX2 overlap kernels */
+namespace math::avx2
+{
+  /* AVX2 operations, 8 lanes.
+   * Members are thin wrappers over intrinsics, the same interface as 'sse::simd', without arguments blocks. */
+  struct simd
+  {
+    using vec = __m256;  // Lanes vector
+    using mask = __m256; // Lanes mask, all bits are set in active lanes
+
+    static constexpr size_t Width {8};     // Lanes count
+    static constexpr isa Isa {isa::eAVX2}; // Instruction set
+
+    /* Loading */
+    static vec Set1( float V ) noexcept { return _mm256_set1_ps(V); }
+    static vec Load( const float *P ) noexcept { return _mm256_loadu_ps(P); }
+    static mask All( void ) noexcept { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    static mask First( size_t N ) noexcept { return _mm256_castsi256_ps(FirstI(N)); }
+    static mask FromBits( uint32_t Bits ) noexcept { const __m256i Lane {_mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128)}; return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int)Bits), Lane), Lane)); }
+    static __m256i FirstI( size_t N ) noexcept { return _mm256_cmpgt_epi32(_mm256_set1_epi32((int)N), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+    static vec LoadFirst( const float *P, size_t N ) noexcept { return _mm256_maskload_ps(P, FirstI(N)); }
+    static vec LoadU16( const uint16_t *P ) noexcept { return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(P)))); }
+    static vec LoadU8( const uint8_t *P ) noexcept { return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(P)))); }
+    static vec LoadInt( const int32_t *P ) noexcept { return _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(P))); }
+    static vec LoadIntFirst( const int32_t *P, size_t N ) noexcept { return _mm256_cvtepi32_ps(_mm256_maskload_epi32(reinterpret_cast<const int *>(P), FirstI(N))); }
+
+    /* Gathering (vgatherdps), every lane offset is a signed 32-bit number of elements.
+     * Triangle list indices are loaded contiguously and deinterleaved: lanes of every vertex
+     * occupy distinct positions of the 3 loaded vectors, so 2 blends and a permute suffice */
+    using ivec = __m256i; // Integer lanes vector
+    static void LoadTriangleIndices( const uint32_t *P, size_t N, ivec *I ) noexcept
+    {
+      const __m256i
+        A {_mm256_maskload_epi32(reinterpret_cast<const int *>(P), FirstI(N * 3))},
+        B {_mm256_maskload_epi32(reinterpret_cast<const int *>(P + 8), FirstI(N * 3 - std::min(N * 3, Width)))},
+        C {_mm256_maskload_epi32(reinterpret_cast<const int *>(P + 16), FirstI(N * 3 - std::min(N * 3, Width * 2)))};
+
+      I[0] = _mm256_permutevar8x32_epi32(_mm256_blend_epi32(_mm256_blend_epi32(A, B, 0x92), C, 0x24), _mm256_setr_epi32(0, 3, 6, 1, 4, 7, 2, 5));
+      I[1] = _mm256_permutevar8x32_epi32(_mm256_blend_epi32(_mm256_blend_epi32(A, B, 0x24), C, 0x49), _mm256_setr_epi32(1, 4, 7, 2, 5, 0, 3, 6));
+      I[2] = _mm256_permutevar8x32_epi32(_mm256_blend_epi32(_mm256_blend_epi32(A, B, 0x49), C, 0x92), _mm256_setr_epi32(2, 5, 0, 3, 6, 1, 4, 7));
+    }
+    static ivec MulInt( ivec A, int32_t B ) noexcept { return _mm256_mullo_epi32(A, _mm256_set1_epi32(B)); }
+    static vec Gather( const float *Base, ivec Offsets ) noexcept { return _mm256_i32gather_ps(Base, Offsets, 4); }
+
+    /* Arithmetic */
+    static vec Add( vec A, vec B ) noexcept { return _mm256_add_ps(A, B); }
+    static vec Sub( vec A, vec B ) noexcept { return _mm256_sub_ps(A, B); }
+    static vec Mul( vec A, vec B ) noexcept { return _mm256_mul_ps(A, B); }
+    static vec FMAdd( vec A, vec B, vec C ) noexcept { return _mm256_fmadd_ps(A, B, C); }
+    static vec FMSub( vec A, vec B, vec C ) noexcept { return _mm256_fmsub_ps(A, B, C); }
+    static vec Min( vec A, vec B ) noexcept { return _mm256_min_ps(A, B); }
+    static vec Max( vec A, vec B ) noexcept { return _mm256_max_ps(A, B); }
+    static vec Abs( vec A ) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), A); }
+    static vec Neg( vec A ) noexcept { return _mm256_xor_ps(_mm256_set1_ps(-0.f), A); }
+
+    /* Comparisons and masks */
+    static mask Less( vec A, vec B ) noexcept { return _mm256_cmp_ps(A, B, _CMP_LT_OQ); }
+    static mask Greater( vec A, vec B ) noexcept { return _mm256_cmp_ps(A, B, _CMP_GT_OQ); }
+    static mask Or( mask A, mask B ) noexcept { return _mm256_or_ps(A, B); }
+    static mask AndNot( mask A, mask B ) noexcept { return _mm256_andnot_ps(A, B); }
+    static bool None( mask A ) noexcept { return _mm256_testz_ps(A, A) != 0; }
+    static uint32_t Bits( mask A ) noexcept { return (uint32_t)_mm256_movemask_ps(A); }
+
+    /* Compaction: overlapping lanes numbers from the table, offset by the pack first index
+     * (indices are consecutive, so table lanes replace the usual permutation of index vector) */
+    static void CompressStore( uint32_t *Dst, uint32_t FirstIndex, uint32_t Bits ) noexcept
+    {
+      const __m256i Lanes {_mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long)CompactionTable<8>[Bits]))};
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(Dst), _mm256_add_epi32(Lanes, _mm256_set1_epi32((int)FirstIndex)));
+    }
+  }; /* end of 'simd' structure */
+
+  /* Instruction set independent kernels */
+#include "overlap_kernels.inl"
+} /* end of 'math::avx2' namespace */
+
+OVERLAP_TARGET_POP()
+
+#endif /* __overlap_avx2_hpp__ */
+
+/* END OF 'overlap_avx2.hpp' FILE */
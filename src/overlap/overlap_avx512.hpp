@@ -0,0 +1,109 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_avx512.hpp" - AVX-512 overlap kernels */
+
+#ifndef __overlap_avx512_hpp__
+#define __overlap_avx512_hpp__
+
+#include "overlap_table.hpp"
+
+OVERLAP_TARGET_PUSH(OVERLAP_TARGET_AVX512)
+
+/* Math namespace // AVX-512 overlap kernels */
+namespace math::avx512
+{
+  /* AVX-512 operations, 16 lanes, masks are kept in opmask registers.
+   * Members are thin wrappers over intrinsics, the same interface as 'sse::simd', without arguments blocks. */
+  struct simd
+  {
+    using vec = __m512;      // Lanes vector
+    using mask = __mmask16;  // Lanes mask, bit per lane
+
+    static constexpr size_t Width {16};      // Lanes count
+    static constexpr isa Isa {isa::eAVX512}; // Instruction set
+
+    /* Loading */
+    static vec Set1( float V ) noexcept { return _mm512_set1_ps(V); }
+    static vec Load( const float *P ) noexcept { return _mm512_loadu_ps(P); }
+    static mask All( void ) noexcept { return (mask)0xFFFF; }
+    static mask First( size_t N ) noexcept { return (mask)((1u << N) - 1); }
+    static mask FromBits( uint32_t Bits ) noexcept { return (mask)Bits; }
+    static vec LoadFirst( const float *P, size_t N ) noexcept { return _mm512_maskz_loadu_ps(First(N), P); }
+    static vec LoadU16( const uint16_t *P ) noexcept { return _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(P)))); }
+    static vec LoadU8( const uint8_t *P ) noexcept { return _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(P)))); } // 8 bytes, upper lanes are zero
+    static vec LoadInt( const int32_t *P ) noexcept { return _mm512_cvtepi32_ps(_mm512_loadu_si512(P)); }
+    static vec LoadIntFirst( const int32_t *P, size_t N ) noexcept { return _mm512_cvtepi32_ps(_mm512_maskz_loadu_epi32(First(N), P)); }
+
+    /* Gathering (vgatherdps), every lane offset is a signed 32-bit number of elements.
+     * Triangle list indices are loaded contiguously and deinterleaved with two-source permutes */
+    using ivec = __m512i; // Integer lanes vector
+    static void LoadTriangleIndices( const uint32_t *P, size_t N, ivec *I ) noexcept
+    {
+      const size_t Count {N * 3};
+      const __m512i
+        A {_mm512_maskz_loadu_epi32(First(std::min(Count, Width)), P)},
+        B {_mm512_maskz_loadu_epi32(First(std::min(Count - std::min(Count, Width), Width)), P + 16)},
+        C {_mm512_maskz_loadu_epi32(First(Count - std::min(Count, Width * 2)), P + 32)};
+
+      /* Lanes from A and B first, then the last ones from C */
+      I[0] = _mm512_permutex2var_epi32(_mm512_permutex2var_epi32(A, _mm512_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21, 24, 27, 30, 0, 0, 0, 0, 0), B),
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 17, 20, 23, 26, 29), C);
+      I[1] = _mm512_permutex2var_epi32(_mm512_permutex2var_epi32(A, _mm512_setr_epi32(1, 4, 7, 10, 13, 16, 19, 22, 25, 28, 31, 0, 0, 0, 0, 0), B),
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 18, 21, 24, 27, 30), C);
+      I[2] = _mm512_permutex2var_epi32(_mm512_permutex2var_epi32(A, _mm512_setr_epi32(2, 5, 8, 11, 14, 17, 20, 23, 26, 29, 0, 0, 0, 0, 0, 0), B),
+        _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 16, 19, 22, 25, 28, 31), C);
+    }
+    static ivec MulInt( ivec A, int32_t B ) noexcept { return _mm512_mullo_epi32(A, _mm512_set1_epi32(B)); }
+    static vec Gather( const float *Base, ivec Offsets ) noexcept { return _mm512_i32gather_ps(Offsets, Base, 4); }
+
+    /* Arithmetic */
+    static vec Add( vec A, vec B ) noexcept { return _mm512_add_ps(A, B); }
+    static vec Sub( vec A, vec B ) noexcept { return _mm512_sub_ps(A, B); }
+    static vec Mul( vec A, vec B ) noexcept { return _mm512_mul_ps(A, B); }
+    static vec FMAdd( vec A, vec B, vec C ) noexcept { return _mm512_fmadd_ps(A, B, C); }
+    static vec FMSub( vec A, vec B, vec C ) noexcept { return _mm512_fmsub_ps(A, B, C); }
+    static vec Min( vec A, vec B ) noexcept { return _mm512_min_ps(A, B); }
+    static vec Max( vec A, vec B ) noexcept { return _mm512_max_ps(A, B); }
+    static vec Abs( vec A ) noexcept { return _mm512_abs_ps(A); }
+    static vec Neg( vec A ) noexcept { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(A), _mm512_set1_epi32(INT32_MIN))); }
+
+    /* Comparisons and masks */
+    static mask Less( vec A, vec B ) noexcept { return _mm512_cmp_ps_mask(A, B, _CMP_LT_OQ); }
+    static mask Greater( vec A, vec B ) noexcept { return _mm512_cmp_ps_mask(A, B, _CMP_GT_OQ); }
+    static mask Or( mask A, mask B ) noexcept { return _mm512_kor(A, B); }
+    static mask AndNot( mask A, mask B ) noexcept { return _mm512_kandn(A, B); }
+    static bool None( mask A ) noexcept { return A == 0; }
+    static uint32_t Bits( mask A ) noexcept { return (uint32_t)A; }
+
+    /* Compaction: vpcompressd straight from the opmask */
+    static void CompressStore( uint32_t *Dst, uint32_t FirstIndex, uint32_t Bits ) noexcept
+    {
+      const __m512i Indices {_mm512_add_epi32(_mm512_set1_epi32((int)FirstIndex),
+                                              _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15))};
+
+      _mm512_storeu_si512(Dst, _mm512_maskz_compress_epi32((mask)Bits, Indices));
+    }
+  }; /* end of 'simd' structure */
+
+  /* Instruction set independent kernels */
+#include "overlap_kernels.inl"
+} /* end of 'math::avx512' namespace */
+
+OVERLAP_TARGET_POP()
+
+#endif /* __overlap_avx512_hpp__ */
+
+/* END OF 'overlap_avx512.hpp' FILE */
@@ -0,0 +1,450 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_base.hpp" - Overlap test base types and scalar reference implementation */
+
+#ifndef __overlap_base_hpp__
+#define __overlap_base_hpp__
+
+#include "overlap_def.h"
+
+/* Math namespace */
+namespace math
+{
+  /* Absolute value function (std::abs is not constexpr before C++23).
+   * ARGUMENTS:
+   *   - Value:
+   *       type Value;
+   * RETURNS:
+   *   (type) Absolute value.
+   */
+  template<std::floating_point type>
+    constexpr type Abs( type Value ) noexcept
+    {
+      return Value < 0 ? -Value : Value;
+    } /* End of 'Abs' function */
+
+  /* Simple 3 component vector */
+  template<std::floating_point type>
+    struct vec3
+    {
+      type X {}, Y {}, Z {}; // Components
+
+      /* Vectors addition operator.
+       * ARGUMENTS:
+       *   - Second operand:
+       *       const vec3 &Rhs;
+       * RETURNS:
+       *   (vec3) Sum.
+       */
+      constexpr vec3 operator+( const vec3 &Rhs ) const noexcept
+      {
+        return {X + Rhs.X, Y + Rhs.Y, Z + Rhs.Z};
+      } /* End of 'operator+' function */
+
+      /* Vectors subtraction operator.
+       * ARGUMENTS:
+       *   - Second operand:
+       *       const vec3 &Rhs;
+       * RETURNS:
+       *   (vec3) Difference.
+       */
+      constexpr vec3 operator-( const vec3 &Rhs ) const noexcept
+      {
+        return {X - Rhs.X, Y - Rhs.Y, Z - Rhs.Z};
+      } /* End of 'operator-' function */
+
+      /* Vector by scalar multiplication operator.
+       * ARGUMENTS:
+       *   - Scalar:
+       *       type Scale;
+       * RETURNS:
+       *   (vec3) Scaled vector.
+       */
+      constexpr vec3 operator*( type Scale ) const noexcept
+      {
+        return {X * Scale, Y * Scale, Z * Scale};
+      } /* End of 'operator*' function */
+
+      /* Comparison operator */
+      constexpr bool operator==( const vec3 & ) const noexcept = default;
+    }; /* end of 'vec3' structure */
+
+  /* Dot product function.
+   * ARGUMENTS:
+   *   - Operands:
+   *       const vec3<type> &A, &B;
+   * RETURNS:
+   *   (type) Dot product.
+   */
+  template<std::floating_point type>
+    constexpr type Dot( const vec3<type> &A, const vec3<type> &B ) noexcept
+    {
+      return A.X * B.X + A.Y * B.Y + A.Z * B.Z;
+    } /* End of 'Dot' function */
+
+  /* Cross product function.
+   * ARGUMENTS:
+   *   - Operands:
+   *       const vec3<type> &A, &B;
+   * RETURNS:
+   *   (vec3<type>) Cross product.
+   */
+  template<std::floating_point type>
+    constexpr vec3<type> Cross( const vec3<type> &A, const vec3<type> &B ) noexcept
+    {
+      return {A.Y * B.Z - A.Z * B.Y, A.Z * B.X - A.X * B.Z, A.X * B.Y - A.Y * B.X};
+    } /* End of 'Cross' function */
+
+  /* Per component absolute value function.
+   * ARGUMENTS:
+   *   - Vector:
+   *       const vec3<type> &V;
+   * RETURNS:
+   *   (vec3<type>) Vector of absolute values.
+   */
+  template<std::floating_point type>
+    constexpr vec3<type> Abs( const vec3<type> &V ) noexcept
+    {
+      return {Abs(V.X), Abs(V.Y), Abs(V.Z)};
+    } /* End of 'Abs' function */
+
+  /* Axis aligned bounding box, stored as center and half size */
+  template<std::floating_point type>
+    struct aabb
+    {
+      vec3<type> Center {};   // Box center
+      vec3<type> HalfSize {}; // Box half extents, non-negative
+
+      /* Box from minimal and maximal corners construction function.
+       * ARGUMENTS:
+       *   - Box corners:
+       *       const vec3<type> &Min, &Max;
+       * RETURNS:
+       *   (aabb) Created box.
+       */
+      static constexpr aabb FromMinMax( const vec3<type> &Min, const vec3<type> &Max ) noexcept
+      {
+        return {(Min + Max) * type(0.5), (Max - Min) * type(0.5)};
+      } /* End of 'FromMinMax' function */
+    }; /* end of 'aabb' structure */
+
+  /* Triangle, stored as three vertices */
+  template<std::floating_point type>
+    struct triangle
+    {
+      vec3<type> V0 {}, V1 {}, V2 {}; // Vertices
+    }; /* end of 'triangle' structure */
+
+  /* Separating axis check by two projected triangle vertices (the third one always
+   * coincides with one of them for edge cross product axes).
+   * ARGUMENTS:
+   *   - Triangle vertices projections:
+   *       type P0, P1;
+   *   - Box projection radius:
+   *       type Rad;
+   * RETURNS:
+   *   (bool) true if axis separates box and triangle.
+   */
+  template<std::floating_point type>
+    constexpr bool IsSeparatingAxis( type P0, type P1, type Rad ) noexcept
+    {
+      return std::min(P0, P1) > Rad || std::max(P0, P1) < -Rad;
+    } /* End of 'IsSeparatingAxis' function */
+
+  /* Box and triangle separating axes groups (scalar reference).
+   * Everything is moved so that box center is in the origin. */
+  template<std::floating_point type>
+    struct box_triangle_axes
+    {
+      vec3<type> H {};                // Box half size
+      vec3<type> V0 {}, V1 {}, V2 {}; // Box center relative triangle vertices
+      vec3<type> E0 {}, E1 {}, E2 {}; // Triangle edges
+
+      /* Constructor from box and triangle.
+       * ARGUMENTS:
+       *   - Box:
+       *       const aabb<type> &Box;
+       *   - Triangle:
+       *       const triangle<type> &Tri;
+       */
+      constexpr box_triangle_axes( const aabb<type> &Box, const triangle<type> &Tri ) noexcept :
+        H {Box.HalfSize},
+        V0 {Tri.V0 - Box.Center},
+        V1 {Tri.V1 - Box.Center},
+        V2 {Tri.V2 - Box.Center},
+        E0 {V1 - V0},
+        E1 {V2 - V1},
+        E2 {V0 - V2}
+      {
+      } /* End of constructor */
+
+      /* Edge cross products with X, Y and Z box axes separation check function.
+       * ARGUMENTS:
+       *   - Triangle edge:
+       *       const vec3<type> &E;
+       *   - Two triangle vertices, having different projections:
+       *       const vec3<type> &A, &B;
+       * RETURNS:
+       *   (bool) true if any of axes separates box and triangle.
+       */
+      constexpr bool EdgeSeparates( const vec3<type> &E, const vec3<type> &A, const vec3<type> &B ) const noexcept
+      {
+        const vec3<type> F {Abs(E)};
+
+        return
+          IsSeparatingAxis(E.Z * A.Y - E.Y * A.Z, E.Z * B.Y - E.Y * B.Z, F.Z * H.Y + F.Y * H.Z) ||
+          IsSeparatingAxis(E.X * A.Z - E.Z * A.X, E.X * B.Z - E.Z * B.X, F.Z * H.X + F.X * H.Z) ||
+          IsSeparatingAxis(E.Y * A.X - E.X * A.Y, E.Y * B.X - E.X * B.Y, F.Y * H.X + F.X * H.Y);
+      } /* End of 'EdgeSeparates' function */
+
+      /* Axes group separation check function.
+       * ARGUMENTS:
+       *   - Axes group:
+       *       axes_group Group;
+       * RETURNS:
+       *   (bool) true if any of group axes separates box and triangle.
+       */
+      constexpr bool Separates( axes_group Group ) const noexcept
+      {
+        switch (Group)
+        {
+        case axes_group::eEdges:
+          return EdgeSeparates(E0, V0, V2) || EdgeSeparates(E1, V0, V1) || EdgeSeparates(E2, V0, V1);
+        case axes_group::eBox:
+          /* Triangle bounding box against box */
+          return
+            std::min({V0.X, V1.X, V2.X}) > H.X || std::max({V0.X, V1.X, V2.X}) < -H.X ||
+            std::min({V0.Y, V1.Y, V2.Y}) > H.Y || std::max({V0.Y, V1.Y, V2.Y}) < -H.Y ||
+            std::min({V0.Z, V1.Z, V2.Z}) > H.Z || std::max({V0.Z, V1.Z, V2.Z}) < -H.Z;
+        default:
+          {
+            const vec3<type> N {Cross(E0, E1)};
+
+            return Abs(Dot(N, V0)) > Dot(Abs(N), H);
+          }
+        }
+      } /* End of 'Separates' function */
+    }; /* end of 'box_triangle_axes' structure */
+
+  /* Box-triangle overlap test function (scalar reference).
+   * Separating axis test by Tomas Akenine-Moller: 9 edge cross products,
+   * 3 box face normals and triangle plane are checked in this order.
+   * Touching counts as overlapping.
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<type> &Box;
+   *   - Triangle:
+   *       const triangle<type> &Tri;
+   * RETURNS:
+   *   (bool) true if box and triangle overlap.
+   */
+  template<std::floating_point type>
+    constexpr bool BoxTriangleOverlapTest( const aabb<type> &Box, const triangle<type> &Tri ) noexcept
+    {
+      const box_triangle_axes<type> Axes {Box, Tri};
+
+      return !Axes.Separates(axes_group::eEdges) && !Axes.Separates(axes_group::eBox) && !Axes.Separates(axes_group::ePlane);
+    } /* End of 'BoxTriangleOverlapTest' function */
+
+  /* All separating axes groups of box and triangle getting function (used to gather statistics).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<type> &Box;
+   *   - Triangle:
+   *       const triangle<type> &Tri;
+   * RETURNS:
+   *   (uint32_t) Separating groups mask, bit (1 << axes_group) is set if group separates.
+   */
+  template<std::floating_point type>
+    constexpr uint32_t BoxTriangleSeparatingGroups( const aabb<type> &Box, const triangle<type> &Tri ) noexcept
+    {
+      const box_triangle_axes<type> Axes {Box, Tri};
+      uint32_t Groups {0};
+
+      for (size_t i {0}; i < (size_t)axes_group::_LastValue; i++)
+        if (Axes.Separates((axes_group)i))
+          Groups |= 1u << i;
+      return Groups;
+    } /* End of 'BoxTriangleSeparatingGroups' function */
+
+  /* Box-triangle relation enumerable */
+  enum class overlap_class
+  {
+    eOutside,   // Box and triangle do not overlap
+    eContained, // Triangle lies entirely inside box (touching its faces counts as inside)
+    eStraddles, // Triangle crosses box boundary
+
+    _LastValue
+  }; /* end of 'overlap_class' enumerable */
+
+  /* Box-triangle classification function (scalar reference).
+   * Triangle is contained iff all its vertices are inside the box. Such a triangle
+   * always overlaps, so separating axes are tested only for the rest.
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<type> &Box;
+   *   - Triangle:
+   *       const triangle<type> &Tri;
+   * RETURNS:
+   *   (overlap_class) Relation of triangle to box.
+   */
+  template<std::floating_point type>
+    constexpr overlap_class BoxTriangleClassify( const aabb<type> &Box, const triangle<type> &Tri ) noexcept
+    {
+      const vec3<type> &H {Box.HalfSize};
+      const vec3<type>
+        A0 {Abs(Tri.V0 - Box.Center)},
+        A1 {Abs(Tri.V1 - Box.Center)},
+        A2 {Abs(Tri.V2 - Box.Center)};
+
+      if (std::max({A0.X, A1.X, A2.X}) <= H.X &&
+          std::max({A0.Y, A1.Y, A2.Y}) <= H.Y &&
+          std::max({A0.Z, A1.Z, A2.Z}) <= H.Z)
+        return overlap_class::eContained;
+      return BoxTriangleOverlapTest(Box, Tri) ? overlap_class::eStraddles : overlap_class::eOutside;
+    } /* End of 'BoxTriangleClassify' function */
+
+  /* Triangles set stored as structure of arrays, non-owning view */
+  template<std::floating_point type>
+    struct triangles_soa_view
+    {
+      std::array<const type *, 3> X {}, Y {}, Z {}; // Vertices coordinates arrays, e.g. X[1][k] is X of k-th triangle second vertex
+      size_t Count {0};                             // Triangles count
+
+      /* Triangle getting function.
+       * ARGUMENTS:
+       *   - Triangle index:
+       *       size_t Index;
+       * RETURNS:
+       *   (triangle<type>) Triangle.
+       */
+      constexpr triangle<type> operator[]( size_t Index ) const noexcept
+      {
+        return
+        {
+          {X[0][Index], Y[0][Index], Z[0][Index]},
+          {X[1][Index], Y[1][Index], Z[1][Index]},
+          {X[2][Index], Y[2][Index], Z[2][Index]},
+        };
+      } /* End of 'operator[]' function */
+    }; /* end of 'triangles_soa_view' structure */
+
+  /* Equally sized boxes set, stored as structure of arrays of centers, non-owning view */
+  template<std::floating_point type>
+    struct box_centers_soa_view
+    {
+      const type *X {}, *Y {}, *Z {}; // Centers coordinates arrays
+      size_t Count {0};               // Boxes count
+    }; /* end of 'box_centers_soa_view' structure */
+
+  /* Triangle, prepared for testing against many boxes of the same size.
+   * Every separating axis is reduced to a box center projection interval: axis
+   * separates box and triangle iff projection of the center falls outside [Lo, Hi]. */
+  template<std::floating_point type>
+    struct triangle_boxes_setup
+    {
+      /* Separating axis projection interval */
+      struct interval
+      {
+        type Lo {}, Hi {}; // Bounds
+      }; /* end of 'interval' structure */
+
+      std::array<vec3<type>, 3> Edges {};                 // Triangle edges
+      std::array<std::array<interval, 3>, 3> EdgeAxes {}; // Edge cross products with X, Y, Z axes intervals, [edge][axis]
+      std::array<interval, 3> BoxAxes {};                 // Box face normals intervals
+      vec3<type> Normal {};                               // Triangle plane normal
+      interval Plane {};                                  // Triangle plane interval
+
+      /* Default constructor */
+      constexpr triangle_boxes_setup( void ) noexcept = default;
+
+      /* Constructor from triangle and boxes half size.
+       * ARGUMENTS:
+       *   - Triangle:
+       *       const triangle<type> &Tri;
+       *   - Boxes half size:
+       *       const vec3<type> &H;
+       */
+      constexpr triangle_boxes_setup( const triangle<type> &Tri, const vec3<type> &H ) noexcept :
+        Edges {Tri.V1 - Tri.V0, Tri.V2 - Tri.V1, Tri.V0 - Tri.V2},
+        Normal {Cross(Tri.V1 - Tri.V0, Tri.V2 - Tri.V1)}
+      {
+        /* Interval from vertices projections and box radius */
+        const auto MakeInterval {[]( type P0, type P1, type P2, type Rad ) -> interval
+          {
+            return {std::min({P0, P1, P2}) - Rad, std::max({P0, P1, P2}) + Rad};
+          }};
+
+        for (size_t i {0}; i < 3; i++)
+        {
+          const vec3<type> &E {Edges[i]};
+          const vec3<type> F {Abs(E)};
+
+          EdgeAxes[i][0] = MakeInterval(
+            E.Z * Tri.V0.Y - E.Y * Tri.V0.Z, E.Z * Tri.V1.Y - E.Y * Tri.V1.Z, E.Z * Tri.V2.Y - E.Y * Tri.V2.Z,
+            F.Z * H.Y + F.Y * H.Z);
+          EdgeAxes[i][1] = MakeInterval(
+            E.X * Tri.V0.Z - E.Z * Tri.V0.X, E.X * Tri.V1.Z - E.Z * Tri.V1.X, E.X * Tri.V2.Z - E.Z * Tri.V2.X,
+            F.Z * H.X + F.X * H.Z);
+          EdgeAxes[i][2] = MakeInterval(
+            E.Y * Tri.V0.X - E.X * Tri.V0.Y, E.Y * Tri.V1.X - E.X * Tri.V1.Y, E.Y * Tri.V2.X - E.X * Tri.V2.Y,
+            F.Y * H.X + F.X * H.Y);
+        }
+
+        BoxAxes[0] = MakeInterval(Tri.V0.X, Tri.V1.X, Tri.V2.X, H.X);
+        BoxAxes[1] = MakeInterval(Tri.V0.Y, Tri.V1.Y, Tri.V2.Y, H.Y);
+        BoxAxes[2] = MakeInterval(Tri.V0.Z, Tri.V1.Z, Tri.V2.Z, H.Z);
+
+        const type D {Dot(Normal, Tri.V0)}, Rad {Dot(Abs(Normal), H)};
+
+        Plane = {D - Rad, D + Rad};
+      } /* End of constructor */
+
+      /* Single box overlap test function (scalar).
+       * ARGUMENTS:
+       *   - Box center:
+       *       const vec3<type> &C;
+       * RETURNS:
+       *   (bool) true if box overlaps triangle.
+       */
+      constexpr bool Test( const vec3<type> &C ) const noexcept
+      {
+        const auto IsInside {[]( type P, const interval &I ) -> bool
+          {
+            return P >= I.Lo && P <= I.Hi;
+          }};
+
+        if (!IsInside(Dot(Normal, C), Plane))
+          return false;
+
+        for (size_t i {0}; i < 3; i++)
+        {
+          const vec3<type> &E {Edges[i]};
+
+          if (!IsInside(E.Z * C.Y - E.Y * C.Z, EdgeAxes[i][0]) ||
+              !IsInside(E.X * C.Z - E.Z * C.X, EdgeAxes[i][1]) ||
+              !IsInside(E.Y * C.X - E.X * C.Y, EdgeAxes[i][2]))
+            return false;
+        }
+
+        return IsInside(C.X, BoxAxes[0]) && IsInside(C.Y, BoxAxes[1]) && IsInside(C.Z, BoxAxes[2]);
+      } /* End of 'Test' function */
+    }; /* end of 'triangle_boxes_setup' structure */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_base_hpp__ */
+
+/* END OF 'overlap_base.hpp' FILE */
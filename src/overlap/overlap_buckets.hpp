@@ -0,0 +1,369 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_buckets.hpp" - Triangles classification by shape and bucketed triangles storage */
+
+#ifndef __overlap_buckets_hpp__
+#define __overlap_buckets_hpp__
+
+#include <vector>
+
+#include "overlap_base.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Triangle shape kind enumerable, selects reduced separating axes set */
+  enum class triangle_kind
+  {
+    eGeneral,  // 13 axes
+    eAlignedX, // Lies in X = const plane: 3 box axes and 3 in-plane edge normals
+    eAlignedY, // Lies in Y = const plane
+    eAlignedZ, // Lies in Z = const plane
+    eSegment,  // Zero area, not a point: 3 box axes and 3 segment cross box axes
+    ePoint,    // All vertices coincide: 3 box axes
+
+    _LastValue
+  }; /* end of 'triangle_kind' enumerable */
+
+  /* Triangle shape classification function.
+   * Only exact cases are detected, so reduced tests are equivalent to the full one.
+   * ARGUMENTS:
+   *   - Triangle:
+   *       const triangle<float> &Tri;
+   * RETURNS:
+   *   (triangle_kind) Shape kind.
+   */
+  constexpr triangle_kind ClassifyTriangle( const triangle<float> &Tri ) noexcept
+  {
+    if (Tri.V0 == Tri.V1 && Tri.V1 == Tri.V2)
+      return triangle_kind::ePoint;
+    if (Cross(Tri.V1 - Tri.V0, Tri.V2 - Tri.V1) == vec3<float> {})
+      return triangle_kind::eSegment;
+    if (Tri.V0.X == Tri.V1.X && Tri.V1.X == Tri.V2.X)
+      return triangle_kind::eAlignedX;
+    if (Tri.V0.Y == Tri.V1.Y && Tri.V1.Y == Tri.V2.Y)
+      return triangle_kind::eAlignedY;
+    if (Tri.V0.Z == Tri.V1.Z && Tri.V1.Z == Tri.V2.Z)
+      return triangle_kind::eAlignedZ;
+    return triangle_kind::eGeneral;
+  } /* End of 'ClassifyTriangle' function */
+
+  /* Vector components in axis aligned plane coordinates getting function.
+   * Plane axis W is the constant one, U and V follow it cyclically (e.g. Y, Z for X = const).
+   * ARGUMENTS:
+   *   - Vector:
+   *       const vec3<float> &P;
+   *   - Plane axis (0 - X, 1 - Y, 2 - Z):
+   *       size_t Axis;
+   * RETURNS:
+   *   (vec3<float>) Vector as (U, V, W).
+   */
+  constexpr vec3<float> ToPlaneAxes( const vec3<float> &P, size_t Axis ) noexcept
+  {
+    switch (Axis)
+    {
+    case 0:
+      return {P.Y, P.Z, P.X};
+    case 1:
+      return {P.Z, P.X, P.Y};
+    default:
+      return P;
+    }
+  } /* End of 'ToPlaneAxes' function */
+
+  /* Box against axis aligned triangle overlap test function (scalar).
+   * ARGUMENTS:
+   *   - Box, in plane coordinates (see 'ToPlaneAxes'):
+   *       const aabb<float> &Box;
+   *   - Vertices U and V coordinates and common W one:
+   *       const std::array<float, 3> &U, &V;
+   *       float W;
+   * RETURNS:
+   *   (bool) true if box and triangle overlap.
+   */
+  constexpr bool BoxAlignedTriangleOverlapTest( const aabb<float> &Box, const std::array<float, 3> &U, const std::array<float, 3> &V, float W ) noexcept
+  {
+    const vec3<float> &C {Box.Center}, &H {Box.HalfSize};
+    const std::array<float, 3>
+      Us {U[0] - C.X, U[1] - C.X, U[2] - C.X},
+      Vs {V[0] - C.Y, V[1] - C.Y, V[2] - C.Y};
+
+    /* Box face normals, plane one coincides with triangle normal */
+    if (Abs(W - C.Z) > H.Z ||
+        std::min({Us[0], Us[1], Us[2]}) > H.X || std::max({Us[0], Us[1], Us[2]}) < -H.X ||
+        std::min({Vs[0], Vs[1], Vs[2]}) > H.Y || std::max({Vs[0], Vs[1], Vs[2]}) < -H.Y)
+      return false;
+
+    /* In-plane edge normals, the rest edge cross products duplicate W axis */
+    for (size_t i {0}; i < 3; i++)
+    {
+      const size_t j {(i + 1) % 3}, k {(i + 2) % 3};
+      const float EU {Us[j] - Us[i]}, EV {Vs[j] - Vs[i]};
+
+      if (IsSeparatingAxis(EV * Us[i] - EU * Vs[i], EV * Us[k] - EU * Vs[k], Abs(EV) * H.X + Abs(EU) * H.Y))
+        return false;
+    }
+    return true;
+  } /* End of 'BoxAlignedTriangleOverlapTest' function */
+
+  /* Box against segment overlap test function (scalar).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Segment ends:
+   *       const vec3<float> &A, &B;
+   * RETURNS:
+   *   (bool) true if box and segment overlap.
+   */
+  constexpr bool BoxSegmentOverlapTest( const aabb<float> &Box, const vec3<float> &A, const vec3<float> &B ) noexcept
+  {
+    const vec3<float> &H {Box.HalfSize};
+    const vec3<float> P {A - Box.Center}, Q {B - Box.Center}, D {Q - P}, F {Abs(D)};
+
+    if (std::min(P.X, Q.X) > H.X || std::max(P.X, Q.X) < -H.X ||
+        std::min(P.Y, Q.Y) > H.Y || std::max(P.Y, Q.Y) < -H.Y ||
+        std::min(P.Z, Q.Z) > H.Z || std::max(P.Z, Q.Z) < -H.Z)
+      return false;
+
+    /* Segment direction cross box axes, both ends project to the same point */
+    return
+      Abs(D.Z * P.Y - D.Y * P.Z) <= F.Z * H.Y + F.Y * H.Z &&
+      Abs(D.X * P.Z - D.Z * P.X) <= F.Z * H.X + F.X * H.Z &&
+      Abs(D.Y * P.X - D.X * P.Y) <= F.Y * H.X + F.X * H.Y;
+  } /* End of 'BoxSegmentOverlapTest' function */
+
+  /* Box against point overlap test function (scalar).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Point:
+   *       const vec3<float> &P;
+   * RETURNS:
+   *   (bool) true if point is inside box.
+   */
+  constexpr bool BoxPointOverlapTest( const aabb<float> &Box, const vec3<float> &P ) noexcept
+  {
+    const vec3<float> D {Abs(P - Box.Center)};
+
+    return D.X <= Box.HalfSize.X && D.Y <= Box.HalfSize.Y && D.Z <= Box.HalfSize.Z;
+  } /* End of 'BoxPointOverlapTest' function */
+
+  /* Single kind triangles bucket, non-owning view. Streams meaning depends on kind:
+   *   - eGeneral: vertices coordinates, [vertex * 3 + component];
+   *   - eAligned*: U of vertices, V of vertices, then W (see 'ToPlaneAxes');
+   *   - eSegment: first end X, Y, Z, then second end X, Y, Z;
+   *   - ePoint: X, Y, Z. */
+  struct triangles_bucket_view
+  {
+    std::array<const float *, 9> Streams {}; // Coordinates streams
+    const uint32_t *Ids {};                  // Original triangles indices
+    size_t Count {0};                        // Triangles count
+  }; /* end of 'triangles_bucket_view' structure */
+
+  /* Triangles set, bucketed by kind, non-owning view */
+  struct bucketed_triangles_view
+  {
+    std::array<triangles_bucket_view, (size_t)triangle_kind::_LastValue> Buckets {}; // Buckets, indexed by 'triangle_kind'
+    size_t Count {0};                                                                 // Total triangles count
+  }; /* end of 'bucketed_triangles_view' structure */
+
+  /* Box against bucketed triangle overlap test function (scalar).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Triangles kind:
+   *       triangle_kind Kind;
+   *   - Bucket:
+   *       const triangles_bucket_view &Bucket;
+   *   - Triangle index in bucket:
+   *       size_t Index;
+   * RETURNS:
+   *   (bool) true if box and triangle overlap.
+   */
+  constexpr bool BoxBucketTriangleOverlapTest( const aabb<float> &Box, triangle_kind Kind, const triangles_bucket_view &Bucket, size_t Index ) noexcept
+  {
+    const auto Get {[&]( size_t Stream ) -> float
+      {
+        return Bucket.Streams[Stream][Index];
+      }};
+
+    switch (Kind)
+    {
+    case triangle_kind::eGeneral:
+      return BoxTriangleOverlapTest(Box, triangle<float> {{Get(0), Get(1), Get(2)}, {Get(3), Get(4), Get(5)}, {Get(6), Get(7), Get(8)}});
+    case triangle_kind::eAlignedX:
+    case triangle_kind::eAlignedY:
+    case triangle_kind::eAlignedZ:
+      {
+        const size_t Axis {(size_t)Kind - (size_t)triangle_kind::eAlignedX};
+
+        return BoxAlignedTriangleOverlapTest({ToPlaneAxes(Box.Center, Axis), ToPlaneAxes(Box.HalfSize, Axis)},
+                                             {Get(0), Get(1), Get(2)}, {Get(3), Get(4), Get(5)}, Get(6));
+      }
+    case triangle_kind::eSegment:
+      return BoxSegmentOverlapTest(Box, {Get(0), Get(1), Get(2)}, {Get(3), Get(4), Get(5)});
+    default:
+      return BoxPointOverlapTest(Box, {Get(0), Get(1), Get(2)});
+    }
+  } /* End of 'BoxBucketTriangleOverlapTest' function */
+
+  /* Triangles set, bucketed by kind (owning) */
+  class bucketed_mesh
+  {
+    /* Single bucket storage */
+    struct bucket
+    {
+      std::array<std::vector<float>, 9> Streams {}; // Coordinates streams
+      std::vector<uint32_t> Ids {};                 // Original triangles indices
+
+      /* Triangle adding function.
+       * ARGUMENTS:
+       *   - Values of streams (the rest streams are not used by kind):
+       *       std::initializer_list<float> Values;
+       *   - Original triangle index:
+       *       uint32_t Id;
+       * RETURNS: None.
+       */
+      void Add( std::initializer_list<float> Values, uint32_t Id )
+      {
+        size_t i {0};
+
+        for (float Value : Values)
+          Streams[i++].push_back(Value);
+        Ids.push_back(Id);
+      } /* End of 'Add' function */
+    }; /* end of 'bucket' structure */
+
+    std::array<bucket, (size_t)triangle_kind::_LastValue> Buckets {}; // Buckets, indexed by 'triangle_kind'
+    size_t Count {0};                                                 // Total triangles count
+
+    /* Axis aligned triangle adding function.
+     * ARGUMENTS:
+     *   - Triangle:
+     *       const triangle<float> &Tri;
+     *   - Plane axis:
+     *       size_t Axis;
+     *   - Original triangle index:
+     *       uint32_t Id;
+     * RETURNS: None.
+     */
+    void AddAligned( const triangle<float> &Tri, size_t Axis, uint32_t Id )
+    {
+      const vec3<float> P0 {ToPlaneAxes(Tri.V0, Axis)}, P1 {ToPlaneAxes(Tri.V1, Axis)}, P2 {ToPlaneAxes(Tri.V2, Axis)};
+
+      Buckets[(size_t)triangle_kind::eAlignedX + Axis].Add({P0.X, P1.X, P2.X, P0.Y, P1.Y, P2.Y, P0.Z}, Id);
+    } /* End of 'AddAligned' function */
+
+  public:
+    /* Default constructor */
+    bucketed_mesh( void ) = default;
+
+    /* Constructor from triangles set.
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Tris;
+     */
+    explicit bucketed_mesh( const triangles_soa_view<float> &Tris ) :
+      Count {Tris.Count}
+    {
+      for (size_t t {0}; t < Tris.Count; t++)
+      {
+        const triangle<float> Tri {Tris[t]};
+        const uint32_t Id {(uint32_t)t};
+        const triangle_kind Kind {ClassifyTriangle(Tri)};
+
+        switch (Kind)
+        {
+        case triangle_kind::eGeneral:
+          Buckets[(size_t)triangle_kind::eGeneral].Add(
+            {Tri.V0.X, Tri.V0.Y, Tri.V0.Z, Tri.V1.X, Tri.V1.Y, Tri.V1.Z, Tri.V2.X, Tri.V2.Y, Tri.V2.Z}, Id);
+          break;
+        case triangle_kind::eAlignedX:
+        case triangle_kind::eAlignedY:
+        case triangle_kind::eAlignedZ:
+          AddAligned(Tri, (size_t)Kind - (size_t)triangle_kind::eAlignedX, Id);
+          break;
+        case triangle_kind::eSegment:
+          {
+            /* The longest edge covers all vertices */
+            const std::array<vec3<float>, 3> V {Tri.V0, Tri.V1, Tri.V2};
+            size_t Longest {0};
+            float MaxLength {-1};
+
+            for (size_t i {0}; i < 3; i++)
+              if (const vec3<float> E {V[(i + 1) % 3] - V[i]}; Dot(E, E) > MaxLength)
+                MaxLength = Dot(E, E), Longest = i;
+
+            const vec3<float> &A {V[Longest]}, &B {V[(Longest + 1) % 3]};
+
+            Buckets[(size_t)triangle_kind::eSegment].Add({A.X, A.Y, A.Z, B.X, B.Y, B.Z}, Id);
+          }
+          break;
+        default:
+          Buckets[(size_t)triangle_kind::ePoint].Add({Tri.V0.X, Tri.V0.Y, Tri.V0.Z}, Id);
+          break;
+        }
+      }
+    } /* End of constructor */
+
+    /* Triangles count getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) Triangles count.
+     */
+    size_t GetCount( void ) const noexcept
+    {
+      return Count;
+    } /* End of 'GetCount' function */
+
+    /* Bucket triangles count getting function.
+     * ARGUMENTS:
+     *   - Triangles kind:
+     *       triangle_kind Kind;
+     * RETURNS:
+     *   (size_t) Triangles count.
+     */
+    size_t GetCount( triangle_kind Kind ) const noexcept
+    {
+      return Buckets[(size_t)Kind].Ids.size();
+    } /* End of 'GetCount' function */
+
+    /* View for batch kernels getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bucketed_triangles_view) View.
+     */
+    bucketed_triangles_view GetView( void ) const noexcept
+    {
+      bucketed_triangles_view View {};
+
+      for (size_t k {0}; k < Buckets.size(); k++)
+      {
+        for (size_t i {0}; i < 9; i++)
+          View.Buckets[k].Streams[i] = Buckets[k].Streams[i].data();
+        View.Buckets[k].Ids = Buckets[k].Ids.data();
+        View.Buckets[k].Count = Buckets[k].Ids.size();
+      }
+      View.Count = Count;
+
+      return View;
+    } /* End of 'GetView' function */
+  }; /* end of 'bucketed_mesh' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_buckets_hpp__ */
+
+/* END OF 'overlap_buckets.hpp' FILE */
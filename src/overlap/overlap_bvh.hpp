@@ -0,0 +1,809 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_bvh.hpp" - Binned SAH bounding volume hierarchy over triangles for box range queries */
+
+#ifndef __overlap_bvh_hpp__
+#define __overlap_bvh_hpp__
+
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "../box_triangle_overlap_test.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Bounding volume hierarchy over triangles set, triangles are copied in leaves order */
+  class bvh
+  {
+  public:
+    static constexpr size_t MaxLeafSize {8};     // Maximal leaf triangles count (leaves are tested by one kernel pack)
+    static constexpr size_t BinsCount {16};      // Split candidates bins per axis
+    static constexpr size_t MaxDepth {64};       // Maximal depth, deeper nodes become (large) leaves
+    static constexpr float TraversalCost {1.f};  // SAH node visit cost
+    static constexpr float TriangleCost {0.25f}; // SAH triangle test cost (relative to node visit, lanes of a pack are tested at once)
+    static constexpr float MaxCostGrowth {1.5f}; // Subtree SAH cost growth since its building, after which refit rebuilds it
+
+  private:
+    /* Range split candidate */
+    struct split
+    {
+      bvh_bounds Bounds;         // Range bounds
+      float Cost {0};            // Split SAH cost (infinite if range can not be split by bins)
+      size_t Axis {0}, Bin {0};  // Split plane: triangles in bins below 'Bin' go left
+      vec3<float> Origin, Scale; // Centroid to bin mapping
+    }; /* end of 'split' structure */
+
+    /* Pending range */
+    struct task
+    {
+      size_t Node, First, End, Depth; // Node index, triangles range, node depth
+    }; /* end of 'task' structure */
+
+    /* Triangle build record, records are partitioned in place (so binning reads memory sequentially) */
+    struct prim
+    {
+      bvh_bounds Bounds; // Triangle bounds
+      uint32_t Index;    // Original triangle index
+
+      /* Doubled bounds center getting function.
+       * ARGUMENTS: None.
+       * RETURNS:
+       *   (vec3<float>) Centroid, doubled.
+       */
+      vec3<float> GetCentroid( void ) const noexcept
+      {
+        return Bounds.Min + Bounds.Max;
+      } /* End of 'GetCentroid' function */
+    }; /* end of 'prim' structure */
+
+    /* Build state: triangles records in hierarchy order */
+    using builder = std::vector<prim>;
+
+    aligned_vector<bvh_node> Nodes {}; // Nodes, root is the first one
+    triangle_soa Tris {};              // Triangles in hierarchy order
+    std::vector<uint32_t> Indices {};  // Original index of every triangle in hierarchy order
+    std::vector<float> BuildCosts {};  // Subtree SAH cost of every node (relative to its area) at the time it was built
+
+    /* Range split finding function (binned SAH over centroids on all axes).
+     * ARGUMENTS:
+     *   - Build state:
+     *       const builder &Build;
+     *   - Triangles range:
+     *       size_t First, End;
+     *   - Threads count for binning:
+     *       size_t ThreadsCount;
+     * RETURNS:
+     *   (split) Best split.
+     */
+    static split FindSplit( const builder &Build, size_t First, size_t End, size_t ThreadsCount )
+    {
+      /* Partial bins of one thread */
+      struct bins
+      {
+        bvh_bounds Bounds, Centroids;
+        std::array<std::array<bvh_bounds, BinsCount>, 3> BinBounds;
+        std::array<std::array<size_t, BinsCount>, 3> BinCounts {};
+      };
+
+      const size_t Count {End - First}, Parts {std::clamp<size_t>(Count / (1 << 16), 1, ThreadsCount)};
+      bins Single {};
+      std::vector<bins> Many(Parts > 1 ? Parts : 0);
+      const std::span<bins> Partial {Parts > 1 ? std::span<bins> {Many} : std::span<bins> {&Single, 1}};
+
+      ParallelFor(Count, [&]( size_t Part, size_t PartFirst, size_t PartEnd )
+        {
+          for (size_t i {First + PartFirst}; i < First + PartEnd; i++)
+          {
+            Partial[Part].Bounds.Extend(Build[i].Bounds);
+            Partial[Part].Centroids.Extend(Build[i].GetCentroid());
+          }
+        }, Parts);
+
+      split Split {};
+      bvh_bounds Centroids {};
+
+      for (const bins &Bins : Partial)
+        Split.Bounds.Extend(Bins.Bounds), Centroids.Extend(Bins.Centroids);
+
+      const vec3<float> Extent {Centroids.Max - Centroids.Min};
+      const auto Scaled {[]( float Size ) { return Size > 0 ? BinsCount * 0.999f / Size : 0.f; }};
+
+      Split.Origin = Centroids.Min;
+      Split.Scale = {Scaled(Extent.X), Scaled(Extent.Y), Scaled(Extent.Z)};
+      Split.Cost = std::numeric_limits<float>::infinity();
+
+      ParallelFor(Count, [&]( size_t Part, size_t PartFirst, size_t PartEnd )
+        {
+          bins &Bins {Partial[Part]};
+
+          for (size_t i {First + PartFirst}; i < First + PartEnd; i++)
+          {
+            const vec3<float> Pos {Build[i].GetCentroid() - Split.Origin};
+            const size_t Bin[3] {(size_t)(Pos.X * Split.Scale.X), (size_t)(Pos.Y * Split.Scale.Y), (size_t)(Pos.Z * Split.Scale.Z)};
+
+            for (size_t Axis {0}; Axis < 3; Axis++)
+            {
+              Bins.BinBounds[Axis][Bin[Axis]].Extend(Build[i].Bounds);
+              Bins.BinCounts[Axis][Bin[Axis]]++;
+            }
+          }
+        }, Parts);
+
+      for (size_t Axis {0}; Axis < 3; Axis++)
+      {
+        if ((&Split.Scale.X)[Axis] == 0)
+          continue;
+
+        std::array<bvh_bounds, BinsCount> BinBounds {};
+        std::array<size_t, BinsCount> BinCounts {};
+
+        for (const bins &Bins : Partial)
+          for (size_t b {0}; b < BinsCount; b++)
+            BinBounds[b].Extend(Bins.BinBounds[Axis][b]), BinCounts[b] += Bins.BinCounts[Axis][b];
+
+        /* Right sides costs sweep, then left sides one */
+        std::array<float, BinsCount> RightCost {};
+        bvh_bounds Side {};
+        size_t SideCount {0};
+
+        for (size_t b {BinsCount - 1}; b > 0; b--)
+        {
+          Side.Extend(BinBounds[b]), SideCount += BinCounts[b];
+          RightCost[b] = SideCount != 0 ? Side.GetArea() * (float)SideCount : std::numeric_limits<float>::infinity();
+        }
+        Side = {}, SideCount = 0;
+        for (size_t b {1}; b < BinsCount; b++)
+        {
+          Side.Extend(BinBounds[b - 1]), SideCount += BinCounts[b - 1];
+
+          const float Cost {SideCount != 0 ? Side.GetArea() * (float)SideCount + RightCost[b] : std::numeric_limits<float>::infinity()};
+
+          if (Cost < Split.Cost)
+            Split.Cost = Cost, Split.Axis = Axis, Split.Bin = b;
+        }
+      }
+      Split.Cost = TraversalCost + TriangleCost * Split.Cost / std::max(Split.Bounds.GetArea(), std::numeric_limits<float>::min());
+      return Split;
+    } /* End of 'FindSplit' function */
+
+    /* Node building function: node becomes a leaf or gets two children at the end of nodes array.
+     * ARGUMENTS:
+     *   - Build state:
+     *       builder &Build;
+     *   - Nodes array:
+     *       std::vector<bvh_node> &Nodes;
+     *   - Node and its range:
+     *       const task &Task;
+     *   - Threads count for binning:
+     *       size_t ThreadsCount;
+     * RETURNS:
+     *   (size_t) Left child range end (right one starts there), 0 if node is a leaf.
+     */
+    static size_t SplitNode( builder &Build, std::vector<bvh_node> &Nodes, const task &Task, size_t ThreadsCount )
+    {
+      const size_t Count {Task.End - Task.First};
+      const split Split {FindSplit(Build, Task.First, Task.End, ThreadsCount)};
+      size_t Mid {0};
+
+      if (Count > 1 && Task.Depth + 1 < MaxDepth &&
+          (Count > MaxLeafSize || Split.Cost < TriangleCost * (float)Count))
+      {
+        if (Split.Cost < std::numeric_limits<float>::infinity())
+        {
+          const float Origin {(&Split.Origin.X)[Split.Axis]}, Scale {(&Split.Scale.X)[Split.Axis]};
+
+          Mid = (size_t)(std::partition(Build.begin() + Task.First, Build.begin() + Task.End,
+            [&]( const prim &Prim )
+            {
+              const vec3<float> Centroid {Prim.GetCentroid()};
+
+              return (size_t)(((&Centroid.X)[Split.Axis] - Origin) * Scale) < Split.Bin;
+            }) - Build.begin());
+        }
+        else
+          Mid = Task.First + Count / 2; // All centroids coincide: any halves are equal
+      }
+
+      if (Mid == 0)
+      {
+        Nodes[Task.Node] = {Split.Bounds.Min, (uint32_t)Task.First, Split.Bounds.Max, (uint32_t)Count};
+        return 0;
+      }
+      Nodes[Task.Node] = {Split.Bounds.Min, (uint32_t)Nodes.size(), Split.Bounds.Max, 0};
+      Nodes.resize(Nodes.size() + 2);
+      return Mid;
+    } /* End of 'SplitNode' function */
+
+    /* Subtree building function (one thread).
+     * ARGUMENTS:
+     *   - Build state:
+     *       builder &Build;
+     *   - Subtree range (root node index is ignored, root becomes the first local node):
+     *       const task &Root;
+     * RETURNS:
+     *   (std::vector<bvh_node>) Subtree nodes, child indices are local.
+     */
+    static std::vector<bvh_node> BuildSubtree( builder &Build, const task &Root )
+    {
+      std::vector<bvh_node> Local(1);
+      std::vector<task> Stack {{0, Root.First, Root.End, Root.Depth}};
+
+      while (!Stack.empty())
+      {
+        const task Task {Stack.back()};
+
+        Stack.pop_back();
+        if (const size_t Mid {SplitNode(Build, Local, Task, 1)}; Mid != 0)
+        {
+          const size_t Child {Local[Task.Node].Index};
+
+          Stack.push_back({Child + 1, Mid, Task.End, Task.Depth + 1});
+          Stack.push_back({Child, Task.First, Mid, Task.Depth + 1});
+        }
+      }
+      return Local;
+    } /* End of 'BuildSubtree' function */
+
+    /* Range building function.
+     * Top levels are split one by one with parallel binning, then subtrees below
+     * a size threshold are built as independent tasks by all threads.
+     * ARGUMENTS:
+     *   - Build state (all its records are the range):
+     *       builder &Build;
+     *   - Range root depth:
+     *       size_t Depth;
+     *   - Threads count:
+     *       size_t ThreadsCount;
+     * RETURNS:
+     *   (std::vector<bvh_node>) Range nodes, child and triangle indices are local.
+     */
+    static std::vector<bvh_node> BuildRange( builder &Build, size_t Depth, size_t ThreadsCount )
+    {
+      /* Top levels */
+      const size_t Count {Build.size()}, TaskSize {std::max<size_t>(Count / (ThreadsCount * 8), 1 << 12)};
+      std::vector<bvh_node> Top(1);
+      std::vector<task> Stack {{0, 0, Count, Depth}}, Tasks {};
+
+      while (!Stack.empty())
+      {
+        const task Task {Stack.back()};
+
+        Stack.pop_back();
+        if (Task.End - Task.First <= TaskSize)
+          Tasks.push_back(Task);
+        else if (const size_t Mid {SplitNode(Build, Top, Task, ThreadsCount)}; Mid != 0)
+        {
+          const size_t Child {Top[Task.Node].Index};
+
+          Stack.push_back({Child + 1, Mid, Task.End, Task.Depth + 1});
+          Stack.push_back({Child, Task.First, Mid, Task.Depth + 1});
+        }
+      }
+
+      /* Subtrees, the largest ones are taken first */
+      std::vector<std::vector<bvh_node>> Subtrees(Tasks.size());
+      std::vector<size_t> TasksOrder(Tasks.size());
+      std::atomic<size_t> NextTask {0};
+
+      std::iota(TasksOrder.begin(), TasksOrder.end(), size_t {0});
+      std::sort(TasksOrder.begin(), TasksOrder.end(), [&]( size_t A, size_t B )
+        {
+          return Tasks[A].End - Tasks[A].First > Tasks[B].End - Tasks[B].First;
+        });
+      ParallelFor(ThreadsCount, [&]( size_t, size_t, size_t )
+        {
+          for (size_t t; (t = NextTask.fetch_add(1, std::memory_order_relaxed)) < Tasks.size(); )
+            Subtrees[TasksOrder[t]] = BuildSubtree(Build, Tasks[TasksOrder[t]]);
+        }, std::min(ThreadsCount, std::max<size_t>(Tasks.size(), 1)));
+
+      /* Subtrees are appended in depth first order, their roots replace task nodes */
+      size_t NodesCount {Top.size()};
+      std::vector<bvh_node> Nodes {};
+
+      for (const std::vector<bvh_node> &Subtree : Subtrees)
+        NodesCount += Subtree.size() - 1;
+      Nodes.reserve(NodesCount);
+      Nodes.assign(Top.begin(), Top.end());
+      for (size_t t {0}; t < Tasks.size(); t++)
+      {
+        const std::vector<bvh_node> &Subtree {Subtrees[t]};
+        const uint32_t Base {(uint32_t)Nodes.size() - 1};
+
+        for (size_t i {0}; i < Subtree.size(); i++)
+        {
+          bvh_node Node {Subtree[i]};
+
+          if (Node.Count == 0)
+            Node.Index += Base;
+          if (i == 0)
+            Nodes[Tasks[t].Node] = Node;
+          else
+            Nodes.push_back(Node);
+        }
+      }
+      return Nodes;
+    } /* End of 'BuildRange' function */
+
+    /* Node bounds and subtree SAH cost updating function, node children must be updated before.
+     * ARGUMENTS:
+     *   - Nodes (leaves triangles indices refer to triangles view):
+     *       std::span<bvh_node> Nodes;
+     *   - Subtrees SAH costs (relative to node area):
+     *       std::span<float> Costs;
+     *   - Node index:
+     *       size_t Index;
+     *   - Triangles in hierarchy order:
+     *       const triangles_soa_view<float> &View;
+     * RETURNS: None.
+     */
+    static void UpdateNode( std::span<bvh_node> Nodes, std::span<float> Costs, size_t Index, const triangles_soa_view<float> &View ) noexcept
+    {
+      bvh_node &Node {Nodes[Index]};
+      bvh_bounds Bounds {};
+
+      if (Node.Count != 0)
+      {
+        for (uint32_t i {Node.Index}; i < Node.Index + Node.Count; i++)
+        {
+          const triangle<float> Tri {View[i]};
+
+          Bounds.Extend(Tri.V0), Bounds.Extend(Tri.V1), Bounds.Extend(Tri.V2);
+        }
+        Costs[Index] = TriangleCost * (float)Node.Count;
+      }
+      else
+      {
+        const bvh_bounds Left {Nodes[Node.Index].Min, Nodes[Node.Index].Max}, Right {Nodes[Node.Index + 1].Min, Nodes[Node.Index + 1].Max};
+
+        Bounds = Left, Bounds.Extend(Right);
+        Costs[Index] = TraversalCost + (Left.GetArea() * Costs[Node.Index] + Right.GetArea() * Costs[Node.Index + 1]) /
+          std::max(Bounds.GetArea(), std::numeric_limits<float>::min());
+      }
+      Node.Min = Bounds.Min, Node.Max = Bounds.Max;
+    } /* End of 'UpdateNode' function */
+
+    /* Subtree rebuilding function: subtree triangles are reordered in place (their range stays the same).
+     * ARGUMENTS:
+     *   - Subtree root, its triangles range and depth (root index is ignored):
+     *       const task &Root;
+     *   - Threads count:
+     *       size_t ThreadsCount;
+     *   - Rebuilt subtree nodes (child indices are local, triangles ones are global) and their SAH costs:
+     *       std::vector<bvh_node> &Local;
+     *       std::vector<float> &LocalCosts;
+     * RETURNS: None.
+     */
+    void RebuildSubtree( const task &Root, size_t ThreadsCount, std::vector<bvh_node> &Local, std::vector<float> &LocalCosts )
+    {
+      const size_t Count {Root.End - Root.First};
+      builder Build(Count);
+      std::vector<triangle<float>> Old(Count);
+      const std::vector<uint32_t> OldIndices(Indices.begin() + Root.First, Indices.begin() + Root.End);
+
+      const size_t PartsCount {std::clamp<size_t>(Count / (1 << 16), 1, ThreadsCount)};
+
+      ParallelFor(Count, [&]( size_t, size_t First, size_t End )
+        {
+          for (size_t i {First}; i < End; i++)
+          {
+            Old[i] = Tris[Root.First + i];
+            Build[i].Bounds = {}, Build[i].Index = (uint32_t)i;
+            Build[i].Bounds.Extend(Old[i].V0), Build[i].Bounds.Extend(Old[i].V1), Build[i].Bounds.Extend(Old[i].V2);
+          }
+        }, PartsCount);
+      Local = BuildRange(Build, Root.Depth, ThreadsCount);
+      ParallelFor(Count, [&]( size_t, size_t First, size_t End )
+        {
+          for (size_t i {First}; i < End; i++)
+          {
+            const triangle<float> &Tri {Old[Build[i].Index]};
+
+            Tris.Set(Root.First + i, Tri.V0, Tri.V1, Tri.V2);
+            Indices[Root.First + i] = OldIndices[Build[i].Index];
+          }
+        }, PartsCount);
+      for (bvh_node &Node : Local)
+        if (Node.Count != 0)
+          Node.Index += (uint32_t)Root.First;
+      LocalCosts.resize(Local.size());
+      for (size_t i {Local.size()}; i-- > 0; )
+        UpdateNode(Local, LocalCosts, i, Tris.GetView());
+    } /* End of 'RebuildSubtree' function */
+
+    /* Nodes compacting function: nodes, unreachable after subtrees rebuilding, are removed.
+     * Nodes are laid out depth first (as by building), so children always follow parents.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Compact( void )
+    {
+      aligned_vector<bvh_node> Packed {Nodes[0]};
+      std::vector<float> PackedCosts {BuildCosts[0]};
+      std::vector<std::pair<uint32_t, uint32_t>> Stack {{0, 0}}; // Old and new node indices
+
+      Packed.reserve(Nodes.size());
+      PackedCosts.reserve(Nodes.size());
+      while (!Stack.empty())
+      {
+        const auto [From, To] {Stack.back()};
+
+        Stack.pop_back();
+        if (Nodes[From].Count != 0)
+          continue;
+
+        const uint32_t Child {Nodes[From].Index}, NewChild {(uint32_t)Packed.size()};
+
+        Packed[To].Index = NewChild;
+        for (uint32_t i {0}; i < 2; i++)
+          Packed.push_back(Nodes[Child + i]), PackedCosts.push_back(BuildCosts[Child + i]);
+        Stack.push_back({Child + 1, NewChild + 1});
+        Stack.push_back({Child, NewChild});
+      }
+      Nodes = std::move(Packed);
+      BuildCosts = std::move(PackedCosts);
+    } /* End of 'Compact' function */
+
+  public:
+    /* Default constructor */
+    bvh( void ) = default;
+
+    /* Constructor: hierarchy building (see 'BuildRange').
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Triangles;
+     *   - Threads count (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     */
+    explicit bvh( const triangles_soa_view<float> &Triangles, size_t ThreadsCount = 0 )
+    {
+      if (Triangles.Count > std::numeric_limits<uint32_t>::max())
+        throw std::out_of_range {"Too many triangles for hierarchy"};
+      if (Triangles.Count == 0)
+        return;
+
+      const size_t Count {Triangles.Count};
+      builder Build(Count);
+
+      ThreadsCount = GetThreadsCount(ThreadsCount);
+      ParallelFor(Count, [&]( size_t, size_t First, size_t End )
+        {
+          for (size_t i {First}; i < End; i++)
+          {
+            const triangle<float> Tri {Triangles[i]};
+            prim &Prim {Build[i]};
+
+            Prim.Bounds = {}, Prim.Index = (uint32_t)i;
+            Prim.Bounds.Extend(Tri.V0), Prim.Bounds.Extend(Tri.V1), Prim.Bounds.Extend(Tri.V2);
+          }
+        }, std::clamp<size_t>(Count / (1 << 16), 1, ThreadsCount));
+
+      const std::vector<bvh_node> Built {BuildRange(Build, 0, ThreadsCount)};
+
+      Nodes.assign(Built.begin(), Built.end());
+      Indices.resize(Count);
+      for (size_t i {0}; i < Count; i++)
+        Indices[i] = Build[i].Index;
+      Tris = Permute(Triangles, Indices, ThreadsCount);
+
+      /* Children always follow parents, so reverse order evaluates subtrees bottom-up */
+      BuildCosts.resize(Nodes.size());
+      for (size_t i {Nodes.size()}; i-- > 0; )
+        UpdateNode(Nodes, BuildCosts, i, Tris.GetView());
+    } /* End of constructor */
+
+    /* Nodes getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const bvh_node>) Nodes, root is the first one (empty for empty hierarchy).
+     */
+    std::span<const bvh_node> GetNodes( void ) const noexcept
+    {
+      return Nodes;
+    } /* End of 'GetNodes' function */
+
+    /* Triangles in hierarchy order getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (triangles_soa_view<float>) Triangles view.
+     */
+    triangles_soa_view<float> GetTriangles( void ) const noexcept
+    {
+      return Tris.GetView();
+    } /* End of 'GetTriangles' function */
+
+    /* Original triangles indices getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const uint32_t>) Original index of every triangle in hierarchy order.
+     */
+    std::span<const uint32_t> GetIndices( void ) const noexcept
+    {
+      return Indices;
+    } /* End of 'GetIndices' function */
+
+    /* View for batch kernels getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bvh_view) View.
+     */
+    bvh_view GetView( void ) const noexcept
+    {
+      return {Nodes.data(), Nodes.size(), Tris.GetView()};
+    } /* End of 'GetView' function */
+
+    /* Hierarchy SAH cost getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (float) Expected cost of a query, relative to a node visit.
+     */
+    float GetSahCost( void ) const noexcept
+    {
+      if (Nodes.empty())
+        return 0;
+
+      const float RootArea {std::max(bvh_bounds {Nodes[0].Min, Nodes[0].Max}.GetArea(), std::numeric_limits<float>::min())};
+      float Cost {0};
+
+      for (const bvh_node &Node : Nodes)
+        Cost += bvh_bounds {Node.Min, Node.Max}.GetArea() * (Node.Count == 0 ? TraversalCost : TriangleCost * (float)Node.Count);
+      return Cost / RootArea;
+    } /* End of 'GetSahCost' function */
+
+    /* Refitting function for deformed triangles (triangles count is the same, vertices moved).
+     * Bounds are updated bottom-up: subtrees below a few top levels are refit as independent tasks
+     * by all threads, then top levels are. Subtrees, whose SAH cost grew more than 'CostGrowth' times
+     * since their building, are then rebuilt: if only one child of a degraded node is degraded, the
+     * degradation is local and the child is checked, otherwise the node is rebuilt (so a degraded node,
+     * left by rebuilding its child, is rebuilt by one of later refits). Large subtrees are rebuilt one
+     * by one with all threads, the rest are independent tasks. If it throws (out of memory),
+     * the hierarchy may be left inconsistent and has to be rebuilt.
+     * ARGUMENTS:
+     *   - Deformed triangles in original order:
+     *       const triangles_soa_view<float> &Triangles;
+     *   - Subtree SAH cost growth, triggering its rebuilding (infinity - bounds are refit only):
+     *       float CostGrowth;
+     *   - Threads count (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     * RETURNS:
+     *   (size_t) Rebuilt subtrees triangles count.
+     */
+    size_t Refit( const triangles_soa_view<float> &Triangles, float CostGrowth = MaxCostGrowth, size_t ThreadsCount = 0 )
+    {
+      if (Triangles.Count != Indices.size())
+        throw std::invalid_argument {"Triangles count differs from hierarchy one"};
+      if (Nodes.empty())
+        return 0;
+
+      const size_t Count {Indices.size()};
+
+      ThreadsCount = GetThreadsCount(ThreadsCount);
+      ParallelFor(Count, [&]( size_t, size_t First, size_t End )
+        {
+          for (size_t i {First}; i < End; i++)
+          {
+            const triangle<float> Tri {Triangles[Indices[i]]};
+
+            Tris.Set(i, Tri.V0, Tri.V1, Tri.V2);
+          }
+        }, std::clamp<size_t>(Count / (1 << 16), 1, ThreadsCount));
+
+      /* Top levels are collected breadth first (children follow parents), nodes below them are subtrees roots */
+      const size_t TopDepth {(size_t)std::bit_width(ThreadsCount * 8 - 1)};
+      std::vector<uint32_t> Top {}, Roots {}, Level {0};
+
+      for (size_t Depth {0}; Depth < TopDepth && !Level.empty(); Depth++)
+      {
+        std::vector<uint32_t> Next {};
+
+        for (const uint32_t Index : Level)
+          if (const bvh_node &Node {Nodes[Index]}; Node.Count == 0)
+            Top.push_back(Index), Next.push_back(Node.Index), Next.push_back(Node.Index + 1);
+          else
+            Roots.push_back(Index);
+        Level = std::move(Next);
+      }
+      Roots.insert(Roots.end(), Level.begin(), Level.end());
+
+      const triangles_soa_view<float> View {Tris.GetView()};
+      std::vector<float> Costs(Nodes.size());
+      std::atomic<size_t> NextRoot {0};
+
+      ParallelFor(ThreadsCount, [&]( size_t, size_t, size_t )
+        {
+          std::vector<uint32_t> Order {};
+
+          for (size_t r; (r = NextRoot.fetch_add(1, std::memory_order_relaxed)) < Roots.size(); )
+          {
+            Order.assign(1, Roots[r]);
+            for (size_t i {0}; i < Order.size(); i++)
+              if (const bvh_node &Node {Nodes[Order[i]]}; Node.Count == 0)
+                Order.push_back(Node.Index), Order.push_back(Node.Index + 1);
+            for (size_t i {Order.size()}; i-- > 0; )
+              UpdateNode(Nodes, Costs, Order[i], View);
+          }
+        }, std::min(ThreadsCount, Roots.size()));
+      for (size_t i {Top.size()}; i-- > 0; )
+        UpdateNode(Nodes, Costs, Top[i], View);
+
+      if (!(CostGrowth < std::numeric_limits<float>::infinity()))
+        return 0;
+
+      /* Degraded subtrees search */
+      const auto IsDegraded {[&]( size_t Index ) { return Costs[Index] > CostGrowth * BuildCosts[Index]; }};
+      std::vector<task> Stack {{0, 0, Count, 0}}, Rebuilds {};
+
+      while (!Stack.empty())
+      {
+        const task Task {Stack.back()};
+        const bvh_node &Node {Nodes[Task.Node]};
+
+        Stack.pop_back();
+        if (!IsDegraded(Task.Node))
+          continue;
+        if (Node.Count == 0 && IsDegraded(Node.Index) != IsDegraded(Node.Index + 1))
+        {
+          /* Children ranges are split at the end of the rightmost leaf of the left one */
+          size_t Last {Node.Index};
+
+          while (Nodes[Last].Count == 0)
+            Last = Nodes[Last].Index + 1;
+
+          const size_t Mid {Nodes[Last].Index + Nodes[Last].Count};
+
+          if (IsDegraded(Node.Index))
+            Stack.push_back({Node.Index, Task.First, Mid, Task.Depth + 1});
+          else
+            Stack.push_back({Node.Index + 1, Mid, Task.End, Task.Depth + 1});
+        }
+        else
+          Rebuilds.push_back(Task);
+      }
+      if (Rebuilds.empty())
+        return 0;
+
+      /* Subtrees rebuilding, the largest ones are taken first */
+      const size_t TaskSize {std::max<size_t>(Count / (ThreadsCount * 8), 1 << 12)};
+      std::vector<std::vector<bvh_node>> Subtrees(Rebuilds.size());
+      std::vector<std::vector<float>> SubtreesCosts(Rebuilds.size());
+      size_t Large {0}, Rebuilt {0};
+
+      std::sort(Rebuilds.begin(), Rebuilds.end(), []( const task &A, const task &B )
+        {
+          return A.End - A.First > B.End - B.First;
+        });
+      for (; Large < Rebuilds.size() && Rebuilds[Large].End - Rebuilds[Large].First > TaskSize; Large++)
+        RebuildSubtree(Rebuilds[Large], ThreadsCount, Subtrees[Large], SubtreesCosts[Large]);
+
+      std::atomic<size_t> NextTask {Large};
+
+      ParallelFor(ThreadsCount, [&]( size_t, size_t, size_t )
+        {
+          for (size_t t; (t = NextTask.fetch_add(1, std::memory_order_relaxed)) < Rebuilds.size(); )
+            RebuildSubtree(Rebuilds[t], 1, Subtrees[t], SubtreesCosts[t]);
+        }, std::clamp<size_t>(Rebuilds.size() - Large, 1, ThreadsCount));
+
+      /* Rebuilt subtrees are appended, their roots replace old ones, old nodes are dropped by compacting */
+      for (size_t t {0}; t < Rebuilds.size(); t++)
+      {
+        const uint32_t Base {(uint32_t)Nodes.size() - 1};
+
+        for (size_t i {0}; i < Subtrees[t].size(); i++)
+        {
+          bvh_node Node {Subtrees[t][i]};
+
+          if (Node.Count == 0)
+            Node.Index += Base;
+          if (i == 0)
+            Nodes[Rebuilds[t].Node] = Node, BuildCosts[Rebuilds[t].Node] = SubtreesCosts[t][0];
+          else
+            Nodes.push_back(Node), BuildCosts.push_back(SubtreesCosts[t][i]);
+        }
+        Rebuilt += Rebuilds[t].End - Rebuilds[t].First;
+      }
+      Compact();
+      return Rebuilt;
+    } /* End of 'Refit' function */
+
+    /* Box query function: nodes are culled by bounds, leaves triangles go to the batch SAT kernel.
+     * ARGUMENTS:
+     *   - Box:
+     *       const aabb<float> &Box;
+     *   - Overlapping triangles sink, called as Sink(OriginalIndex) (in no particular order):
+     *       sink &&Sink;
+     * RETURNS: None.
+     */
+    template<class sink>
+      void Query( const aabb<float> &Box, sink &&Sink ) const
+      {
+        if (Nodes.empty())
+          return;
+
+        const bvh_query_bounds Query {Box};
+        const triangles_soa_view<float> View {Tris.GetView()};
+        uint32_t Stack[MaxDepth + 1], Hits[MaxLeafSize];
+        size_t Top {0};
+
+        if (!Query.Overlaps(Nodes[0].Min, Nodes[0].Max))
+          return;
+        Stack[Top++] = 0;
+        while (Top > 0)
+        {
+          const bvh_node &Node {Nodes[Stack[--Top]]};
+
+          if (Node.Count == 0)
+          {
+            for (uint32_t Child {Node.Index}; Child < Node.Index + 2; Child++)
+              if (Query.Overlaps(Nodes[Child].Min, Nodes[Child].Max))
+                Stack[Top++] = Child;
+            continue;
+          }
+          if (Query.Contains(Node.Min, Node.Max))
+          {
+            for (uint32_t i {Node.Index}; i < Node.Index + Node.Count; i++)
+              Sink(Indices[i]);
+            continue;
+          }
+          for (uint32_t First {Node.Index}; First < Node.Index + Node.Count; First += MaxLeafSize)
+          {
+            const size_t Count {std::min<size_t>(Node.Index + Node.Count - First, MaxLeafSize)};
+            const triangles_soa_view<float> Leaf
+            {
+              {View.X[0] + First, View.X[1] + First, View.X[2] + First},
+              {View.Y[0] + First, View.Y[1] + First, View.Y[2] + First},
+              {View.Z[0] + First, View.Z[1] + First, View.Z[2] + First},
+              Count,
+            };
+            const size_t HitsCount {BoxTrianglesOverlapTest(Box, Leaf, std::span<uint32_t> {Hits}, First)};
+
+            for (size_t i {0}; i < HitsCount; i++)
+              Sink(Indices[Hits[i]]);
+          }
+        }
+      } /* End of 'Query' function */
+
+    /* Boxes batch query function (best instruction set).
+     * Boxes traverse hierarchy in packets of 'bvh_view::PacketSize' with active boxes mask per node,
+     * so every node is loaded once per packet instead of once per box, and leaf triangles are tested
+     * against all active boxes of the packet at once. Nodes are shared only by close boxes, so
+     * consecutive boxes of the batch should be spatially coherent (e.g. sorted along a space filling curve).
+     * ARGUMENTS:
+     *   - Boxes:
+     *       std::span<const aabb<float>> Boxes;
+     *   - Overlapping pairs sink, called as Sink(BoxIndex, OriginalIndex) (in no particular order):
+     *       sink &&Sink;
+     * RETURNS: None.
+     */
+    template<class sink>
+      void Query( std::span<const aabb<float>> Boxes, sink &&Sink ) const
+      {
+        auto Receive {[&]( std::span<const bvh_pair> Pairs )
+          {
+            for (const bvh_pair &Pair : Pairs)
+              Sink(Pair.Box, Indices[Pair.Triangle]);
+          }};
+
+        BoxesBvhTrianglesQuery(Boxes, GetView(),
+          []( void *Context, std::span<const bvh_pair> Pairs ) { (*static_cast<decltype(Receive) *>(Context))(Pairs); }, &Receive);
+      } /* End of 'Query' function */
+  }; /* end of 'bvh' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_bvh_hpp__ */
+
+/* END OF 'overlap_bvh.hpp' FILE */
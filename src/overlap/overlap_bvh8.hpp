@@ -0,0 +1,426 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_bvh8.hpp" - 8-ary bounding volume hierarchies (plain and quantized), collapsed from the binary one, with prepared triangles leaves */
+
+#ifndef __overlap_bvh8_hpp__
+#define __overlap_bvh8_hpp__
+
+#include "overlap_bvh.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* 8-ary bounding volume hierarchy over triangles set.
+   * Every node holds bounds of up to 8 children, so a query tests them by one vector comparisons
+   * sequence instead of descending 3 binary levels; leaves keep up to 8 prepared triangles
+   * (see 'prepared_mesh') in contiguous blocks, which are tested by one kernel pack */
+  class bvh8
+  {
+    static_assert(bvh::MaxLeafSize <= bvh8_node::Width);
+    static_assert(bvh::MaxDepth <= bvh8_view::MaxDepth);
+
+    /* Pending binary node */
+    struct task
+    {
+      uint32_t Source; // Binary node index
+      size_t Node;     // Wide node index, built from binary node children
+    }; /* end of 'task' structure */
+
+    /* Node without children */
+    static constexpr bvh8_node EmptyNode {[]
+      {
+        bvh8_node Node {};
+
+        for (size_t Axis {0}; Axis < 3; Axis++)
+          Node.Min[Axis].fill(std::numeric_limits<float>::infinity()), Node.Max[Axis].fill(-std::numeric_limits<float>::infinity());
+        return Node;
+      }()};
+
+    aligned_vector<bvh8_node> Nodes {}; // Nodes, root is the first one
+    std::vector<bvh_range> Subtrees {}; // Triangles range of every node subtree
+    aligned_vector<float> Leaves {};    // Leaves prepared triangles blocks (see 'bvh8_view')
+    std::vector<uint32_t> Indices {};   // Original index of every triangle in hierarchy order
+
+  public:
+    /* Default constructor */
+    bvh8( void ) = default;
+
+    /* Constructor: binary hierarchy building and collapsing.
+     * Every wide node takes children of a binary node, then repeatedly replaces its inner
+     * child with the largest surface area by that child's children, while slots remain.
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Triangles;
+     *   - Threads count for binary hierarchy building (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     */
+    explicit bvh8( const triangles_soa_view<float> &Triangles, size_t ThreadsCount = 0 )
+    {
+      const bvh Binary {Triangles, ThreadsCount};
+      const std::span<const bvh_node> Source {Binary.GetNodes()};
+
+      if (Source.empty())
+        return;
+
+      Indices.assign(Binary.GetIndices().begin(), Binary.GetIndices().end());
+
+      /* Leaves blocks */
+      const triangles_soa_view<float> Sorted {Binary.GetTriangles()};
+
+      Leaves.resize(Sorted.Count * prepared_mesh::StreamsCount + prepared_mesh::Padding);
+      std::fill(Leaves.end() - prepared_mesh::Padding, Leaves.end(), 0.f);
+      ParallelFor(Source.size(), [&]( size_t, size_t First, size_t End )
+        {
+          for (size_t n {First}; n < End; n++)
+            for (uint32_t i {0}; i < Source[n].Count; i++)
+              prepared_mesh::PrepareTriangle(Sorted[Source[n].Index + i],
+                Leaves.data() + (size_t)Source[n].Index * prepared_mesh::StreamsCount + i, Source[n].Count);
+        }, GetThreadsCount(ThreadsCount));
+
+      /* Binary subtrees ranges, children always follow their parents */
+      std::vector<bvh_range> Ranges(Source.size());
+
+      for (size_t n {Source.size()}; n-- > 0; )
+        if (Source[n].Count != 0)
+          Ranges[n] = {Source[n].Index, Source[n].Count};
+        else
+          Ranges[n] = {Ranges[Source[n].Index].First, Ranges[Source[n].Index].Count + Ranges[Source[n].Index + 1].Count};
+
+      /* Nodes */
+      Nodes.reserve(Source.size() / (bvh8_node::Width - 1) + 1);
+      Nodes.push_back(EmptyNode);
+      Subtrees.push_back({});
+
+      std::vector<task> Stack {{0, 0}};
+
+      while (!Stack.empty())
+      {
+        const task Task {Stack.back()};
+        std::array<uint32_t, bvh8_node::Width> Children {};
+        size_t Count {0};
+
+        Stack.pop_back();
+        if (Source[Task.Source].Count != 0)
+          Children[Count++] = Task.Source; // Leaf root
+        else
+          Children[Count++] = Source[Task.Source].Index, Children[Count++] = Source[Task.Source].Index + 1;
+
+        while (Count < bvh8_node::Width)
+        {
+          size_t Best {Count};
+          float BestArea {-1};
+
+          for (size_t i {0}; i < Count; i++)
+            if (const bvh_node &Child {Source[Children[i]]}; Child.Count == 0)
+              if (const float Area {bvh_bounds {Child.Min, Child.Max}.GetArea()}; Area > BestArea)
+                Best = i, BestArea = Area;
+          if (Best == Count)
+            break;
+
+          const uint32_t Opened {Source[Children[Best]].Index};
+
+          Children[Best] = Opened, Children[Count++] = Opened + 1;
+        }
+
+        bvh8_node Node {EmptyNode};
+
+        for (size_t Slot {0}; Slot < Count; Slot++)
+        {
+          const bvh_node &Child {Source[Children[Slot]]};
+
+          Node.Min[0][Slot] = Child.Min.X, Node.Min[1][Slot] = Child.Min.Y, Node.Min[2][Slot] = Child.Min.Z;
+          Node.Max[0][Slot] = Child.Max.X, Node.Max[1][Slot] = Child.Max.Y, Node.Max[2][Slot] = Child.Max.Z;
+          Node.Count[Slot] = Child.Count;
+          if (Child.Count != 0)
+            Node.Child[Slot] = Child.Index;
+          else
+          {
+            Node.Child[Slot] = (uint32_t)Nodes.size();
+            Stack.push_back({Children[Slot], Nodes.size()});
+            Nodes.push_back(EmptyNode);
+            Subtrees.push_back({});
+          }
+        }
+        Nodes[Task.Node] = Node;
+        Subtrees[Task.Node] = Ranges[Task.Source];
+      }
+    } /* End of constructor */
+
+    /* Nodes getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const bvh8_node>) Nodes, root is the first one (empty for empty hierarchy).
+     */
+    std::span<const bvh8_node> GetNodes( void ) const noexcept
+    {
+      return Nodes;
+    } /* End of 'GetNodes' function */
+
+    /* Original triangles indices getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const uint32_t>) Original index of every triangle in hierarchy order.
+     */
+    std::span<const uint32_t> GetIndices( void ) const noexcept
+    {
+      return Indices;
+    } /* End of 'GetIndices' function */
+
+    /* View for batch kernels getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bvh8_view) View.
+     */
+    bvh8_view GetView( void ) const noexcept
+    {
+      return {Nodes.data(), Subtrees.data(), Nodes.size(), Leaves.data()};
+    } /* End of 'GetView' function */
+
+    /* Box query function (best instruction set): all children of a node are culled at once,
+     * leaves triangles go to the prepared triangles kernel.
+     * ARGUMENTS:
+     *   - Box:
+     *       const aabb<float> &Box;
+     *   - Overlapping triangles sink, called as Sink(OriginalIndex) (in no particular order):
+     *       sink &&Sink;
+     * RETURNS: None.
+     */
+    template<class sink>
+      void Query( const aabb<float> &Box, sink &&Sink ) const
+      {
+        auto Receive {[&]( std::span<const uint32_t> Hits )
+          {
+            for (const uint32_t Hit : Hits)
+              Sink(Indices[Hit]);
+          }};
+
+        BoxBvhTrianglesQuery(Box, GetView(),
+          []( void *Context, std::span<const uint32_t> Hits ) { (*static_cast<decltype(Receive) *>(Context))(Hits); }, &Receive);
+      } /* End of 'Query' function */
+  }; /* end of 'bvh8' class */
+
+  /* Quantized 8-ary bounding volume hierarchy over triangles set.
+   * Nodes are 'bvh8' ones with children bounds quantized to bytes (see 'quantized_bvh8_node'),
+   * so a node takes 80 bytes instead of 256 and is decoded in registers during traversal */
+  class quantized_bvh8
+  {
+    /* Pending wide node */
+    struct task
+    {
+      uint32_t Source; // Wide node index
+      size_t Node;     // Quantized node index
+    }; /* end of 'task' structure */
+
+    aligned_vector<quantized_bvh8_node> Nodes {}; // Nodes, root is the first one
+    std::vector<bvh_range> Subtrees {};           // Triangles range of every node subtree
+    aligned_vector<float> Leaves {};              // Leaves prepared triangles blocks (see 'bvh8_view')
+    std::vector<uint32_t> Indices {};             // Original index of every triangle in hierarchy order
+
+    /* Bounds decoding function.
+     * ARGUMENTS:
+     *   - Node bounds minimal corner component:
+     *       float Origin;
+     *   - Quantization step binary exponent:
+     *       int Exponent;
+     *   - Offset in steps:
+     *       uint32_t Offset;
+     * RETURNS:
+     *   (float) Decoded bounds component, exactly as kernels do it.
+     */
+    static float Decode( float Origin, int Exponent, uint32_t Offset ) noexcept
+    {
+      return Origin + (float)Offset * std::ldexp(1.f, Exponent);
+    } /* End of 'Decode' function */
+
+    /* Node bounds quantization along an axis function.
+     * ARGUMENTS:
+     *   - Node bounds along axis:
+     *       float Min, Max;
+     *   - Children bounds along axis, empty ones are skipped:
+     *       const bvh8_node &Source; size_t Axis;
+     *   - Quantized node (origin, exponent and offsets along axis are set):
+     *       quantized_bvh8_node &Node;
+     * RETURNS: None.
+     */
+    static void Quantize( float Min, float Max, const bvh8_node &Source, size_t Axis, quantized_bvh8_node &Node ) noexcept
+    {
+      /* The smallest step, for which 255 steps cover node */
+      int Exponent {std::max(std::ilogb(std::max(Max - Min, std::numeric_limits<float>::min())) - 8, -126)};
+
+      while (Exponent < 127 && Decode(Min, Exponent, 255) < Max)
+        Exponent++;
+      (&Node.Origin.X)[Axis] = Min;
+      Node.Exponents[Axis] = (int8_t)Exponent;
+
+      /* Offsets are rounded outwards, then adjusted by exact decoding */
+      const float Step {std::ldexp(1.f, Exponent)};
+
+      for (size_t Slot {0}; Slot < bvh8_node::Width; Slot++)
+        if (Node.Valid & (1u << Slot))
+        {
+          uint32_t
+            Lo {(uint32_t)std::clamp(std::floor((Source.Min[Axis][Slot] - Min) / Step), 0.f, 255.f)},
+            Hi {(uint32_t)std::clamp(std::ceil((Source.Max[Axis][Slot] - Min) / Step), 0.f, 255.f)};
+
+          while (Lo > 0 && Decode(Min, Exponent, Lo) > Source.Min[Axis][Slot])
+            Lo--;
+          while (Hi < 255 && Decode(Min, Exponent, Hi) < Source.Max[Axis][Slot])
+            Hi++;
+          Node.QMin[Axis][Slot] = (uint8_t)Lo;
+          Node.QMax[Axis][Slot] = (uint8_t)Hi;
+        }
+    } /* End of 'Quantize' function */
+
+  public:
+    /* Default constructor */
+    quantized_bvh8( void ) = default;
+
+    /* Constructor from 8-ary hierarchy.
+     * Triangles are reordered, so leaves of every node are adjacent in slots order
+     * (subtrees stay contiguous, as nodes are visited depth first).
+     * ARGUMENTS:
+     *   - 8-ary hierarchy:
+     *       const bvh8 &Wide;
+     */
+    explicit quantized_bvh8( const bvh8 &Wide )
+    {
+      const bvh8_view Source {Wide.GetView()};
+      const std::span<const uint32_t> SourceIndices {Wide.GetIndices()};
+
+      if (Source.NodesCount == 0)
+        return;
+
+      Nodes.resize(1);
+      Subtrees.resize(1);
+      Indices.resize(SourceIndices.size());
+      Leaves.resize(SourceIndices.size() * prepared_mesh::StreamsCount + prepared_mesh::Padding);
+      std::fill(Leaves.end() - prepared_mesh::Padding, Leaves.end(), 0.f);
+
+      std::vector<task> Stack {{0, 0}};
+      uint32_t NextTriangle {0};
+
+      while (!Stack.empty())
+      {
+        const task Task {Stack.back()};
+        const bvh8_node &From {Source.Nodes[Task.Source]};
+        quantized_bvh8_node Node {};
+        bvh_bounds Bounds {};
+
+        Stack.pop_back();
+        for (size_t Slot {0}; Slot < bvh8_node::Width; Slot++)
+          if (const bvh_bounds Child {From.GetChildBounds(Slot)}; Child.Min.X <= Child.Max.X)
+            Node.Valid |= (uint8_t)(1u << Slot), Bounds.Extend(Child);
+        for (size_t Axis {0}; Axis < 3; Axis++)
+          Quantize((&Bounds.Min.X)[Axis], (&Bounds.Max.X)[Axis], From, Axis, Node);
+
+        Node.FirstChild = (uint32_t)Nodes.size();
+        Node.FirstTriangle = NextTriangle;
+        Subtrees[Task.Node] = {NextTriangle, Source.Subtrees[Task.Source].Count};
+        for (size_t Slot {0}; Slot < bvh8_node::Width; Slot++)
+        {
+          uint32_t First, Count;
+
+          if (!(Node.Valid & (1u << Slot)))
+            continue;
+          From.GetChild(Slot, First, Count);
+          if (Count == 0)
+          {
+            Stack.push_back({First, Nodes.size()});
+            Nodes.emplace_back();
+            Subtrees.emplace_back();
+            continue;
+          }
+          if (Count > std::numeric_limits<uint8_t>::max())
+            throw std::out_of_range {"Hierarchy leaf is too large for quantized node"};
+
+          Node.Count[Slot] = (uint8_t)Count;
+          std::copy_n(Source.Leaves + (size_t)First * prepared_mesh::StreamsCount, (size_t)Count * prepared_mesh::StreamsCount,
+            Leaves.data() + (size_t)NextTriangle * prepared_mesh::StreamsCount);
+          std::copy_n(SourceIndices.data() + First, Count, Indices.data() + NextTriangle);
+          NextTriangle += Count;
+        }
+        Nodes[Task.Node] = Node;
+      }
+    } /* End of constructor */
+
+    /* Constructor from triangles set.
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Triangles;
+     *   - Threads count for hierarchy building (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     */
+    explicit quantized_bvh8( const triangles_soa_view<float> &Triangles, size_t ThreadsCount = 0 ) :
+      quantized_bvh8(bvh8 {Triangles, ThreadsCount})
+    {
+    } /* End of constructor */
+
+    /* Nodes getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const quantized_bvh8_node>) Nodes, root is the first one (empty for empty hierarchy).
+     */
+    std::span<const quantized_bvh8_node> GetNodes( void ) const noexcept
+    {
+      return Nodes;
+    } /* End of 'GetNodes' function */
+
+    /* Original triangles indices getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const uint32_t>) Original index of every triangle in hierarchy order.
+     */
+    std::span<const uint32_t> GetIndices( void ) const noexcept
+    {
+      return Indices;
+    } /* End of 'GetIndices' function */
+
+    /* View for batch kernels getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (quantized_bvh8_view) View.
+     */
+    quantized_bvh8_view GetView( void ) const noexcept
+    {
+      return {Nodes.data(), Subtrees.data(), Nodes.size(), Leaves.data()};
+    } /* End of 'GetView' function */
+
+    /* Box query function (best instruction set), see 'bvh8::Query'.
+     * ARGUMENTS:
+     *   - Box:
+     *       const aabb<float> &Box;
+     *   - Overlapping triangles sink, called as Sink(OriginalIndex) (in no particular order):
+     *       sink &&Sink;
+     * RETURNS: None.
+     */
+    template<class sink>
+      void Query( const aabb<float> &Box, sink &&Sink ) const
+      {
+        auto Receive {[&]( std::span<const uint32_t> Hits )
+          {
+            for (const uint32_t Hit : Hits)
+              Sink(Indices[Hit]);
+          }};
+
+        BoxBvhTrianglesQuery(Box, GetView(),
+          []( void *Context, std::span<const uint32_t> Hits ) { (*static_cast<decltype(Receive) *>(Context))(Hits); }, &Receive);
+      } /* End of 'Query' function */
+  }; /* end of 'quantized_bvh8' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_bvh8_hpp__ */
+
+/* END OF 'overlap_bvh8.hpp' FILE */
@@ -0,0 +1,328 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+/* "overlap_bvh_node.hpp" - Hierarchy nodes layouts and query bounds, shared by hierarchy builders and batch kernels */
+
+#ifndef __overlap_bvh_node_hpp__
+#define __overlap_bvh_node_hpp__
+
+#include <cmath>
+#include <limits>
+
+#include "overlap_base.hpp"
+#include "overlap_prepared.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Bounds stored as minimal and maximal corners (empty ones are inverted infinite) */
+  struct bvh_bounds
+  {
+    vec3<float> Min {std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()};
+    vec3<float> Max {-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+
+    /* Point including function.
+     * ARGUMENTS:
+     *   - Point:
+     *       const vec3<float> &P;
+     * RETURNS: None.
+     */
+    void Extend( const vec3<float> &P ) noexcept
+    {
+      Min = {std::min(Min.X, P.X), std::min(Min.Y, P.Y), std::min(Min.Z, P.Z)};
+      Max = {std::max(Max.X, P.X), std::max(Max.Y, P.Y), std::max(Max.Z, P.Z)};
+    } /* End of 'Extend' function */
+
+    /* Bounds including function.
+     * ARGUMENTS:
+     *   - Bounds:
+     *       const bvh_bounds &B;
+     * RETURNS: None.
+     */
+    void Extend( const bvh_bounds &B ) noexcept
+    {
+      Min = {std::min(Min.X, B.Min.X), std::min(Min.Y, B.Min.Y), std::min(Min.Z, B.Min.Z)};
+      Max = {std::max(Max.X, B.Max.X), std::max(Max.Y, B.Max.Y), std::max(Max.Z, B.Max.Z)};
+    } /* End of 'Extend' function */
+
+    /* Half surface area getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (float) Half surface area, 0 for empty bounds.
+     */
+    float GetArea( void ) const noexcept
+    {
+      const vec3<float> Size {Max - Min};
+
+      return Size.X < 0 ? 0 : Size.X * Size.Y + Size.Y * Size.Z + Size.Z * Size.X;
+    } /* End of 'GetArea' function */
+  }; /* end of 'bvh_bounds' structure */
+
+  /* Box query bounds: box corners rounded outwards (for culling, so no triangle accepted
+   * by SAT test is rejected) and inwards (for containment, so no rejected one is accepted) */
+  struct bvh_query_bounds
+  {
+    vec3<float> OuterMin, OuterMax, InnerMin, InnerMax; // Rounded box corners
+
+    /* Constructor.
+     * ARGUMENTS:
+     *   - Box:
+     *       const aabb<float> &Box;
+     */
+    explicit bvh_query_bounds( const aabb<float> &Box ) noexcept
+    {
+      constexpr float Inf {std::numeric_limits<float>::infinity()};
+      const vec3<float> Min {Box.Center - Box.HalfSize}, Max {Box.Center + Box.HalfSize};
+
+      OuterMin = {std::nextafter(Min.X, -Inf), std::nextafter(Min.Y, -Inf), std::nextafter(Min.Z, -Inf)};
+      OuterMax = {std::nextafter(Max.X, Inf), std::nextafter(Max.Y, Inf), std::nextafter(Max.Z, Inf)};
+      InnerMin = {std::nextafter(Min.X, Inf), std::nextafter(Min.Y, Inf), std::nextafter(Min.Z, Inf)};
+      InnerMax = {std::nextafter(Max.X, -Inf), std::nextafter(Max.Y, -Inf), std::nextafter(Max.Z, -Inf)};
+    } /* End of constructor */
+
+    /* Bounds overlap check function.
+     * ARGUMENTS:
+     *   - Bounds corners:
+     *       const vec3<float> &Min, &Max;
+     * RETURNS:
+     *   (bool) true if bounds may overlap box.
+     */
+    bool Overlaps( const vec3<float> &Min, const vec3<float> &Max ) const noexcept
+    {
+      return
+        Min.X <= OuterMax.X && Max.X >= OuterMin.X &&
+        Min.Y <= OuterMax.Y && Max.Y >= OuterMin.Y &&
+        Min.Z <= OuterMax.Z && Max.Z >= OuterMin.Z;
+    } /* End of 'Overlaps' function */
+
+    /* Bounds containment check function.
+     * ARGUMENTS:
+     *   - Bounds corners:
+     *       const vec3<float> &Min, &Max;
+     * RETURNS:
+     *   (bool) true if bounds are inside box.
+     */
+    bool Contains( const vec3<float> &Min, const vec3<float> &Max ) const noexcept
+    {
+      return
+        Min.X >= InnerMin.X && Max.X <= InnerMax.X &&
+        Min.Y >= InnerMin.Y && Max.Y <= InnerMax.Y &&
+        Min.Z >= InnerMin.Z && Max.Z <= InnerMax.Z;
+    } /* End of 'Contains' function */
+  }; /* end of 'bvh_query_bounds' structure */
+
+  /* Hierarchy node, 32 bytes. Children of inner node are adjacent, leaves refer to
+   * contiguous triangles ranges in hierarchy order */
+  struct bvh_node
+  {
+    vec3<float> Min;  // Bounds minimal corner
+    uint32_t Index;   // Inner node: first child index, leaf: first triangle index
+    vec3<float> Max;  // Bounds maximal corner
+    uint32_t Count;   // Leaf triangles count, 0 for inner nodes
+  }; /* end of 'bvh_node' structure */
+
+  /* 8-ary hierarchy node, 256 bytes (4 cache lines). Children bounds are stored by components,
+   * so all 8 of them are tested against a box by a few vector comparisons. Empty slots have
+   * inverted infinite bounds and never overlap anything */
+  struct alignas(64) bvh8_node
+  {
+    static constexpr size_t Width {8}; // Children slots count
+
+    std::array<std::array<float, Width>, 3> Min; // Children bounds minimal corners components, [axis][slot]
+    std::array<std::array<float, Width>, 3> Max; // Children bounds maximal corners components, [axis][slot]
+    std::array<uint32_t, Width> Child;           // Inner child: node index, leaf: first triangle index
+    std::array<uint32_t, Width> Count;           // Leaf triangles count, 0 for inner children and empty slots
+
+    /* Child bounds getting function.
+     * ARGUMENTS:
+     *   - Child slot:
+     *       size_t Slot;
+     * RETURNS:
+     *   (bvh_bounds) Bounds, empty for empty slot.
+     */
+    bvh_bounds GetChildBounds( size_t Slot ) const noexcept
+    {
+      return {{Min[0][Slot], Min[1][Slot], Min[2][Slot]}, {Max[0][Slot], Max[1][Slot], Max[2][Slot]}};
+    } /* End of 'GetChildBounds' function */
+
+    /* Child reference getting function.
+     * ARGUMENTS:
+     *   - Child slot:
+     *       size_t Slot;
+     *   - Inner child node index or leaf first triangle index output:
+     *       uint32_t &Index;
+     *   - Leaf triangles count output, 0 for inner child:
+     *       uint32_t &TrianglesCount;
+     * RETURNS: None.
+     */
+    void GetChild( size_t Slot, uint32_t &Index, uint32_t &TrianglesCount ) const noexcept
+    {
+      Index = Child[Slot], TrianglesCount = Count[Slot];
+    } /* End of 'GetChild' function */
+  }; /* end of 'bvh8_node' structure */
+  static_assert(sizeof(bvh8_node) == 256);
+
+  /* Quantized 8-ary hierarchy node, 80 bytes. Children bounds are 8-bit offsets from the node
+   * bounds minimal corner in steps of power of two size, so they are decoded exactly by one
+   * multiply-add; minimal corners are rounded down and maximal ones up, so decoded bounds
+   * always enclose the original ones. Inner children are adjacent nodes, leaves triangles
+   * are adjacent ranges in slots order, so no per child references are stored */
+  struct alignas(16) quantized_bvh8_node
+  {
+    static constexpr size_t Width {8}; // Children slots count
+
+    vec3<float> Origin;                              // Node bounds minimal corner
+    uint32_t FirstChild;                             // First inner child node index
+    uint32_t FirstTriangle;                          // First triangle of the first leaf child
+    std::array<int8_t, 3> Exponents;                 // Quantization step binary exponent for every axis
+    uint8_t Valid;                                   // Used slots mask
+    std::array<uint8_t, Width> Count;                // Leaf triangles count, 0 for inner children
+    std::array<std::array<uint8_t, Width>, 3> QMin;  // Children bounds minimal corners offsets, in steps, [axis][slot]
+    std::array<std::array<uint8_t, Width>, 3> QMax;  // Children bounds maximal corners offsets, in steps, [axis][slot]
+
+    /* Quantization step getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (vec3<float>) Step along every axis.
+     */
+    vec3<float> GetStep( void ) const noexcept
+    {
+      const auto Pow2 {[]( int8_t Exponent ) { return std::bit_cast<float>((uint32_t)(Exponent + 127) << 23); }};
+
+      return {Pow2(Exponents[0]), Pow2(Exponents[1]), Pow2(Exponents[2])};
+    } /* End of 'GetStep' function */
+
+    /* Child bounds getting function.
+     * ARGUMENTS:
+     *   - Child slot:
+     *       size_t Slot;
+     * RETURNS:
+     *   (bvh_bounds) Decoded bounds, empty for empty slot.
+     */
+    bvh_bounds GetChildBounds( size_t Slot ) const noexcept
+    {
+      if (!(Valid & (1u << Slot)))
+        return {};
+
+      const vec3<float> Step {GetStep()};
+
+      return
+      {
+        {Origin.X + (float)QMin[0][Slot] * Step.X, Origin.Y + (float)QMin[1][Slot] * Step.Y, Origin.Z + (float)QMin[2][Slot] * Step.Z},
+        {Origin.X + (float)QMax[0][Slot] * Step.X, Origin.Y + (float)QMax[1][Slot] * Step.Y, Origin.Z + (float)QMax[2][Slot] * Step.Z},
+      };
+    } /* End of 'GetChildBounds' function */
+
+    /* Child reference getting function.
+     * ARGUMENTS:
+     *   - Child slot:
+     *       size_t Slot;
+     *   - Inner child node index or leaf first triangle index output:
+     *       uint32_t &Index;
+     *   - Leaf triangles count output, 0 for inner child:
+     *       uint32_t &TrianglesCount;
+     * RETURNS: None.
+     */
+    void GetChild( size_t Slot, uint32_t &Index, uint32_t &TrianglesCount ) const noexcept
+    {
+      const uint32_t Below {Valid & ((1u << Slot) - 1)};
+
+      TrianglesCount = Count[Slot];
+      if (TrianglesCount == 0)
+      {
+        uint32_t Inner {0};
+
+        for (uint32_t Rest {Below}; Rest != 0; Rest &= Rest - 1)
+          Inner += Count[std::countr_zero(Rest)] == 0;
+        Index = FirstChild + Inner;
+      }
+      else
+      {
+        Index = FirstTriangle;
+        for (uint32_t Rest {Below}; Rest != 0; Rest &= Rest - 1)
+          Index += Count[std::countr_zero(Rest)];
+      }
+    } /* End of 'GetChild' function */
+  }; /* end of 'quantized_bvh8_node' structure */
+  static_assert(sizeof(quantized_bvh8_node) == 80);
+
+  /* Triangles range in hierarchy order */
+  struct bvh_range
+  {
+    uint32_t First; // First triangle index
+    uint32_t Count; // Triangles count
+  }; /* end of 'bvh_range' structure */
+
+  /* 8-ary hierarchy view for batch kernels. Leaves are contiguous ranges of triangles in hierarchy order,
+   * every leaf keeps its prepared triangles (see 'prepared_mesh') in its own block:
+   * leaf of Count triangles from First one occupies 'prepared_mesh::StreamsCount' streams of Count
+   * elements from Leaves + First * 'prepared_mesh::StreamsCount', so it is read sequentially.
+   * Node type is 'bvh8_node' or 'quantized_bvh8_node' */
+  template<class node>
+    struct wide_bvh_view
+    {
+      static constexpr size_t MaxDepth {64}; // Maximal nodes depth (traversal stack is sized by it)
+
+      const node *Nodes {};         // Nodes, root is the first one
+      const bvh_range *Subtrees {}; // Triangles range of every node subtree (contained subtrees are accepted entirely)
+      size_t NodesCount {0};        // Nodes count, 0 for empty hierarchy
+      const float *Leaves {};       // Leaves prepared triangles blocks, padded by 'prepared_mesh::Padding' elements
+    }; /* end of 'wide_bvh_view' structure */
+
+  /* 8-ary hierarchy views */
+  using bvh8_view = wide_bvh_view<bvh8_node>;
+  using quantized_bvh8_view = wide_bvh_view<quantized_bvh8_node>;
+
+  /* Binary hierarchy view for batch kernels, leaves are contiguous ranges of triangles in hierarchy order */
+  struct bvh_view
+  {
+    static constexpr size_t MaxDepth {64};   // Maximal nodes depth (traversal stack is sized by it)
+    static constexpr size_t PacketSize {64}; // Query boxes traversing hierarchy together (active boxes mask is 64-bit)
+
+    const bvh_node *Nodes {};               // Nodes, root is the first one
+    size_t NodesCount {0};                  // Nodes count, 0 for empty hierarchy
+    triangles_soa_view<float> Triangles {}; // Triangles in hierarchy order
+  }; /* end of 'bvh_view' structure */
+
+  /* Overlapping box and triangle pair of a boxes batch query */
+  struct bvh_pair
+  {
+    uint32_t Box;      // Box index in batch
+    uint32_t Triangle; // Triangle index in hierarchy order
+  }; /* end of 'bvh_pair' structure */
+
+  /* Hierarchy query hits receiver: called with batches of hierarchy order triangles indices.
+   * ARGUMENTS:
+   *   - Receiver context:
+   *       void *Context;
+   *   - Overlapping triangles indices:
+   *       std::span<const uint32_t> Indices;
+   * RETURNS: None.
+   */
+  using bvh_hits_callback = void (*)( void *Context, std::span<const uint32_t> Indices );
+
+  /* Hierarchy boxes batch query pairs receiver: called with batches of overlapping pairs.
+   * ARGUMENTS:
+   *   - Receiver context:
+   *       void *Context;
+   *   - Overlapping pairs:
+   *       std::span<const bvh_pair> Pairs;
+   * RETURNS: None.
+   */
+  using bvh_pairs_callback = void (*)( void *Context, std::span<const bvh_pair> Pairs );
+} /* end of 'math' namespace */
+
+#endif /* __overlap_bvh_node_hpp__ */
+
+/* END OF 'overlap_bvh_node.hpp' FILE */
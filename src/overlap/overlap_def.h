@@ -0,0 +1,246 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_def.h" - Overlap test module definitions: includes, instruction sets detection */
+
+#ifndef __overlap_def_h__
+#define __overlap_def_h__
+
+/* Module is kept independent from "def.h" (and Windows.h) to be usable outside of the demo */
+#include <algorithm>
+#include <concepts>
+#include <array>
+#include <span>
+#include <cstdint>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+/* SIMD intrinsics */
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#else
+#  include <cpuid.h>
+#endif
+
+/* Kernels for every instruction set are compiled into the same binary:
+ * each "overlap_<isa>.hpp" file enables the instruction set only for itself
+ * by wrapping its contents into OVERLAP_TARGET_PUSH/OVERLAP_TARGET_POP (MSVC allows intrinsics everywhere). */
+#if defined(__clang__)
+#  define OVERLAP_TARGET_PUSH(Target) _Pragma(Target)
+#  define OVERLAP_TARGET_POP() _Pragma("clang attribute pop")
+#  define OVERLAP_TARGET_SSE42 "clang attribute push (__attribute__((target(\"sse4.2,popcnt\"))), apply_to = function)"
+#  define OVERLAP_TARGET_AVX2 "clang attribute push (__attribute__((target(\"avx2,fma,bmi,bmi2,popcnt\"))), apply_to = function)"
+#  define OVERLAP_TARGET_AVX512 "clang attribute push (__attribute__((target(\"avx512f,avx2,fma,bmi,bmi2,popcnt\"))), apply_to = function)"
+#elif defined(__GNUC__)
+#  define OVERLAP_TARGET_PUSH(Target) _Pragma("GCC push_options") _Pragma(Target)
+#  define OVERLAP_TARGET_POP() _Pragma("GCC pop_options")
+#  define OVERLAP_TARGET_SSE42 "GCC target(\"sse4.2,popcnt\")"
+#  define OVERLAP_TARGET_AVX2 "GCC target(\"avx2,fma,bmi,bmi2,popcnt\")"
+#  define OVERLAP_TARGET_AVX512 "GCC target(\"avx512f,avx2,fma,bmi,bmi2,popcnt\")"
+#else
+#  define OVERLAP_TARGET_PUSH(Target)
+#  define OVERLAP_TARGET_POP()
+#endif
+
+/* Math namespace */
+namespace math
+{
+  /* Instruction set enumerable, ordered from the worst to the best */
+  enum class isa
+  {
+    eScalar, // Reference implementation, no SIMD
+    eSSE42,  // 4 wide kernels
+    eAVX2,   // 8 wide kernels, FMA is required as well
+    eAVX512, // 16 wide kernels, AVX-512F
+
+    _LastValue
+  }; /* end of 'isa' enumerable */
+
+  /* Instruction set name getting function.
+   * ARGUMENTS:
+   *   - Instruction set:
+   *       isa Isa;
+   * RETURNS:
+   *   (const char *) Name.
+   */
+  constexpr const char *GetIsaName( isa Isa ) noexcept
+  {
+    switch (Isa)
+    {
+    case isa::eScalar:
+      return "Scalar";
+    case isa::eSSE42:
+      return "SSE4.2";
+    case isa::eAVX2:
+      return "AVX2";
+    case isa::eAVX512:
+      return "AVX-512";
+    default:
+      return "Unknown";
+    }
+  } /* End of 'GetIsaName' function */
+
+  /* Separating axes groups enumerable */
+  enum class axes_group
+  {
+    eEdges, // 9 edge cross products with box axes, the most expensive group
+    eBox,   // 3 box face normals (triangle bounding box against box)
+    ePlane, // Triangle plane normal
+
+    _LastValue
+  }; /* end of 'axes_group' enumerable */
+
+  /* Separating axes groups evaluation order enumerable */
+  enum class axes_order
+  {
+    eDefault,     // Order, tuned for every kernel separately
+    eEdgesFirst,  // Edges, box, plane (classic one)
+    eBoxFirst,    // Box, edges, plane
+    ePlaneFirst,  // Plane, edges, box
+
+    _LastValue
+  }; /* end of 'axes_order' enumerable */
+
+  /* Axes groups sequence by evaluation order getting function.
+   * ARGUMENTS:
+   *   - Evaluation order (not 'eDefault'):
+   *       axes_order Order;
+   * RETURNS:
+   *   (std::array<axes_group, 3>) Groups in evaluation order.
+   */
+  constexpr std::array<axes_group, 3> GetAxesGroups( axes_order Order ) noexcept
+  {
+    switch (Order)
+    {
+    case axes_order::eBoxFirst:
+      return {axes_group::eBox, axes_group::eEdges, axes_group::ePlane};
+    case axes_order::ePlaneFirst:
+      return {axes_group::ePlane, axes_group::eEdges, axes_group::eBox};
+    default:
+      return {axes_group::eEdges, axes_group::eBox, axes_group::ePlane};
+    }
+  } /* End of 'GetAxesGroups' function */
+
+  /* Axes evaluation order name getting function.
+   * ARGUMENTS:
+   *   - Evaluation order:
+   *       axes_order Order;
+   * RETURNS:
+   *   (const char *) Name.
+   */
+  constexpr const char *GetAxesOrderName( axes_order Order ) noexcept
+  {
+    switch (Order)
+    {
+    case axes_order::eDefault:
+      return "Default";
+    case axes_order::eEdgesFirst:
+      return "Edges first";
+    case axes_order::eBoxFirst:
+      return "Box first";
+    case axes_order::ePlaneFirst:
+      return "Plane first";
+    default:
+      return "Unknown";
+    }
+  } /* End of 'GetAxesOrderName' function */
+
+  /* Lanes compaction table: for every lanes mask numbers of set lanes, packed into bytes from the lowest one */
+  template<size_t Width>
+    inline constexpr std::array<uint64_t, 1 << Width> CompactionTable {[]
+      {
+        std::array<uint64_t, 1 << Width> Table {};
+
+        for (uint32_t Mask {0}; Mask < (1u << Width); Mask++)
+          for (uint32_t Lane {0}, Pos {0}; Lane < Width; Lane++)
+            if (Mask & (1u << Lane))
+              Table[Mask] |= (uint64_t)Lane << (8 * Pos++);
+        return Table;
+      }()};
+
+  /* Best instruction set supported by CPU and OS detection function.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (isa) Detected instruction set.
+   */
+  inline isa DetectIsa( void ) noexcept
+  {
+    /* CPUID leaf reading */
+    const auto CpuId {[]( uint32_t Leaf, uint32_t SubLeaf ) -> std::array<uint32_t, 4>
+      {
+        std::array<uint32_t, 4> Regs {};
+#if defined(_MSC_VER)
+        int Tmp[4] {};
+        __cpuidex(Tmp, (int)Leaf, (int)SubLeaf);
+        std::memcpy(Regs.data(), Tmp, sizeof Tmp);
+#else
+        __cpuid_count(Leaf, SubLeaf, Regs[0], Regs[1], Regs[2], Regs[3]);
+#endif
+        return Regs;
+      }};
+
+    /* Extended control register reading */
+    const auto XGetBV {[]( void ) -> uint64_t
+      {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        uint32_t Lo, Hi;
+        __asm__ ("xgetbv" : "=a"(Lo), "=d"(Hi) : "c"(0));
+        return ((uint64_t)Hi << 32) | Lo;
+#endif
+      }};
+
+    const uint32_t MaxLeaf {CpuId(0, 0)[0]};
+
+    if (MaxLeaf < 1)
+      return isa::eScalar;
+
+    const auto Leaf1 {CpuId(1, 0)};
+    const bool
+      HasSSE42 {(Leaf1[2] & (1u << 20)) != 0},
+      HasPopCnt {(Leaf1[2] & (1u << 23)) != 0},
+      HasFMA {(Leaf1[2] & (1u << 12)) != 0},
+      HasOSXSave {(Leaf1[2] & (1u << 27)) != 0},
+      HasAVX {(Leaf1[2] & (1u << 28)) != 0};
+
+    if (!HasSSE42 || !HasPopCnt)
+      return isa::eScalar;
+    if (!HasOSXSave || !HasAVX || !HasFMA || MaxLeaf < 7)
+      return isa::eSSE42;
+
+    /* OS must save YMM (and ZMM/opmask) state */
+    const uint64_t XCR0 {XGetBV()};
+    const auto Leaf7 {CpuId(7, 0)};
+    const bool
+      HasAVX2 {(Leaf7[1] & (1u << 5)) != 0},
+      HasBMI1 {(Leaf7[1] & (1u << 3)) != 0},
+      HasBMI2 {(Leaf7[1] & (1u << 8)) != 0},
+      HasAVX512F {(Leaf7[1] & (1u << 16)) != 0};
+
+    if ((XCR0 & 0x06) != 0x06 || !HasAVX2 || !HasBMI1 || !HasBMI2)
+      return isa::eSSE42;
+    if ((XCR0 & 0xE6) != 0xE6 || !HasAVX512F)
+      return isa::eAVX2;
+    return isa::eAVX512;
+  } /* End of 'DetectIsa' function */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_def_h__ */
+
+/* END OF 'overlap_def.h' FILE */
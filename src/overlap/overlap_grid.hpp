@@ -0,0 +1,111 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_grid.hpp" - Uniform grid cells overlap test setup */
+
+#ifndef __overlap_grid_hpp__
+#define __overlap_grid_hpp__
+
+#include "overlap_base.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Uniform grid descriptor.
+   * It is a structural type, so it may be passed as a template parameter ('template<grid_desc Grid>')
+   * or kept constexpr: cell size is folded into constants in 'ToCells' then. */
+  struct grid_desc
+  {
+    vec3<float> Origin {};          // Cell (0, 0, 0) minimal corner
+    vec3<float> CellSize {1, 1, 1}; // Cell size, positive
+
+    /* Cell box getting function.
+     * ARGUMENTS:
+     *   - Cell integer coordinates:
+     *       int32_t X, Y, Z;
+     * RETURNS:
+     *   (aabb<float>) Cell box.
+     */
+    constexpr aabb<float> GetCell( int32_t X, int32_t Y, int32_t Z ) const noexcept
+    {
+      const vec3<float> Min {Origin.X + (float)X * CellSize.X, Origin.Y + (float)Y * CellSize.Y, Origin.Z + (float)Z * CellSize.Z};
+
+      return {Min + CellSize * 0.5f, CellSize * 0.5f};
+    } /* End of 'GetCell' function */
+
+    /* Point to cells space, where cell centers have integer coordinates, conversion function.
+     * ARGUMENTS:
+     *   - Point:
+     *       const vec3<float> &P;
+     * RETURNS:
+     *   (vec3<float>) Point in cells space.
+     */
+    constexpr vec3<float> ToCells( const vec3<float> &P ) const noexcept
+    {
+      return {(P.X - Origin.X) / CellSize.X - 0.5f, (P.Y - Origin.Y) / CellSize.Y - 0.5f, (P.Z - Origin.Z) / CellSize.Z - 0.5f};
+    } /* End of 'ToCells' function */
+  }; /* end of 'grid_desc' structure */
+
+  /* Cells set, stored as structure of arrays of integer coordinates, non-owning view */
+  struct cell_coords_soa_view
+  {
+    const int32_t *X {}, *Y {}, *Z {}; // Cells coordinates arrays
+    size_t Count {0};                  // Cells count
+  }; /* end of 'cell_coords_soa_view' structure */
+
+  /* Triangle, prepared for testing against cells of uniform grid.
+   * Triangle is moved to cells space, so every cell is a box of half size 0.5 centered at its
+   * integer coordinates: half size projections are folded into axes intervals once per triangle
+   * and kernels convert cell coordinates to floats only. Coordinates must not exceed 2^24 by
+   * absolute value. Results may differ from world space tests within rounding, unless
+   * cell size is a power of two. */
+  struct triangle_cells_setup : triangle_boxes_setup<float>
+  {
+    static constexpr vec3<float> CellHalfSize {0.5f, 0.5f, 0.5f}; // Cell half size in cells space
+
+    /* Default constructor */
+    constexpr triangle_cells_setup( void ) noexcept = default;
+
+    /* Constructor from triangle and grid.
+     * ARGUMENTS:
+     *   - Triangle:
+     *       const triangle<float> &Tri;
+     *   - Grid:
+     *       const grid_desc &Grid;
+     */
+    constexpr triangle_cells_setup( const triangle<float> &Tri, const grid_desc &Grid ) noexcept :
+      triangle_boxes_setup<float> {{Grid.ToCells(Tri.V0), Grid.ToCells(Tri.V1), Grid.ToCells(Tri.V2)}, CellHalfSize}
+    {
+    } /* End of constructor */
+
+    using triangle_boxes_setup<float>::Test;
+
+    /* Single cell overlap test function (scalar).
+     * ARGUMENTS:
+     *   - Cell integer coordinates:
+     *       int32_t X, Y, Z;
+     * RETURNS:
+     *   (bool) true if cell overlaps triangle.
+     */
+    constexpr bool Test( int32_t X, int32_t Y, int32_t Z ) const noexcept
+    {
+      return Test({(float)X, (float)Y, (float)Z});
+    } /* End of 'Test' function */
+  }; /* end of 'triangle_cells_setup' structure */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_grid_hpp__ */
+
+/* END OF 'overlap_grid.hpp' FILE */
@@ -0,0 +1,959 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_import.hpp" - Parallel STL/OBJ/PLY meshes importer into aligned triangle streams */
+
+#ifndef __overlap_import_hpp__
+#define __overlap_import_hpp__
+
+#include <charconv>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "overlap_mapped_file.hpp"
+#include "overlap_parallel.hpp"
+#include "overlap_soa.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Importable mesh file formats enumerable */
+  enum class mesh_format
+  {
+    eStlBinary, // Binary STL: 80 bytes header, triangles count, 50 bytes records
+    eStlAscii,  // ASCII STL: 'facet'/'outer loop'/'vertex' blocks
+    eObj,       // Wavefront OBJ: 'v' and 'f' lines, polygons are fan triangulated
+    ePly,       // Binary (little or big endian) PLY: 'vertex' and 'face' elements
+
+    _LastValue
+  }; /* end of 'mesh_format' enumerable */
+
+  /* Mesh format name getting function.
+   * ARGUMENTS:
+   *   - Format:
+   *       mesh_format Format;
+   * RETURNS:
+   *   (const char *) Name.
+   */
+  constexpr const char *GetMeshFormatName( mesh_format Format ) noexcept
+  {
+    switch (Format)
+    {
+    case mesh_format::eStlBinary:
+      return "Binary STL";
+    case mesh_format::eStlAscii:
+      return "ASCII STL";
+    case mesh_format::eObj:
+      return "OBJ";
+    case mesh_format::ePly:
+      return "Binary PLY";
+    default:
+      return "Unknown";
+    }
+  } /* End of 'GetMeshFormatName' function */
+
+  /* Importer internals namespace */
+  namespace mesh_import
+  {
+    /* Minimal file part, parsed by one thread */
+    inline constexpr size_t MinChunkSize {1 << 20};
+
+    /* File part, parsed by one thread */
+    struct chunk
+    {
+      size_t First {0}, End {0};        // Bytes (or records) range
+      size_t VerticesCount {0};         // Vertices count in part (offset of the first one after 'PrefixSums')
+      size_t TrianglesCount {0};        // Triangles count in part (offset of the first one after 'PrefixSums')
+      const char *Error {};             // Parsing error message, nullptr if none
+      size_t ErrorPos {0};              // Parsing error byte offset
+    }; /* end of 'chunk' structure */
+
+    /* White space (except line end) check function.
+     * ARGUMENTS:
+     *   - Character:
+     *       char C;
+     * RETURNS:
+     *   (bool) true if character is a space.
+     */
+    constexpr bool IsSpace( char C ) noexcept
+    {
+      return C == ' ' || C == '\t' || C == '\r' || C == '\v' || C == '\f';
+    } /* End of 'IsSpace' function */
+
+    /* Spaces skipping function.
+     * ARGUMENTS:
+     *   - Text position and end:
+     *       const char *Ptr, *End;
+     * RETURNS:
+     *   (const char *) First non space character (or line end) position.
+     */
+    inline const char *SkipSpaces( const char *Ptr, const char *End ) noexcept
+    {
+      while (Ptr < End && IsSpace(*Ptr))
+        Ptr++;
+      return Ptr;
+    } /* End of 'SkipSpaces' function */
+
+    /* Line skipping function.
+     * ARGUMENTS:
+     *   - Text position and end:
+     *       const char *Ptr, *End;
+     * RETURNS:
+     *   (const char *) Next line start.
+     */
+    inline const char *SkipLine( const char *Ptr, const char *End ) noexcept
+    {
+      const void *Eol {std::memchr(Ptr, '\n', (size_t)(End - Ptr))};
+
+      return Eol != nullptr ? static_cast<const char *>(Eol) + 1 : End;
+    } /* End of 'SkipLine' function */
+
+    /* Keyword at position check function, keyword must be followed by a space or line end.
+     * ARGUMENTS:
+     *   - Text position and end:
+     *       const char *Ptr, *End;
+     *   - Keyword:
+     *       std::string_view Word;
+     * RETURNS:
+     *   (bool) true if text starts with keyword.
+     */
+    inline bool IsWord( const char *Ptr, const char *End, std::string_view Word ) noexcept
+    {
+      return (size_t)(End - Ptr) >= Word.size() && std::equal(Word.begin(), Word.end(), Ptr) &&
+        (Ptr + Word.size() == End || IsSpace(Ptr[Word.size()]) || Ptr[Word.size()] == '\n');
+    } /* End of 'IsWord' function */
+
+    /* Floating point number parsing function (leading spaces are skipped).
+     * ARGUMENTS:
+     *   - Text position and end:
+     *       const char *Ptr, *End;
+     *   - Parsed value:
+     *       float &Value;
+     * RETURNS:
+     *   (const char *) Position after number, nullptr on error.
+     */
+    inline const char *ParseFloat( const char *Ptr, const char *End, float &Value ) noexcept
+    {
+      Ptr = SkipSpaces(Ptr, End);
+      if (Ptr < End && *Ptr == '+')
+        Ptr++;
+
+      const auto [Next, Error] {std::from_chars(Ptr, End, Value)};
+
+      return Error == std::errc {} ? Next : nullptr;
+    } /* End of 'ParseFloat' function */
+
+    /* Vector parsing function.
+     * ARGUMENTS:
+     *   - Text position and end:
+     *       const char *Ptr, *End;
+     *   - Parsed vector:
+     *       vec3<float> &V;
+     * RETURNS:
+     *   (const char *) Position after vector, nullptr on error.
+     */
+    inline const char *ParseVector( const char *Ptr, const char *End, vec3<float> &V ) noexcept
+    {
+      if ((Ptr = ParseFloat(Ptr, End, V.X)) == nullptr || (Ptr = ParseFloat(Ptr, End, V.Y)) == nullptr)
+        return nullptr;
+      return ParseFloat(Ptr, End, V.Z);
+    } /* End of 'ParseVector' function */
+
+    /* Text splitting into line aligned parts function.
+     * ARGUMENTS:
+     *   - Text:
+     *       std::span<const char> Text;
+     *   - Threads count:
+     *       size_t ThreadsCount;
+     * RETURNS:
+     *   (std::vector<chunk>) Parts, every one starts at line start.
+     */
+    inline std::vector<chunk> SplitText( std::span<const char> Text, size_t ThreadsCount )
+    {
+      const size_t Count {std::clamp<size_t>(Text.size() / MinChunkSize, 1, ThreadsCount)};
+      const char *Begin {Text.data()}, *End {Text.data() + Text.size()};
+      std::vector<chunk> Chunks(Count);
+
+      for (size_t i {1}; i < Count; i++)
+        Chunks[i].First = Chunks[i - 1].End = (size_t)(SkipLine(Begin + std::max(Text.size() / Count * i, Chunks[i - 1].First), End) - Begin);
+      Chunks.back().End = Text.size();
+      return Chunks;
+    } /* End of 'SplitText' function */
+
+    /* Parts processing in parallel function, the first parsing error is thrown.
+     * ARGUMENTS:
+     *   - Parts:
+     *       std::vector<chunk> &Chunks;
+     *   - Part processing function, called as Func(Chunk), must not throw (reports errors into chunk):
+     *       func &&Func;
+     *   - Threads count:
+     *       size_t ThreadsCount;
+     *   - Format name for error messages:
+     *       const char *Name;
+     * RETURNS: None.
+     */
+    template<class func>
+      void ProcessChunks( std::vector<chunk> &Chunks, func &&Func, size_t ThreadsCount, const char *Name )
+      {
+        ParallelFor(Chunks.size(), [&]( size_t, size_t First, size_t End )
+          {
+            for (size_t i {First}; i < End; i++)
+              Func(Chunks[i]);
+          }, std::clamp<size_t>(Chunks.size(), 1, ThreadsCount));
+
+        for (const chunk &Chunk : Chunks)
+          if (Chunk.Error != nullptr)
+            throw std::runtime_error {std::string {Name} + ": " + Chunk.Error + " at byte " + std::to_string(Chunk.ErrorPos)};
+      } /* End of 'ProcessChunks' function */
+
+    /* Parts counts to offsets converting function.
+     * ARGUMENTS:
+     *   - Parts:
+     *       std::vector<chunk> &Chunks;
+     * RETURNS:
+     *   (std::pair<size_t, size_t>) Total vertices and triangles counts.
+     */
+    inline std::pair<size_t, size_t> PrefixSums( std::vector<chunk> &Chunks ) noexcept
+    {
+      size_t Vertices {0}, Triangles {0};
+
+      for (chunk &Chunk : Chunks)
+      {
+        Vertices += std::exchange(Chunk.VerticesCount, Vertices);
+        Triangles += std::exchange(Chunk.TrianglesCount, Triangles);
+      }
+      return {Vertices, Triangles};
+    } /* End of 'PrefixSums' function */
+
+    /* Binary STL importing function.
+     * ARGUMENTS:
+     *   - File data:
+     *       std::span<const char> Data;
+     *   - Threads count:
+     *       size_t ThreadsCount;
+     * RETURNS:
+     *   (triangle_soa) Triangles.
+     */
+    inline triangle_soa ImportStlBinary( std::span<const char> Data, size_t ThreadsCount )
+    {
+      constexpr size_t HeaderSize {84}, RecordSize {50};
+      uint32_t Count {0};
+
+      if (Data.size() < HeaderSize)
+        throw std::runtime_error {"Binary STL: file is too small"};
+      std::memcpy(&Count, Data.data() + 80, sizeof Count);
+      if ((Data.size() - HeaderSize) / RecordSize < Count)
+        throw std::runtime_error {"Binary STL: file is truncated"};
+
+      triangle_soa Tris {};
+
+      Tris.Expand(Count);
+      ParallelFor(Count, [&]( size_t, size_t First, size_t End )
+        {
+          for (size_t i {First}; i < End; i++)
+          {
+            /* Record: normal, 3 vertices, attribute bytes count */
+            float Coords[9];
+
+            std::memcpy(Coords, Data.data() + HeaderSize + i * RecordSize + 12, sizeof Coords);
+            Tris.Set(i, {Coords[0], Coords[1], Coords[2]}, {Coords[3], Coords[4], Coords[5]}, {Coords[6], Coords[7], Coords[8]});
+          }
+        }, std::clamp<size_t>(Count * RecordSize / MinChunkSize, 1, ThreadsCount));
+      return Tris;
+    } /* End of 'ImportStlBinary' function */
+
+    /* ASCII STL importing function. Every 3 consecutive 'vertex' lines form a triangle,
+     * so parts are cut at any line and vertices are counted first. Text without vertices must be
+     * an empty solid ('endsolid' is required), otherwise it is not an ASCII STL file.
+     * ARGUMENTS:
+     *   - File text:
+     *       std::span<const char> Text;
+     *   - Threads count:
+     *       size_t ThreadsCount;
+     * RETURNS:
+     *   (triangle_soa) Triangles.
+     */
+    inline triangle_soa ImportStlAscii( std::span<const char> Text, size_t ThreadsCount )
+    {
+      constexpr const char *Name {"ASCII STL"};
+      const char *Begin {Text.data()};
+      std::vector<chunk> Chunks {SplitText(Text, ThreadsCount)};
+
+      ProcessChunks(Chunks, [Begin]( chunk &Chunk )
+        {
+          for (const char *Ptr {Begin + Chunk.First}, *End {Begin + Chunk.End}; Ptr < End; Ptr = SkipLine(Ptr, End))
+            if (IsWord(Ptr = SkipSpaces(Ptr, End), End, "vertex"))
+              Chunk.VerticesCount++;
+        }, ThreadsCount, Name);
+
+      const size_t VerticesCount {PrefixSums(Chunks).first};
+
+      if (VerticesCount % 3 != 0)
+        throw std::runtime_error {"ASCII STL: vertices count is not a multiple of 3"};
+      if (VerticesCount == 0 && std::string_view {Text.data(), Text.size()}.find("endsolid") == std::string_view::npos)
+        throw std::runtime_error {"ASCII STL: file has no facets"};
+
+      triangle_soa Tris {};
+
+      Tris.Expand(VerticesCount / 3);
+      ProcessChunks(Chunks, [Begin, &Tris]( chunk &Chunk )
+        {
+          size_t Index {Chunk.VerticesCount};
+
+          for (const char *Ptr {Begin + Chunk.First}, *End {Begin + Chunk.End}; Ptr < End; Ptr = SkipLine(Ptr, End))
+            if (IsWord(Ptr = SkipSpaces(Ptr, End), End, "vertex"))
+            {
+              vec3<float> V;
+
+              if (ParseVector(Ptr + 6, End, V) == nullptr)
+              {
+                Chunk.Error = "invalid vertex", Chunk.ErrorPos = (size_t)(Ptr - Begin);
+                return;
+              }
+              Tris.SetVertex(Index / 3, Index % 3, V);
+              Index++;
+            }
+        }, ThreadsCount, Name);
+      return Tris;
+    } /* End of 'ImportStlAscii' function */
+
+    /* OBJ face line vertex references iterator */
+    class obj_face
+    {
+    private:
+      const char *Ptr, *End; // Current position and line end
+
+    public:
+      /* Constructor.
+       * ARGUMENTS:
+       *   - Position after 'f' keyword and text end:
+       *       const char *Ptr, *End;
+       */
+      obj_face( const char *Ptr, const char *End ) noexcept :
+        Ptr {Ptr}, End {End}
+      {
+      } /* End of constructor */
+
+      /* Next vertex reference getting function, texture and normal references are skipped.
+       * ARGUMENTS:
+       *   - Parsed reference (1-based, negative ones are relative):
+       *       int64_t &Ref;
+       * RETURNS:
+       *   (int) 1 if reference is parsed, 0 on line end, -1 on error.
+       */
+      int Next( int64_t &Ref ) noexcept
+      {
+        Ptr = SkipSpaces(Ptr, End);
+        if (Ptr == End || *Ptr == '\n' || *Ptr == '#')
+          return 0;
+
+        const auto [Next, Error] {std::from_chars(Ptr, End, Ref)};
+
+        if (Error != std::errc {} || Ref == 0)
+          return -1;
+        for (Ptr = Next; Ptr < End && !IsSpace(*Ptr) && *Ptr != '\n'; Ptr++)
+          ;
+        return 1;
+      } /* End of 'Next' function */
+    }; /* end of 'obj_face' class */
+
+    /* OBJ importing function. Parsed in 3 parallel passes: counting, vertices, faces.
+     * ARGUMENTS:
+     *   - File text:
+     *       std::span<const char> Text;
+     *   - Threads count:
+     *       size_t ThreadsCount;
+     * RETURNS:
+     *   (triangle_soa) Triangles.
+     */
+    inline triangle_soa ImportObj( std::span<const char> Text, size_t ThreadsCount )
+    {
+      constexpr const char *Name {"OBJ"};
+      const char *Begin {Text.data()};
+      std::vector<chunk> Chunks {SplitText(Text, ThreadsCount)};
+
+      ProcessChunks(Chunks, [Begin]( chunk &Chunk )
+        {
+          for (const char *Ptr {Begin + Chunk.First}, *End {Begin + Chunk.End}; Ptr < End; Ptr = SkipLine(Ptr, End))
+            if (IsWord(Ptr = SkipSpaces(Ptr, End), End, "v"))
+              Chunk.VerticesCount++;
+            else if (IsWord(Ptr, End, "f"))
+            {
+              obj_face Face {Ptr + 1, End};
+              int64_t Ref;
+              size_t Count {0};
+              int Res;
+
+              while ((Res = Face.Next(Ref)) > 0)
+                Count++;
+              if (Res < 0 || Count < 3)
+              {
+                Chunk.Error = "invalid face", Chunk.ErrorPos = (size_t)(Ptr - Begin);
+                return;
+              }
+              Chunk.TrianglesCount += Count - 2;
+            }
+        }, ThreadsCount, Name);
+
+      const auto [VerticesCount, TrianglesCount] {PrefixSums(Chunks)};
+      std::vector<vec3<float>> Vertices(VerticesCount);
+
+      ProcessChunks(Chunks, [Begin, &Vertices]( chunk &Chunk )
+        {
+          size_t Index {Chunk.VerticesCount};
+
+          for (const char *Ptr {Begin + Chunk.First}, *End {Begin + Chunk.End}; Ptr < End; Ptr = SkipLine(Ptr, End))
+            if (IsWord(Ptr = SkipSpaces(Ptr, End), End, "v") && ParseVector(Ptr + 1, End, Vertices[Index++]) == nullptr)
+            {
+              Chunk.Error = "invalid vertex", Chunk.ErrorPos = (size_t)(Ptr - Begin);
+              return;
+            }
+        }, ThreadsCount, Name);
+
+      triangle_soa Tris {};
+
+      Tris.Expand(TrianglesCount);
+      ProcessChunks(Chunks, [Begin, &Vertices, &Tris]( chunk &Chunk )
+        {
+          size_t Defined {Chunk.VerticesCount}, Index {Chunk.TrianglesCount};
+
+          for (const char *Ptr {Begin + Chunk.First}, *End {Begin + Chunk.End}; Ptr < End; Ptr = SkipLine(Ptr, End))
+            if (IsWord(Ptr = SkipSpaces(Ptr, End), End, "v"))
+              Defined++;
+            else if (IsWord(Ptr, End, "f"))
+            {
+              obj_face Face {Ptr + 1, End};
+              int64_t Ref;
+              size_t Refs[3], Count {0};
+
+              /* Polygon is triangulated as a fan around its first vertex */
+              while (Face.Next(Ref) > 0)
+              {
+                const int64_t Resolved {Ref > 0 ? Ref - 1 : (int64_t)Defined + Ref};
+
+                if (Resolved < 0 || Resolved >= (int64_t)Vertices.size())
+                {
+                  Chunk.Error = "face vertex index is out of range", Chunk.ErrorPos = (size_t)(Ptr - Begin);
+                  return;
+                }
+                Refs[std::min<size_t>(Count++, 2)] = (size_t)Resolved;
+                if (Count >= 3)
+                {
+                  Tris.Set(Index++, Vertices[Refs[0]], Vertices[Refs[1]], Vertices[Refs[2]]);
+                  Refs[1] = Refs[2];
+                }
+              }
+            }
+        }, ThreadsCount, Name);
+      return Tris;
+    } /* End of 'ImportObj' function */
+
+    /* PLY property scalar types enumerable */
+    enum class ply_type
+    {
+      eInt8, eUInt8, eInt16, eUInt16, eInt32, eUInt32, eFloat32, eFloat64,
+
+      _LastValue
+    }; /* end of 'ply_type' enumerable */
+
+    /* PLY property */
+    struct ply_property
+    {
+      std::string Name;                      // Property name
+      ply_type Type {ply_type::eFloat32};    // Value (or list items) type
+      bool IsList {false};                   // List property flag
+      ply_type CountType {ply_type::eUInt8}; // List length type
+    }; /* end of 'ply_property' structure */
+
+    /* PLY element */
+    struct ply_element
+    {
+      std::string Name;                     // Element name
+      size_t Count {0};                     // Records count
+      std::vector<ply_property> Properties; // Record layout
+    }; /* end of 'ply_element' structure */
+
+    /* PLY type size getting function.
+     * ARGUMENTS:
+     *   - Type:
+     *       ply_type Type;
+     * RETURNS:
+     *   (size_t) Size in bytes.
+     */
+    constexpr size_t GetPlyTypeSize( ply_type Type ) noexcept
+    {
+      constexpr size_t Sizes[] {1, 1, 2, 2, 4, 4, 4, 8};
+
+      return Sizes[(size_t)Type];
+    } /* End of 'GetPlyTypeSize' function */
+
+    /* PLY type by name getting function.
+     * ARGUMENTS:
+     *   - Type name:
+     *       std::string_view Name;
+     * RETURNS:
+     *   (ply_type) Type.
+     */
+    inline ply_type GetPlyType( std::string_view Name )
+    {
+      constexpr std::string_view Names[][2]
+      {
+        {"char", "int8"}, {"uchar", "uint8"}, {"short", "int16"}, {"ushort", "uint16"},
+        {"int", "int32"}, {"uint", "uint32"}, {"float", "float32"}, {"double", "float64"},
+      };
+
+      for (size_t i {0}; i < (size_t)ply_type::_LastValue; i++)
+        if (Name == Names[i][0] || Name == Names[i][1])
+          return (ply_type)i;
+      throw std::runtime_error {"Binary PLY: unknown property type"};
+    } /* End of 'GetPlyType' function */
+
+    /* PLY value of known type reading function.
+     * ARGUMENTS:
+     *   - Value position:
+     *       const char *Ptr;
+     *   - Big endian data flag:
+     *       bool IsBigEndian;
+     * RETURNS:
+     *   (type) Value, converted.
+     */
+    template<class type, class value>
+      type LoadPlyValue( const char *Ptr, bool IsBigEndian ) noexcept
+      {
+        uint8_t Bytes[sizeof(value)];
+        value Value;
+
+        std::memcpy(Bytes, Ptr, sizeof Bytes);
+        if (IsBigEndian)
+          std::reverse(Bytes, Bytes + sizeof Bytes);
+        std::memcpy(&Value, Bytes, sizeof Value);
+        return (type)Value;
+      } /* End of 'LoadPlyValue' function */
+
+    /* PLY value reading function.
+     * ARGUMENTS:
+     *   - Value position:
+     *       const char *Ptr;
+     *   - Value type:
+     *       ply_type Type;
+     *   - Big endian data flag:
+     *       bool IsBigEndian;
+     * RETURNS:
+     *   (type) Value, converted.
+     */
+    template<class type>
+      type ReadPlyValue( const char *Ptr, ply_type Type, bool IsBigEndian ) noexcept
+      {
+        switch (Type)
+        {
+        case ply_type::eInt8:
+          return LoadPlyValue<type, int8_t>(Ptr, IsBigEndian);
+        case ply_type::eUInt8:
+          return LoadPlyValue<type, uint8_t>(Ptr, IsBigEndian);
+        case ply_type::eInt16:
+          return LoadPlyValue<type, int16_t>(Ptr, IsBigEndian);
+        case ply_type::eUInt16:
+          return LoadPlyValue<type, uint16_t>(Ptr, IsBigEndian);
+        case ply_type::eInt32:
+          return LoadPlyValue<type, int32_t>(Ptr, IsBigEndian);
+        case ply_type::eUInt32:
+          return LoadPlyValue<type, uint32_t>(Ptr, IsBigEndian);
+        case ply_type::eFloat32:
+          return LoadPlyValue<type, float>(Ptr, IsBigEndian);
+        default:
+          return LoadPlyValue<type, double>(Ptr, IsBigEndian);
+        }
+      } /* End of 'ReadPlyValue' function */
+
+    /* Binary PLY importing function. Vertices are converted in parallel, then face records
+     * (variable sized) are walked once reading only list lengths to cut them into parts,
+     * which are triangulated in parallel.
+     * ARGUMENTS:
+     *   - File data:
+     *       std::span<const char> Data;
+     *   - Threads count:
+     *       size_t ThreadsCount;
+     * RETURNS:
+     *   (triangle_soa) Triangles.
+     */
+    inline triangle_soa ImportPly( std::span<const char> Data, size_t ThreadsCount )
+    {
+      constexpr const char *Name {"Binary PLY"};
+      const char *Begin {Data.data()}, *End {Data.data() + Data.size()}, *Ptr {Begin};
+      std::vector<ply_element> Elements {};
+      bool IsBigEndian {false}, HasFormat {false};
+
+      if (!std::string_view {Begin, Data.size()}.starts_with("ply"))
+        throw std::runtime_error {"Binary PLY: invalid signature"};
+
+      /* Header: one keyword line after another up to 'end_header' */
+      for (Ptr = SkipLine(Ptr, End); ; Ptr = SkipLine(Ptr, End))
+      {
+        if (Ptr == End)
+          throw std::runtime_error {"Binary PLY: header is not terminated"};
+
+        const char *Eol {SkipLine(Ptr, End)};
+        std::vector<std::string_view> Words {};
+
+        for (const char *Word {SkipSpaces(Ptr, Eol)}; Word < Eol && *Word != '\n'; Word = SkipSpaces(Word, Eol))
+        {
+          const char *WordEnd {Word};
+
+          while (WordEnd < Eol && !IsSpace(*WordEnd) && *WordEnd != '\n')
+            WordEnd++;
+          Words.emplace_back(Word, (size_t)(WordEnd - Word));
+          Word = WordEnd;
+        }
+
+        if (Words.empty() || Words[0] == "comment" || Words[0] == "obj_info")
+          continue;
+        if (Words[0] == "end_header")
+        {
+          Ptr = Eol;
+          break;
+        }
+        if (Words[0] == "format" && Words.size() >= 2)
+        {
+          if (Words[1] != "binary_little_endian" && Words[1] != "binary_big_endian")
+            throw std::runtime_error {"Binary PLY: only binary formats are supported"};
+          IsBigEndian = Words[1] == "binary_big_endian", HasFormat = true;
+        }
+        else if (Words[0] == "element" && Words.size() == 3)
+        {
+          ply_element &Element {Elements.emplace_back()};
+          const auto [Next, Error] {std::from_chars(Words[2].data(), Words[2].data() + Words[2].size(), Element.Count)};
+
+          if (Error != std::errc {})
+            throw std::runtime_error {"Binary PLY: invalid element count"};
+          Element.Name = Words[1];
+        }
+        else if (Words[0] == "property" && !Elements.empty() && Words.size() == 3)
+          Elements.back().Properties.push_back({std::string {Words[2]}, GetPlyType(Words[1])});
+        else if (Words[0] == "property" && !Elements.empty() && Words.size() == 5 && Words[1] == "list")
+          Elements.back().Properties.push_back({std::string {Words[4]}, GetPlyType(Words[3]), true, GetPlyType(Words[2])});
+        else
+          throw std::runtime_error {"Binary PLY: invalid header line"};
+      }
+      if (!HasFormat)
+        throw std::runtime_error {"Binary PLY: format is not specified"};
+
+      /* Elements data placement: fixed size records are skipped at once, lists are walked */
+      const ply_element *VertexElement {}, *FaceElement {};
+      const char *VertexData {}, *FaceData {};
+      size_t VertexSize {0}, Offsets[3] {}, FaceList {0};
+      ply_type CoordTypes[3] {};
+
+      for (const ply_element &Element : Elements)
+      {
+        const bool HasLists {std::any_of(Element.Properties.begin(), Element.Properties.end(),
+          []( const ply_property &Property ) { return Property.IsList; })};
+        size_t RecordSize {0};
+
+        for (const ply_property &Property : Element.Properties)
+          RecordSize += Property.IsList ? 0 : GetPlyTypeSize(Property.Type);
+
+        if (Element.Name == "vertex")
+        {
+          if (HasLists)
+            throw std::runtime_error {"Binary PLY: list properties in vertices are not supported"};
+          for (size_t k {0}; k < 3; k++)
+          {
+            const std::string_view Coord {&"xyz"[k], 1};
+            size_t Offset {0};
+            bool Found {false};
+
+            for (const ply_property &Property : Element.Properties)
+            {
+              if (Property.Name == Coord)
+              {
+                Offsets[k] = Offset, CoordTypes[k] = Property.Type, Found = true;
+                break;
+              }
+              Offset += GetPlyTypeSize(Property.Type);
+            }
+            if (!Found)
+              throw std::runtime_error {"Binary PLY: vertex has no coordinates"};
+          }
+          VertexElement = &Element, VertexData = Ptr, VertexSize = RecordSize;
+        }
+        else if (Element.Name == "face")
+        {
+          for (FaceList = 0; FaceList < Element.Properties.size(); FaceList++)
+            if (Element.Properties[FaceList].IsList &&
+                (Element.Properties[FaceList].Name == "vertex_indices" || Element.Properties[FaceList].Name == "vertex_index"))
+              break;
+          if (FaceList == Element.Properties.size())
+            throw std::runtime_error {"Binary PLY: face has no vertex indices"};
+          if (VertexElement == nullptr)
+            throw std::runtime_error {"Binary PLY: faces before vertices are not supported"};
+          FaceElement = &Element, FaceData = Ptr;
+        }
+
+        if (!HasLists)
+        {
+          if (RecordSize != 0 && (size_t)(End - Ptr) / RecordSize < Element.Count)
+            throw std::runtime_error {"Binary PLY: file is truncated"};
+          Ptr += RecordSize * Element.Count;
+          continue;
+        }
+        if (&Element == FaceElement)
+          break;
+        for (size_t i {0}; i < Element.Count; i++)
+          for (const ply_property &Property : Element.Properties)
+          {
+            const size_t Size {GetPlyTypeSize(Property.IsList ? Property.CountType : Property.Type)};
+
+            if ((size_t)(End - Ptr) < Size)
+              throw std::runtime_error {"Binary PLY: file is truncated"};
+            if (Property.IsList)
+            {
+              const size_t Length {ReadPlyValue<size_t>(Ptr, Property.CountType, IsBigEndian)};
+
+              if ((size_t)(End - Ptr - Size) / GetPlyTypeSize(Property.Type) < Length)
+                throw std::runtime_error {"Binary PLY: file is truncated"};
+              Ptr += Size + Length * GetPlyTypeSize(Property.Type);
+            }
+            else
+              Ptr += Size;
+          }
+      }
+      if (VertexElement == nullptr || FaceElement == nullptr)
+        throw std::runtime_error {"Binary PLY: file has no vertices or faces"};
+
+      /* Vertices conversion */
+      std::vector<vec3<float>> Vertices(VertexElement->Count);
+
+      ParallelFor(Vertices.size(), [&]( size_t, size_t First, size_t Last )
+        {
+          for (size_t i {First}; i < Last; i++)
+          {
+            const char *Record {VertexData + i * VertexSize};
+
+            Vertices[i] =
+            {
+              ReadPlyValue<float>(Record + Offsets[0], CoordTypes[0], IsBigEndian),
+              ReadPlyValue<float>(Record + Offsets[1], CoordTypes[1], IsBigEndian),
+              ReadPlyValue<float>(Record + Offsets[2], CoordTypes[2], IsBigEndian),
+            };
+          }
+        }, std::clamp<size_t>(Vertices.size() * VertexSize / MinChunkSize, 1, ThreadsCount));
+
+      /* Face records walking: parts bounds and triangles counts */
+      const std::vector<ply_property> &FaceProps {FaceElement->Properties};
+      const size_t FacesCount {FaceElement->Count};
+      const size_t PartsCount {std::clamp<size_t>((size_t)(End - FaceData) / MinChunkSize, 1, ThreadsCount)};
+      std::vector<chunk> Chunks(PartsCount);
+      size_t Part {0};
+
+      Ptr = FaceData;
+      for (size_t i {0}; i < FacesCount; i++)
+      {
+        if (Part < PartsCount && i == FacesCount / PartsCount * Part)
+        {
+          Chunks[Part].First = (size_t)(Ptr - Begin);
+          if (Part > 0)
+            Chunks[Part - 1].End = Chunks[Part].First;
+          Part++;
+        }
+        for (size_t p {0}; p < FaceProps.size(); p++)
+        {
+          const ply_property &Property {FaceProps[p]};
+          const size_t Size {GetPlyTypeSize(Property.IsList ? Property.CountType : Property.Type)};
+
+          if ((size_t)(End - Ptr) < Size)
+            throw std::runtime_error {"Binary PLY: file is truncated"};
+          if (!Property.IsList)
+          {
+            Ptr += Size;
+            continue;
+          }
+
+          const size_t Length {ReadPlyValue<size_t>(Ptr, Property.CountType, IsBigEndian)};
+
+          if ((size_t)(End - Ptr - Size) / GetPlyTypeSize(Property.Type) < Length)
+            throw std::runtime_error {"Binary PLY: file is truncated"};
+          if (p == FaceList)
+          {
+            if (Length < 3)
+              throw std::runtime_error {"Binary PLY: face has less than 3 vertices"};
+            Chunks[Part - 1].TrianglesCount += Length - 2;
+          }
+          Ptr += Size + Length * GetPlyTypeSize(Property.Type);
+        }
+      }
+      Chunks.resize(Part);
+      if (!Chunks.empty())
+        Chunks.back().End = (size_t)(Ptr - Begin);
+
+      /* Faces triangulation, parts are bytes ranges of whole face records */
+      const size_t TrianglesCount {PrefixSums(Chunks).second};
+      triangle_soa Tris {};
+
+      Tris.Expand(TrianglesCount);
+      ProcessChunks(Chunks, [&]( chunk &Chunk )
+        {
+          const char *Record {Begin + Chunk.First};
+          size_t Index {Chunk.TrianglesCount};
+
+          while (Record < Begin + Chunk.End)
+            for (size_t p {0}; p < FaceProps.size(); p++)
+            {
+              const ply_property &Property {FaceProps[p]};
+              const size_t Size {GetPlyTypeSize(Property.IsList ? Property.CountType : Property.Type)};
+
+              if (!Property.IsList)
+              {
+                Record += Size;
+                continue;
+              }
+
+              const size_t Length {ReadPlyValue<size_t>(Record, Property.CountType, IsBigEndian)}, ItemSize {GetPlyTypeSize(Property.Type)};
+              const char *Items {Record + Size};
+
+              Record = Items + Length * ItemSize;
+              if (p != FaceList)
+                continue;
+
+              /* Polygon is triangulated as a fan around its first vertex */
+              size_t Refs[3];
+
+              for (size_t k {0}; k < Length; k++)
+              {
+                const int64_t Ref {ReadPlyValue<int64_t>(Items + k * ItemSize, Property.Type, IsBigEndian)};
+
+                if (Ref < 0 || Ref >= (int64_t)Vertices.size())
+                {
+                  Chunk.Error = "face vertex index is out of range", Chunk.ErrorPos = (size_t)(Items - Begin);
+                  return;
+                }
+                Refs[std::min<size_t>(k, 2)] = (size_t)Ref;
+                if (k >= 2)
+                {
+                  Tris.Set(Index++, Vertices[Refs[0]], Vertices[Refs[1]], Vertices[Refs[2]]);
+                  Refs[1] = Refs[2];
+                }
+              }
+            }
+        }, ThreadsCount, Name);
+      return Tris;
+    } /* End of 'ImportPly' function */
+  } /* end of 'mesh_import' namespace */
+
+  /* Mesh format detection by file contents function.
+   * ARGUMENTS:
+   *   - File data:
+   *       std::span<const char> Data;
+   * RETURNS:
+   *   (mesh_format) Detected format.
+   */
+  inline mesh_format DetectMeshFormat( std::span<const char> Data )
+  {
+    const std::string_view Text {Data.data(), std::min<size_t>(Data.size(), 4096)};
+
+    if (Text.starts_with("ply\n") || Text.starts_with("ply\r\n"))
+      return mesh_format::ePly;
+
+    /* Binary STL headers may start with 'solid' as well, so records count is checked first */
+    uint32_t Count {0};
+
+    if (Data.size() >= 84)
+    {
+      std::memcpy(&Count, Data.data() + 80, sizeof Count);
+      if (Data.size() == 84 + (uint64_t)Count * 50)
+        return mesh_format::eStlBinary;
+    }
+
+    /* Text formats have no NUL bytes, binary STL files may have trailing bytes after records */
+    if (Text.find('\0') == std::string_view::npos)
+    {
+      const size_t Start {Text.find_first_not_of(" \t\r\n")};
+
+      if (Start != std::string_view::npos && Text.substr(Start).starts_with("solid"))
+        return mesh_format::eStlAscii;
+      return mesh_format::eObj;
+    }
+    if (Data.size() >= 84 && (Data.size() - 84) / 50 >= Count)
+      return mesh_format::eStlBinary;
+    throw std::runtime_error {"Unknown mesh file format"};
+  } /* End of 'DetectMeshFormat' function */
+
+  /* Mesh importing from memory function.
+   * Text formats are cut into line aligned parts, every part is parsed by its own thread
+   * (count pass, then values pass), values go straight into the result streams.
+   * ARGUMENTS:
+   *   - File data:
+   *       std::span<const char> Data;
+   *   - File format:
+   *       mesh_format Format;
+   *   - Threads count (0 - hardware concurrency):
+   *       size_t ThreadsCount;
+   * RETURNS:
+   *   (triangle_soa) Triangles.
+   */
+  inline triangle_soa ImportMesh( std::span<const char> Data, mesh_format Format, size_t ThreadsCount = 0 )
+  {
+    ThreadsCount = GetThreadsCount(ThreadsCount);
+    switch (Format)
+    {
+    case mesh_format::eStlBinary:
+      return mesh_import::ImportStlBinary(Data, ThreadsCount);
+    case mesh_format::eStlAscii:
+      return mesh_import::ImportStlAscii(Data, ThreadsCount);
+    case mesh_format::eObj:
+      return mesh_import::ImportObj(Data, ThreadsCount);
+    case mesh_format::ePly:
+      return mesh_import::ImportPly(Data, ThreadsCount);
+    default:
+      throw std::out_of_range {"Invalid mesh format"};
+    }
+  } /* End of 'ImportMesh' function */
+
+  /* Mesh importing from memory function, format is detected by contents.
+   * ARGUMENTS:
+   *   - File data:
+   *       std::span<const char> Data;
+   *   - Threads count (0 - hardware concurrency):
+   *       size_t ThreadsCount;
+   * RETURNS:
+   *   (triangle_soa) Triangles.
+   */
+  inline triangle_soa ImportMesh( std::span<const char> Data, size_t ThreadsCount = 0 )
+  {
+    return ImportMesh(Data, DetectMeshFormat(Data), ThreadsCount);
+  } /* End of 'ImportMesh' function */
+
+  /* Mesh file importing function. File is memory mapped, so parts are read by their parsing threads.
+   * ARGUMENTS:
+   *   - File path:
+   *       const std::filesystem::path &Path;
+   *   - Threads count (0 - hardware concurrency):
+   *       size_t ThreadsCount;
+   * RETURNS:
+   *   (triangle_soa) Triangles.
+   */
+  inline triangle_soa ImportMesh( const std::filesystem::path &Path, size_t ThreadsCount = 0 )
+  {
+    const mapped_file File {Path};
+
+    return ImportMesh(File.GetText(), ThreadsCount);
+  } /* End of 'ImportMesh' function */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_import_hpp__ */
+
+/* END OF 'overlap_import.hpp' FILE */
@@ -0,0 +1,67 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_indexed.hpp" - Indexed triangle meshes input for batch tests */
+
+#ifndef __overlap_indexed_hpp__
+#define __overlap_indexed_hpp__
+
+#include "overlap_base.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Indexed triangle mesh (vertex buffer and triangle list index buffer), non-owning view.
+   * Kernels gather vertices by index, so the mesh is not expanded into a triangle soup:
+   * 12 bytes of indices per triangle plus shared vertices instead of 36 bytes. */
+  struct indexed_triangles_view
+  {
+    const float *Vertices {};    // Vertices coordinates, X, Y, Z of each vertex are consecutive
+    size_t VertexStride {3};     // Distance between consecutive vertices in floats, at least 3
+    size_t VertexCount {0};      // Vertices count, VertexCount * VertexStride must fit into int32_t (gather offsets are 32-bit)
+    const uint32_t *Indices {};  // Triangles vertices indices, 3 consecutive per triangle, all less than VertexCount
+    size_t Count {0};            // Triangles count
+
+    /* Vertex getting function.
+     * ARGUMENTS:
+     *   - Vertex index:
+     *       uint32_t Index;
+     * RETURNS:
+     *   (vec3<float>) Vertex.
+     */
+    constexpr vec3<float> GetVertex( uint32_t Index ) const noexcept
+    {
+      const float *V {Vertices + (size_t)Index * VertexStride};
+
+      return {V[0], V[1], V[2]};
+    } /* End of 'GetVertex' function */
+
+    /* Triangle getting function.
+     * ARGUMENTS:
+     *   - Triangle index:
+     *       size_t Index;
+     * RETURNS:
+     *   (triangle<float>) Triangle.
+     */
+    constexpr triangle<float> operator[]( size_t Index ) const noexcept
+    {
+      return {GetVertex(Indices[Index * 3]), GetVertex(Indices[Index * 3 + 1]), GetVertex(Indices[Index * 3 + 2])};
+    } /* End of 'operator[]' function */
+  }; /* end of 'indexed_triangles_view' structure */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_indexed_hpp__ */
+
+/* END OF 'overlap_indexed.hpp' FILE */
@@ -0,0 +1,1763 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_kernels.inl" - Instruction set independent SIMD overlap kernels.
+ * Included into each 'math::<isa>' namespace after its 'simd' operations structure,
+ * so it is compiled once per instruction set. No include guard is intended. */
+
+/* 3 component vectors pack */
+struct vec3x
+{
+  simd::vec X, Y, Z; // Components
+}; /* end of 'vec3x' structure */
+
+/* Vectors subtraction function.
+ * ARGUMENTS:
+ *   - Operands:
+ *       const vec3x &A, &B;
+ * RETURNS:
+ *   (vec3x) Difference.
+ */
+inline vec3x Sub( const vec3x &A, const vec3x &B ) noexcept
+{
+  return {simd::Sub(A.X, B.X), simd::Sub(A.Y, B.Y), simd::Sub(A.Z, B.Z)};
+} /* End of 'Sub' function */
+
+/* Broadcasted vector creation function.
+ * ARGUMENTS:
+ *   - Vector:
+ *       const vec3<float> &V;
+ * RETURNS:
+ *   (vec3x) Pack of equal vectors.
+ */
+inline vec3x Set1( const vec3<float> &V ) noexcept
+{
+  return {simd::Set1(V.X), simd::Set1(V.Y), simd::Set1(V.Z)};
+} /* End of 'Set1' function */
+
+/* Separating axis mask by two projected triangle vertices (see scalar 'IsSeparatingAxis').
+ * ARGUMENTS:
+ *   - Triangle vertices projections:
+ *       simd::vec P0, P1;
+ *   - Box projection radius:
+ *       simd::vec Rad;
+ * RETURNS:
+ *   (simd::mask) Lanes, where axis separates box and triangle.
+ */
+inline simd::mask SeparatingAxisMask( simd::vec P0, simd::vec P1, simd::vec Rad ) noexcept
+{
+  return simd::Or(simd::Greater(simd::Min(P0, P1), Rad), simd::Less(simd::Max(P0, P1), simd::Neg(Rad)));
+} /* End of 'SeparatingAxisMask' function */
+
+/* Edge cross products with X, Y and Z box axes separation mask function.
+ * ARGUMENTS:
+ *   - Triangle edge:
+ *       const vec3x &E;
+ *   - Two triangle vertices, having different projections:
+ *       const vec3x &A, &B;
+ *   - Box half size:
+ *       const vec3x &H;
+ * RETURNS:
+ *   (simd::mask) Separation mask.
+ */
+inline simd::mask EdgeAxesMask( const vec3x &E, const vec3x &A, const vec3x &B, const vec3x &H ) noexcept
+{
+  const vec3x F {simd::Abs(E.X), simd::Abs(E.Y), simd::Abs(E.Z)};
+
+  const simd::mask SepX {SeparatingAxisMask(
+    simd::FMSub(E.Z, A.Y, simd::Mul(E.Y, A.Z)),
+    simd::FMSub(E.Z, B.Y, simd::Mul(E.Y, B.Z)),
+    simd::FMAdd(F.Z, H.Y, simd::Mul(F.Y, H.Z)))};
+  const simd::mask SepY {SeparatingAxisMask(
+    simd::FMSub(E.X, A.Z, simd::Mul(E.Z, A.X)),
+    simd::FMSub(E.X, B.Z, simd::Mul(E.Z, B.X)),
+    simd::FMAdd(F.Z, H.X, simd::Mul(F.X, H.Z)))};
+  const simd::mask SepZ {SeparatingAxisMask(
+    simd::FMSub(E.Y, A.X, simd::Mul(E.X, A.Y)),
+    simd::FMSub(E.Y, B.X, simd::Mul(E.X, B.Y)),
+    simd::FMAdd(F.Y, H.X, simd::Mul(F.X, H.Y)))};
+
+  return simd::Or(SepX, simd::Or(SepY, SepZ));
+} /* End of 'EdgeAxesMask' function */
+
+/* Single box face normal separation mask function.
+ * ARGUMENTS:
+ *   - Box center relative triangle vertices coordinates:
+ *       simd::vec A, B, C;
+ *   - Box half size along axis:
+ *       simd::vec H;
+ * RETURNS:
+ *   (simd::mask) Separation mask.
+ */
+inline simd::mask BoxAxisMask( simd::vec A, simd::vec B, simd::vec C, simd::vec H ) noexcept
+{
+  return simd::Or(simd::Greater(simd::Min(A, simd::Min(B, C)), H), simd::Less(simd::Max(A, simd::Max(B, C)), simd::Neg(H)));
+} /* End of 'BoxAxisMask' function */
+
+/* Box face normals separation mask function.
+ * ARGUMENTS:
+ *   - Box center relative triangle vertices:
+ *       const vec3x &V0, &V1, &V2;
+ *   - Box half size:
+ *       const vec3x &H;
+ * RETURNS:
+ *   (simd::mask) Separation mask.
+ */
+inline simd::mask BoxAxesMask( const vec3x &V0, const vec3x &V1, const vec3x &V2, const vec3x &H ) noexcept
+{
+  return simd::Or(BoxAxisMask(V0.X, V1.X, V2.X, H.X),
+                  simd::Or(BoxAxisMask(V0.Y, V1.Y, V2.Y, H.Y), BoxAxisMask(V0.Z, V1.Z, V2.Z, H.Z)));
+} /* End of 'BoxAxesMask' function */
+
+/* Triangle plane separation mask function.
+ * ARGUMENTS:
+ *   - Box center relative first triangle vertex:
+ *       const vec3x &V0;
+ *   - Triangle edges:
+ *       const vec3x &E0, &E1;
+ *   - Box half size:
+ *       const vec3x &H;
+ * RETURNS:
+ *   (simd::mask) Separation mask.
+ */
+inline simd::mask PlaneAxisMask( const vec3x &V0, const vec3x &E0, const vec3x &E1, const vec3x &H ) noexcept
+{
+  const vec3x N
+  {
+    simd::FMSub(E0.Y, E1.Z, simd::Mul(E0.Z, E1.Y)),
+    simd::FMSub(E0.Z, E1.X, simd::Mul(E0.X, E1.Z)),
+    simd::FMSub(E0.X, E1.Y, simd::Mul(E0.Y, E1.X)),
+  };
+
+  const simd::vec Dist {simd::FMAdd(N.X, V0.X, simd::FMAdd(N.Y, V0.Y, simd::Mul(N.Z, V0.Z)))};
+  const simd::vec Rad {simd::FMAdd(simd::Abs(N.X), H.X, simd::FMAdd(simd::Abs(N.Y), H.Y, simd::Mul(simd::Abs(N.Z), H.Z)))};
+
+  return simd::Greater(simd::Abs(Dist), Rad);
+} /* End of 'PlaneAxisMask' function */
+
+/* Pack lanes rejection by axes group function.
+ * ARGUMENTS:
+ *   - Axes group, template parameter:
+ *       axes_group Group;
+ *   - Pack separating axes (provides 'EdgeMask(i)', 'BoxMask()' and 'PlaneMask()'):
+ *       const axes &Axes;
+ *   - Alive lanes mask, updated:
+ *       simd::mask &Alive;
+ * RETURNS:
+ *   (bool) true if all lanes are rejected.
+ */
+template<axes_group Group, class axes>
+  bool RejectGroup( const axes &Axes, simd::mask &Alive ) noexcept
+  {
+    if constexpr (Group == axes_group::eEdges)
+    {
+      /* Every edge is a separate step, so packs rejected by the first one do not pay for the rest */
+      for (size_t i {0}; i < 3; i++)
+      {
+        Alive = simd::AndNot(Axes.EdgeMask(i), Alive);
+        if (simd::None(Alive))
+          return true;
+      }
+      return false;
+    }
+    else if constexpr (Group == axes_group::eBox)
+      Alive = simd::AndNot(Axes.BoxMask(), Alive);
+    else
+      Alive = simd::AndNot(Axes.PlaneMask(), Alive);
+    return simd::None(Alive);
+  } /* End of 'RejectGroup' function */
+
+/* Pack separating axes test function.
+ * Lanes are masked branchlessly, function returns as soon as all of them are rejected.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order (not 'eDefault'), template parameter:
+ *       axes_order Order;
+ *   - Pack separating axes:
+ *       const axes &Axes;
+ *   - Initial alive lanes mask (i.e. valid elements):
+ *       simd::mask Alive;
+ * RETURNS:
+ *   (uint32_t) Overlap bit mask, bit i corresponds to i-th lane.
+ */
+template<axes_order Order, class axes>
+  uint32_t TestAxes( const axes &Axes, simd::mask Alive ) noexcept
+  {
+    constexpr std::array<axes_group, 3> Groups {GetAxesGroups(Order)};
+
+    if (RejectGroup<Groups[0]>(Axes, Alive) || RejectGroup<Groups[1]>(Axes, Alive) || RejectGroup<Groups[2]>(Axes, Alive))
+      return 0;
+    return simd::Bits(Alive);
+  } /* End of 'TestAxes' function */
+
+/* Evaluation order resolving function.
+ * ARGUMENTS:
+ *   - Requested order:
+ *       axes_order Order;
+ *   - Kernel default order:
+ *       axes_order Default;
+ * RETURNS:
+ *   (axes_order) Order to use.
+ */
+constexpr axes_order ResolveOrder( axes_order Order, axes_order Default ) noexcept
+{
+  return Order == axes_order::eDefault ? Default : Order;
+} /* End of 'ResolveOrder' function */
+
+/* Box against triangles pack separating axes */
+struct box_triangles_axes
+{
+  const vec3x &H;                 // Box half size
+  vec3x V0, V1, V2;               // Box center relative triangle vertices
+  vec3x E0 {Sub(V1, V0)}, E1 {Sub(V2, V1)}, E2 {Sub(V0, V2)}; // Triangle edges
+
+  /* Edge cross products with box axes separation mask getting function.
+   * ARGUMENTS:
+   *   - Edge index:
+   *       size_t Index;
+   * RETURNS:
+   *   (simd::mask) Separation mask.
+   */
+  simd::mask EdgeMask( size_t Index ) const noexcept
+  {
+    return Index == 0 ? EdgeAxesMask(E0, V0, V2, H) : Index == 1 ? EdgeAxesMask(E1, V0, V1, H) : EdgeAxesMask(E2, V0, V1, H);
+  } /* End of 'EdgeMask' function */
+
+  /* Box face normals separation mask getting function.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (simd::mask) Separation mask.
+   */
+  simd::mask BoxMask( void ) const noexcept
+  {
+    return BoxAxesMask(V0, V1, V2, H);
+  } /* End of 'BoxMask' function */
+
+  /* Triangle plane separation mask getting function.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (simd::mask) Separation mask.
+   */
+  simd::mask PlaneMask( void ) const noexcept
+  {
+    return PlaneAxisMask(V0, E0, E1, H);
+  } /* End of 'PlaneMask' function */
+}; /* end of 'box_triangles_axes' structure */
+
+/* Box against triangles pack overlap test function.
+ * Classic order is the default: edges, box face normals, plane.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box center and half size (broadcasted, or boxes ones against a broadcast triangle):
+ *       const vec3x &C, &H;
+ *   - Triangles vertices:
+ *       const vec3x &P0, &P1, &P2;
+ *   - Initial alive lanes mask (i.e. valid triangles):
+ *       simd::mask Alive;
+ * RETURNS:
+ *   (uint32_t) Overlap bit mask, bit i corresponds to i-th lane.
+ */
+template<axes_order Order>
+  uint32_t BoxTriangles( const vec3x &C, const vec3x &H, const vec3x &P0, const vec3x &P1, const vec3x &P2, simd::mask Alive ) noexcept
+  {
+    /* Move everything so that box center is in the origin */
+    const box_triangles_axes Axes {H, Sub(P0, C), Sub(P1, C), Sub(P2, C)};
+
+    return TestAxes<ResolveOrder(Order, axes_order::eEdgesFirst)>(Axes, Alive);
+  } /* End of 'BoxTriangles' function */
+
+/* Outside of interval, given by center and half width, check function.
+ * ARGUMENTS:
+ *   - Projections:
+ *       simd::vec P;
+ *   - Interval center and half width:
+ *       simd::vec Mid, Rad;
+ * RETURNS:
+ *   (simd::mask) Separation mask.
+ */
+inline simd::mask OutsideMask( simd::vec P, simd::vec Mid, simd::vec Rad ) noexcept
+{
+  return simd::Greater(simd::Abs(simd::Sub(P, Mid)), Rad);
+} /* End of 'OutsideMask' function */
+
+/* Box against prepared triangles pack separating axes */
+struct box_prepared_triangles_axes
+{
+  const vec3x &C, &H;                   // Box center and half size
+  const prepared_triangles_view &Tris;  // Prepared triangles
+  size_t First;                         // First pack triangle index
+
+  /* Edge cross products with box axes separation mask getting function.
+   * ARGUMENTS:
+   *   - Edge index:
+   *       size_t Index;
+   * RETURNS:
+   *   (simd::mask) Separation mask.
+   */
+  simd::mask EdgeMask( size_t Index ) const noexcept
+  {
+    const size_t i {Index};
+    const vec3x
+      E {simd::Load(Tris.Edges[i * 3] + First), simd::Load(Tris.Edges[i * 3 + 1] + First), simd::Load(Tris.Edges[i * 3 + 2] + First)},
+      F {simd::Load(Tris.AbsEdges[i * 3] + First), simd::Load(Tris.AbsEdges[i * 3 + 1] + First), simd::Load(Tris.AbsEdges[i * 3 + 2] + First)};
+
+    return simd::Or(
+      OutsideMask(simd::FMSub(E.Z, C.Y, simd::Mul(E.Y, C.Z)), simd::Load(Tris.AxesMid[i * 3] + First),
+        simd::FMAdd(F.Z, H.Y, simd::FMAdd(F.Y, H.Z, simd::Load(Tris.AxesHalf[i * 3] + First)))),
+      simd::Or(
+        OutsideMask(simd::FMSub(E.X, C.Z, simd::Mul(E.Z, C.X)), simd::Load(Tris.AxesMid[i * 3 + 1] + First),
+          simd::FMAdd(F.Z, H.X, simd::FMAdd(F.X, H.Z, simd::Load(Tris.AxesHalf[i * 3 + 1] + First)))),
+        OutsideMask(simd::FMSub(E.Y, C.X, simd::Mul(E.X, C.Y)), simd::Load(Tris.AxesMid[i * 3 + 2] + First),
+          simd::FMAdd(F.Y, H.X, simd::FMAdd(F.X, H.Y, simd::Load(Tris.AxesHalf[i * 3 + 2] + First))))));
+  } /* End of 'EdgeMask' function */
+
+  /* Box face normals separation mask getting function.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (simd::mask) Separation mask.
+   */
+  simd::mask BoxMask( void ) const noexcept
+  {
+    return simd::Or(
+      OutsideMask(C.X, simd::Load(Tris.BoundsMid[0] + First), simd::Add(simd::Load(Tris.BoundsHalf[0] + First), H.X)),
+      simd::Or(
+        OutsideMask(C.Y, simd::Load(Tris.BoundsMid[1] + First), simd::Add(simd::Load(Tris.BoundsHalf[1] + First), H.Y)),
+        OutsideMask(C.Z, simd::Load(Tris.BoundsMid[2] + First), simd::Add(simd::Load(Tris.BoundsHalf[2] + First), H.Z))));
+  } /* End of 'BoxMask' function */
+
+  /* Triangle plane separation mask getting function.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (simd::mask) Separation mask.
+   */
+  simd::mask PlaneMask( void ) const noexcept
+  {
+    const vec3x
+      N {simd::Load(Tris.Normal[0] + First), simd::Load(Tris.Normal[1] + First), simd::Load(Tris.Normal[2] + First)},
+      AbsN {simd::Load(Tris.AbsNormal[0] + First), simd::Load(Tris.AbsNormal[1] + First), simd::Load(Tris.AbsNormal[2] + First)};
+
+    return OutsideMask(simd::FMAdd(N.X, C.X, simd::FMAdd(N.Y, C.Y, simd::Mul(N.Z, C.Z))), simd::Load(Tris.PlaneD + First),
+                       simd::FMAdd(AbsN.X, H.X, simd::FMAdd(AbsN.Y, H.Y, simd::Mul(AbsN.Z, H.Z))));
+  } /* End of 'PlaneMask' function */
+}; /* end of 'box_prepared_triangles_axes' structure */
+
+/* Box against prepared triangles pack overlap test function.
+ * Box face normals go first by default: they are the cheapest and reject the most for small
+ * query boxes, so rejected packs do not touch edge streams at all.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box center and half size (broadcasted):
+ *       const vec3x &C, &H;
+ *   - Prepared triangles:
+ *       const prepared_triangles_view &Tris;
+ *   - First pack triangle index:
+ *       size_t First;
+ *   - Initial alive lanes mask (i.e. valid triangles):
+ *       simd::mask Alive;
+ * RETURNS:
+ *   (uint32_t) Overlap bit mask, bit i corresponds to i-th lane.
+ */
+template<axes_order Order>
+  uint32_t BoxPreparedTriangles( const vec3x &C, const vec3x &H, const prepared_triangles_view &Tris, size_t First, simd::mask Alive ) noexcept
+  {
+    return TestAxes<ResolveOrder(Order, axes_order::eBoxFirst)>(box_prepared_triangles_axes {C, H, Tris, First}, Alive);
+  } /* End of 'BoxPreparedTriangles' function */
+
+/* Box and triangles pack classification bits */
+struct class_bits
+{
+  uint32_t Overlap;   // Overlapping triangles (contained ones included)
+  uint32_t Contained; // Triangles entirely inside box
+}; /* end of 'class_bits' structure */
+
+/* Box against triangles pack classification function (see scalar 'BoxTriangleClassify').
+ * Contained lanes are known to overlap, so they are excluded from separating axes tests.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box center and half size (broadcasted):
+ *       const vec3x &C, &H;
+ *   - Triangles vertices:
+ *       const vec3x &P0, &P1, &P2;
+ *   - Initial alive lanes mask (i.e. valid triangles):
+ *       simd::mask Alive;
+ * RETURNS:
+ *   (class_bits) Overlap and containment bit masks, bit i corresponds to i-th lane.
+ */
+template<axes_order Order>
+  class_bits BoxTrianglesClasses( const vec3x &C, const vec3x &H, const vec3x &P0, const vec3x &P1, const vec3x &P2, simd::mask Alive ) noexcept
+  {
+    const vec3x V0 {Sub(P0, C)}, V1 {Sub(P1, C)}, V2 {Sub(P2, C)};
+
+    const simd::mask Out {simd::Or(
+      simd::Greater(simd::Max(simd::Abs(V0.X), simd::Max(simd::Abs(V1.X), simd::Abs(V2.X))), H.X),
+      simd::Or(
+        simd::Greater(simd::Max(simd::Abs(V0.Y), simd::Max(simd::Abs(V1.Y), simd::Abs(V2.Y))), H.Y),
+        simd::Greater(simd::Max(simd::Abs(V0.Z), simd::Max(simd::Abs(V1.Z), simd::Abs(V2.Z))), H.Z)))};
+    const simd::mask Inside {simd::AndNot(Out, Alive)};
+    const uint32_t Contained {simd::Bits(Inside)};
+
+    return {Contained | BoxTriangles<Order>(C, H, P0, P1, P2, simd::AndNot(Inside, Alive)), Contained};
+  } /* End of 'BoxTrianglesClasses' function */
+
+/* Box against prepared triangles pack classification function (see scalar 'BoxPreparedTriangleClassify').
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box center and half size (broadcasted):
+ *       const vec3x &C, &H;
+ *   - Prepared triangles:
+ *       const prepared_triangles_view &Tris;
+ *   - First pack triangle index:
+ *       size_t First;
+ *   - Initial alive lanes mask (i.e. valid triangles):
+ *       simd::mask Alive;
+ * RETURNS:
+ *   (class_bits) Overlap and containment bit masks, bit i corresponds to i-th lane.
+ */
+template<axes_order Order>
+  class_bits BoxPreparedTrianglesClasses( const vec3x &C, const vec3x &H, const prepared_triangles_view &Tris, size_t First, simd::mask Alive ) noexcept
+  {
+    const simd::mask Out {simd::Or(
+      OutsideMask(C.X, simd::Load(Tris.BoundsMid[0] + First), simd::Sub(H.X, simd::Load(Tris.BoundsHalf[0] + First))),
+      simd::Or(
+        OutsideMask(C.Y, simd::Load(Tris.BoundsMid[1] + First), simd::Sub(H.Y, simd::Load(Tris.BoundsHalf[1] + First))),
+        OutsideMask(C.Z, simd::Load(Tris.BoundsMid[2] + First), simd::Sub(H.Z, simd::Load(Tris.BoundsHalf[2] + First)))))};
+    const simd::mask Inside {simd::AndNot(Out, Alive)};
+    const uint32_t Contained {simd::Bits(Inside)};
+
+    return {Contained | BoxPreparedTriangles<Order>(C, H, Tris, First, simd::AndNot(Inside, Alive)), Contained};
+  } /* End of 'BoxPreparedTrianglesClasses' function */
+
+/* Outside of interval check function.
+ * ARGUMENTS:
+ *   - Projections:
+ *       simd::vec P;
+ *   - Interval:
+ *       const triangle_boxes_setup<float>::interval &I;
+ * RETURNS:
+ *   (simd::mask) Separation mask.
+ */
+inline simd::mask OutsideMask( simd::vec P, const triangle_boxes_setup<float>::interval &I ) noexcept
+{
+  return simd::Or(simd::Less(P, simd::Set1(I.Lo)), simd::Greater(P, simd::Set1(I.Hi)));
+} /* End of 'OutsideMask' function */
+
+/* Triangle against equally sized boxes pack separating axes */
+struct triangle_boxes_axes
+{
+  const triangle_boxes_setup<float> &Tri; // Prepared triangle
+  const vec3x &C;                         // Box centers
+
+  /* Edge cross products with box axes separation mask getting function.
+   * ARGUMENTS:
+   *   - Edge index:
+   *       size_t Index;
+   * RETURNS:
+   *   (simd::mask) Separation mask.
+   */
+  simd::mask EdgeMask( size_t Index ) const noexcept
+  {
+    const vec3x E {Set1(Tri.Edges[Index])};
+
+    return simd::Or(
+      OutsideMask(simd::FMSub(E.Z, C.Y, simd::Mul(E.Y, C.Z)), Tri.EdgeAxes[Index][0]),
+      simd::Or(
+        OutsideMask(simd::FMSub(E.X, C.Z, simd::Mul(E.Z, C.X)), Tri.EdgeAxes[Index][1]),
+        OutsideMask(simd::FMSub(E.Y, C.X, simd::Mul(E.X, C.Y)), Tri.EdgeAxes[Index][2])));
+  } /* End of 'EdgeMask' function */
+
+  /* Box face normals separation mask getting function.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (simd::mask) Separation mask.
+   */
+  simd::mask BoxMask( void ) const noexcept
+  {
+    return simd::Or(OutsideMask(C.X, Tri.BoxAxes[0]), simd::Or(OutsideMask(C.Y, Tri.BoxAxes[1]), OutsideMask(C.Z, Tri.BoxAxes[2])));
+  } /* End of 'BoxMask' function */
+
+  /* Triangle plane separation mask getting function.
+   * ARGUMENTS: None.
+   * RETURNS:
+   *   (simd::mask) Separation mask.
+   */
+  simd::mask PlaneMask( void ) const noexcept
+  {
+    const vec3x N {Set1(Tri.Normal)};
+
+    return OutsideMask(simd::FMAdd(N.X, C.X, simd::FMAdd(N.Y, C.Y, simd::Mul(N.Z, C.Z))), Tri.Plane);
+  } /* End of 'PlaneMask' function */
+}; /* end of 'triangle_boxes_axes' structure */
+
+/* Triangle against equally sized boxes pack overlap test function.
+ * Plane is tested first by default: for cells inside triangle bounds it rejects the most,
+ * box face normals almost never reject there, so they go last.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Prepared triangle:
+ *       const triangle_boxes_setup<float> &Tri;
+ *   - Box centers:
+ *       const vec3x &C;
+ *   - Initial alive lanes mask (i.e. valid boxes):
+ *       simd::mask Alive;
+ * RETURNS:
+ *   (uint32_t) Overlap bit mask, bit i corresponds to i-th lane.
+ */
+template<axes_order Order>
+  uint32_t TriangleBoxes( const triangle_boxes_setup<float> &Tri, const vec3x &C, simd::mask Alive ) noexcept
+  {
+    return TestAxes<ResolveOrder(Order, axes_order::ePlaneFirst)>(triangle_boxes_axes {Tri, C}, Alive);
+  } /* End of 'TriangleBoxes' function */
+
+/* Box against general triangles bucket pack overlap test function.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box center and half size (broadcasted):
+ *       const vec3x &C, &H;
+ *   - Bucket streams (see 'triangles_bucket_view'):
+ *       const simd::vec *S;
+ *   - Initial alive lanes mask (i.e. valid triangles):
+ *       simd::mask Alive;
+ * RETURNS:
+ *   (uint32_t) Overlap bit mask, bit i corresponds to i-th lane.
+ */
+template<axes_order Order>
+  uint32_t BoxGeneralTriangles( const vec3x &C, const vec3x &H, const simd::vec *S, simd::mask Alive ) noexcept
+  {
+    return BoxTriangles<Order>(C, H, {S[0], S[1], S[2]}, {S[3], S[4], S[5]}, {S[6], S[7], S[8]}, Alive);
+  } /* End of 'BoxGeneralTriangles' function */
+
+/* Box against axis aligned triangles bucket pack overlap test function (see scalar 'BoxAlignedTriangleOverlapTest').
+ * ARGUMENTS:
+ *   - Box center and half size in plane coordinates (broadcasted):
+ *       const vec3x &C, &H;
+ *   - Bucket streams (U of vertices, V of vertices, W):
+ *       const simd::vec *S;
+ *   - Initial alive lanes mask (i.e. valid triangles):
+ *       simd::mask Alive;
+ * RETURNS:
+ *   (uint32_t) Overlap bit mask, bit i corresponds to i-th lane.
+ */
+inline uint32_t BoxAlignedTriangles( const vec3x &C, const vec3x &H, const simd::vec *S, simd::mask Alive ) noexcept
+{
+  const simd::vec
+    U[3] {simd::Sub(S[0], C.X), simd::Sub(S[1], C.X), simd::Sub(S[2], C.X)},
+    V[3] {simd::Sub(S[3], C.Y), simd::Sub(S[4], C.Y), simd::Sub(S[5], C.Y)};
+
+  /* Box face normals */
+  Alive = simd::AndNot(simd::Or(simd::Greater(simd::Abs(simd::Sub(S[6], C.Z)), H.Z),
+                                simd::Or(BoxAxisMask(U[0], U[1], U[2], H.X), BoxAxisMask(V[0], V[1], V[2], H.Y))), Alive);
+  if (simd::None(Alive))
+    return 0;
+
+  /* In-plane edge normals */
+  for (size_t i {0}; i < 3; i++)
+  {
+    const size_t j {(i + 1) % 3}, k {(i + 2) % 3};
+    const simd::vec EU {simd::Sub(U[j], U[i])}, EV {simd::Sub(V[j], V[i])};
+
+    Alive = simd::AndNot(SeparatingAxisMask(
+      simd::FMSub(EV, U[i], simd::Mul(EU, V[i])),
+      simd::FMSub(EV, U[k], simd::Mul(EU, V[k])),
+      simd::FMAdd(simd::Abs(EV), H.X, simd::Mul(simd::Abs(EU), H.Y))), Alive);
+  }
+  return simd::Bits(Alive);
+} /* End of 'BoxAlignedTriangles' function */
+
+/* Box against segments bucket pack overlap test function (see scalar 'BoxSegmentOverlapTest').
+ * ARGUMENTS:
+ *   - Box center and half size (broadcasted):
+ *       const vec3x &C, &H;
+ *   - Bucket streams (first and second ends coordinates):
+ *       const simd::vec *S;
+ *   - Initial alive lanes mask (i.e. valid segments):
+ *       simd::mask Alive;
+ * RETURNS:
+ *   (uint32_t) Overlap bit mask, bit i corresponds to i-th lane.
+ */
+inline uint32_t BoxSegments( const vec3x &C, const vec3x &H, const simd::vec *S, simd::mask Alive ) noexcept
+{
+  const vec3x P {Sub({S[0], S[1], S[2]}, C)}, Q {Sub({S[3], S[4], S[5]}, C)}, D {Sub(Q, P)};
+  const vec3x F {simd::Abs(D.X), simd::Abs(D.Y), simd::Abs(D.Z)};
+
+  /* Box face normals */
+  Alive = simd::AndNot(simd::Or(SeparatingAxisMask(P.X, Q.X, H.X),
+                                simd::Or(SeparatingAxisMask(P.Y, Q.Y, H.Y), SeparatingAxisMask(P.Z, Q.Z, H.Z))), Alive);
+  if (simd::None(Alive))
+    return 0;
+
+  /* Segment direction cross box axes */
+  Alive = simd::AndNot(simd::Or(
+    simd::Greater(simd::Abs(simd::FMSub(D.Z, P.Y, simd::Mul(D.Y, P.Z))), simd::FMAdd(F.Z, H.Y, simd::Mul(F.Y, H.Z))),
+    simd::Or(
+      simd::Greater(simd::Abs(simd::FMSub(D.X, P.Z, simd::Mul(D.Z, P.X))), simd::FMAdd(F.Z, H.X, simd::Mul(F.X, H.Z))),
+      simd::Greater(simd::Abs(simd::FMSub(D.Y, P.X, simd::Mul(D.X, P.Y))), simd::FMAdd(F.Y, H.X, simd::Mul(F.X, H.Y))))), Alive);
+  return simd::Bits(Alive);
+} /* End of 'BoxSegments' function */
+
+/* Box against points bucket pack overlap test function.
+ * ARGUMENTS:
+ *   - Box center and half size (broadcasted):
+ *       const vec3x &C, &H;
+ *   - Bucket streams (coordinates):
+ *       const simd::vec *S;
+ *   - Initial alive lanes mask (i.e. valid points):
+ *       simd::mask Alive;
+ * RETURNS:
+ *   (uint32_t) Overlap bit mask, bit i corresponds to i-th lane.
+ */
+inline uint32_t BoxPoints( const vec3x &C, const vec3x &H, const simd::vec *S, simd::mask Alive ) noexcept
+{
+  return simd::Bits(simd::AndNot(simd::Or(OutsideMask(S[0], C.X, H.X), simd::Or(OutsideMask(S[1], C.Y, H.Y), OutsideMask(S[2], C.Z, H.Z))), Alive));
+} /* End of 'BoxPoints' function */
+
+/* Overlap bit masks output */
+struct masks_sink
+{
+  std::span<uint8_t> Masks; // Output, one bit per element
+  size_t Count;             // Total elements count
+
+  /* Pack overlap bits storing function.
+   * ARGUMENTS:
+   *   - Index of the first pack element (multiple of pack width):
+   *       size_t First;
+   *   - Pack overlap bits:
+   *       uint32_t Bits;
+   * RETURNS: None.
+   */
+  void Put( size_t First, uint32_t Bits ) noexcept
+  {
+    if constexpr (simd::Width < 8)
+    {
+      uint8_t &Byte {Masks[First / 8]};
+
+      Byte = (uint8_t)((First % 8 == 0 ? 0 : Byte) | (Bits << (First % 8)));
+    }
+    else
+      for (size_t i {First / 8}, End {std::min(First + simd::Width, Count + 7) / 8}; i < End; i++, Bits >>= 8)
+        Masks[i] = (uint8_t)Bits;
+  } /* End of 'Put' function */
+}; /* end of 'masks_sink' structure */
+
+/* Compacted overlapping elements indices output */
+struct indices_sink
+{
+  std::span<uint32_t> Indices; // Output, at least elements count long
+  uint32_t IndexBase;          // Value added to every written index
+  size_t Written {0};          // Written indices count
+
+  /* Pack overlapping indices storing function.
+   * ARGUMENTS:
+   *   - Index of the first pack element:
+   *       size_t First;
+   *   - Pack overlap bits:
+   *       uint32_t Bits;
+   * RETURNS: None.
+   */
+  void Put( size_t First, uint32_t Bits ) noexcept
+  {
+    /* Whole pack is always stored, so it is done only while it fits */
+    if (Written + simd::Width <= Indices.size())
+      simd::CompressStore(Indices.data() + Written, IndexBase + (uint32_t)First, Bits);
+    else
+    {
+      size_t Pos {Written};
+
+      for (uint32_t Rest {Bits}; Rest != 0; Rest &= Rest - 1)
+        Indices[Pos++] = IndexBase + (uint32_t)First + (uint32_t)std::countr_zero(Rest);
+    }
+    Written += (size_t)std::popcount(Bits);
+  } /* End of 'Put' function */
+}; /* end of 'indices_sink' structure */
+
+/* Overlap and containment bit masks output */
+struct classes_sink
+{
+  masks_sink Overlap;   // Overlapping elements masks
+  masks_sink Contained; // Contained elements masks
+
+  /* Pack classification bits storing function.
+   * ARGUMENTS:
+   *   - Index of the first pack element (multiple of pack width):
+   *       size_t First;
+   *   - Pack classification bits:
+   *       class_bits Bits;
+   * RETURNS: None.
+   */
+  void Put( size_t First, class_bits Bits ) noexcept
+  {
+    Overlap.Put(First, Bits.Overlap);
+    Contained.Put(First, Bits.Contained);
+  } /* End of 'Put' function */
+}; /* end of 'classes_sink' structure */
+
+/* Box against triangles set processing function.
+ * ARGUMENTS:
+ *   - Pack test ('BoxTriangles' or 'BoxTrianglesClasses'), template parameter:
+ *       auto PackTest;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Triangles:
+ *       const triangles_soa_view<float> &Tris;
+ *   - Packs results receiver ('masks_sink', 'indices_sink' or 'classes_sink'):
+ *       sink &Sink;
+ * RETURNS: None.
+ */
+template<auto PackTest, class sink>
+  void BoxTrianglesPacks( const aabb<float> &Box, const triangles_soa_view<float> &Tris, sink &Sink ) noexcept
+  {
+    const vec3x C {Set1(Box.Center)}, H {Set1(Box.HalfSize)};
+    const size_t FullCount {Tris.Count - Tris.Count % simd::Width};
+
+    for (size_t i {0}; i < FullCount; i += simd::Width)
+      Sink.Put(i, PackTest(C, H,
+        {simd::Load(Tris.X[0] + i), simd::Load(Tris.Y[0] + i), simd::Load(Tris.Z[0] + i)},
+        {simd::Load(Tris.X[1] + i), simd::Load(Tris.Y[1] + i), simd::Load(Tris.Z[1] + i)},
+        {simd::Load(Tris.X[2] + i), simd::Load(Tris.Y[2] + i), simd::Load(Tris.Z[2] + i)},
+        simd::All()));
+
+    /* Remaining triangles are loaded partially to stay inside arrays */
+    if (const size_t Rest {Tris.Count - FullCount}; Rest != 0)
+    {
+      const size_t i {FullCount};
+
+      Sink.Put(i, PackTest(C, H,
+        {simd::LoadFirst(Tris.X[0] + i, Rest), simd::LoadFirst(Tris.Y[0] + i, Rest), simd::LoadFirst(Tris.Z[0] + i, Rest)},
+        {simd::LoadFirst(Tris.X[1] + i, Rest), simd::LoadFirst(Tris.Y[1] + i, Rest), simd::LoadFirst(Tris.Z[1] + i, Rest)},
+        {simd::LoadFirst(Tris.X[2] + i, Rest), simd::LoadFirst(Tris.Y[2] + i, Rest), simd::LoadFirst(Tris.Z[2] + i, Rest)},
+        simd::First(Rest)));
+    }
+  } /* End of 'BoxTrianglesPacks' function */
+
+/* Box against prepared triangles set processing function.
+ * ARGUMENTS:
+ *   - Pack test ('BoxPreparedTriangles' or 'BoxPreparedTrianglesClasses'), template parameter:
+ *       auto PackTest;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Prepared triangles (streams are padded, so tail pack is loaded entirely):
+ *       const prepared_triangles_view &Tris;
+ *   - Packs results receiver ('masks_sink', 'indices_sink' or 'classes_sink'):
+ *       sink &Sink;
+ * RETURNS: None.
+ */
+template<auto PackTest, class sink>
+  void BoxPreparedTrianglesPacks( const aabb<float> &Box, const prepared_triangles_view &Tris, sink &Sink ) noexcept
+  {
+    const vec3x C {Set1(Box.Center)}, H {Set1(Box.HalfSize)};
+
+    for (size_t i {0}; i < Tris.Count; i += simd::Width)
+      Sink.Put(i, PackTest(C, H, Tris, i, i + simd::Width <= Tris.Count ? simd::All() : simd::First(Tris.Count - i)));
+  } /* End of 'BoxPreparedTrianglesPacks' function */
+
+/* Box against indexed triangles set processing function.
+ * Vertices are gathered: pack indices are loaded and deinterleaved first,
+ * then scaled to offsets and used to gather 3 coordinates of every vertex.
+ * ARGUMENTS:
+ *   - Pack test ('BoxTriangles' or 'BoxTrianglesClasses'), template parameter:
+ *       auto PackTest;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Indexed triangles:
+ *       const indexed_triangles_view &Tris;
+ *   - Packs results receiver ('masks_sink', 'indices_sink' or 'classes_sink'):
+ *       sink &Sink;
+ * RETURNS: None.
+ */
+template<auto PackTest, class sink>
+  void BoxIndexedTrianglesPacks( const aabb<float> &Box, const indexed_triangles_view &Tris, sink &Sink ) noexcept
+  {
+    const vec3x C {Set1(Box.Center)}, H {Set1(Box.HalfSize)};
+    vec3x P[3];
+
+    /* Inactive tail lanes get index 0, so they gather the first vertex, staying inside the buffer */
+    for (size_t i {0}; i < Tris.Count; i += simd::Width)
+    {
+      const size_t Rest {std::min(Tris.Count - i, simd::Width)};
+      simd::ivec Indices[3];
+
+      simd::LoadTriangleIndices(Tris.Indices + i * 3, Rest, Indices);
+      for (size_t k {0}; k < 3; k++)
+      {
+        const simd::ivec Offsets {simd::MulInt(Indices[k], (int32_t)Tris.VertexStride)};
+
+        P[k] = {simd::Gather(Tris.Vertices, Offsets), simd::Gather(Tris.Vertices + 1, Offsets), simd::Gather(Tris.Vertices + 2, Offsets)};
+      }
+      Sink.Put(i, PackTest(C, H, P[0], P[1], P[2], Rest == simd::Width ? simd::All() : simd::First(Rest)));
+    }
+  } /* End of 'BoxIndexedTrianglesPacks' function */
+
+/* Quantized triangles vertex pack decoding function.
+ * ARGUMENTS:
+ *   - Quantized triangles:
+ *       const quantized_triangles_view &Tris;
+ *   - Vertex number:
+ *       size_t Vertex;
+ *   - First pack triangle index:
+ *       size_t First;
+ *   - Chunk origin and quantization step (broadcasted):
+ *       const vec3x &Origin, &Step;
+ * RETURNS:
+ *   (vec3x) Decoded vertices.
+ */
+inline vec3x DecodeVertices( const quantized_triangles_view &Tris, size_t Vertex, size_t First, const vec3x &Origin, const vec3x &Step ) noexcept
+{
+  return
+  {
+    simd::FMAdd(simd::LoadU16(Tris.Streams[Vertex * 3] + First), Step.X, Origin.X),
+    simd::FMAdd(simd::LoadU16(Tris.Streams[Vertex * 3 + 1] + First), Step.Y, Origin.Y),
+    simd::FMAdd(simd::LoadU16(Tris.Streams[Vertex * 3 + 2] + First), Step.Z, Origin.Z),
+  };
+} /* End of 'DecodeVertices' function */
+
+/* Box against quantized triangles set processing function.
+ * Box is inflated by decoding error of every chunk (conservative test), chunks
+ * whose bounding box misses the inflated box are not decoded at all.
+ * ARGUMENTS:
+ *   - Pack test ('BoxTriangles' or 'BoxTrianglesClasses'), template parameter:
+ *       auto PackTest;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Quantized triangles (streams are padded to whole chunks):
+ *       const quantized_triangles_view &Tris;
+ *   - Packs results receiver ('masks_sink' or 'indices_sink'):
+ *       sink &Sink;
+ * RETURNS: None.
+ */
+template<auto PackTest, class sink>
+  void BoxQuantizedTrianglesPacks( const aabb<float> &Box, const quantized_triangles_view &Tris, sink &Sink ) noexcept
+  {
+    constexpr float MaxCode {(float)std::numeric_limits<uint16_t>::max()};
+    const vec3x C {Set1(Box.Center)};
+
+    for (size_t First {0}; First < Tris.Count; First += quantized_triangles_view::ChunkSize)
+    {
+      const quantized_chunk &Chunk {Tris.Chunks[First / quantized_triangles_view::ChunkSize]};
+      const size_t End {std::min(First + quantized_triangles_view::ChunkSize, Tris.Count)};
+      const vec3<float>
+        HalfSize {Box.HalfSize + Chunk.Error},
+        Min {Chunk.Origin - Chunk.Error},
+        Max {Chunk.Origin + Chunk.Step * MaxCode + Chunk.Error};
+
+      if (Box.Center.X + HalfSize.X < Min.X || Box.Center.X - HalfSize.X > Max.X ||
+          Box.Center.Y + HalfSize.Y < Min.Y || Box.Center.Y - HalfSize.Y > Max.Y ||
+          Box.Center.Z + HalfSize.Z < Min.Z || Box.Center.Z - HalfSize.Z > Max.Z)
+      {
+        for (size_t i {First}; i < End; i += simd::Width)
+          Sink.Put(i, 0);
+        continue;
+      }
+
+      const vec3x H {Set1(HalfSize)}, Origin {Set1(Chunk.Origin)}, Step {Set1(Chunk.Step)};
+
+      for (size_t i {First}; i < End; i += simd::Width)
+        Sink.Put(i, PackTest(C, H,
+          DecodeVertices(Tris, 0, i, Origin, Step), DecodeVertices(Tris, 1, i, Origin, Step), DecodeVertices(Tris, 2, i, Origin, Step),
+          i + simd::Width <= End ? simd::All() : simd::First(End - i)));
+    }
+  } /* End of 'BoxQuantizedTrianglesPacks' function */
+
+/* Box against triangles bucket processing function.
+ * ARGUMENTS:
+ *   - Bucket streams count and pack test, template parameters:
+ *       size_t StreamsCount;
+ *       auto PackTest;
+ *   - Box center and half size (broadcasted, in bucket coordinates):
+ *       const vec3x &C, &H;
+ *   - Bucket:
+ *       const triangles_bucket_view &Bucket;
+ *   - Packs results receiver:
+ *       sink &Sink;
+ * RETURNS: None.
+ */
+template<size_t StreamsCount, auto PackTest, class sink>
+  void BucketPacks( const vec3x &C, const vec3x &H, const triangles_bucket_view &Bucket, sink &Sink ) noexcept
+  {
+    const size_t FullCount {Bucket.Count - Bucket.Count % simd::Width};
+    simd::vec S[StreamsCount];
+
+    for (size_t i {0}; i < FullCount; i += simd::Width)
+    {
+      for (size_t k {0}; k < StreamsCount; k++)
+        S[k] = simd::Load(Bucket.Streams[k] + i);
+      Sink.Put(i, PackTest(C, H, S, simd::All()));
+    }
+
+    if (const size_t Rest {Bucket.Count - FullCount}; Rest != 0)
+    {
+      for (size_t k {0}; k < StreamsCount; k++)
+        S[k] = simd::LoadFirst(Bucket.Streams[k] + FullCount, Rest);
+      Sink.Put(FullCount, PackTest(C, H, S, simd::First(Rest)));
+    }
+  } /* End of 'BucketPacks' function */
+
+/* Box against triangles bucket overlap test function, original indices output.
+ * ARGUMENTS:
+ *   - Bucket streams count and pack test, template parameters:
+ *       size_t StreamsCount;
+ *       auto PackTest;
+ *   - Box center and half size (broadcasted, in bucket coordinates):
+ *       const vec3x &C, &H;
+ *   - Bucket:
+ *       const triangles_bucket_view &Bucket;
+ *   - Overlapping triangles indices output (at least Bucket.Count long):
+ *       std::span<uint32_t> Indices;
+ *   - Value added to every written index:
+ *       uint32_t IndexBase;
+ * RETURNS:
+ *   (size_t) Written indices count.
+ */
+template<size_t StreamsCount, auto PackTest>
+  size_t BucketIndices( const vec3x &C, const vec3x &H, const triangles_bucket_view &Bucket, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    indices_sink Sink {Indices, 0};
+
+    BucketPacks<StreamsCount, PackTest>(C, H, Bucket, Sink);
+
+    /* Hits are much rarer than tests, so bucket indices are mapped back after compaction */
+    for (size_t i {0}; i < Sink.Written; i++)
+      Indices[i] = IndexBase + Bucket.Ids[Indices[i]];
+    return Sink.Written;
+  } /* End of 'BucketIndices' function */
+
+/* Triangle against equally sized boxes set processing function.
+ * ARGUMENTS:
+ *   - Pack test ('TriangleBoxes'), template parameter:
+ *       auto PackTest;
+ *   - Triangle, prepared for boxes size:
+ *       const triangle_boxes_setup<float> &Tri;
+ *   - Boxes centers:
+ *       const box_centers_soa_view<float> &Centers;
+ *   - Packs results receiver ('masks_sink' or 'indices_sink'):
+ *       sink &Sink;
+ * RETURNS: None.
+ */
+template<auto PackTest, class sink>
+  void TriangleBoxesPacks( const triangle_boxes_setup<float> &Tri, const box_centers_soa_view<float> &Centers, sink &Sink ) noexcept
+  {
+    const size_t FullCount {Centers.Count - Centers.Count % simd::Width};
+
+    for (size_t i {0}; i < FullCount; i += simd::Width)
+      Sink.Put(i, PackTest(Tri,
+        {simd::Load(Centers.X + i), simd::Load(Centers.Y + i), simd::Load(Centers.Z + i)},
+        simd::All()));
+
+    if (const size_t Rest {Centers.Count - FullCount}; Rest != 0)
+    {
+      const size_t i {FullCount};
+
+      Sink.Put(i, PackTest(Tri,
+        {simd::LoadFirst(Centers.X + i, Rest), simd::LoadFirst(Centers.Y + i, Rest), simd::LoadFirst(Centers.Z + i, Rest)},
+        simd::First(Rest)));
+    }
+  } /* End of 'TriangleBoxesPacks' function */
+
+/* Triangle against uniform grid cells set processing function.
+ * ARGUMENTS:
+ *   - Pack test ('TriangleBoxes'), template parameter:
+ *       auto PackTest;
+ *   - Triangle, prepared for grid cells:
+ *       const triangle_cells_setup &Tri;
+ *   - Cells integer coordinates:
+ *       const cell_coords_soa_view &Cells;
+ *   - Packs results receiver ('masks_sink' or 'indices_sink'):
+ *       sink &Sink;
+ * RETURNS: None.
+ */
+template<auto PackTest, class sink>
+  void TriangleCellsPacks( const triangle_cells_setup &Tri, const cell_coords_soa_view &Cells, sink &Sink ) noexcept
+  {
+    const size_t FullCount {Cells.Count - Cells.Count % simd::Width};
+
+    for (size_t i {0}; i < FullCount; i += simd::Width)
+      Sink.Put(i, PackTest(Tri,
+        {simd::LoadInt(Cells.X + i), simd::LoadInt(Cells.Y + i), simd::LoadInt(Cells.Z + i)},
+        simd::All()));
+
+    if (const size_t Rest {Cells.Count - FullCount}; Rest != 0)
+    {
+      const size_t i {FullCount};
+
+      Sink.Put(i, PackTest(Tri,
+        {simd::LoadIntFirst(Cells.X + i, Rest), simd::LoadIntFirst(Cells.Y + i, Rest), simd::LoadIntFirst(Cells.Z + i, Rest)},
+        simd::First(Rest)));
+    }
+  } /* End of 'TriangleCellsPacks' function */
+
+/* Box against triangles set overlap test function, bit masks output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Triangles:
+ *       const triangles_soa_view<float> &Tris;
+ *   - Overlap masks output, one bit per triangle (at least (Tris.Count + 7) / 8 bytes):
+ *       std::span<uint8_t> Masks;
+ * RETURNS: None.
+ */
+template<axes_order Order>
+  void BoxTrianglesOverlapTest( const aabb<float> &Box, const triangles_soa_view<float> &Tris, std::span<uint8_t> Masks ) noexcept
+  {
+    masks_sink Sink {Masks, Tris.Count};
+
+    BoxTrianglesPacks<BoxTriangles<Order>>(Box, Tris, Sink);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+/* Box against triangles set overlap test function, compacted indices output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Triangles:
+ *       const triangles_soa_view<float> &Tris;
+ *   - Overlapping triangles indices output (at least Tris.Count long):
+ *       std::span<uint32_t> Indices;
+ *   - Value added to every written index:
+ *       uint32_t IndexBase;
+ * RETURNS:
+ *   (size_t) Written indices count.
+ */
+template<axes_order Order>
+  size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const triangles_soa_view<float> &Tris, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    indices_sink Sink {Indices, IndexBase};
+
+    BoxTrianglesPacks<BoxTriangles<Order>>(Box, Tris, Sink);
+    return Sink.Written;
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+/* Box against indexed triangles set overlap test function, bit masks output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Indexed triangles:
+ *       const indexed_triangles_view &Tris;
+ *   - Overlap masks output, one bit per triangle (at least (Tris.Count + 7) / 8 bytes):
+ *       std::span<uint8_t> Masks;
+ * RETURNS: None.
+ */
+template<axes_order Order>
+  void BoxTrianglesOverlapTest( const aabb<float> &Box, const indexed_triangles_view &Tris, std::span<uint8_t> Masks ) noexcept
+  {
+    masks_sink Sink {Masks, Tris.Count};
+
+    BoxIndexedTrianglesPacks<BoxTriangles<Order>>(Box, Tris, Sink);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+/* Box against indexed triangles set overlap test function, compacted indices output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Indexed triangles:
+ *       const indexed_triangles_view &Tris;
+ *   - Overlapping triangles indices output (at least Tris.Count long):
+ *       std::span<uint32_t> Indices;
+ *   - Value added to every written index:
+ *       uint32_t IndexBase;
+ * RETURNS:
+ *   (size_t) Written indices count.
+ */
+template<axes_order Order>
+  size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const indexed_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    indices_sink Sink {Indices, IndexBase};
+
+    BoxIndexedTrianglesPacks<BoxTriangles<Order>>(Box, Tris, Sink);
+    return Sink.Written;
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+/* Box against quantized triangles set conservative overlap test function, bit masks output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Quantized triangles:
+ *       const quantized_triangles_view &Tris;
+ *   - Overlap masks output, one bit per triangle (at least (Tris.Count + 7) / 8 bytes):
+ *       std::span<uint8_t> Masks;
+ * RETURNS: None.
+ */
+template<axes_order Order>
+  void BoxTrianglesOverlapTest( const aabb<float> &Box, const quantized_triangles_view &Tris, std::span<uint8_t> Masks ) noexcept
+  {
+    masks_sink Sink {Masks, Tris.Count};
+
+    BoxQuantizedTrianglesPacks<BoxTriangles<Order>>(Box, Tris, Sink);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+/* Box against quantized triangles set conservative overlap test function, compacted indices output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Quantized triangles:
+ *       const quantized_triangles_view &Tris;
+ *   - Overlapping triangles indices output (at least Tris.Count long):
+ *       std::span<uint32_t> Indices;
+ *   - Value added to every written index:
+ *       uint32_t IndexBase;
+ * RETURNS:
+ *   (size_t) Written indices count.
+ */
+template<axes_order Order>
+  size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const quantized_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    indices_sink Sink {Indices, IndexBase};
+
+    BoxQuantizedTrianglesPacks<BoxTriangles<Order>>(Box, Tris, Sink);
+    return Sink.Written;
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+/* Box against prepared triangles set overlap test function, bit masks output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Prepared triangles:
+ *       const prepared_triangles_view &Tris;
+ *   - Overlap masks output, one bit per triangle (at least (Tris.Count + 7) / 8 bytes):
+ *       std::span<uint8_t> Masks;
+ * RETURNS: None.
+ */
+template<axes_order Order>
+  void BoxTrianglesOverlapTest( const aabb<float> &Box, const prepared_triangles_view &Tris, std::span<uint8_t> Masks ) noexcept
+  {
+    masks_sink Sink {Masks, Tris.Count};
+
+    BoxPreparedTrianglesPacks<BoxPreparedTriangles<Order>>(Box, Tris, Sink);
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+/* Box against prepared triangles set overlap test function, compacted indices output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Prepared triangles:
+ *       const prepared_triangles_view &Tris;
+ *   - Overlapping triangles indices output (at least Tris.Count long):
+ *       std::span<uint32_t> Indices;
+ *   - Value added to every written index:
+ *       uint32_t IndexBase;
+ * RETURNS:
+ *   (size_t) Written indices count.
+ */
+template<axes_order Order>
+  size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const prepared_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    indices_sink Sink {Indices, IndexBase};
+
+    BoxPreparedTrianglesPacks<BoxPreparedTriangles<Order>>(Box, Tris, Sink);
+    return Sink.Written;
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+/* Triangle against equally sized boxes set overlap test function, bit masks output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Triangle, prepared for boxes size:
+ *       const triangle_boxes_setup<float> &Tri;
+ *   - Boxes centers:
+ *       const box_centers_soa_view<float> &Centers;
+ *   - Overlap masks output, one bit per box (at least (Centers.Count + 7) / 8 bytes):
+ *       std::span<uint8_t> Masks;
+ * RETURNS: None.
+ */
+template<axes_order Order>
+  void TriangleBoxesOverlapTest( const triangle_boxes_setup<float> &Tri, const box_centers_soa_view<float> &Centers, std::span<uint8_t> Masks ) noexcept
+  {
+    masks_sink Sink {Masks, Centers.Count};
+
+    TriangleBoxesPacks<TriangleBoxes<Order>>(Tri, Centers, Sink);
+  } /* End of 'TriangleBoxesOverlapTest' function */
+
+/* Triangle against equally sized boxes set overlap test function, compacted indices output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Triangle, prepared for boxes size:
+ *       const triangle_boxes_setup<float> &Tri;
+ *   - Boxes centers:
+ *       const box_centers_soa_view<float> &Centers;
+ *   - Overlapping boxes indices output (at least Centers.Count long):
+ *       std::span<uint32_t> Indices;
+ *   - Value added to every written index:
+ *       uint32_t IndexBase;
+ * RETURNS:
+ *   (size_t) Written indices count.
+ */
+template<axes_order Order>
+  size_t TriangleBoxesOverlapTest( const triangle_boxes_setup<float> &Tri, const box_centers_soa_view<float> &Centers, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    indices_sink Sink {Indices, IndexBase};
+
+    TriangleBoxesPacks<TriangleBoxes<Order>>(Tri, Centers, Sink);
+    return Sink.Written;
+  } /* End of 'TriangleBoxesOverlapTest' function */
+
+/* Box against bucketed triangles set overlap test function, compacted indices output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order (general triangles only), template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Bucketed triangles:
+ *       const bucketed_triangles_view &Tris;
+ *   - Overlapping triangles original indices output, grouped by bucket (at least Tris.Count long):
+ *       std::span<uint32_t> Indices;
+ *   - Value added to every written index:
+ *       uint32_t IndexBase;
+ * RETURNS:
+ *   (size_t) Written indices count.
+ */
+template<axes_order Order>
+  size_t BoxTrianglesOverlapTest( const aabb<float> &Box, const bucketed_triangles_view &Tris, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    const vec3x C {Set1(Box.Center)}, H {Set1(Box.HalfSize)};
+    size_t Written {0};
+
+    Written += BucketIndices<9, BoxGeneralTriangles<Order>>(C, H, Tris.Buckets[(size_t)triangle_kind::eGeneral], Indices.subspan(Written), IndexBase);
+    for (size_t Axis {0}; Axis < 3; Axis++)
+      Written += BucketIndices<7, BoxAlignedTriangles>(Set1(ToPlaneAxes(Box.Center, Axis)), Set1(ToPlaneAxes(Box.HalfSize, Axis)),
+        Tris.Buckets[(size_t)triangle_kind::eAlignedX + Axis], Indices.subspan(Written), IndexBase);
+    Written += BucketIndices<6, BoxSegments>(C, H, Tris.Buckets[(size_t)triangle_kind::eSegment], Indices.subspan(Written), IndexBase);
+    Written += BucketIndices<3, BoxPoints>(C, H, Tris.Buckets[(size_t)triangle_kind::ePoint], Indices.subspan(Written), IndexBase);
+    return Written;
+  } /* End of 'BoxTrianglesOverlapTest' function */
+
+/* Triangle against uniform grid cells set overlap test function, bit masks output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Triangle, prepared for grid cells:
+ *       const triangle_cells_setup &Tri;
+ *   - Cells integer coordinates:
+ *       const cell_coords_soa_view &Cells;
+ *   - Overlap masks output, one bit per cell (at least (Cells.Count + 7) / 8 bytes):
+ *       std::span<uint8_t> Masks;
+ * RETURNS: None.
+ */
+template<axes_order Order>
+  void TriangleCellsOverlapTest( const triangle_cells_setup &Tri, const cell_coords_soa_view &Cells, std::span<uint8_t> Masks ) noexcept
+  {
+    masks_sink Sink {Masks, Cells.Count};
+
+    TriangleCellsPacks<TriangleBoxes<Order>>(Tri, Cells, Sink);
+  } /* End of 'TriangleCellsOverlapTest' function */
+
+/* Triangle against uniform grid cells set overlap test function, compacted indices output.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Triangle, prepared for grid cells:
+ *       const triangle_cells_setup &Tri;
+ *   - Cells integer coordinates:
+ *       const cell_coords_soa_view &Cells;
+ *   - Overlapping cells indices output (at least Cells.Count long):
+ *       std::span<uint32_t> Indices;
+ *   - Value added to every written index:
+ *       uint32_t IndexBase;
+ * RETURNS:
+ *   (size_t) Written indices count.
+ */
+template<axes_order Order>
+  size_t TriangleCellsOverlapTest( const triangle_cells_setup &Tri, const cell_coords_soa_view &Cells, std::span<uint32_t> Indices, uint32_t IndexBase ) noexcept
+  {
+    indices_sink Sink {Indices, IndexBase};
+
+    TriangleCellsPacks<TriangleBoxes<Order>>(Tri, Cells, Sink);
+    return Sink.Written;
+  } /* End of 'TriangleCellsOverlapTest' function */
+
+/* Box against triangles set classification function (see 'overlap_class').
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Triangles:
+ *       const triangles_soa_view<float> &Tris;
+ *   - Overlap and containment masks outputs, one bit per triangle (at least (Tris.Count + 7) / 8 bytes each):
+ *       std::span<uint8_t> Overlap, Contained;
+ * RETURNS: None.
+ */
+template<axes_order Order>
+  void BoxTrianglesClassify( const aabb<float> &Box, const triangles_soa_view<float> &Tris, std::span<uint8_t> Overlap, std::span<uint8_t> Contained ) noexcept
+  {
+    classes_sink Sink {{Overlap, Tris.Count}, {Contained, Tris.Count}};
+
+    BoxTrianglesPacks<BoxTrianglesClasses<Order>>(Box, Tris, Sink);
+  } /* End of 'BoxTrianglesClassify' function */
+
+/* Box against prepared triangles set classification function (see 'overlap_class').
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Prepared triangles:
+ *       const prepared_triangles_view &Tris;
+ *   - Overlap and containment masks outputs, one bit per triangle (at least (Tris.Count + 7) / 8 bytes each):
+ *       std::span<uint8_t> Overlap, Contained;
+ * RETURNS: None.
+ */
+template<axes_order Order>
+  void BoxTrianglesClassify( const aabb<float> &Box, const prepared_triangles_view &Tris, std::span<uint8_t> Overlap, std::span<uint8_t> Contained ) noexcept
+  {
+    classes_sink Sink {{Overlap, Tris.Count}, {Contained, Tris.Count}};
+
+    BoxPreparedTrianglesPacks<BoxPreparedTrianglesClasses<Order>>(Box, Tris, Sink);
+  } /* End of 'BoxTrianglesClassify' function */
+
+/* 8-ary hierarchy children bounds against query bounds test function.
+ * ARGUMENTS:
+ *   - Children bounds corners (a lanes group):
+ *       const vec3x &Min, &Max;
+ *   - Query bounds corners, rounded outwards (broadcasted):
+ *       const vec3x &OuterMin, &OuterMax;
+ *   - Query bounds corners, rounded inwards (broadcasted):
+ *       const vec3x &InnerMin, &InnerMax;
+ *   - Contained children bit mask output (subset of overlapping ones):
+ *       uint32_t &Contained;
+ * RETURNS:
+ *   (uint32_t) Overlapping children bit mask, bit i corresponds to i-th lane.
+ */
+inline uint32_t WideBoundsChildren( const vec3x &Min, const vec3x &Max, const vec3x &OuterMin, const vec3x &OuterMax,
+                                    const vec3x &InnerMin, const vec3x &InnerMax, uint32_t &Contained ) noexcept
+{
+  const simd::mask
+    Outside {simd::Or(simd::Or(simd::Or(simd::Greater(Min.X, OuterMax.X), simd::Less(Max.X, OuterMin.X)),
+                               simd::Or(simd::Greater(Min.Y, OuterMax.Y), simd::Less(Max.Y, OuterMin.Y))),
+                      simd::Or(simd::Greater(Min.Z, OuterMax.Z), simd::Less(Max.Z, OuterMin.Z)))},
+    Sticking {simd::Or(simd::Or(simd::Or(simd::Less(Min.X, InnerMin.X), simd::Greater(Max.X, InnerMax.X)),
+                                simd::Or(simd::Less(Min.Y, InnerMin.Y), simd::Greater(Max.Y, InnerMax.Y))),
+                       simd::Or(simd::Less(Min.Z, InnerMin.Z), simd::Greater(Max.Z, InnerMax.Z)))};
+
+  Contained = ~simd::Bits(simd::Or(Outside, Sticking));
+  return ~simd::Bits(Outside);
+} /* End of 'WideBoundsChildren' function */
+
+/* 8-ary hierarchy node children against query bounds test functions.
+ * Lanes groups of narrower instruction sets cover slots one after another,
+ * wider ones load the node into the lower part of the vector.
+ * ARGUMENTS:
+ *   - Node:
+ *       const bvh8_node &Node;
+ *       const quantized_bvh8_node &Node;
+ *   - Query bounds corners, rounded outwards (broadcasted):
+ *       const vec3x &OuterMin, &OuterMax;
+ *   - Query bounds corners, rounded inwards (broadcasted):
+ *       const vec3x &InnerMin, &InnerMax;
+ *   - Contained children bit mask output (subset of overlapping ones):
+ *       uint32_t &Contained;
+ * RETURNS:
+ *   (uint32_t) Overlapping children bit mask, bit i corresponds to i-th slot.
+ */
+inline uint32_t WideNodeChildren( const bvh8_node &Node, const vec3x &OuterMin, const vec3x &OuterMax,
+                                  const vec3x &InnerMin, const vec3x &InnerMax, uint32_t &Contained ) noexcept
+{
+  constexpr size_t Lanes {std::min(simd::Width, bvh8_node::Width)};
+  constexpr uint32_t LanesBits {(1u << Lanes) - 1};
+  uint32_t Overlap {0};
+
+  Contained = 0;
+  for (size_t Slot {0}; Slot < bvh8_node::Width; Slot += Lanes)
+  {
+    const auto Load {[&]( const std::array<float, bvh8_node::Width> &Src )
+      {
+        return simd::Width <= bvh8_node::Width ? simd::Load(Src.data() + Slot) : simd::LoadFirst(Src.data(), bvh8_node::Width);
+      }};
+    uint32_t GroupContained;
+    const uint32_t GroupOverlap {WideBoundsChildren(
+      {Load(Node.Min[0]), Load(Node.Min[1]), Load(Node.Min[2])},
+      {Load(Node.Max[0]), Load(Node.Max[1]), Load(Node.Max[2])},
+      OuterMin, OuterMax, InnerMin, InnerMax, GroupContained)};
+
+    Overlap |= (GroupOverlap & LanesBits) << Slot;
+    Contained |= (GroupContained & GroupOverlap & LanesBits) << Slot;
+  }
+  return Overlap;
+} /* End of 'WideNodeChildren' function */
+
+inline uint32_t WideNodeChildren( const quantized_bvh8_node &Node, const vec3x &OuterMin, const vec3x &OuterMax,
+                                  const vec3x &InnerMin, const vec3x &InnerMax, uint32_t &Contained ) noexcept
+{
+  constexpr size_t Lanes {std::min(simd::Width, quantized_bvh8_node::Width)};
+  constexpr uint32_t LanesBits {(1u << Lanes) - 1};
+  const vec3x Origin {Set1(Node.Origin)}, Step {Set1(Node.GetStep())};
+  uint32_t Overlap {0};
+
+  /* Offsets times power of two steps are exact, so every instruction set decodes the same bounds */
+  Contained = 0;
+  for (size_t Slot {0}; Slot < quantized_bvh8_node::Width; Slot += Lanes)
+  {
+    uint32_t GroupContained;
+    const uint32_t GroupOverlap {WideBoundsChildren(
+      {simd::FMAdd(simd::LoadU8(Node.QMin[0].data() + Slot), Step.X, Origin.X),
+       simd::FMAdd(simd::LoadU8(Node.QMin[1].data() + Slot), Step.Y, Origin.Y),
+       simd::FMAdd(simd::LoadU8(Node.QMin[2].data() + Slot), Step.Z, Origin.Z)},
+      {simd::FMAdd(simd::LoadU8(Node.QMax[0].data() + Slot), Step.X, Origin.X),
+       simd::FMAdd(simd::LoadU8(Node.QMax[1].data() + Slot), Step.Y, Origin.Y),
+       simd::FMAdd(simd::LoadU8(Node.QMax[2].data() + Slot), Step.Z, Origin.Z)},
+      OuterMin, OuterMax, InnerMin, InnerMax, GroupContained)};
+
+    Overlap |= (GroupOverlap & LanesBits) << Slot;
+    Contained |= (GroupContained & GroupOverlap & LanesBits) << Slot;
+  }
+  Contained &= Node.Valid;
+  return Overlap & Node.Valid;
+} /* End of 'WideNodeChildren' function */
+
+/* Box against 8-ary hierarchy triangles overlap query function.
+ * Contained children (leaves or whole subtrees) are accepted entirely, other overlapping
+ * inner children are pushed to the stack and leaves go to the prepared triangles kernel.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Box:
+ *       const aabb<float> &Box;
+ *   - Hierarchy:
+ *       const wide_bvh_view<node> &Bvh;
+ *   - Overlapping triangles (hierarchy order) receiver and its context:
+ *       bvh_hits_callback Callback; void *Context;
+ * RETURNS: None.
+ */
+template<axes_order Order, class node>
+  void BoxWideBvhTrianglesQuery( const aabb<float> &Box, const wide_bvh_view<node> &Bvh, bvh_hits_callback Callback, void *Context )
+  {
+    if (Bvh.NodesCount == 0)
+      return;
+
+    const bvh_query_bounds Query {Box};
+    const vec3x
+      C {Set1(Box.Center)}, H {Set1(Box.HalfSize)},
+      OuterMin {Set1(Query.OuterMin)}, OuterMax {Set1(Query.OuterMax)},
+      InnerMin {Set1(Query.InnerMin)}, InnerMax {Set1(Query.InnerMax)};
+    uint32_t Stack[(node::Width - 1) * wide_bvh_view<node>::MaxDepth + 1], Hits[256];
+    size_t Top {0}, Written {0};
+
+    Stack[Top++] = 0;
+    while (Top > 0)
+    {
+      const node &Node {Bvh.Nodes[Stack[--Top]]};
+      uint32_t Contained;
+
+      for (uint32_t Rest {WideNodeChildren(Node, OuterMin, OuterMax, InnerMin, InnerMax, Contained)}; Rest != 0; Rest &= Rest - 1)
+      {
+        const size_t Slot {(size_t)std::countr_zero(Rest)};
+        uint32_t First, Count;
+
+        Node.GetChild(Slot, First, Count);
+        if (Contained & (1u << Slot))
+        {
+          /* Contained subtree is accepted entirely, without descending */
+          if (Count == 0)
+            Count = Bvh.Subtrees[First].Count, First = Bvh.Subtrees[First].First;
+          for (uint32_t i {0}; i < Count; i++)
+          {
+            if (Written == std::size(Hits))
+              Callback(Context, {Hits, Written}), Written = 0;
+            Hits[Written++] = First + i;
+          }
+          continue;
+        }
+        if (Count == 0)
+        {
+          Stack[Top++] = First;
+          continue;
+        }
+
+        const prepared_triangles_view Leaf {prepared_mesh::MakeView(Bvh.Leaves + (size_t)First * prepared_mesh::StreamsCount, Count, Count)};
+
+        /* Packs are stored whole, so buffer is flushed while a pack may not fit */
+        for (uint32_t i {0}; i < Count; i += simd::Width)
+        {
+          if (Written + simd::Width > std::size(Hits))
+            Callback(Context, {Hits, Written}), Written = 0;
+
+          const uint32_t Bits {BoxPreparedTriangles<Order>(C, H, Leaf, i, i + simd::Width <= Count ? simd::All() : simd::First(Count - i))};
+
+          simd::CompressStore(Hits + Written, First + i, Bits);
+          Written += (size_t)std::popcount(Bits);
+        }
+      }
+    }
+    if (Written != 0)
+      Callback(Context, {Hits, Written});
+  } /* End of 'BoxWideBvhTrianglesQuery' function */
+
+/* Query boxes packet for hierarchy traversal, stored by components */
+struct boxes_packet
+{
+  static constexpr size_t Size {bvh_view::PacketSize}; // Boxes count
+
+  alignas(64) float OuterMin[3][Size], OuterMax[3][Size]; // Outwards rounded corners (see 'bvh_query_bounds')
+  alignas(64) float InnerMin[3][Size], InnerMax[3][Size]; // Inwards rounded corners
+  alignas(64) float Center[3][Size], HalfSize[3][Size];   // Boxes
+}; /* end of 'boxes_packet' structure */
+
+/* Hierarchy node against boxes packet culling function.
+ * Only lane groups with active boxes are tested, so sparse packets cost less.
+ * ARGUMENTS:
+ *   - Node:
+ *       const bvh_node &Node;
+ *   - Packet:
+ *       const boxes_packet &Packet;
+ *   - Active boxes mask:
+ *       uint64_t Active;
+ *   - Active boxes, containing node (stored):
+ *       uint64_t &Contained;
+ * RETURNS:
+ *   (uint64_t) Active boxes, which may overlap node.
+ */
+inline uint64_t NodeBoxes( const bvh_node &Node, const boxes_packet &Packet, uint64_t Active, uint64_t &Contained ) noexcept
+{
+  constexpr uint64_t LanesBits {(1ull << simd::Width) - 1};
+  const vec3x Min {Set1(Node.Min)}, Max {Set1(Node.Max)};
+  uint64_t Overlap {0};
+
+  Contained = 0;
+  for (uint64_t Rest {Active}; Rest != 0; )
+  {
+    const size_t Lane {(size_t)std::countr_zero(Rest) / simd::Width * simd::Width};
+    const simd::mask
+      Outside {simd::Or(
+        simd::Or(simd::Greater(Min.X, simd::Load(Packet.OuterMax[0] + Lane)), simd::Less(Max.X, simd::Load(Packet.OuterMin[0] + Lane))),
+        simd::Or(
+          simd::Or(simd::Greater(Min.Y, simd::Load(Packet.OuterMax[1] + Lane)), simd::Less(Max.Y, simd::Load(Packet.OuterMin[1] + Lane))),
+          simd::Or(simd::Greater(Min.Z, simd::Load(Packet.OuterMax[2] + Lane)), simd::Less(Max.Z, simd::Load(Packet.OuterMin[2] + Lane)))))},
+      Sticking {simd::Or(
+        simd::Or(simd::Less(Min.X, simd::Load(Packet.InnerMin[0] + Lane)), simd::Greater(Max.X, simd::Load(Packet.InnerMax[0] + Lane))),
+        simd::Or(
+          simd::Or(simd::Less(Min.Y, simd::Load(Packet.InnerMin[1] + Lane)), simd::Greater(Max.Y, simd::Load(Packet.InnerMax[1] + Lane))),
+          simd::Or(simd::Less(Min.Z, simd::Load(Packet.InnerMin[2] + Lane)), simd::Greater(Max.Z, simd::Load(Packet.InnerMax[2] + Lane)))))};
+
+    Overlap |= (~(uint64_t)simd::Bits(Outside) & LanesBits) << Lane;
+    Contained |= (~(uint64_t)simd::Bits(Sticking) & LanesBits) << Lane;
+    Rest &= ~(LanesBits << Lane);
+  }
+  Contained &= Overlap & Active;
+  return Overlap & Active;
+} /* End of 'NodeBoxes' function */
+
+/* Boxes batch against binary hierarchy triangles overlap query function.
+ * Boxes traverse hierarchy in packets with active boxes mask per node, so every node is loaded
+ * once per packet. Boxes containing a node accept its whole subtree and leave the packet there.
+ * Leaf triangles are tested against all active boxes at once, by the cheaper of two ways:
+ * box against triangles pack kernel transposed (triangle is broadcast, boxes occupy lanes)
+ * for crowded leaves, the usual one (box is broadcast, leaf triangles occupy lanes) otherwise.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ *   - Boxes:
+ *       std::span<const aabb<float>> Boxes;
+ *   - Hierarchy:
+ *       const bvh_view &Bvh;
+ *   - Overlapping pairs receiver and its context:
+ *       bvh_pairs_callback Callback; void *Context;
+ * RETURNS: None.
+ */
+template<axes_order Order>
+  void BoxesBvhTrianglesQuery( std::span<const aabb<float>> Boxes, const bvh_view &Bvh, bvh_pairs_callback Callback, void *Context )
+  {
+    if (Bvh.NodesCount == 0)
+      return;
+
+    /* Pending node with its active boxes */
+    struct entry
+    {
+      uint32_t Node;
+      uint64_t Active;
+    };
+
+    constexpr uint64_t LanesBits {(1ull << simd::Width) - 1};
+    const triangles_soa_view<float> &Tris {Bvh.Triangles};
+    boxes_packet Packet;
+    entry Stack[bvh_view::MaxDepth + 1];
+    bvh_pair Pairs[256];
+    size_t Written {0};
+
+    /* Pairs storing with buffer flushing */
+    const auto Store {[&]( uint32_t Box, uint32_t Triangle )
+      {
+        if (Written == std::size(Pairs))
+          Callback(Context, {Pairs, Written}), Written = 0;
+        Pairs[Written++] = {Box, Triangle};
+      }};
+
+    for (size_t Base {0}; Base < Boxes.size(); Base += boxes_packet::Size)
+    {
+      const size_t Count {std::min(Boxes.size() - Base, boxes_packet::Size)};
+      size_t Top {0};
+
+      /* Lanes past the batch end repeat its first box, so they are initialized (and never active) */
+      for (size_t i {0}; i < boxes_packet::Size; i++)
+      {
+        const aabb<float> &Box {Boxes[Base + (i < Count ? i : 0)]};
+        const bvh_query_bounds Query {Box};
+
+        for (size_t a {0}; a < 3; a++)
+        {
+          Packet.OuterMin[a][i] = (&Query.OuterMin.X)[a], Packet.OuterMax[a][i] = (&Query.OuterMax.X)[a];
+          Packet.InnerMin[a][i] = (&Query.InnerMin.X)[a], Packet.InnerMax[a][i] = (&Query.InnerMax.X)[a];
+          Packet.Center[a][i] = (&Box.Center.X)[a], Packet.HalfSize[a][i] = (&Box.HalfSize.X)[a];
+        }
+      }
+
+      /* Node culling: containing boxes accept subtree triangles (from the leftmost leaf to the rightmost one) */
+      const auto Visit {[&]( uint32_t Index, uint64_t Active )
+        {
+          uint64_t Contained;
+          const uint64_t Overlap {NodeBoxes(Bvh.Nodes[Index], Packet, Active, Contained)};
+
+          if (Contained != 0)
+          {
+            uint32_t Left {Index}, Right {Index};
+
+            while (Bvh.Nodes[Left].Count == 0)
+              Left = Bvh.Nodes[Left].Index;
+            while (Bvh.Nodes[Right].Count == 0)
+              Right = Bvh.Nodes[Right].Index + 1;
+            for (uint64_t Rest {Contained}; Rest != 0; Rest &= Rest - 1)
+              for (uint32_t t {Bvh.Nodes[Left].Index}; t < Bvh.Nodes[Right].Index + Bvh.Nodes[Right].Count; t++)
+                Store((uint32_t)(Base + (size_t)std::countr_zero(Rest)), t);
+          }
+          if (Overlap != Contained)
+            Stack[Top++] = {Index, Overlap & ~Contained};
+        }};
+
+      Visit(0, Count == boxes_packet::Size ? ~0ull : (1ull << Count) - 1);
+      while (Top > 0)
+      {
+        const entry Entry {Stack[--Top]};
+        const bvh_node &Node {Bvh.Nodes[Entry.Node]};
+
+        if (Node.Count == 0)
+        {
+          Visit(Node.Index, Entry.Active);
+          Visit(Node.Index + 1, Entry.Active);
+          continue;
+        }
+
+        /* Vector operations count of both ways */
+        size_t Groups {0};
+
+        for (uint64_t Rest {Entry.Active}; Rest != 0; Groups++)
+          Rest &= ~(LanesBits << ((size_t)std::countr_zero(Rest) / simd::Width * simd::Width));
+        if ((size_t)std::popcount(Entry.Active) * ((Node.Count + simd::Width - 1) / simd::Width) <= Node.Count * Groups)
+        {
+          for (uint64_t Rest {Entry.Active}; Rest != 0; Rest &= Rest - 1)
+          {
+            const size_t Box {(size_t)std::countr_zero(Rest)};
+            const vec3x
+              C {simd::Set1(Packet.Center[0][Box]), simd::Set1(Packet.Center[1][Box]), simd::Set1(Packet.Center[2][Box])},
+              H {simd::Set1(Packet.HalfSize[0][Box]), simd::Set1(Packet.HalfSize[1][Box]), simd::Set1(Packet.HalfSize[2][Box])};
+
+            for (uint32_t First {Node.Index}; First < Node.Index + Node.Count; First += simd::Width)
+            {
+              const size_t Lanes {std::min<size_t>(Node.Index + Node.Count - First, simd::Width)};
+              const auto Load {[&]( const float *P ) { return simd::LoadFirst(P + First, Lanes); }};
+
+              for (uint32_t Bits {BoxTriangles<Order>(C, H,
+                     {Load(Tris.X[0]), Load(Tris.Y[0]), Load(Tris.Z[0])},
+                     {Load(Tris.X[1]), Load(Tris.Y[1]), Load(Tris.Z[1])},
+                     {Load(Tris.X[2]), Load(Tris.Y[2]), Load(Tris.Z[2])}, simd::First(Lanes))}; Bits != 0; Bits &= Bits - 1)
+                Store((uint32_t)(Base + Box), First + (uint32_t)std::countr_zero(Bits));
+            }
+          }
+          continue;
+        }
+        for (uint32_t t {Node.Index}; t < Node.Index + Node.Count; t++)
+        {
+          const triangle<float> Tri {Tris[t]};
+          const vec3x P0 {Set1(Tri.V0)}, P1 {Set1(Tri.V1)}, P2 {Set1(Tri.V2)};
+
+          for (uint64_t Rest {Entry.Active}; Rest != 0; )
+          {
+            const size_t Lane {(size_t)std::countr_zero(Rest) / simd::Width * simd::Width};
+            const vec3x
+              C {simd::Load(Packet.Center[0] + Lane), simd::Load(Packet.Center[1] + Lane), simd::Load(Packet.Center[2] + Lane)},
+              H {simd::Load(Packet.HalfSize[0] + Lane), simd::Load(Packet.HalfSize[1] + Lane), simd::Load(Packet.HalfSize[2] + Lane)};
+
+            for (uint32_t Bits {BoxTriangles<Order>(C, H, P0, P1, P2, simd::FromBits((uint32_t)((Rest >> Lane) & LanesBits)))}; Bits != 0; Bits &= Bits - 1)
+              Store((uint32_t)(Base + Lane + (size_t)std::countr_zero(Bits)), t);
+            Rest &= ~(LanesBits << Lane);
+          }
+        }
+      }
+    }
+    if (Written != 0)
+      Callback(Context, {Pairs, Written});
+  } /* End of 'BoxesBvhTrianglesQuery' function */
+
+/* Kernels table of the instruction set for axes evaluation order creation function.
+ * ARGUMENTS:
+ *   - Axes groups evaluation order, template parameter:
+ *       axes_order Order;
+ * RETURNS:
+ *   (overlap_kernels) Kernels table.
+ */
+template<axes_order Order>
+  constexpr overlap_kernels MakeKernels( void ) noexcept
+  {
+    return
+    {
+      .Isa = simd::Isa,
+      .Order = Order,
+      .BoxTriangles = BoxTrianglesOverlapTest<Order>,
+      .BoxTrianglesIndices = BoxTrianglesOverlapTest<Order>,
+      .BoxPreparedTriangles = BoxTrianglesOverlapTest<Order>,
+      .BoxPreparedTrianglesIndices = BoxTrianglesOverlapTest<Order>,
+      .BoxIndexedTriangles = BoxTrianglesOverlapTest<Order>,
+      .BoxIndexedTrianglesIndices = BoxTrianglesOverlapTest<Order>,
+      .BoxQuantizedTriangles = BoxTrianglesOverlapTest<Order>,
+      .BoxQuantizedTrianglesIndices = BoxTrianglesOverlapTest<Order>,
+      .BoxBucketedTrianglesIndices = BoxTrianglesOverlapTest<Order>,
+      .TriangleBoxes = TriangleBoxesOverlapTest<Order>,
+      .TriangleBoxesIndices = TriangleBoxesOverlapTest<Order>,
+      .TriangleCells = TriangleCellsOverlapTest<Order>,
+      .TriangleCellsIndices = TriangleCellsOverlapTest<Order>,
+      .BoxTrianglesClasses = BoxTrianglesClassify<Order>,
+      .BoxPreparedTrianglesClasses = BoxTrianglesClassify<Order>,
+      .BoxBvh8Triangles = BoxWideBvhTrianglesQuery<Order>,
+      .BoxQuantizedBvh8Triangles = BoxWideBvhTrianglesQuery<Order>,
+      .BoxesBvhTriangles = BoxesBvhTrianglesQuery<Order>,
+    };
+  } /* End of 'MakeKernels' function */
+
+/* Kernels tables of the instruction set, indexed by 'axes_order' */
+inline constexpr overlap_kernels Kernels[]
+{
+  MakeKernels<axes_order::eDefault>(),
+  MakeKernels<axes_order::eEdgesFirst>(),
+  MakeKernels<axes_order::eBoxFirst>(),
+  MakeKernels<axes_order::ePlaneFirst>(),
+};
+static_assert(std::size(Kernels) == (size_t)axes_order::_LastValue);
+
+/* END OF 'overlap_kernels.inl' FILE */
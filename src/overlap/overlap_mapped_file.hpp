@@ -0,0 +1,199 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_mapped_file.hpp" - Read only memory mapped file */
+
+#ifndef __overlap_mapped_file_hpp__
+#define __overlap_mapped_file_hpp__
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/* Math namespace */
+namespace math
+{
+  /* Read only memory mapped file (pages are loaded on first access), move only */
+  class mapped_file
+  {
+  private:
+    const uint8_t *Data {}; // Mapped file
+    size_t Size {0};        // Mapped bytes count
+#if defined(_WIN32)
+    HANDLE File {INVALID_HANDLE_VALUE}; // File handle
+    HANDLE Mapping {};                  // File mapping handle
+#endif
+
+    /* Mapping closing function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Close( void ) noexcept
+    {
+#if defined(_WIN32)
+      if (Data != nullptr)
+        UnmapViewOfFile(Data);
+      if (Mapping != nullptr)
+        CloseHandle(Mapping);
+      if (File != INVALID_HANDLE_VALUE)
+        CloseHandle(File);
+      File = INVALID_HANDLE_VALUE;
+      Mapping = nullptr;
+#else
+      if (Data != nullptr)
+        munmap(const_cast<uint8_t *>(Data), Size);
+#endif
+      Data = nullptr;
+      Size = 0;
+    } /* End of 'Close' function */
+
+  public:
+    /* Default constructor */
+    mapped_file( void ) = default;
+
+    /* Constructor from file path, empty files are rejected.
+     * ARGUMENTS:
+     *   - File path:
+     *       const std::filesystem::path &Path;
+     */
+    explicit mapped_file( const std::filesystem::path &Path )
+    {
+#if defined(_WIN32)
+      File = CreateFileW(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (File == INVALID_HANDLE_VALUE)
+        throw std::runtime_error {"Cannot open file"};
+
+      LARGE_INTEGER FileSize {};
+
+      if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+      {
+        Close();
+        throw std::runtime_error {"Cannot get file size"};
+      }
+      Size = (size_t)FileSize.QuadPart;
+      Mapping = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (Mapping != nullptr)
+        Data = static_cast<const uint8_t *>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+      const int Fd {open(Path.c_str(), O_RDONLY)};
+
+      if (Fd < 0)
+        throw std::runtime_error {"Cannot open file"};
+
+      struct stat Stat {};
+
+      if (fstat(Fd, &Stat) != 0 || Stat.st_size == 0)
+      {
+        close(Fd);
+        throw std::runtime_error {"Cannot get file size"};
+      }
+      Size = (size_t)Stat.st_size;
+
+      void *Ptr {mmap(nullptr, Size, PROT_READ, MAP_SHARED, Fd, 0)};
+
+      close(Fd);
+      if (Ptr != MAP_FAILED)
+        Data = static_cast<const uint8_t *>(Ptr);
+#endif
+      if (Data == nullptr)
+      {
+        Close();
+        throw std::runtime_error {"Cannot map file"};
+      }
+    } /* End of constructor */
+
+    /* Move constructor */
+    mapped_file( mapped_file &&Other ) noexcept
+    {
+      *this = std::move(Other);
+    } /* End of constructor */
+
+    /* Move assignment operator */
+    mapped_file &operator=( mapped_file &&Other ) noexcept
+    {
+      if (this != &Other)
+      {
+        Close();
+        Data = std::exchange(Other.Data, nullptr);
+        Size = std::exchange(Other.Size, 0);
+#if defined(_WIN32)
+        File = std::exchange(Other.File, INVALID_HANDLE_VALUE);
+        Mapping = std::exchange(Other.Mapping, nullptr);
+#endif
+      }
+      return *this;
+    } /* End of 'operator=' function */
+
+    mapped_file( const mapped_file & ) = delete;
+    mapped_file &operator=( const mapped_file & ) = delete;
+
+    /* Destructor */
+    ~mapped_file( void )
+    {
+      Close();
+    } /* End of destructor */
+
+    /* Mapped data getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const uint8_t *) Mapped file start.
+     */
+    const uint8_t *GetData( void ) const noexcept
+    {
+      return Data;
+    } /* End of 'GetData' function */
+
+    /* Mapped bytes count getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) File size.
+     */
+    size_t GetSize( void ) const noexcept
+    {
+      return Size;
+    } /* End of 'GetSize' function */
+
+    /* Mapped file text getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const char>) Mapped file as characters.
+     */
+    std::span<const char> GetText( void ) const noexcept
+    {
+      return {reinterpret_cast<const char *>(Data), Size};
+    } /* End of 'GetText' function */
+  }; /* end of 'mapped_file' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_mapped_file_hpp__ */
+
+/* END OF 'overlap_mapped_file.hpp' FILE */
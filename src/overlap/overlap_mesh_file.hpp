@@ -0,0 +1,673 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_mesh_file.hpp" - Memory mapped binary mesh container (format is described in "src/overlap_mesh_format.md") */
+
+#ifndef __overlap_mesh_file_hpp__
+#define __overlap_mesh_file_hpp__
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "overlap_mapped_file.hpp"
+#include "overlap_prepared.hpp"
+#include "overlap_indexed.hpp"
+#include "overlap_bvh_node.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Mesh file sections types enumerable (values are stored in files, never reorder) */
+  enum class mesh_section : uint32_t
+  {
+    eTriangles     = 1, // Triangle soup: 9 float streams [vertex * 3 + component], 'Stride' floats each
+    eVertices      = 2, // Indexed mesh vertices: X, Y, Z floats per vertex
+    eIndices       = 3, // Indexed mesh triangle list: 3 uint32_t per triangle
+    ePrepared      = 4, // Prepared triangles (see 'prepared_mesh'): 49 float streams, 'Stride' floats each
+    eBvh           = 5, // Binary hierarchy ('bvh_view'): nodes, original indices, triangles in hierarchy order; 'Stride' is nodes count
+    eBvh8          = 6, // 8-ary hierarchy ('bvh8_view'): nodes, subtrees, original indices, leaves blocks; 'Stride' is nodes count
+    eQuantizedBvh8 = 7, // Quantized 8-ary hierarchy ('quantized_bvh8_view'), laid out as 'eBvh8'
+
+    _LastValue
+  }; /* end of 'mesh_section' enumerable */
+
+  /* Mesh file header, little endian */
+  struct mesh_file_header
+  {
+    static constexpr char Signature[8] {'O', 'V', 'L', 'P', 'M', 'E', 'S', 'H'}; // File signature
+    static constexpr uint32_t CurrentVersion {1};                                // Format version, written by this code
+
+    char Magic[8];           // Signature
+    uint32_t Version;        // Format version, files with greater one are rejected
+    uint32_t SectionsCount;  // Sections table length, table follows the header
+    uint64_t TrianglesCount; // Triangles count, common for all sections
+    uint64_t VerticesCount;  // Indexed mesh vertices count (0 if there are no indexed mesh sections)
+    uint64_t FileSize;       // Whole file size, truncated files are detected with it
+    uint8_t Reserved[24];    // Zeros
+  }; /* end of 'mesh_file_header' structure */
+  static_assert(sizeof(mesh_file_header) == 64);
+
+  /* Mesh file sections table entry */
+  struct mesh_file_section
+  {
+    uint32_t Type;   // Section type ('mesh_section'), unknown types are skipped by readers
+    uint32_t Flags;  // Zero
+    uint64_t Offset; // Section data offset from file start, multiple of 'MeshFileAlignment'
+    uint64_t Size;   // Section data size in bytes
+    uint64_t Stride; // Stream length in elements for streams sections, nodes count for hierarchy sections, 0 for others
+  }; /* end of 'mesh_file_section' structure */
+  static_assert(sizeof(mesh_file_section) == 32);
+
+  /* Mesh file sections data alignment, cache line (mapping base is page aligned) */
+  inline constexpr uint64_t MeshFileAlignment {64};
+
+  /* Saturating file size multiplication function: sizes, read from a corrupted file, may overflow.
+   * ARGUMENTS:
+   *   - Factors:
+   *       uint64_t A, B;
+   * RETURNS:
+   *   (uint64_t) Product or 'UINT64_MAX' on overflow (greater than any mapped file size).
+   */
+  constexpr uint64_t MulFileSize( uint64_t A, uint64_t B ) noexcept
+  {
+    return B != 0 && A > std::numeric_limits<uint64_t>::max() / B ? std::numeric_limits<uint64_t>::max() : A * B;
+  } /* End of 'MulFileSize' function */
+
+  /* Saturating file size addition function.
+   * ARGUMENTS:
+   *   - Terms:
+   *       uint64_t A, B;
+   * RETURNS:
+   *   (uint64_t) Sum or 'UINT64_MAX' on overflow (greater than any mapped file size).
+   */
+  constexpr uint64_t AddFileSize( uint64_t A, uint64_t B ) noexcept
+  {
+    return A > std::numeric_limits<uint64_t>::max() - B ? std::numeric_limits<uint64_t>::max() : A + B;
+  } /* End of 'AddFileSize' function */
+
+  /* Saturating file size rounding up function.
+   * ARGUMENTS:
+   *   - Size:
+   *       uint64_t Size;
+   *   - Alignment:
+   *       uint64_t Alignment;
+   * RETURNS:
+   *   (uint64_t) Size rounded up to a multiple of alignment or 'UINT64_MAX' on overflow.
+   */
+  constexpr uint64_t AlignFileSize( uint64_t Size, uint64_t Alignment ) noexcept
+  {
+    const uint64_t Sum {AddFileSize(Size, Alignment - 1)};
+
+    return Sum == std::numeric_limits<uint64_t>::max() ? Sum : Sum / Alignment * Alignment;
+  } /* End of 'AlignFileSize' function */
+
+  /* Hierarchy section parts offsets from section start, every part is aligned to 'MeshFileAlignment' */
+  struct mesh_file_hierarchy_layout
+  {
+    uint64_t Nodes {0};     // Nodes array
+    uint64_t Subtrees {0};  // Subtrees ranges, one per node (8-ary hierarchies only)
+    uint64_t Indices {0};   // Original index of every triangle in hierarchy order
+    uint64_t Triangles {0}; // Triangles in hierarchy order: 9 float streams (binary) or leaves blocks (8-ary)
+    uint64_t Size {0};      // Section size
+  }; /* end of 'mesh_file_hierarchy_layout' structure */
+
+  /* Hierarchy section layout getting function.
+   * ARGUMENTS:
+   *   - Section type ('eBvh', 'eBvh8' or 'eQuantizedBvh8'):
+   *       mesh_section Type;
+   *   - Nodes count:
+   *       uint64_t NodesCount;
+   *   - Triangles count:
+   *       uint64_t Count;
+   * RETURNS:
+   *   (mesh_file_hierarchy_layout) Layout, overflowing offsets and size are 'UINT64_MAX'.
+   */
+  constexpr mesh_file_hierarchy_layout GetHierarchyLayout( mesh_section Type, uint64_t NodesCount, uint64_t Count ) noexcept
+  {
+    constexpr uint64_t Padding {prepared_mesh::Padding};
+    mesh_file_hierarchy_layout Layout {};
+
+    if (Type == mesh_section::eBvh)
+    {
+      Layout.Subtrees = Layout.Indices = AlignFileSize(MulFileSize(NodesCount, sizeof(bvh_node)), MeshFileAlignment);
+      Layout.Triangles = AlignFileSize(AddFileSize(Layout.Indices, MulFileSize(Count, sizeof(uint32_t))), MeshFileAlignment);
+      Layout.Size = AddFileSize(Layout.Triangles, MulFileSize(AlignFileSize(Count, Padding), 9 * sizeof(float)));
+    }
+    else
+    {
+      Layout.Subtrees = AlignFileSize(MulFileSize(NodesCount, Type == mesh_section::eBvh8 ? sizeof(bvh8_node) : sizeof(quantized_bvh8_node)), MeshFileAlignment);
+      Layout.Indices = AlignFileSize(AddFileSize(Layout.Subtrees, MulFileSize(NodesCount, sizeof(bvh_range))), MeshFileAlignment);
+      Layout.Triangles = AlignFileSize(AddFileSize(Layout.Indices, MulFileSize(Count, sizeof(uint32_t))), MeshFileAlignment);
+      Layout.Size = AddFileSize(Layout.Triangles, MulFileSize(AddFileSize(MulFileSize(Count, prepared_mesh::StreamsCount), Padding), sizeof(float)));
+    }
+    return Layout;
+  } /* End of 'GetHierarchyLayout' function */
+
+  /* Hierarchy to write: view and original index of every triangle in hierarchy order ('GetIndices' of builders) */
+  template<class view>
+    struct mesh_file_hierarchy
+    {
+      view View {};                         // Hierarchy view
+      std::span<const uint32_t> Indices {}; // Original triangles indices
+    }; /* end of 'mesh_file_hierarchy' structure */
+
+  /* Mesh file content to write, every present part must have the same triangles count */
+  struct mesh_file_content
+  {
+    std::optional<triangles_soa_view<float>> Triangles {};                     // Triangle soup
+    std::optional<indexed_triangles_view> Indexed {};                          // Indexed mesh
+    std::optional<prepared_triangles_view> Prepared {};                        // Prepared triangles, streams must be padded to 'prepared_mesh::Padding'
+    std::optional<mesh_file_hierarchy<bvh_view>> Bvh {};                       // Binary hierarchy
+    std::optional<mesh_file_hierarchy<bvh8_view>> Bvh8 {};                     // 8-ary hierarchy
+    std::optional<mesh_file_hierarchy<quantized_bvh8_view>> QuantizedBvh8 {};  // Quantized 8-ary hierarchy
+  }; /* end of 'mesh_file_content' structure */
+
+  /* Prepared triangles streams getting function.
+   * ARGUMENTS:
+   *   - Prepared triangles:
+   *       const prepared_triangles_view &Tris;
+   * RETURNS:
+   *   (std::array<const float *, prepared_mesh::StreamsCount>) Streams in 'prepared_mesh' storage order.
+   */
+  inline std::array<const float *, prepared_mesh::StreamsCount> GetPreparedStreams( const prepared_triangles_view &Tris ) noexcept
+  {
+    std::array<const float *, prepared_mesh::StreamsCount> Streams {};
+    size_t Pos {0};
+
+    for (const std::array<const float *, 9> *Group : {&Tris.Edges, &Tris.AbsEdges, &Tris.AxesMid, &Tris.AxesHalf})
+      for (const float *Stream : *Group)
+        Streams[Pos++] = Stream;
+    for (const std::array<const float *, 3> *Group : {&Tris.BoundsMid, &Tris.BoundsHalf, &Tris.Normal, &Tris.AbsNormal})
+      for (const float *Stream : *Group)
+        Streams[Pos++] = Stream;
+    Streams[Pos] = Tris.PlaneD;
+    return Streams;
+  } /* End of 'GetPreparedStreams' function */
+
+  /* Prepared triangles view from consecutive streams creation function.
+   * ARGUMENTS:
+   *   - First stream and streams stride in floats:
+   *       const float *Base; size_t Stride;
+   *   - Triangles count:
+   *       size_t Count;
+   * RETURNS:
+   *   (prepared_triangles_view) View.
+   */
+  inline prepared_triangles_view MakePreparedView( const float *Base, size_t Stride, size_t Count ) noexcept
+  {
+    prepared_triangles_view View {};
+    size_t Pos {0};
+
+    for (std::array<const float *, 9> *Group : {&View.Edges, &View.AbsEdges, &View.AxesMid, &View.AxesHalf})
+      for (const float *&Stream : *Group)
+        Stream = Base + Stride * Pos++;
+    for (std::array<const float *, 3> *Group : {&View.BoundsMid, &View.BoundsHalf, &View.Normal, &View.AbsNormal})
+      for (const float *&Stream : *Group)
+        Stream = Base + Stride * Pos++;
+    View.PlaneD = Base + Stride * Pos;
+    View.Count = Count;
+    return View;
+  } /* End of 'MakePreparedView' function */
+
+  /* Mesh file writing function.
+   * ARGUMENTS:
+   *   - File path:
+   *       const std::filesystem::path &Path;
+   *   - Content:
+   *       const mesh_file_content &Content;
+   * RETURNS: None.
+   */
+  inline void WriteMeshFile( const std::filesystem::path &Path, const mesh_file_content &Content )
+  {
+    constexpr size_t Padding {prepared_mesh::Padding};
+    const size_t Count
+    {
+      Content.Triangles ? Content.Triangles->Count :
+      Content.Indexed ? Content.Indexed->Count :
+      Content.Prepared ? Content.Prepared->Count : 0
+    };
+
+    if ((Content.Triangles && Content.Triangles->Count != Count) ||
+        (Content.Indexed && Content.Indexed->Count != Count) ||
+        (Content.Prepared && Content.Prepared->Count != Count) ||
+        (Content.Bvh && (Content.Bvh->Indices.size() != Count || Content.Bvh->View.Triangles.Count != Count)) ||
+        (Content.Bvh8 && Content.Bvh8->Indices.size() != Count) ||
+        (Content.QuantizedBvh8 && Content.QuantizedBvh8->Indices.size() != Count))
+      throw std::invalid_argument {"Mesh file parts have different triangles counts"};
+
+    /* Sections layout */
+    const size_t Stride {(Count + Padding - 1) / Padding * Padding};
+    std::vector<mesh_file_section> Sections {};
+
+    if (Content.Triangles)
+      Sections.push_back({(uint32_t)mesh_section::eTriangles, 0, 0, 9 * Stride * sizeof(float), Stride});
+    if (Content.Indexed)
+    {
+      Sections.push_back({(uint32_t)mesh_section::eVertices, 0, 0, Content.Indexed->VertexCount * 3 * sizeof(float), 0});
+      Sections.push_back({(uint32_t)mesh_section::eIndices, 0, 0, Count * 3 * sizeof(uint32_t), 0});
+    }
+    if (Content.Prepared)
+      Sections.push_back({(uint32_t)mesh_section::ePrepared, 0, 0, prepared_mesh::StreamsCount * Stride * sizeof(float), Stride});
+    if (Content.Bvh)
+      Sections.push_back({(uint32_t)mesh_section::eBvh, 0, 0,
+        GetHierarchyLayout(mesh_section::eBvh, Content.Bvh->View.NodesCount, Count).Size, Content.Bvh->View.NodesCount});
+    if (Content.Bvh8)
+      Sections.push_back({(uint32_t)mesh_section::eBvh8, 0, 0,
+        GetHierarchyLayout(mesh_section::eBvh8, Content.Bvh8->View.NodesCount, Count).Size, Content.Bvh8->View.NodesCount});
+    if (Content.QuantizedBvh8)
+      Sections.push_back({(uint32_t)mesh_section::eQuantizedBvh8, 0, 0,
+        GetHierarchyLayout(mesh_section::eQuantizedBvh8, Content.QuantizedBvh8->View.NodesCount, Count).Size, Content.QuantizedBvh8->View.NodesCount});
+
+    uint64_t Offset {sizeof(mesh_file_header) + Sections.size() * sizeof(mesh_file_section)};
+
+    for (mesh_file_section &Section : Sections)
+    {
+      Section.Offset = (Offset + MeshFileAlignment - 1) / MeshFileAlignment * MeshFileAlignment;
+      Offset = Section.Offset + Section.Size;
+    }
+
+    mesh_file_header Header {};
+
+    std::copy_n(mesh_file_header::Signature, 8, Header.Magic);
+    Header.Version = mesh_file_header::CurrentVersion;
+    Header.SectionsCount = (uint32_t)Sections.size();
+    Header.TrianglesCount = Count;
+    Header.VerticesCount = Content.Indexed ? Content.Indexed->VertexCount : 0;
+    Header.FileSize = Offset;
+
+    /* Writing, data goes stream by stream with zero padding */
+    std::ofstream File {Path, std::ios::binary | std::ios::trunc};
+
+    if (!File)
+      throw std::runtime_error {"Cannot create mesh file"};
+
+    const std::vector<char> Zeros(std::max<size_t>(MeshFileAlignment, (Stride - Count) * sizeof(float)));
+    const auto Write {[&]( const void *Data, size_t Size )
+      {
+        File.write(static_cast<const char *>(Data), (std::streamsize)Size);
+      }};
+    const auto WriteStream {[&]( const float *Stream )
+      {
+        Write(Stream, Count * sizeof(float));
+        Write(Zeros.data(), (Stride - Count) * sizeof(float));
+      }};
+    const auto WriteTriangles {[&]( const triangles_soa_view<float> &Tris )
+      {
+        for (size_t i {0}; i < 3; i++)
+        {
+          WriteStream(Tris.X[i]);
+          WriteStream(Tris.Y[i]);
+          WriteStream(Tris.Z[i]);
+        }
+      }};
+    const auto WriteWide {[&]( const mesh_file_section &Section, const auto &Bvh, size_t NodeSize )
+      {
+        const mesh_file_hierarchy_layout Layout {GetHierarchyLayout((mesh_section)Section.Type, Section.Stride, Count)};
+
+        Write(Bvh.View.Nodes, Bvh.View.NodesCount * NodeSize);
+        Write(Zeros.data(), Layout.Subtrees - Bvh.View.NodesCount * NodeSize);
+        Write(Bvh.View.Subtrees, Bvh.View.NodesCount * sizeof(bvh_range));
+        Write(Zeros.data(), Layout.Indices - Layout.Subtrees - Bvh.View.NodesCount * sizeof(bvh_range));
+        Write(Bvh.Indices.data(), Count * sizeof(uint32_t));
+        Write(Zeros.data(), Layout.Triangles - Layout.Indices - Count * sizeof(uint32_t));
+        Write(Bvh.View.Leaves, Count * prepared_mesh::StreamsCount * sizeof(float));
+        Write(Zeros.data(), Padding * sizeof(float));
+      }};
+
+    Write(&Header, sizeof Header);
+    Write(Sections.data(), Sections.size() * sizeof(mesh_file_section));
+    for (const mesh_file_section &Section : Sections)
+    {
+      Write(Zeros.data(), Section.Offset - (uint64_t)File.tellp());
+      switch ((mesh_section)Section.Type)
+      {
+      case mesh_section::eTriangles:
+        WriteTriangles(*Content.Triangles);
+        break;
+      case mesh_section::eVertices:
+        if (Content.Indexed->VertexStride == 3)
+          Write(Content.Indexed->Vertices, Section.Size);
+        else
+          for (size_t i {0}; i < Content.Indexed->VertexCount; i++)
+            Write(Content.Indexed->Vertices + i * Content.Indexed->VertexStride, 3 * sizeof(float));
+        break;
+      case mesh_section::eIndices:
+        Write(Content.Indexed->Indices, Section.Size);
+        break;
+      case mesh_section::ePrepared:
+        for (const float *Stream : GetPreparedStreams(*Content.Prepared))
+          WriteStream(Stream);
+        break;
+      case mesh_section::eBvh:
+        {
+          const mesh_file_hierarchy_layout Layout {GetHierarchyLayout(mesh_section::eBvh, Section.Stride, Count)};
+
+          Write(Content.Bvh->View.Nodes, Content.Bvh->View.NodesCount * sizeof(bvh_node));
+          Write(Zeros.data(), Layout.Indices - Content.Bvh->View.NodesCount * sizeof(bvh_node));
+          Write(Content.Bvh->Indices.data(), Count * sizeof(uint32_t));
+          Write(Zeros.data(), Layout.Triangles - Layout.Indices - Count * sizeof(uint32_t));
+          WriteTriangles(Content.Bvh->View.Triangles);
+        }
+        break;
+      case mesh_section::eBvh8:
+        WriteWide(Section, *Content.Bvh8, sizeof(bvh8_node));
+        break;
+      case mesh_section::eQuantizedBvh8:
+        WriteWide(Section, *Content.QuantizedBvh8, sizeof(quantized_bvh8_node));
+        break;
+      default:
+        break;
+      }
+    }
+
+    if (!File.flush())
+      throw std::runtime_error {"Mesh file writing failed"};
+  } /* End of 'WriteMeshFile' function */
+
+  /* Read only memory mapped mesh file. Views point straight into the mapping (no copies,
+   * pages are loaded on first access), so they are valid while the object is alive */
+  class mesh_file
+  {
+  private:
+    mapped_file File;                  // File mapping
+    const uint8_t *Data {};            // Mapped file start
+    size_t Size {0};                   // Mapped bytes count
+    const mesh_file_header *Header {}; // File header
+    std::array<const mesh_file_section *, (size_t)mesh_section::_LastValue> Sections {}; // Known sections, by type
+
+    /* Header and sections table validation function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Validate( void )
+    {
+      if (Size < sizeof(mesh_file_header))
+        throw std::runtime_error {"Mesh file is too small"};
+
+      Header = reinterpret_cast<const mesh_file_header *>(Data);
+      if (!std::equal(Header->Magic, Header->Magic + 8, mesh_file_header::Signature))
+        throw std::runtime_error {"Not a mesh file"};
+      if (Header->Version == 0 || Header->Version > mesh_file_header::CurrentVersion)
+        throw std::runtime_error {"Unsupported mesh file version"};
+      if (Header->FileSize != Size || Header->SectionsCount > (Size - sizeof(mesh_file_header)) / sizeof(mesh_file_section))
+        throw std::runtime_error {"Mesh file is truncated or corrupted"};
+
+      /* Every triangle takes at least an index and every vertex 3 floats, greater counts are corrupted (and could overflow sizes) */
+      if (Header->TrianglesCount > Size / sizeof(uint32_t) || Header->VerticesCount > Size / (3 * sizeof(float)))
+        throw std::runtime_error {"Mesh file counts do not fit file size"};
+
+      const uint64_t Count {Header->TrianglesCount};
+      const uint64_t Stride {AlignFileSize(Count, prepared_mesh::Padding)};
+      const mesh_file_section *Table {reinterpret_cast<const mesh_file_section *>(Data + sizeof(mesh_file_header))};
+
+      for (size_t i {0}; i < Header->SectionsCount; i++)
+      {
+        const mesh_file_section &Section {Table[i]};
+
+        if (Section.Offset % MeshFileAlignment != 0 || Section.Offset > Size || Section.Size > Size - Section.Offset)
+          throw std::runtime_error {"Mesh file section is out of file"};
+        if (Section.Type == 0 || Section.Type >= (uint32_t)mesh_section::_LastValue)
+          continue;
+
+        uint64_t Expected {0};
+
+        switch ((mesh_section)Section.Type)
+        {
+        case mesh_section::eTriangles:
+          Expected = Section.Stride == Stride ? MulFileSize(Stride, 9 * sizeof(float)) : 0;
+          break;
+        case mesh_section::eVertices:
+          Expected = MulFileSize(Header->VerticesCount, 3 * sizeof(float));
+          break;
+        case mesh_section::eIndices:
+          Expected = MulFileSize(Count, 3 * sizeof(uint32_t));
+          break;
+        case mesh_section::ePrepared:
+          Expected = Section.Stride == Stride ? MulFileSize(Stride, prepared_mesh::StreamsCount * sizeof(float)) : 0;
+          break;
+        case mesh_section::eBvh:
+        case mesh_section::eBvh8:
+        case mesh_section::eQuantizedBvh8:
+          Expected = Section.Stride <= Section.Size / sizeof(bvh_node) && (Section.Stride != 0) == (Count != 0) ?
+            GetHierarchyLayout((mesh_section)Section.Type, Section.Stride, Count).Size : 0;
+          break;
+        default:
+          break;
+        }
+        if (Section.Size != Expected)
+          throw std::runtime_error {"Mesh file section size does not match triangles count"};
+        Sections[Section.Type] = &Section;
+      }
+      if (Has(mesh_section::eVertices) != Has(mesh_section::eIndices))
+        throw std::runtime_error {"Mesh file indexed mesh is incomplete"};
+    } /* End of 'Validate' function */
+
+    /* 8-ary hierarchy view getting function.
+     * ARGUMENTS:
+     *   - Section type ('eBvh8' or 'eQuantizedBvh8'):
+     *       mesh_section Type;
+     * RETURNS:
+     *   (wide_bvh_view<node>) View into mapping.
+     */
+    template<class node>
+      wide_bvh_view<node> GetWideBvh( mesh_section Type ) const
+      {
+        const mesh_file_section &Section {GetSection(Type)};
+        const mesh_file_hierarchy_layout Layout {GetHierarchyLayout(Type, Section.Stride, Header->TrianglesCount)};
+        const uint8_t *Base {Data + Section.Offset};
+
+        return
+        {
+          reinterpret_cast<const node *>(Base),
+          reinterpret_cast<const bvh_range *>(Base + Layout.Subtrees),
+          (size_t)Section.Stride,
+          reinterpret_cast<const float *>(Base + Layout.Triangles),
+        };
+      } /* End of 'GetWideBvh' function */
+
+  public:
+    /* Default constructor */
+    mesh_file( void ) = default;
+
+    /* Constructor from file path, file is mapped and validated (not its data).
+     * ARGUMENTS:
+     *   - File path:
+     *       const std::filesystem::path &Path;
+     */
+    explicit mesh_file( const std::filesystem::path &Path ) :
+      File {Path}, Data {File.GetData()}, Size {File.GetSize()}
+    {
+      Validate();
+    } /* End of constructor */
+
+    /* Move constructor */
+    mesh_file( mesh_file &&Other ) noexcept
+    {
+      *this = std::move(Other);
+    } /* End of constructor */
+
+    /* Move assignment operator */
+    mesh_file &operator=( mesh_file &&Other ) noexcept
+    {
+      if (this != &Other)
+      {
+        File = std::move(Other.File);
+        Data = std::exchange(Other.Data, nullptr);
+        Size = std::exchange(Other.Size, 0);
+        Header = std::exchange(Other.Header, nullptr);
+        Sections = std::exchange(Other.Sections, {});
+      }
+      return *this;
+    } /* End of 'operator=' function */
+
+    mesh_file( const mesh_file & ) = delete;
+    mesh_file &operator=( const mesh_file & ) = delete;
+
+    /* Triangles count getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) Triangles count.
+     */
+    size_t GetCount( void ) const noexcept
+    {
+      return Header != nullptr ? (size_t)Header->TrianglesCount : 0;
+    } /* End of 'GetCount' function */
+
+    /* Section presence check function.
+     * ARGUMENTS:
+     *   - Section type:
+     *       mesh_section Type;
+     * RETURNS:
+     *   (bool) true if file has section.
+     */
+    bool Has( mesh_section Type ) const noexcept
+    {
+      return (size_t)Type < Sections.size() && Sections[(size_t)Type] != nullptr;
+    } /* End of 'Has' function */
+
+    /* Section getting function.
+     * ARGUMENTS:
+     *   - Section type:
+     *       mesh_section Type;
+     * RETURNS:
+     *   (const mesh_file_section &) Section.
+     */
+    const mesh_file_section &GetSection( mesh_section Type ) const
+    {
+      if (!Has(Type))
+        throw std::runtime_error {"Mesh file has no requested section"};
+      return *Sections[(size_t)Type];
+    } /* End of 'GetSection' function */
+
+    /* Triangle soup view getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (triangles_soa_view<float>) View into mapping.
+     */
+    triangles_soa_view<float> GetTriangles( void ) const
+    {
+      const mesh_file_section &Section {GetSection(mesh_section::eTriangles)};
+      const float *Base {reinterpret_cast<const float *>(Data + Section.Offset)};
+      const size_t Stride {(size_t)Section.Stride};
+
+      return
+      {
+        {Base, Base + Stride * 3, Base + Stride * 6},
+        {Base + Stride, Base + Stride * 4, Base + Stride * 7},
+        {Base + Stride * 2, Base + Stride * 5, Base + Stride * 8},
+        GetCount(),
+      };
+    } /* End of 'GetTriangles' function */
+
+    /* Indexed mesh view getting function (indices are not validated).
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (indexed_triangles_view) View into mapping.
+     */
+    indexed_triangles_view GetIndexed( void ) const
+    {
+      return
+      {
+        reinterpret_cast<const float *>(Data + GetSection(mesh_section::eVertices).Offset),
+        3,
+        (size_t)Header->VerticesCount,
+        reinterpret_cast<const uint32_t *>(Data + GetSection(mesh_section::eIndices).Offset),
+        GetCount(),
+      };
+    } /* End of 'GetIndexed' function */
+
+    /* Prepared triangles view getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (prepared_triangles_view) View into mapping.
+     */
+    prepared_triangles_view GetPrepared( void ) const
+    {
+      const mesh_file_section &Section {GetSection(mesh_section::ePrepared)};
+
+      return MakePreparedView(reinterpret_cast<const float *>(Data + Section.Offset), (size_t)Section.Stride, GetCount());
+    } /* End of 'GetPrepared' function */
+
+    /* Binary hierarchy view getting function (nodes are not validated).
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bvh_view) View into mapping, query results are in hierarchy order (see 'GetHierarchyIndices').
+     */
+    bvh_view GetBvh( void ) const
+    {
+      const mesh_file_section &Section {GetSection(mesh_section::eBvh)};
+      const mesh_file_hierarchy_layout Layout {GetHierarchyLayout(mesh_section::eBvh, Section.Stride, Header->TrianglesCount)};
+      const float *Base {reinterpret_cast<const float *>(Data + Section.Offset + Layout.Triangles)};
+      const size_t Stride {(GetCount() + prepared_mesh::Padding - 1) / prepared_mesh::Padding * prepared_mesh::Padding};
+
+      return
+      {
+        reinterpret_cast<const bvh_node *>(Data + Section.Offset),
+        (size_t)Section.Stride,
+        {
+          {Base, Base + Stride * 3, Base + Stride * 6},
+          {Base + Stride, Base + Stride * 4, Base + Stride * 7},
+          {Base + Stride * 2, Base + Stride * 5, Base + Stride * 8},
+          GetCount(),
+        },
+      };
+    } /* End of 'GetBvh' function */
+
+    /* 8-ary hierarchy view getting function (nodes are not validated).
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (bvh8_view) View into mapping, query results are in hierarchy order (see 'GetHierarchyIndices').
+     */
+    bvh8_view GetBvh8( void ) const
+    {
+      return GetWideBvh<bvh8_node>(mesh_section::eBvh8);
+    } /* End of 'GetBvh8' function */
+
+    /* Quantized 8-ary hierarchy view getting function (nodes are not validated).
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (quantized_bvh8_view) View into mapping, query results are in hierarchy order (see 'GetHierarchyIndices').
+     */
+    quantized_bvh8_view GetQuantizedBvh8( void ) const
+    {
+      return GetWideBvh<quantized_bvh8_node>(mesh_section::eQuantizedBvh8);
+    } /* End of 'GetQuantizedBvh8' function */
+
+    /* Hierarchy triangles original indices getting function.
+     * ARGUMENTS:
+     *   - Hierarchy section type ('eBvh', 'eBvh8' or 'eQuantizedBvh8'):
+     *       mesh_section Type;
+     * RETURNS:
+     *   (std::span<const uint32_t>) Original index of every triangle in hierarchy order.
+     */
+    std::span<const uint32_t> GetHierarchyIndices( mesh_section Type ) const
+    {
+      if (Type != mesh_section::eBvh && Type != mesh_section::eBvh8 && Type != mesh_section::eQuantizedBvh8)
+        throw std::invalid_argument {"Mesh file section is not a hierarchy"};
+
+      const mesh_file_section &Section {GetSection(Type)};
+
+      return {reinterpret_cast<const uint32_t *>(Data + Section.Offset + GetHierarchyLayout(Type, Section.Stride, Header->TrianglesCount).Indices), GetCount()};
+    } /* End of 'GetHierarchyIndices' function */
+  }; /* end of 'mesh_file' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_mesh_file_hpp__ */
+
+/* END OF 'overlap_mesh_file.hpp' FILE */
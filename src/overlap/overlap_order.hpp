@@ -0,0 +1,299 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_order.hpp" - Spatial (Morton/Hilbert curve) triangles reordering */
+
+#ifndef __overlap_order_hpp__
+#define __overlap_order_hpp__
+
+#include <limits>
+
+#include "overlap_soa.hpp"
+#include "overlap_parallel.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Space filling curve enumerable */
+  enum class space_curve
+  {
+    eMorton,  // Z-order, bits interleaving, the cheapest one
+    eHilbert, // Hilbert curve, consecutive cells are always adjacent
+
+    _LastValue
+  }; /* end of 'space_curve' enumerable */
+
+  /* Bits per coordinate of curve codes (3 * 21 bits fit into 64-bit code) */
+  inline constexpr uint32_t CurveBits {21};
+
+  /* 21-bit number bits spreading (every bit is followed by 2 zero bits) function.
+   * ARGUMENTS:
+   *   - Number:
+   *       uint32_t X;
+   * RETURNS:
+   *   (uint64_t) Spread bits.
+   */
+  constexpr uint64_t SpreadBits3( uint32_t X ) noexcept
+  {
+    uint64_t V {X & 0x1FFFFFu};
+
+    V = (V | V << 32) & 0x001F00000000FFFFull;
+    V = (V | V << 16) & 0x001F0000FF0000FFull;
+    V = (V | V << 8) & 0x100F00F00F00F00Full;
+    V = (V | V << 4) & 0x10C30C30C30C30C3ull;
+    V = (V | V << 2) & 0x1249249249249249ull;
+    return V;
+  } /* End of 'SpreadBits3' function */
+
+  /* Morton code calculation function.
+   * ARGUMENTS:
+   *   - Cell coordinates (lower 'CurveBits' bits are used):
+   *       uint32_t X, Y, Z;
+   * RETURNS:
+   *   (uint64_t) Code, X bits are the most significant ones at every level.
+   */
+  constexpr uint64_t MortonCode( uint32_t X, uint32_t Y, uint32_t Z ) noexcept
+  {
+    return SpreadBits3(X) << 2 | SpreadBits3(Y) << 1 | SpreadBits3(Z);
+  } /* End of 'MortonCode' function */
+
+  /* Hilbert code calculation function (J. Skilling, "Programming the Hilbert curve", 2004):
+   * coordinates are transformed in place into the "transposed" index, then interleaved.
+   * ARGUMENTS:
+   *   - Cell coordinates (lower 'CurveBits' bits are used):
+   *       uint32_t X, Y, Z;
+   * RETURNS:
+   *   (uint64_t) Code.
+   */
+  constexpr uint64_t HilbertCode( uint32_t X, uint32_t Y, uint32_t Z ) noexcept
+  {
+    uint32_t C[3] {X & 0x1FFFFFu, Y & 0x1FFFFFu, Z & 0x1FFFFFu};
+
+    /* Inverse undo, branchless: coordinates bits are random, so branches would be mispredicted */
+    for (uint32_t Q {1u << (CurveBits - 1)}; Q > 1; Q >>= 1)
+    {
+      const uint32_t P {Q - 1};
+
+      for (size_t i {0}; i < 3; i++)
+      {
+        const uint32_t
+          Invert {P & (0u - ((C[i] & Q) != 0))},
+          T {(C[0] ^ C[i]) & P & ~Invert}; // Exchange low bits with the first coordinate if not inverted
+
+        C[0] ^= Invert ^ T;
+        C[i] ^= T;
+      }
+    }
+
+    /* Gray encode */
+    C[1] ^= C[0];
+    C[2] ^= C[1];
+
+    uint32_t T {0};
+
+    for (uint32_t Q {1u << (CurveBits - 1)}; Q > 1; Q >>= 1)
+      T ^= (Q - 1) & (0u - ((C[2] & Q) != 0));
+    return MortonCode(C[0] ^ T, C[1] ^ T, C[2] ^ T);
+  } /* End of 'HilbertCode' function */
+
+  /* Parallel stable LSD radix sort of 64-bit keys with 32-bit values function.
+   * Every 8-bit digit pass counts digits per thread part, prefix sums counts and
+   * scatters parts in parallel; passes with the same digit in all keys are skipped.
+   * ARGUMENTS:
+   *   - Keys and values to sort by keys (of the same size):
+   *       std::span<uint64_t> Keys;
+   *       std::span<uint32_t> Values;
+   *   - Threads count (default: 0 - hardware concurrency):
+   *       size_t ThreadsCount;
+   * RETURNS: None.
+   */
+  inline void RadixSort( std::span<uint64_t> Keys, std::span<uint32_t> Values, size_t ThreadsCount = 0 )
+  {
+    if (Keys.size() != Values.size())
+      throw std::out_of_range {"Radix sort keys and values counts differ"};
+
+    constexpr size_t MinPartSize {1 << 16};
+    const size_t Count {Keys.size()};
+    const size_t Parts {std::clamp<size_t>(Count / MinPartSize, 1, GetThreadsCount(ThreadsCount))};
+
+    std::vector<uint64_t> KeysTmp(Count);
+    std::vector<uint32_t> ValuesTmp(Count);
+    std::vector<std::array<size_t, 256>> Offsets(Parts);
+    std::span<uint64_t> SrcKeys {Keys}, DstKeys {KeysTmp};
+    std::span<uint32_t> SrcValues {Values}, DstValues {ValuesTmp};
+
+    for (uint32_t Shift {0}; Shift < 64; Shift += 8)
+    {
+      ParallelFor(Count, [&]( size_t Part, size_t First, size_t End )
+        {
+          std::array<size_t, 256> &Hist {Offsets[Part]};
+
+          Hist.fill(0);
+          for (size_t i {First}; i < End; i++)
+            Hist[(SrcKeys[i] >> Shift) & 0xFF]++;
+        }, Parts);
+
+      /* Digits offsets: by digit, then by part */
+      size_t Sum {0};
+      bool IsTrivial {false};
+
+      for (size_t d {0}; d < 256; d++)
+      {
+        size_t DigitCount {0};
+
+        for (size_t p {0}; p < Parts; p++)
+        {
+          const size_t PartCount {Offsets[p][d]};
+
+          Offsets[p][d] = Sum;
+          Sum += PartCount;
+          DigitCount += PartCount;
+        }
+        IsTrivial |= DigitCount == Count;
+      }
+      if (IsTrivial)
+        continue;
+
+      ParallelFor(Count, [&]( size_t Part, size_t First, size_t End )
+        {
+          std::array<size_t, 256> &Offset {Offsets[Part]};
+
+          for (size_t i {First}; i < End; i++)
+          {
+            const size_t Pos {Offset[(SrcKeys[i] >> Shift) & 0xFF]++};
+
+            DstKeys[Pos] = SrcKeys[i];
+            DstValues[Pos] = SrcValues[i];
+          }
+        }, Parts);
+      std::swap(SrcKeys, DstKeys);
+      std::swap(SrcValues, DstValues);
+    }
+
+    if (SrcKeys.data() != Keys.data())
+    {
+      std::copy(SrcKeys.begin(), SrcKeys.end(), Keys.begin());
+      std::copy(SrcValues.begin(), SrcValues.end(), Values.begin());
+    }
+  } /* End of 'RadixSort' function */
+
+  /* Triangles spatial order evaluation function.
+   * Centroids are quantized to 2^21 cells along every axis of their bounding box, triangles are
+   * sorted by curve codes of their cells.
+   * ARGUMENTS:
+   *   - Triangles:
+   *       const triangles_soa_view<float> &Tris;
+   *   - Space filling curve (default: Hilbert):
+   *       space_curve Curve;
+   *   - Threads count (default: 0 - hardware concurrency):
+   *       size_t ThreadsCount;
+   * RETURNS:
+   *   (std::vector<uint32_t>) Permutation: i-th triangle in spatial order is Order[i]-th original one.
+   */
+  inline std::vector<uint32_t> GetSpatialOrder( const triangles_soa_view<float> &Tris, space_curve Curve = space_curve::eHilbert, size_t ThreadsCount = 0 )
+  {
+    if ((size_t)Curve >= (size_t)space_curve::_LastValue)
+      throw std::out_of_range {"Unknown space filling curve"};
+
+    const size_t Count {Tris.Count};
+    const size_t Parts {std::clamp<size_t>(Count / (1 << 16), 1, GetThreadsCount(ThreadsCount))};
+    std::vector<vec3<float>> Centroids(Count);
+    constexpr float Inf {std::numeric_limits<float>::infinity()};
+    std::vector<std::array<vec3<float>, 2>> Bounds(Parts, {vec3<float> {Inf, Inf, Inf}, vec3<float> {-Inf, -Inf, -Inf}});
+
+    ParallelFor(Count, [&]( size_t Part, size_t First, size_t End )
+      {
+        vec3<float> &Min {Bounds[Part][0]}, &Max {Bounds[Part][1]};
+
+        for (size_t i {First}; i < End; i++)
+        {
+          const triangle<float> Tri {Tris[i]};
+          const vec3<float> C {(Tri.V0 + Tri.V1 + Tri.V2) * (1 / 3.f)};
+
+          Centroids[i] = C;
+          Min = {std::min(Min.X, C.X), std::min(Min.Y, C.Y), std::min(Min.Z, C.Z)};
+          Max = {std::max(Max.X, C.X), std::max(Max.Y, C.Y), std::max(Max.Z, C.Z)};
+        }
+      }, Parts);
+
+    vec3<float> Min {Bounds[0][0]}, Max {Bounds[0][1]};
+
+    for (const std::array<vec3<float>, 2> &B : Bounds)
+    {
+      Min = {std::min(Min.X, B[0].X), std::min(Min.Y, B[0].Y), std::min(Min.Z, B[0].Z)};
+      Max = {std::max(Max.X, B[1].X), std::max(Max.Y, B[1].Y), std::max(Max.Z, B[1].Z)};
+    }
+
+    /* Cells scale, degenerate axes get zero cell coordinates */
+    constexpr float MaxCell {(float)((1u << CurveBits) - 1)};
+    const vec3<float> Size {Max - Min};
+    const vec3<float> Scale {Size.X > 0 ? MaxCell / Size.X : 0, Size.Y > 0 ? MaxCell / Size.Y : 0, Size.Z > 0 ? MaxCell / Size.Z : 0};
+    std::vector<uint64_t> Codes(Count);
+    std::vector<uint32_t> Order(Count);
+
+    ParallelFor(Count, [&]( size_t, size_t First, size_t End )
+      {
+        for (size_t i {First}; i < End; i++)
+        {
+          const vec3<float> P {Centroids[i] - Min};
+          const uint32_t
+            X {(uint32_t)std::clamp(P.X * Scale.X, 0.f, MaxCell)},
+            Y {(uint32_t)std::clamp(P.Y * Scale.Y, 0.f, MaxCell)},
+            Z {(uint32_t)std::clamp(P.Z * Scale.Z, 0.f, MaxCell)};
+
+          Codes[i] = Curve == space_curve::eMorton ? MortonCode(X, Y, Z) : HilbertCode(X, Y, Z);
+          Order[i] = (uint32_t)i;
+        }
+      }, Parts);
+
+    RadixSort(Codes, Order, ThreadsCount);
+    return Order;
+  } /* End of 'GetSpatialOrder' function */
+
+  /* Triangles permutation function.
+   * ARGUMENTS:
+   *   - Triangles:
+   *       const triangles_soa_view<float> &Tris;
+   *   - Permutation (i-th result triangle is Order[i]-th source one, see 'GetSpatialOrder'):
+   *       std::span<const uint32_t> Order;
+   *   - Threads count (default: 0 - hardware concurrency):
+   *       size_t ThreadsCount;
+   * RETURNS:
+   *   (triangle_soa) Reordered triangles.
+   */
+  inline triangle_soa Permute( const triangles_soa_view<float> &Tris, std::span<const uint32_t> Order, size_t ThreadsCount = 0 )
+  {
+    if (Order.size() != Tris.Count)
+      throw std::out_of_range {"Permutation size differs from triangles count"};
+
+    triangle_soa Result {};
+
+    Result.Expand(Order.size());
+    ParallelFor(Order.size(), [&]( size_t, size_t First, size_t End )
+      {
+        for (size_t i {First}; i < End; i++)
+        {
+          const triangle<float> Tri {Tris[Order[i]]};
+
+          Result.Set(i, Tri.V0, Tri.V1, Tri.V2);
+        }
+      }, std::clamp<size_t>(Order.size() / (1 << 16), 1, GetThreadsCount(ThreadsCount)));
+    return Result;
+  } /* End of 'Permute' function */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_order_hpp__ */
+
+/* END OF 'overlap_order.hpp' FILE */
@@ -0,0 +1,97 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_parallel.hpp" - Simple fork-join helpers for preprocessing passes */
+
+#ifndef __overlap_parallel_hpp__
+#define __overlap_parallel_hpp__
+
+#include <exception>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+/* Math namespace */
+namespace math
+{
+  /* Worker threads count resolving function.
+   * ARGUMENTS:
+   *   - Requested threads count (0 - hardware concurrency):
+   *       size_t ThreadsCount;
+   * RETURNS:
+   *   (size_t) Threads count, at least 1.
+   */
+  inline size_t GetThreadsCount( size_t ThreadsCount ) noexcept
+  {
+    return ThreadsCount != 0 ? ThreadsCount : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  } /* End of 'GetThreadsCount' function */
+
+  /* Range processing in parallel function.
+   * Range is split into 'ThreadsCount' contiguous equal parts (split depends only on count
+   * and threads count, so several passes may rely on it), the last part runs on the calling thread.
+   * All threads are joined before return, the first exception (by part number) is rethrown then.
+   * ARGUMENTS:
+   *   - Elements count:
+   *       size_t Count;
+   *   - Part processing function, called as Func(Part, First, End):
+   *       func &&Func;
+   *   - Threads count (parts count, must be non-zero):
+   *       size_t ThreadsCount;
+   * RETURNS: None.
+   */
+  template<class func>
+    void ParallelFor( size_t Count, func &&Func, size_t ThreadsCount )
+    {
+      const size_t PartSize {(Count + ThreadsCount - 1) / ThreadsCount};
+      std::vector<std::exception_ptr> Errors(ThreadsCount);
+      std::vector<std::thread> Threads {};
+
+      /* Part running, its exception is kept until all threads are joined */
+      const auto Run {[&Func, &Errors, PartSize, Count]( size_t Part ) noexcept
+        {
+          try
+          {
+            Func(Part, std::min(Part * PartSize, Count), std::min((Part + 1) * PartSize, Count));
+          }
+          catch (...)
+          {
+            Errors[Part] = std::current_exception();
+          }
+        }};
+
+      try
+      {
+        Threads.reserve(ThreadsCount - 1);
+        for (size_t t {0}; t + 1 < ThreadsCount; t++)
+          Threads.emplace_back(Run, t);
+        Run(ThreadsCount - 1);
+      }
+      catch (...)
+      {
+        /* Thread is not started: the rest of parts is not run */
+        Errors.back() = std::current_exception();
+      }
+
+      for (std::thread &Thread : Threads)
+        Thread.join();
+      for (const std::exception_ptr &Error : Errors)
+        if (Error != nullptr)
+          std::rethrow_exception(Error);
+    } /* End of 'ParallelFor' function */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_parallel_hpp__ */
+
+/* END OF 'overlap_parallel.hpp' FILE */
@@ -0,0 +1,293 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_prepared.hpp" - Prepared triangles cache for repeated box queries */
+
+#ifndef __overlap_prepared_hpp__
+#define __overlap_prepared_hpp__
+
+#include <memory>
+#include <new>
+
+#include "overlap_base.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Prepared triangles set view. Every separating axis except box ones does not depend
+   * on the box, so its triangle projection interval is stored together with the axis:
+   * axis separates iff |Axis . C - Mid| > Half + |Axis| . H.
+   * All streams are padded with zeros up to multiple of 'prepared_mesh::Padding' elements. */
+  struct prepared_triangles_view
+  {
+    std::array<const float *, 9> Edges {};      // Edges components, [edge * 3 + component]
+    std::array<const float *, 9> AbsEdges {};   // Edges components absolute values, [edge * 3 + component]
+    std::array<const float *, 9> AxesMid {};    // Edge cross X, Y, Z axes projection interval centers, [edge * 3 + axis]
+    std::array<const float *, 9> AxesHalf {};   // Edge cross X, Y, Z axes projection interval half widths, [edge * 3 + axis]
+    std::array<const float *, 3> BoundsMid {};  // Triangle bounding box center
+    std::array<const float *, 3> BoundsHalf {}; // Triangle bounding box half size
+    std::array<const float *, 3> Normal {};     // Plane normal
+    std::array<const float *, 3> AbsNormal {};  // Plane normal components absolute values
+    const float *PlaneD {};                     // Plane offset, Normal . V0
+    size_t Count {0};                           // Triangles count
+  }; /* end of 'prepared_triangles_view' structure */
+
+  /* Box against prepared triangle overlap test function (scalar).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Prepared triangles:
+   *       const prepared_triangles_view &Tris;
+   *   - Triangle index:
+   *       size_t Index;
+   * RETURNS:
+   *   (bool) true if box and triangle overlap.
+   */
+  inline bool BoxPreparedTriangleOverlapTest( const aabb<float> &Box, const prepared_triangles_view &Tris, size_t Index ) noexcept
+  {
+    const vec3<float> &C {Box.Center}, &H {Box.HalfSize};
+
+    /* Box face normals */
+    if (Abs(Tris.BoundsMid[0][Index] - C.X) > Tris.BoundsHalf[0][Index] + H.X ||
+        Abs(Tris.BoundsMid[1][Index] - C.Y) > Tris.BoundsHalf[1][Index] + H.Y ||
+        Abs(Tris.BoundsMid[2][Index] - C.Z) > Tris.BoundsHalf[2][Index] + H.Z)
+      return false;
+
+    /* Edge cross products with X, Y and Z box axes */
+    for (size_t i {0}; i < 3; i++)
+    {
+      const vec3<float>
+        E {Tris.Edges[i * 3 + 0][Index], Tris.Edges[i * 3 + 1][Index], Tris.Edges[i * 3 + 2][Index]},
+        F {Tris.AbsEdges[i * 3 + 0][Index], Tris.AbsEdges[i * 3 + 1][Index], Tris.AbsEdges[i * 3 + 2][Index]};
+
+      if (Abs(E.Z * C.Y - E.Y * C.Z - Tris.AxesMid[i * 3 + 0][Index]) > Tris.AxesHalf[i * 3 + 0][Index] + F.Z * H.Y + F.Y * H.Z ||
+          Abs(E.X * C.Z - E.Z * C.X - Tris.AxesMid[i * 3 + 1][Index]) > Tris.AxesHalf[i * 3 + 1][Index] + F.Z * H.X + F.X * H.Z ||
+          Abs(E.Y * C.X - E.X * C.Y - Tris.AxesMid[i * 3 + 2][Index]) > Tris.AxesHalf[i * 3 + 2][Index] + F.Y * H.X + F.X * H.Y)
+        return false;
+    }
+
+    /* Triangle plane */
+    const vec3<float>
+      N {Tris.Normal[0][Index], Tris.Normal[1][Index], Tris.Normal[2][Index]},
+      AbsN {Tris.AbsNormal[0][Index], Tris.AbsNormal[1][Index], Tris.AbsNormal[2][Index]};
+
+    return Abs(Dot(N, C) - Tris.PlaneD[Index]) <= Dot(AbsN, H);
+  } /* End of 'BoxPreparedTriangleOverlapTest' function */
+
+  /* Box against prepared triangle classification function (scalar, see 'BoxTriangleClassify').
+   * Containment is checked by the triangle bounding box: |BoundsMid - C| + BoundsHalf <= H.
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Prepared triangles:
+   *       const prepared_triangles_view &Tris;
+   *   - Triangle index:
+   *       size_t Index;
+   * RETURNS:
+   *   (overlap_class) Relation of triangle to box.
+   */
+  inline overlap_class BoxPreparedTriangleClassify( const aabb<float> &Box, const prepared_triangles_view &Tris, size_t Index ) noexcept
+  {
+    const vec3<float> &C {Box.Center}, &H {Box.HalfSize};
+
+    if (Abs(Tris.BoundsMid[0][Index] - C.X) + Tris.BoundsHalf[0][Index] <= H.X &&
+        Abs(Tris.BoundsMid[1][Index] - C.Y) + Tris.BoundsHalf[1][Index] <= H.Y &&
+        Abs(Tris.BoundsMid[2][Index] - C.Z) + Tris.BoundsHalf[2][Index] <= H.Z)
+      return overlap_class::eContained;
+    return BoxPreparedTriangleOverlapTest(Box, Tris, Index) ? overlap_class::eStraddles : overlap_class::eOutside;
+  } /* End of 'BoxPreparedTriangleClassify' function */
+
+  /* Triangles set with precomputed per triangle separating axes setup (owning) */
+  class prepared_mesh
+  {
+  public:
+    static constexpr size_t Padding {16};      // Streams length granularity, widest kernel lanes count
+    static constexpr size_t Alignment {64};    // Streams alignment, cache line
+    static constexpr size_t StreamsCount {49}; // Floats per triangle
+
+  private:
+    /* Aligned storage deleter */
+    struct aligned_deleter
+    {
+      void operator()( float *Ptr ) const noexcept
+      {
+        ::operator delete[](Ptr, std::align_val_t {Alignment});
+      }
+    }; /* end of 'aligned_deleter' structure */
+
+    /* Streams offsets in storage, in streams */
+    enum stream : size_t
+    {
+      eEdges      = 0,
+      eAbsEdges   = 9,
+      eAxesMid    = 18,
+      eAxesHalf   = 27,
+      eBoundsMid  = 36,
+      eBoundsHalf = 39,
+      eNormal     = 42,
+      eAbsNormal  = 45,
+      ePlaneD     = 48,
+    }; /* end of 'stream' enumerable */
+
+    size_t Count {0};  // Triangles count
+    size_t Stride {0}; // Single stream length, padded (one extra pack keeps streams off power of two distances)
+    std::unique_ptr<float[], aligned_deleter> Data {}; // All streams storage
+
+  public:
+    /* Triangle preparation function.
+     * ARGUMENTS:
+     *   - Triangle:
+     *       const triangle<float> &Tri;
+     *   - Triangle first stream value output, stream k value goes to Dst[k * Stride]:
+     *       float *Dst;
+     *   - Distance between streams:
+     *       size_t Stride;
+     * RETURNS: None.
+     */
+    static void PrepareTriangle( const triangle<float> &Tri, float *Dst, size_t Stride ) noexcept
+    {
+      const std::array<vec3<float>, 3> Edges {Tri.V1 - Tri.V0, Tri.V2 - Tri.V1, Tri.V0 - Tri.V2};
+
+      for (size_t i {0}; i < 3; i++)
+      {
+        const vec3<float> &E {Edges[i]};
+
+        /* Projections of all vertices on edge cross X, Y and Z axes */
+        const std::array<vec3<float>, 3> Proj
+        {{
+          {E.Z * Tri.V0.Y - E.Y * Tri.V0.Z, E.Z * Tri.V1.Y - E.Y * Tri.V1.Z, E.Z * Tri.V2.Y - E.Y * Tri.V2.Z},
+          {E.X * Tri.V0.Z - E.Z * Tri.V0.X, E.X * Tri.V1.Z - E.Z * Tri.V1.X, E.X * Tri.V2.Z - E.Z * Tri.V2.X},
+          {E.Y * Tri.V0.X - E.X * Tri.V0.Y, E.Y * Tri.V1.X - E.X * Tri.V1.Y, E.Y * Tri.V2.X - E.X * Tri.V2.Y},
+        }};
+
+        Dst[(eEdges + i * 3) * Stride] = E.X;
+        Dst[(eEdges + i * 3 + 1) * Stride] = E.Y;
+        Dst[(eEdges + i * 3 + 2) * Stride] = E.Z;
+        Dst[(eAbsEdges + i * 3) * Stride] = Abs(E.X);
+        Dst[(eAbsEdges + i * 3 + 1) * Stride] = Abs(E.Y);
+        Dst[(eAbsEdges + i * 3 + 2) * Stride] = Abs(E.Z);
+
+        for (size_t k {0}; k < 3; k++)
+        {
+          const float
+            Min {std::min({Proj[k].X, Proj[k].Y, Proj[k].Z})},
+            Max {std::max({Proj[k].X, Proj[k].Y, Proj[k].Z})};
+
+          Dst[(eAxesMid + i * 3 + k) * Stride] = (Min + Max) * 0.5f;
+          Dst[(eAxesHalf + i * 3 + k) * Stride] = (Max - Min) * 0.5f;
+        }
+      }
+
+      const vec3<float>
+        Min {std::min({Tri.V0.X, Tri.V1.X, Tri.V2.X}), std::min({Tri.V0.Y, Tri.V1.Y, Tri.V2.Y}), std::min({Tri.V0.Z, Tri.V1.Z, Tri.V2.Z})},
+        Max {std::max({Tri.V0.X, Tri.V1.X, Tri.V2.X}), std::max({Tri.V0.Y, Tri.V1.Y, Tri.V2.Y}), std::max({Tri.V0.Z, Tri.V1.Z, Tri.V2.Z})},
+        BoundsMid {(Min + Max) * 0.5f},
+        BoundsHalf {(Max - Min) * 0.5f},
+        N {Cross(Edges[0], Edges[1])};
+
+      Dst[eBoundsMid * Stride] = BoundsMid.X;
+      Dst[(eBoundsMid + 1) * Stride] = BoundsMid.Y;
+      Dst[(eBoundsMid + 2) * Stride] = BoundsMid.Z;
+      Dst[eBoundsHalf * Stride] = BoundsHalf.X;
+      Dst[(eBoundsHalf + 1) * Stride] = BoundsHalf.Y;
+      Dst[(eBoundsHalf + 2) * Stride] = BoundsHalf.Z;
+      Dst[eNormal * Stride] = N.X;
+      Dst[(eNormal + 1) * Stride] = N.Y;
+      Dst[(eNormal + 2) * Stride] = N.Z;
+      Dst[eAbsNormal * Stride] = Abs(N.X);
+      Dst[(eAbsNormal + 1) * Stride] = Abs(N.Y);
+      Dst[(eAbsNormal + 2) * Stride] = Abs(N.Z);
+      Dst[ePlaneD * Stride] = Dot(N, Tri.V0);
+    } /* End of 'PrepareTriangle' function */
+
+    /* View of streams with a given layout making function.
+     * ARGUMENTS:
+     *   - First stream:
+     *       const float *Data;
+     *   - Distance between streams:
+     *       size_t Stride;
+     *   - Triangles count:
+     *       size_t Count;
+     * RETURNS:
+     *   (prepared_triangles_view) View.
+     */
+    static prepared_triangles_view MakeView( const float *Data, size_t Stride, size_t Count ) noexcept
+    {
+      prepared_triangles_view View {};
+
+      for (size_t i {0}; i < 9; i++)
+      {
+        View.Edges[i] = Data + (eEdges + i) * Stride;
+        View.AbsEdges[i] = Data + (eAbsEdges + i) * Stride;
+        View.AxesMid[i] = Data + (eAxesMid + i) * Stride;
+        View.AxesHalf[i] = Data + (eAxesHalf + i) * Stride;
+      }
+      for (size_t i {0}; i < 3; i++)
+      {
+        View.BoundsMid[i] = Data + (eBoundsMid + i) * Stride;
+        View.BoundsHalf[i] = Data + (eBoundsHalf + i) * Stride;
+        View.Normal[i] = Data + (eNormal + i) * Stride;
+        View.AbsNormal[i] = Data + (eAbsNormal + i) * Stride;
+      }
+      View.PlaneD = Data + ePlaneD * Stride;
+      View.Count = Count;
+
+      return View;
+    } /* End of 'MakeView' function */
+
+    /* Default constructor */
+    prepared_mesh( void ) = default;
+
+    /* Constructor from triangles set.
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Tris;
+     */
+    explicit prepared_mesh( const triangles_soa_view<float> &Tris ) :
+      Count {Tris.Count},
+      Stride {(Tris.Count + Padding - 1) / Padding * Padding + Padding},
+      Data {static_cast<float *>(::operator new[](StreamsCount * Stride * sizeof(float), std::align_val_t {Alignment}))}
+    {
+      std::fill_n(Data.get(), StreamsCount * Stride, 0.f);
+
+      for (size_t t {0}; t < Count; t++)
+        PrepareTriangle(Tris[t], Data.get() + t, Stride);
+    } /* End of constructor */
+
+    /* Triangles count getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) Triangles count.
+     */
+    size_t GetCount( void ) const noexcept
+    {
+      return Count;
+    } /* End of 'GetCount' function */
+
+    /* View for batch kernels getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (prepared_triangles_view) View.
+     */
+    prepared_triangles_view GetView( void ) const noexcept
+    {
+      return MakeView(Data.get(), Stride, Count);
+    } /* End of 'GetView' function */
+  }; /* end of 'prepared_mesh' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_prepared_hpp__ */
+
+/* END OF 'overlap_prepared.hpp' FILE */
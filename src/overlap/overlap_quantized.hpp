@@ -0,0 +1,193 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_quantized.hpp" - 16-bit quantized triangles storage */
+
+#ifndef __overlap_quantized_hpp__
+#define __overlap_quantized_hpp__
+
+#include <cmath>
+#include <limits>
+
+#include "overlap_soa.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Quantized triangles chunk parameters. Vertex coordinate is decoded as Origin + Q * Step,
+   * decoded vertices differ from the original ones by at most Error along every axis */
+  struct quantized_chunk
+  {
+    vec3<float> Origin {}; // Chunk bounding box minimal corner
+    vec3<float> Step {};   // Quantization step
+    vec3<float> Error {};  // Decoding error bound, query boxes are inflated by it
+  }; /* end of 'quantized_chunk' structure */
+
+  /* Quantized triangles set, non-owning view.
+   * Triangles are split into chunks of 'ChunkSize', streams are padded to whole chunks */
+  struct quantized_triangles_view
+  {
+    static constexpr size_t ChunkSize {256}; // Triangles per chunk, multiple of the widest kernel width
+
+    const quantized_chunk *Chunks {};            // Chunks parameters
+    std::array<const uint16_t *, 9> Streams {};  // Quantized coordinates streams [vertex * 3 + component]
+    size_t Count {0};                            // Triangles count
+
+    /* Decoded triangle getting function.
+     * ARGUMENTS:
+     *   - Triangle index:
+     *       size_t Index;
+     * RETURNS:
+     *   (triangle<float>) Decoded triangle.
+     */
+    triangle<float> operator[]( size_t Index ) const noexcept
+    {
+      const quantized_chunk &Chunk {Chunks[Index / ChunkSize]};
+      vec3<float> V[3];
+
+      for (size_t i {0}; i < 3; i++)
+        V[i] =
+        {
+          std::fma((float)Streams[i * 3][Index], Chunk.Step.X, Chunk.Origin.X),
+          std::fma((float)Streams[i * 3 + 1][Index], Chunk.Step.Y, Chunk.Origin.Y),
+          std::fma((float)Streams[i * 3 + 2][Index], Chunk.Step.Z, Chunk.Origin.Z),
+        };
+      return {V[0], V[1], V[2]};
+    } /* End of 'operator[]' function */
+  }; /* end of 'quantized_triangles_view' structure */
+
+  /* Box against quantized triangle conservative overlap test function.
+   * Box is inflated by the chunk decoding error, so triangles, overlapping the box before
+   * quantization, are never rejected (some close ones are reported as overlapping).
+   * ARGUMENTS:
+   *   - Box:
+   *       const aabb<float> &Box;
+   *   - Quantized triangles:
+   *       const quantized_triangles_view &Tris;
+   *   - Triangle index:
+   *       size_t Index;
+   * RETURNS:
+   *   (bool) true if triangle may overlap box.
+   */
+  inline bool BoxQuantizedTriangleOverlapTest( const aabb<float> &Box, const quantized_triangles_view &Tris, size_t Index ) noexcept
+  {
+    return BoxTriangleOverlapTest({Box.Center, Box.HalfSize + Tris.Chunks[Index / quantized_triangles_view::ChunkSize].Error}, Tris[Index]);
+  } /* End of 'BoxQuantizedTriangleOverlapTest' function */
+
+  /* Triangles set, quantized to 16 bits relative to bounding box of every chunk */
+  class quantized_mesh
+  {
+  public:
+    static constexpr size_t ChunkSize {quantized_triangles_view::ChunkSize}; // Triangles per chunk
+
+  private:
+    std::vector<quantized_chunk> Chunks {};            // Chunks parameters
+    std::array<aligned_vector<uint16_t>, 9> Streams {}; // Quantized coordinates streams
+    size_t Count {0};                                   // Triangles count
+
+  public:
+    /* Default constructor */
+    quantized_mesh( void ) = default;
+
+    /* Constructor from triangles set.
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Tris;
+     */
+    explicit quantized_mesh( const triangles_soa_view<float> &Tris ) :
+      Chunks((Tris.Count + ChunkSize - 1) / ChunkSize),
+      Count {Tris.Count}
+    {
+      constexpr float MaxCode {(float)std::numeric_limits<uint16_t>::max()};
+
+      for (aligned_vector<uint16_t> &Stream : Streams)
+        Stream.resize(Chunks.size() * ChunkSize, 0);
+
+      for (size_t c {0}; c < Chunks.size(); c++)
+      {
+        const size_t First {c * ChunkSize}, End {std::min(First + ChunkSize, Count)};
+        vec3<float> Min {Tris[First].V0}, Max {Min};
+
+        for (size_t t {First}; t < End; t++)
+        {
+          const triangle<float> Tri {Tris[t]};
+
+          for (const vec3<float> &V : {Tri.V0, Tri.V1, Tri.V2})
+          {
+            Min = {std::min(Min.X, V.X), std::min(Min.Y, V.Y), std::min(Min.Z, V.Z)};
+            Max = {std::max(Max.X, V.X), std::max(Max.Y, V.Y), std::max(Max.Z, V.Z)};
+          }
+        }
+
+        quantized_chunk &Chunk {Chunks[c]};
+
+        Chunk.Origin = Min;
+        Chunk.Step = (Max - Min) * (1 / MaxCode);
+
+        /* Every coordinate is quantized to the nearest code, error bound is measured on decoded
+         * values (both with and without FMA, as kernels do) and widened by float rounding of the test */
+        const float *Origin {&Chunk.Origin.X}, *Step {&Chunk.Step.X};
+        float *Error {&Chunk.Error.X};
+
+        for (size_t t {First}; t < End; t++)
+        {
+          const triangle<float> Tri {Tris[t]};
+          const vec3<float> *V[3] {&Tri.V0, &Tri.V1, &Tri.V2};
+
+          for (size_t i {0}; i < 3; i++)
+            for (size_t k {0}; k < 3; k++)
+            {
+              const float
+                Value {(&V[i]->X)[k]},
+                Code {Step[k] > 0 ? std::clamp(std::nearbyint((Value - Origin[k]) / Step[k]), 0.f, MaxCode) : 0.f};
+
+              Streams[i * 3 + k][t] = (uint16_t)Code;
+              Error[k] = std::max({Error[k], Abs(std::fma(Code, Step[k], Origin[k]) - Value), Abs(Code * Step[k] + Origin[k] - Value)});
+            }
+        }
+        for (size_t k {0}; k < 3; k++)
+          Error[k] += (Abs(Origin[k]) + Abs(Origin[k] + Step[k] * MaxCode)) * std::numeric_limits<float>::epsilon();
+      }
+    } /* End of constructor */
+
+    /* Triangles count getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) Triangles count.
+     */
+    size_t GetCount( void ) const noexcept
+    {
+      return Count;
+    } /* End of 'GetCount' function */
+
+    /* View for batch kernels getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (quantized_triangles_view) View.
+     */
+    quantized_triangles_view GetView( void ) const noexcept
+    {
+      quantized_triangles_view View {Chunks.data(), {}, Count};
+
+      for (size_t i {0}; i < 9; i++)
+        View.Streams[i] = Streams[i].data();
+      return View;
+    } /* End of 'GetView' function */
+  }; /* end of 'quantized_mesh' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_quantized_hpp__ */
+
+/* END OF 'overlap_quantized.hpp' FILE */
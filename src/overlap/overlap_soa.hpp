@@ -0,0 +1,368 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_soa.hpp" - Aligned structure of arrays containers for batch tests input */
+
+#ifndef __overlap_soa_hpp__
+#define __overlap_soa_hpp__
+
+#include <vector>
+#include <new>
+#include <type_traits>
+
+#include "overlap_base.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Cache line aligned allocator */
+  template<class type, size_t Alignment = 64>
+    struct aligned_allocator
+    {
+      using value_type = type;
+
+      /* Rebinding to other type structure */
+      template<class other_type>
+        struct rebind
+        {
+          using other = aligned_allocator<other_type, Alignment>;
+        }; /* end of 'rebind' structure */
+
+      /* Default constructor */
+      constexpr aligned_allocator( void ) noexcept = default;
+
+      /* Converting constructor */
+      template<class other_type>
+        constexpr aligned_allocator( const aligned_allocator<other_type, Alignment> & ) noexcept
+        {
+        } /* End of constructor */
+
+      /* Memory allocation function.
+       * ARGUMENTS:
+       *   - Elements count:
+       *       size_t Count;
+       * RETURNS:
+       *   (type *) Allocated memory.
+       */
+      type *allocate( size_t Count )
+      {
+        return static_cast<type *>(::operator new[](Count * sizeof(type), std::align_val_t {Alignment}));
+      } /* End of 'allocate' function */
+
+      /* Memory freeing function.
+       * ARGUMENTS:
+       *   - Memory:
+       *       type *Ptr;
+       *   - Elements count:
+       *       size_t Count;
+       * RETURNS: None.
+       */
+      void deallocate( type *Ptr, size_t ) noexcept
+      {
+        ::operator delete[](Ptr, std::align_val_t {Alignment});
+      } /* End of 'deallocate' function */
+
+      /* Element default construction function: trivial elements are left uninitialized, so growing
+       * containers does not write memory, which is filled right after (possibly by several threads).
+       * ARGUMENTS:
+       *   - Element:
+       *       other_type *Ptr;
+       * RETURNS: None.
+       */
+      template<class other_type>
+        void construct( other_type *Ptr ) noexcept(std::is_nothrow_default_constructible_v<other_type>)
+        {
+          ::new(static_cast<void *>(Ptr)) other_type;
+        } /* End of 'construct' function */
+
+      /* Comparison operator, all instances are interchangeable */
+      template<class other_type>
+        constexpr bool operator==( const aligned_allocator<other_type, Alignment> & ) const noexcept
+        {
+          return true;
+        } /* End of 'operator==' function */
+    }; /* end of 'aligned_allocator' structure */
+
+  /* Cache line aligned vector */
+  template<class type>
+    using aligned_vector = std::vector<type, aligned_allocator<type>>;
+
+  /* Aligned streams set, every stream is padded with zeros to multiple of 'Padding' elements */
+  template<size_t StreamsCount>
+    class aligned_streams
+    {
+    public:
+      static constexpr size_t Padding {16}; // Streams length granularity, widest kernel lanes count
+
+    protected:
+      std::array<aligned_vector<float>, StreamsCount> Streams {}; // Streams
+      size_t Count {0};                                           // Elements count
+
+      /* Streams growing function, added elements are uninitialized (padding is zeroed).
+       * ARGUMENTS:
+       *   - Elements count to add:
+       *       size_t Added;
+       * RETURNS:
+       *   (size_t) Index of the first added element.
+       */
+      size_t Grow( size_t Added )
+      {
+        const size_t First {Count};
+
+        Count += Added;
+        for (aligned_vector<float> &Stream : Streams)
+        {
+          Stream.resize(GetPaddedCount());
+          std::fill(Stream.begin() + Count, Stream.end(), 0.f);
+        }
+        return First;
+      } /* End of 'Grow' function */
+
+    public:
+      /* Elements count getting function.
+       * ARGUMENTS: None.
+       * RETURNS:
+       *   (size_t) Elements count.
+       */
+      size_t GetCount( void ) const noexcept
+      {
+        return Count;
+      } /* End of 'GetCount' function */
+
+      /* Padded elements count getting function.
+       * ARGUMENTS: None.
+       * RETURNS:
+       *   (size_t) Elements count, rounded up to multiple of 'Padding' (so of any kernel width).
+       */
+      size_t GetPaddedCount( void ) const noexcept
+      {
+        return (Count + Padding - 1) / Padding * Padding;
+      } /* End of 'GetPaddedCount' function */
+
+      /* Stream getting function.
+       * ARGUMENTS:
+       *   - Stream index:
+       *       size_t Index;
+       * RETURNS:
+       *   (std::span<const float>) Stream, including zero padding.
+       */
+      std::span<const float> GetStream( size_t Index ) const noexcept
+      {
+        return {Streams[Index].data(), GetPaddedCount()};
+      } /* End of 'GetStream' function */
+
+      /* Memory reserving function.
+       * ARGUMENTS:
+       *   - Elements count to reserve memory for:
+       *       size_t Capacity;
+       * RETURNS: None.
+       */
+      void Reserve( size_t Capacity )
+      {
+        for (aligned_vector<float> &Stream : Streams)
+          Stream.reserve((Capacity + Padding - 1) / Padding * Padding);
+      } /* End of 'Reserve' function */
+
+      /* Clearing function.
+       * ARGUMENTS: None.
+       * RETURNS: None.
+       */
+      void Clear( void ) noexcept
+      {
+        for (aligned_vector<float> &Stream : Streams)
+          Stream.clear();
+        Count = 0;
+      } /* End of 'Clear' function */
+    }; /* end of 'aligned_streams' class */
+
+  /* Triangle soup, stored as 9 aligned coordinates streams [vertex * 3 + component] */
+  class triangle_soa : public aligned_streams<9>
+  {
+  public:
+    /* Triangles appending function.
+     * ARGUMENTS:
+     *   - Triangles:
+     *       std::span<const triangle<float>> Tris;
+     * RETURNS: None.
+     */
+    void Append( std::span<const triangle<float>> Tris )
+    {
+      const size_t First {Grow(Tris.size())};
+
+      for (size_t i {0}; i < Tris.size(); i++)
+      {
+        const triangle<float> &Tri {Tris[i]};
+
+        Set(First + i, Tri.V0, Tri.V1, Tri.V2);
+      }
+    } /* End of 'Append' function */
+
+    /* Triangles from vertices appending function.
+     * ARGUMENTS:
+     *   - Vertices, 3 consecutive per triangle:
+     *       std::span<const vec3<float>> Vertices;
+     * RETURNS: None.
+     */
+    void Append( std::span<const vec3<float>> Vertices )
+    {
+      if (Vertices.size() % 3 != 0)
+        throw std::invalid_argument {"Vertices count is not a multiple of 3"};
+
+      const size_t First {Grow(Vertices.size() / 3)};
+
+      for (size_t i {0}; i < Vertices.size() / 3; i++)
+        Set(First + i, Vertices[i * 3], Vertices[i * 3 + 1], Vertices[i * 3 + 2]);
+    } /* End of 'Append' function */
+
+    /* Triangles from interleaved coordinates appending function.
+     * ARGUMENTS:
+     *   - Coordinates, 9 consecutive per triangle:
+     *       std::span<const float> Coords;
+     * RETURNS: None.
+     */
+    void Append( std::span<const float> Coords )
+    {
+      if (Coords.size() % 9 != 0)
+        throw std::invalid_argument {"Coordinates count is not a multiple of 9"};
+
+      const size_t First {Grow(Coords.size() / 9)};
+
+      for (size_t i {0}; i < Coords.size() / 9; i++)
+        for (size_t k {0}; k < 9; k++)
+          Streams[k][First + i] = Coords[i * 9 + k];
+    } /* End of 'Append' function */
+
+    /* Uninitialized triangles appending function, they must be filled later by 'Set'/'SetVertex'
+     * (distinct triangles may be filled from different threads, so memory is first touched by them).
+     * ARGUMENTS:
+     *   - Triangles count to add:
+     *       size_t Added;
+     * RETURNS:
+     *   (size_t) Index of the first added triangle.
+     */
+    size_t Expand( size_t Added )
+    {
+      return Grow(Added);
+    } /* End of 'Expand' function */
+
+    /* Single triangle setting function.
+     * ARGUMENTS:
+     *   - Triangle index:
+     *       size_t Index;
+     *   - Vertices:
+     *       const vec3<float> &V0, &V1, &V2;
+     * RETURNS: None.
+     */
+    void Set( size_t Index, const vec3<float> &V0, const vec3<float> &V1, const vec3<float> &V2 ) noexcept
+    {
+      Streams[0][Index] = V0.X, Streams[1][Index] = V0.Y, Streams[2][Index] = V0.Z;
+      Streams[3][Index] = V1.X, Streams[4][Index] = V1.Y, Streams[5][Index] = V1.Z;
+      Streams[6][Index] = V2.X, Streams[7][Index] = V2.Y, Streams[8][Index] = V2.Z;
+    } /* End of 'Set' function */
+
+    /* Single triangle vertex setting function.
+     * ARGUMENTS:
+     *   - Triangle index:
+     *       size_t Index;
+     *   - Vertex number (0, 1 or 2):
+     *       size_t Vertex;
+     *   - Vertex:
+     *       const vec3<float> &V;
+     * RETURNS: None.
+     */
+    void SetVertex( size_t Index, size_t Vertex, const vec3<float> &V ) noexcept
+    {
+      Streams[Vertex * 3][Index] = V.X, Streams[Vertex * 3 + 1][Index] = V.Y, Streams[Vertex * 3 + 2][Index] = V.Z;
+    } /* End of 'SetVertex' function */
+
+    /* Triangle getting function.
+     * ARGUMENTS:
+     *   - Triangle index:
+     *       size_t Index;
+     * RETURNS:
+     *   (triangle<float>) Triangle.
+     */
+    triangle<float> operator[]( size_t Index ) const noexcept
+    {
+      return GetView()[Index];
+    } /* End of 'operator[]' function */
+
+    /* View for batch kernels getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (triangles_soa_view<float>) View.
+     */
+    triangles_soa_view<float> GetView( void ) const noexcept
+    {
+      return
+      {
+        {Streams[0].data(), Streams[3].data(), Streams[6].data()},
+        {Streams[1].data(), Streams[4].data(), Streams[7].data()},
+        {Streams[2].data(), Streams[5].data(), Streams[8].data()},
+        Count,
+      };
+    } /* End of 'GetView' function */
+  }; /* end of 'triangle_soa' class */
+
+  /* Boxes set, stored as 6 aligned streams: center X, Y, Z, then half size X, Y, Z */
+  class box_soa : public aligned_streams<6>
+  {
+  public:
+    /* Boxes appending function.
+     * ARGUMENTS:
+     *   - Boxes:
+     *       std::span<const aabb<float>> Boxes;
+     * RETURNS: None.
+     */
+    void Append( std::span<const aabb<float>> Boxes )
+    {
+      const size_t First {Grow(Boxes.size())};
+
+      for (size_t i {0}; i < Boxes.size(); i++)
+      {
+        const aabb<float> &Box {Boxes[i]};
+
+        Streams[0][First + i] = Box.Center.X, Streams[1][First + i] = Box.Center.Y, Streams[2][First + i] = Box.Center.Z;
+        Streams[3][First + i] = Box.HalfSize.X, Streams[4][First + i] = Box.HalfSize.Y, Streams[5][First + i] = Box.HalfSize.Z;
+      }
+    } /* End of 'Append' function */
+
+    /* Box getting function.
+     * ARGUMENTS:
+     *   - Box index:
+     *       size_t Index;
+     * RETURNS:
+     *   (aabb<float>) Box.
+     */
+    aabb<float> operator[]( size_t Index ) const noexcept
+    {
+      return {{Streams[0][Index], Streams[1][Index], Streams[2][Index]}, {Streams[3][Index], Streams[4][Index], Streams[5][Index]}};
+    } /* End of 'operator[]' function */
+
+    /* Box centers view for batch kernels getting function (for equally sized boxes).
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (box_centers_soa_view<float>) View.
+     */
+    box_centers_soa_view<float> GetCentersView( void ) const noexcept
+    {
+      return {Streams[0].data(), Streams[1].data(), Streams[2].data(), Count};
+    } /* End of 'GetCentersView' function */
+  }; /* end of 'box_soa' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_soa_hpp__ */
+
+/* END OF 'overlap_soa.hpp' FILE */
@@ -0,0 +1,497 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_sparse_grid.hpp" - Spatial hash sparse grid over triangles with exact (SAT) cell binning */
+
+#ifndef __overlap_sparse_grid_hpp__
+#define __overlap_sparse_grid_hpp__
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "overlap_triangle_grid.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Sparse grid hash table slot (open addressing, linear probing) */
+  struct sparse_grid_slot
+  {
+    static constexpr int32_t MinCoord {-(1 << 20)};    // Minimal cell coordinate
+    static constexpr int32_t MaxCoord {(1 << 20) - 1}; // Maximal cell coordinate
+    static constexpr uint64_t EmptyKey {~0ull};        // Free slot key
+
+    uint64_t Key {EmptyKey}; // Packed cell coordinates (21 bits per axis)
+    uint32_t First {0};      // Cell first triangle index in frozen grid
+    uint32_t Count {0};      // Cell triangles count
+
+    /* Cell key getting function.
+     * ARGUMENTS:
+     *   - Cell integer coordinates (from 'MinCoord' to 'MaxCoord'):
+     *       int32_t X, Y, Z;
+     * RETURNS:
+     *   (uint64_t) Packed coordinates.
+     */
+    static constexpr uint64_t GetKey( int32_t X, int32_t Y, int32_t Z ) noexcept
+    {
+      return (uint64_t)(uint32_t)(X - MinCoord) | (uint64_t)(uint32_t)(Y - MinCoord) << 21 | (uint64_t)(uint32_t)(Z - MinCoord) << 42;
+    } /* End of 'GetKey' function */
+
+    /* Key hash getting function (64-bit finalizer mix, keys of neighbour cells spread over the table).
+     * ARGUMENTS:
+     *   - Cell key:
+     *       uint64_t Key;
+     * RETURNS:
+     *   (uint64_t) Hash.
+     */
+    static constexpr uint64_t GetHash( uint64_t Key ) noexcept
+    {
+      Key = (Key ^ (Key >> 30)) * 0xBF58476D1CE4E5B9ull;
+      Key = (Key ^ (Key >> 27)) * 0x94D049BB133111EBull;
+      return Key ^ (Key >> 31);
+    } /* End of 'GetHash' function */
+
+    /* Cell coordinates getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::array<int32_t, 3>) Cell integer coordinates.
+     */
+    constexpr std::array<int32_t, 3> GetCoords( void ) const noexcept
+    {
+      return {(int32_t)(Key & 0x1FFFFF) + MinCoord, (int32_t)(Key >> 21 & 0x1FFFFF) + MinCoord, (int32_t)(Key >> 42 & 0x1FFFFF) + MinCoord};
+    } /* End of 'GetCoords' function */
+  }; /* end of 'sparse_grid_slot' structure */
+
+  /* Frozen sparse grid over triangles: hash table of non-empty cells only, every cell keeps indices of
+   * triangles, which overlap it by the exact separating axes test. Read only: slots keep cell span in place,
+   * so a lookup touches one slot (usually one cache line) and returns a contiguous span. */
+  class sparse_triangle_grid
+  {
+    friend class sparse_triangle_grid_builder;
+
+    grid_desc Desc {};                      // Grid descriptor, cell (0, 0, 0) starts at origin
+    std::vector<sparse_grid_slot> Slots {}; // Hash table (power of 2 size, at most half full)
+    std::vector<uint32_t> Indices {};       // Overlapping triangles indices cell by cell, ascending in every cell
+    size_t CellsCount {0};                  // Non-empty cells count
+
+    /* Cell slot finding function.
+     * ARGUMENTS:
+     *   - Cell key:
+     *       uint64_t Key;
+     * RETURNS:
+     *   (size_t) Cell slot index, slots count if cell is empty.
+     */
+    size_t FindSlot( uint64_t Key ) const noexcept
+    {
+      if (Slots.empty())
+        return 0;
+
+      const size_t Mask {Slots.size() - 1};
+
+      for (size_t Index {(size_t)sparse_grid_slot::GetHash(Key) & Mask};; Index = (Index + 1) & Mask)
+        if (Slots[Index].Key == Key)
+          return Index;
+        else if (Slots[Index].Key == sparse_grid_slot::EmptyKey)
+          return Slots.size();
+    } /* End of 'FindSlot' function */
+
+  public:
+    /* Grid descriptor getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const grid_desc &) Grid descriptor.
+     */
+    const grid_desc & GetDesc( void ) const noexcept
+    {
+      return Desc;
+    } /* End of 'GetDesc' function */
+
+    /* Non-empty cells count getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) Cells count.
+     */
+    size_t GetCellsCount( void ) const noexcept
+    {
+      return CellsCount;
+    } /* End of 'GetCellsCount' function */
+
+    /* Cell triangles getting function.
+     * ARGUMENTS:
+     *   - Cell integer coordinates:
+     *       int32_t X, Y, Z;
+     * RETURNS:
+     *   (std::span<const uint32_t>) Indices of triangles overlapping cell, ascending (empty for empty cells).
+     */
+    std::span<const uint32_t> GetCell( int32_t X, int32_t Y, int32_t Z ) const noexcept
+    {
+      if (std::min({X, Y, Z}) < sparse_grid_slot::MinCoord || std::max({X, Y, Z}) > sparse_grid_slot::MaxCoord)
+        return {};
+
+      const size_t Index {FindSlot(sparse_grid_slot::GetKey(X, Y, Z))};
+
+      if (Index == Slots.size())
+        return {};
+      return {Indices.data() + Slots[Index].First, Slots[Index].Count};
+    } /* End of 'GetCell' function */
+
+    /* Point cell triangles getting function.
+     * ARGUMENTS:
+     *   - Point:
+     *       const vec3<float> &P;
+     * RETURNS:
+     *   (std::span<const uint32_t>) Indices of triangles overlapping cell, containing point.
+     */
+    std::span<const uint32_t> GetCell( const vec3<float> &P ) const noexcept
+    {
+      const vec3<float> C {Desc.ToCells(P)};
+      std::array<int32_t, 3> Cell;
+
+      for (size_t a {0}; a < 3; a++)
+      {
+        const float Coord {std::floor((&C.X)[a] + 0.5f)};
+
+        if (!(Coord >= (float)sparse_grid_slot::MinCoord && Coord <= (float)sparse_grid_slot::MaxCoord))
+          return {};
+        Cell[a] = (int32_t)Coord;
+      }
+      return GetCell(Cell[0], Cell[1], Cell[2]);
+    } /* End of 'GetCell' function */
+
+    /* Non-empty cells walking function (in table order).
+     * ARGUMENTS:
+     *   - Cell processing function, called as Func(X, Y, Z, std::span<const uint32_t> Triangles):
+     *       func &&Func;
+     * RETURNS: None.
+     */
+    template<class func>
+      void ForEachCell( func &&Func ) const
+      {
+        for (const sparse_grid_slot &Slot : Slots)
+          if (Slot.Key != sparse_grid_slot::EmptyKey)
+          {
+            const std::array<int32_t, 3> Coords {Slot.GetCoords()};
+
+            Func(Coords[0], Coords[1], Coords[2], std::span<const uint32_t> {Indices.data() + Slot.First, Slot.Count});
+          }
+      } /* End of 'ForEachCell' function */
+
+    /* Overlapping triangles indices getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const uint32_t>) Overlapping triangles indices cell by cell.
+     */
+    std::span<const uint32_t> GetIndices( void ) const noexcept
+    {
+      return Indices;
+    } /* End of 'GetIndices' function */
+  }; /* end of 'sparse_triangle_grid' class */
+
+  /* Sparse grid builder: triangles are inserted in bulk, concurrently from several threads as well,
+   * cells are claimed in a flat hash table by atomic compare and exchange. 'Freeze' turns it into a read only grid. */
+  class sparse_triangle_grid_builder
+  {
+    static constexpr size_t MinCapacity {1 << 10}; // Initial hash table size
+    static constexpr size_t LockBatch {64};        // Triangles count inserted under one table lock
+
+    /* Triangle overlapping cell reference */
+    struct reference
+    {
+      uint64_t Key;      // Cell key
+      uint32_t Triangle; // Triangle index
+    }; /* end of 'reference' structure */
+
+    grid_desc Desc {};                                 // Grid descriptor
+    std::vector<sparse_grid_slot> Slots;               // Hash table (power of 2 size, at most 3/4 full)
+    std::atomic<size_t> Used {0};                      // Claimed slots count
+    std::vector<std::vector<reference>> References {}; // References of insertion parts
+    std::shared_mutex TableMutex {};                   // Table guard: shared - inserting cells, unique - growing
+    std::mutex ReferencesMutex {};                     // References list guard
+
+    /* Cell claiming function (table is locked shared).
+     * ARGUMENTS:
+     *   - Cell key:
+     *       uint64_t Key;
+     * RETURNS:
+     *   (bool) false if table is full and has to grow first.
+     */
+    bool TryAdd( uint64_t Key ) noexcept
+    {
+      const size_t Mask {Slots.size() - 1};
+
+      for (size_t Index {(size_t)sparse_grid_slot::GetHash(Key) & Mask};; Index = (Index + 1) & Mask)
+      {
+        std::atomic_ref<uint64_t> SlotKey {Slots[Index].Key};
+        uint64_t Current {SlotKey.load(std::memory_order_relaxed)};
+
+        if (Current == sparse_grid_slot::EmptyKey)
+        {
+          if (Used.fetch_add(1, std::memory_order_relaxed) >= Slots.size() / 4 * 3)
+          {
+            Used.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+          }
+          if (SlotKey.compare_exchange_strong(Current, Key, std::memory_order_relaxed))
+            Current = Key;
+          else
+            Used.fetch_sub(1, std::memory_order_relaxed);
+        }
+        if (Current == Key)
+        {
+          std::atomic_ref<uint32_t> {Slots[Index].Count}.fetch_add(1, std::memory_order_relaxed);
+          return true;
+        }
+      }
+    } /* End of 'TryAdd' function */
+
+    /* Hash table growing function (table is not locked).
+     * ARGUMENTS:
+     *   - Table size seen full:
+     *       size_t Capacity;
+     * RETURNS: None.
+     */
+    void Grow( size_t Capacity )
+    {
+      std::unique_lock Lock {TableMutex};
+
+      /* Another thread has grown it already */
+      if (Slots.size() != Capacity)
+        return;
+
+      std::vector<sparse_grid_slot> NewSlots(Capacity * 2);
+      const size_t Mask {NewSlots.size() - 1};
+
+      for (const sparse_grid_slot &Slot : Slots)
+        if (Slot.Key != sparse_grid_slot::EmptyKey)
+        {
+          size_t Index {(size_t)sparse_grid_slot::GetHash(Slot.Key) & Mask};
+
+          while (NewSlots[Index].Key != sparse_grid_slot::EmptyKey)
+            Index = (Index + 1) & Mask;
+          NewSlots[Index] = Slot;
+        }
+      Slots = std::move(NewSlots);
+    } /* End of 'Grow' function */
+
+  public:
+    /* Constructor.
+     * ARGUMENTS:
+     *   - Grid descriptor (cell (0, 0, 0) starts at origin):
+     *       const grid_desc &Desc;
+     *   - Expected non-empty cells count (table is sized for it, 0 - small table):
+     *       size_t CellsCount;
+     */
+    explicit sparse_triangle_grid_builder( const grid_desc &Desc, size_t CellsCount = 0 ) :
+      Desc {Desc}, Slots(std::bit_ceil(std::max(CellsCount / 3 * 4 + 1, MinCapacity)))
+    {
+    } /* End of constructor */
+
+    /* Triangles bulk insertion function.
+     * May be called from several threads at once (not with 'Freeze'), every call is split between its own threads.
+     * If it throws after the range check (out of memory), cells counts may miss references, so builder should be dropped.
+     * ARGUMENTS:
+     *   - Triangles (cells space coordinates from 'MinCoord' to 'MaxCoord'):
+     *       const triangles_soa_view<float> &Tris;
+     *   - Index of the first triangle (indices of all inserted triangles must fit 32 bits):
+     *       uint32_t IndexBase;
+     *   - Threads count (0 - hardware concurrency, 1 for calls from several threads):
+     *       size_t ThreadsCount;
+     * RETURNS: None.
+     */
+    void Insert( const triangles_soa_view<float> &Tris, uint32_t IndexBase = 0, size_t ThreadsCount = 0 )
+    {
+      if (Tris.Count > (size_t)std::numeric_limits<uint32_t>::max() - IndexBase)
+        throw std::out_of_range {"Too many triangles for sparse grid"};
+      if (Tris.Count == 0)
+        return;
+
+      ThreadsCount = GetThreadsCount(ThreadsCount);
+
+      const size_t PartsCount {std::clamp<size_t>(Tris.Count / (1 << 12), 1, ThreadsCount)};
+
+      /* Triangles are checked against coordinates range before any insertion */
+      std::vector<bvh_bounds> Bounds(PartsCount);
+
+      ParallelFor(Tris.Count, [&]( size_t Part, size_t First, size_t End )
+        {
+          for (size_t i {First}; i < End; i++)
+          {
+            const triangle<float> Tri {Tris[i]};
+
+            Bounds[Part].Extend(Desc.ToCells(Tri.V0)), Bounds[Part].Extend(Desc.ToCells(Tri.V1)), Bounds[Part].Extend(Desc.ToCells(Tri.V2));
+          }
+        }, PartsCount);
+      for (const bvh_bounds &B : Bounds)
+        if (!(std::min({B.Min.X, B.Min.Y, B.Min.Z}) >= (float)sparse_grid_slot::MinCoord &&
+              std::max({B.Max.X, B.Max.Y, B.Max.Z}) <= (float)sparse_grid_slot::MaxCoord))
+          throw std::out_of_range {"Triangles are out of sparse grid coordinates range"};
+
+      ParallelFor(Tris.Count, [&]( size_t, size_t First, size_t End )
+        {
+          constexpr std::array<int32_t, 3>
+            Min {sparse_grid_slot::MinCoord, sparse_grid_slot::MinCoord, sparse_grid_slot::MinCoord},
+            Max {sparse_grid_slot::MaxCoord, sparse_grid_slot::MaxCoord, sparse_grid_slot::MaxCoord};
+          triangle_cells_binner Binner {};
+          std::vector<reference> Local {};
+          std::shared_lock Lock {TableMutex, std::defer_lock};
+
+          for (size_t i {First}; i < End; i++)
+          {
+            /* Lock is released from time to time to let table grow */
+            if ((i - First) % LockBatch == 0)
+            {
+              if (Lock.owns_lock())
+                Lock.unlock();
+              Lock.lock();
+            }
+            Binner.Bin(Tris[i], Desc, Min, Max, [&]( int32_t X, int32_t Y, int32_t Z )
+              {
+                const uint64_t Key {sparse_grid_slot::GetKey(X, Y, Z)};
+
+                while (!TryAdd(Key))
+                {
+                  const size_t Capacity {Slots.size()};
+
+                  Lock.unlock();
+                  Grow(Capacity);
+                  Lock.lock();
+                }
+                Local.push_back({Key, IndexBase + (uint32_t)i});
+              });
+          }
+          if (Lock.owns_lock())
+            Lock.unlock();
+
+          std::lock_guard Guard {ReferencesMutex};
+
+          References.push_back(std::move(Local));
+        }, PartsCount);
+    } /* End of 'Insert' function */
+
+    /* Non-empty cells count getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) Cells count.
+     */
+    size_t GetCellsCount( void ) const noexcept
+    {
+      return Used.load(std::memory_order_relaxed);
+    } /* End of 'GetCellsCount' function */
+
+    /* Read only grid building function.
+     * Cells are rehashed into a half full table, their triangles counts are prefix summed into spans
+     * and references are scattered into them in parallel. Builder is left empty.
+     * ARGUMENTS:
+     *   - Threads count (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     * RETURNS:
+     *   (sparse_triangle_grid) Frozen grid.
+     */
+    sparse_triangle_grid Freeze( size_t ThreadsCount = 0 )
+    {
+      std::unique_lock Lock {TableMutex};
+      std::lock_guard Guard {ReferencesMutex};
+      sparse_triangle_grid Grid {};
+
+      ThreadsCount = GetThreadsCount(ThreadsCount);
+      Grid.Desc = Desc;
+      Grid.CellsCount = Used.load(std::memory_order_relaxed);
+      Grid.Slots.resize(std::bit_ceil(std::max(Grid.CellsCount * 2, MinCapacity)));
+
+      /* Rehash */
+      const size_t Mask {Grid.Slots.size() - 1};
+
+      ParallelFor(Slots.size(), [&]( size_t, size_t First, size_t End )
+        {
+          for (size_t s {First}; s < End; s++)
+            if (Slots[s].Key != sparse_grid_slot::EmptyKey)
+              for (size_t Index {(size_t)sparse_grid_slot::GetHash(Slots[s].Key) & Mask};; Index = (Index + 1) & Mask)
+              {
+                uint64_t Empty {sparse_grid_slot::EmptyKey};
+
+                if (std::atomic_ref<uint64_t> {Grid.Slots[Index].Key}.compare_exchange_strong(Empty, Slots[s].Key, std::memory_order_relaxed))
+                {
+                  Grid.Slots[Index].Count = Slots[s].Count;
+                  break;
+                }
+              }
+        }, std::clamp<size_t>(Slots.size() / (1 << 16), 1, ThreadsCount));
+
+      /* Exclusive prefix sum of counts: parts sums, their offsets, then parts */
+      const size_t ScanPartsCount {std::clamp<size_t>(Grid.Slots.size() / (1 << 16), 1, ThreadsCount)};
+      std::vector<size_t> Sums(ScanPartsCount);
+
+      ParallelFor(Grid.Slots.size(), [&]( size_t Part, size_t First, size_t End )
+        {
+          for (size_t s {First}; s < End; s++)
+            Sums[Part] += Grid.Slots[s].Count;
+        }, ScanPartsCount);
+
+      size_t Total {0};
+
+      for (size_t &Sum : Sums)
+        Total += std::exchange(Sum, Total);
+      if (Total > std::numeric_limits<uint32_t>::max())
+        throw std::out_of_range {"Too many sparse grid references"};
+      ParallelFor(Grid.Slots.size(), [&]( size_t Part, size_t First, size_t End )
+        {
+          size_t Sum {Sums[Part]};
+
+          for (size_t s {First}; s < End; s++)
+            Grid.Slots[s].First = (uint32_t)Sum, Sum += Grid.Slots[s].Count;
+        }, ScanPartsCount);
+
+      /* Scatter (counts are cursors meanwhile, the same cache line as keys), insertion parts are interleaved in cells, so cells are sorted then */
+      for (sparse_grid_slot &Slot : Grid.Slots)
+        Slot.Count = 0;
+      Grid.Indices.resize(Total);
+      ParallelFor(References.size(), [&]( size_t, size_t First, size_t End )
+        {
+          for (size_t p {First}; p < End; p++)
+          {
+            uint64_t Key {sparse_grid_slot::EmptyKey};
+            size_t Index {0};
+
+            for (const reference &Ref : References[p])
+            {
+              /* Neighbour references mostly share cells */
+              if (Ref.Key != Key)
+                Key = Ref.Key, Index = Grid.FindSlot(Key);
+
+              sparse_grid_slot &Slot {Grid.Slots[Index]};
+
+              Grid.Indices[Slot.First + std::atomic_ref<uint32_t> {Slot.Count}.fetch_add(1, std::memory_order_relaxed)] = Ref.Triangle;
+            }
+            References[p] = {};
+          }
+        }, std::clamp<size_t>(References.size(), 1, ThreadsCount));
+      ParallelFor(Grid.Slots.size(), [&]( size_t, size_t First, size_t End )
+        {
+          for (size_t s {First}; s < End; s++)
+            if (Grid.Slots[s].Count > 1)
+              std::sort(Grid.Indices.begin() + Grid.Slots[s].First, Grid.Indices.begin() + Grid.Slots[s].First + Grid.Slots[s].Count);
+        }, ScanPartsCount);
+
+      Slots.assign(MinCapacity, {});
+      Used.store(0, std::memory_order_relaxed);
+      References.clear();
+      return Grid;
+    } /* End of 'Freeze' function */
+  }; /* end of 'sparse_triangle_grid_builder' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_sparse_grid_hpp__ */
+
+/* END OF 'overlap_sparse_grid.hpp' FILE */
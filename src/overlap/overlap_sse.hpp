@@ -0,0 +1,118 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_sse.hpp" - SSE4.2 overlap kernels */
+
+#ifndef __overlap_sse_hpp__
+#define __overlap_sse_hpp__
+
+#include "overlap_table.hpp"
+
+OVERLAP_TARGET_PUSH(OVERLAP_TARGET_SSE42)
+
+/* Math namespace // SSE4.2 overlap kernels */
+namespace math::sse
+{
+  /* SSE4.2 operations, 4 lanes.
+   * Members are thin wrappers over intrinsics (a few short sequences emulate missing ones),
+   * so they are deliberately kept without arguments blocks. */
+  struct simd
+  {
+    using vec = __m128;  // Lanes vector
+    using mask = __m128; // Lanes mask, all bits are set in active lanes
+
+    static constexpr size_t Width {4};      // Lanes count
+    static constexpr isa Isa {isa::eSSE42}; // Instruction set
+
+    /* Loading */
+    static vec Set1( float V ) noexcept { return _mm_set1_ps(V); }
+    static vec Load( const float *P ) noexcept { return _mm_loadu_ps(P); }
+    static mask All( void ) noexcept { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+    static mask First( size_t N ) noexcept { return _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32((int)N), _mm_setr_epi32(0, 1, 2, 3))); }
+    static mask FromBits( uint32_t Bits ) noexcept { const __m128i Lane {_mm_setr_epi32(1, 2, 4, 8)}; return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32((int)Bits), Lane), Lane)); }
+    static vec LoadFirst( const float *P, size_t N ) noexcept
+    {
+      alignas(16) float Tmp[Width] {};
+
+      std::copy_n(P, std::min(N, Width), Tmp);
+      return _mm_load_ps(Tmp);
+    }
+    static vec LoadU16( const uint16_t *P ) noexcept { return _mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(P)))); }
+    static vec LoadU8( const uint8_t *P ) noexcept { int32_t V; std::memcpy(&V, P, sizeof V); return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(V))); }
+    static vec LoadInt( const int32_t *P ) noexcept { return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(P))); }
+    static vec LoadIntFirst( const int32_t *P, size_t N ) noexcept
+    {
+      alignas(16) int32_t Tmp[Width] {};
+
+      std::copy_n(P, std::min(N, Width), Tmp);
+      return _mm_cvtepi32_ps(_mm_load_si128(reinterpret_cast<const __m128i *>(Tmp)));
+    }
+
+    /* Gathering, emulated with scalar loads (no gather instructions in this instruction set) */
+    using ivec = __m128i; // Integer lanes vector
+    static void LoadTriangleIndices( const uint32_t *P, size_t N, ivec *I ) noexcept
+    {
+      alignas(16) uint32_t Tmp[3][Width] {};
+
+      for (size_t i {0}; i < N; i++)
+        for (size_t k {0}; k < 3; k++)
+          Tmp[k][i] = P[i * 3 + k];
+      for (size_t k {0}; k < 3; k++)
+        I[k] = _mm_load_si128(reinterpret_cast<const __m128i *>(Tmp[k]));
+    }
+    static ivec MulInt( ivec A, int32_t B ) noexcept { return _mm_mullo_epi32(A, _mm_set1_epi32(B)); }
+    static vec Gather( const float *Base, ivec Offsets ) noexcept
+    {
+      return _mm_setr_ps(Base[(uint32_t)_mm_cvtsi128_si32(Offsets)], Base[(uint32_t)_mm_extract_epi32(Offsets, 1)],
+                         Base[(uint32_t)_mm_extract_epi32(Offsets, 2)], Base[(uint32_t)_mm_extract_epi32(Offsets, 3)]);
+    }
+
+    /* Arithmetic, no FMA in this instruction set */
+    static vec Add( vec A, vec B ) noexcept { return _mm_add_ps(A, B); }
+    static vec Sub( vec A, vec B ) noexcept { return _mm_sub_ps(A, B); }
+    static vec Mul( vec A, vec B ) noexcept { return _mm_mul_ps(A, B); }
+    static vec FMAdd( vec A, vec B, vec C ) noexcept { return _mm_add_ps(_mm_mul_ps(A, B), C); }
+    static vec FMSub( vec A, vec B, vec C ) noexcept { return _mm_sub_ps(_mm_mul_ps(A, B), C); }
+    static vec Min( vec A, vec B ) noexcept { return _mm_min_ps(A, B); }
+    static vec Max( vec A, vec B ) noexcept { return _mm_max_ps(A, B); }
+    static vec Abs( vec A ) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.f), A); }
+    static vec Neg( vec A ) noexcept { return _mm_xor_ps(_mm_set1_ps(-0.f), A); }
+
+    /* Comparisons and masks */
+    static mask Less( vec A, vec B ) noexcept { return _mm_cmplt_ps(A, B); }
+    static mask Greater( vec A, vec B ) noexcept { return _mm_cmpgt_ps(A, B); }
+    static mask Or( mask A, mask B ) noexcept { return _mm_or_ps(A, B); }
+    static mask AndNot( mask A, mask B ) noexcept { return _mm_andnot_ps(A, B); }
+    static bool None( mask A ) noexcept { return _mm_movemask_ps(A) == 0; }
+    static uint32_t Bits( mask A ) noexcept { return (uint32_t)_mm_movemask_ps(A); }
+
+    /* Compaction: overlapping lanes numbers from the table, offset by the pack first index */
+    static void CompressStore( uint32_t *Dst, uint32_t FirstIndex, uint32_t Bits ) noexcept
+    {
+      const __m128i Lanes {_mm_cvtepu8_epi32(_mm_cvtsi32_si128((int)CompactionTable<4>[Bits]))};
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(Dst), _mm_add_epi32(Lanes, _mm_set1_epi32((int)FirstIndex)));
+    }
+  }; /* end of 'simd' structure */
+
+  /* Instruction set independent kernels */
+#include "overlap_kernels.inl"
+} /* end of 'math::sse' namespace */
+
+OVERLAP_TARGET_POP()
+
+#endif /* __overlap_sse_hpp__ */
+
+/* END OF 'overlap_sse.hpp' FILE */
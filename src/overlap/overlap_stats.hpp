@@ -0,0 +1,168 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_stats.hpp" - Separating axes rejection statistics, axes evaluation order selection */
+
+#ifndef __overlap_stats_hpp__
+#define __overlap_stats_hpp__
+
+#include "overlap_base.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Separating axes rejection statistics of a workload.
+   * For every sampled box-triangle pair all axes groups are evaluated, so expected cost
+   * of any evaluation order can be estimated afterwards. SIMD kernels stop a pack only
+   * when all its lanes are rejected, so the estimate is exact for single pairs only,
+   * but it ranks orders the same way for coherent packs. */
+  class axes_stats
+  {
+  public:
+    /* Relative axes groups evaluation costs, indexed by 'axes_group' (measured on batch kernels) */
+    static constexpr std::array<float, 3> DefaultCosts {4.f, 1.f, 1.5f};
+
+  private:
+    std::array<uint64_t, 1 << (size_t)axes_group::_LastValue> Counts {}; // Pairs count by separating groups mask
+
+  public:
+    /* Single pair adding function.
+     * ARGUMENTS:
+     *   - Box:
+     *       const aabb<float> &Box;
+     *   - Triangle:
+     *       const triangle<float> &Tri;
+     * RETURNS: None.
+     */
+    void Add( const aabb<float> &Box, const triangle<float> &Tri ) noexcept
+    {
+      Counts[BoxTriangleSeparatingGroups(Box, Tri)]++;
+    } /* End of 'Add' function */
+
+    /* Box against triangles set pairs sampling function.
+     * ARGUMENTS:
+     *   - Box:
+     *       const aabb<float> &Box;
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Tris;
+     *   - Sampling step, every Step-th triangle is added:
+     *       size_t Step;
+     * RETURNS: None.
+     */
+    void Add( const aabb<float> &Box, const triangles_soa_view<float> &Tris, size_t Step = 1 ) noexcept
+    {
+      for (size_t i {0}; i < Tris.Count; i += std::max<size_t>(Step, 1))
+        Add(Box, Tris[i]);
+    } /* End of 'Add' function */
+
+    /* Statistics clearing function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Reset( void ) noexcept
+    {
+      Counts = {};
+    } /* End of 'Reset' function */
+
+    /* Sampled pairs count getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (uint64_t) Pairs count.
+     */
+    uint64_t GetCount( void ) const noexcept
+    {
+      uint64_t Count {0};
+
+      for (uint64_t C : Counts)
+        Count += C;
+      return Count;
+    } /* End of 'GetCount' function */
+
+    /* Pairs, separated by axes group, count getting function.
+     * ARGUMENTS:
+     *   - Axes group:
+     *       axes_group Group;
+     * RETURNS:
+     *   (uint64_t) Pairs count (pair may be separated by several groups).
+     */
+    uint64_t GetRejections( axes_group Group ) const noexcept
+    {
+      uint64_t Count {0};
+
+      for (uint32_t Groups {0}; Groups < Counts.size(); Groups++)
+        if (Groups & (1u << (uint32_t)Group))
+          Count += Counts[Groups];
+      return Count;
+    } /* End of 'GetRejections' function */
+
+    /* Expected evaluation cost per pair getting function.
+     * ARGUMENTS:
+     *   - Evaluation order ('eDefault' stands for 'eEdgesFirst', as scalar reference does):
+     *       axes_order Order;
+     *   - Relative axes groups costs:
+     *       const std::array<float, 3> &Costs;
+     * RETURNS:
+     *   (float) Expected cost, 0 if there are no samples.
+     */
+    float GetCost( axes_order Order, const std::array<float, 3> &Costs = DefaultCosts ) const noexcept
+    {
+      const std::array<axes_group, 3> Groups {GetAxesGroups(Order)};
+      const uint64_t Total {GetCount()};
+      double Cost {0};
+
+      if (Total == 0)
+        return 0;
+
+      for (uint32_t Separating {0}; Separating < Counts.size(); Separating++)
+      {
+        double PairCost {0};
+
+        /* Groups are evaluated until the first separating one */
+        for (axes_group Group : Groups)
+        {
+          PairCost += Costs[(size_t)Group];
+          if (Separating & (1u << (uint32_t)Group))
+            break;
+        }
+        Cost += PairCost * (double)Counts[Separating];
+      }
+      return (float)(Cost / (double)Total);
+    } /* End of 'GetCost' function */
+
+    /* The cheapest evaluation order for gathered statistics getting function.
+     * ARGUMENTS:
+     *   - Relative axes groups costs:
+     *       const std::array<float, 3> &Costs;
+     * RETURNS:
+     *   (axes_order) Best order, 'eDefault' if there are no samples.
+     */
+    axes_order GetBestOrder( const std::array<float, 3> &Costs = DefaultCosts ) const noexcept
+    {
+      if (GetCount() == 0)
+        return axes_order::eDefault;
+
+      axes_order Best {axes_order::eEdgesFirst};
+
+      for (size_t i {(size_t)axes_order::eEdgesFirst + 1}; i < (size_t)axes_order::_LastValue; i++)
+        if (GetCost((axes_order)i, Costs) < GetCost(Best, Costs))
+          Best = (axes_order)i;
+      return Best;
+    } /* End of 'GetBestOrder' function */
+  }; /* end of 'axes_stats' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_stats_hpp__ */
+
+/* END OF 'overlap_stats.hpp' FILE */
@@ -0,0 +1,478 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_stream.hpp" - Out-of-core streaming of triangle files through batch kernels */
+
+#ifndef __overlap_stream_hpp__
+#define __overlap_stream_hpp__
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "../box_triangle_overlap_test.hpp"
+#include "overlap_mesh_file.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Default memory budget of streaming buffers, bytes */
+  inline constexpr size_t DefaultStreamBudget {256 << 20};
+
+  /* Triangles placement in streamed file */
+  struct triangle_stream_layout
+  {
+    uint64_t Offset {0};       // First triangle data offset in file, bytes
+    uint64_t Count {0};        // Triangles count
+    uint64_t Stride {0};       // Streams layout: floats from one of 9 streams [vertex * 3 + component] to the next, 0 - records layout
+    uint32_t RecordSize {36};  // Records layout: bytes per triangle record
+    uint32_t CoordsOffset {0}; // Records layout: offset of 9 coordinates floats (V0, V1, V2) in record
+  }; /* end of 'triangle_stream_layout' structure */
+
+  /* Streamed box-triangle overlap */
+  struct stream_hit
+  {
+    uint64_t Triangle; // Triangle index in file
+    uint32_t Box;      // Query box index
+  }; /* end of 'stream_hit' structure */
+
+  /* Streaming query statistics */
+  struct stream_stats
+  {
+    uint64_t ChunksCount {0}; // Processed chunks count
+    size_t ChunkSize {0};     // Triangles per chunk
+    uint64_t BytesRead {0};   // Bytes read from file
+    double WaitTime {0};      // Time spent waiting for reads, seconds
+    double TotalTime {0};     // Total query time, seconds
+  }; /* end of 'stream_stats' structure */
+
+  /* Raw triangles file layout getting function: 'triangle<float>' records (9 floats) up to file end.
+   * ARGUMENTS:
+   *   - File path:
+   *       const std::filesystem::path &Path;
+   *   - First triangle offset, bytes (default: 0):
+   *       uint64_t Offset;
+   * RETURNS:
+   *   (triangle_stream_layout) Layout.
+   */
+  inline triangle_stream_layout GetRawStreamLayout( const std::filesystem::path &Path, uint64_t Offset = 0 )
+  {
+    const uint64_t Size {std::filesystem::file_size(Path)};
+
+    if (Offset > Size)
+      throw std::out_of_range {"Raw triangles offset is out of file"};
+    return {Offset, (Size - Offset) / (9 * sizeof(float))};
+  } /* End of 'GetRawStreamLayout' function */
+
+  /* Binary STL file layout getting function.
+   * ARGUMENTS:
+   *   - File path:
+   *       const std::filesystem::path &Path;
+   * RETURNS:
+   *   (triangle_stream_layout) Layout.
+   */
+  inline triangle_stream_layout GetStlStreamLayout( const std::filesystem::path &Path )
+  {
+    std::ifstream File {Path, std::ios::binary};
+    char Header[84];
+    uint32_t Count {0};
+
+    if (!File.read(Header, sizeof Header))
+      throw std::runtime_error {"Cannot read binary STL header"};
+    std::memcpy(&Count, Header + 80, sizeof Count);
+    if ((std::filesystem::file_size(Path) - sizeof Header) / 50 < Count)
+      throw std::runtime_error {"Binary STL file is truncated"};
+    return {sizeof Header, Count, 0, 50, 12};
+  } /* End of 'GetStlStreamLayout' function */
+
+  /* Mesh file (see 'mesh_file') triangle soup section layout getting function.
+   * Only header pages are touched, so it is fine for files larger than memory.
+   * ARGUMENTS:
+   *   - File path:
+   *       const std::filesystem::path &Path;
+   * RETURNS:
+   *   (triangle_stream_layout) Layout.
+   */
+  inline triangle_stream_layout GetMeshFileStreamLayout( const std::filesystem::path &Path )
+  {
+    const mesh_file File {Path};
+    const mesh_file_section &Section {File.GetSection(mesh_section::eTriangles)};
+
+    return {Section.Offset, File.GetCount(), Section.Stride};
+  } /* End of 'GetMeshFileStreamLayout' function */
+
+  /* Streamed triangles file chunk */
+  struct triangle_stream_chunk
+  {
+    uint64_t First {0};              // First triangle index in file
+    triangles_soa_view<float> Tris;  // Chunk triangles, valid until next chunk request
+  }; /* end of 'triangle_stream_chunk' structure */
+
+  /* Triangles file reader by fixed size chunks. A background thread reads the next chunk (pread or
+   * ReadFile at offset) while the caller processes the current one (double buffering), so memory use
+   * is bounded by two chunks plus staging buffer for records layouts regardless of file size */
+  class triangle_stream
+  {
+  private:
+    /* Chunk buffer */
+    struct slot
+    {
+      aligned_vector<float> Streams; // 9 zero padded streams, 'Stride' floats each
+      size_t Count {0};              // Loaded triangles count
+    }; /* end of 'slot' structure */
+
+#if defined(_WIN32)
+    HANDLE File {INVALID_HANDLE_VALUE};                    // File handle
+#else
+    int File {-1};                                         // File descriptor
+#endif
+    triangle_stream_layout Layout;                         // Triangles placement
+    size_t ChunkSize {0}, Stride {0};                      // Triangles per chunk, buffer stream length
+    uint64_t ChunksCount {0};                              // Chunks count
+    std::array<slot, 2> Slots {};                          // Chunk buffers, chunk i goes to Slots[i % 2]
+    std::vector<uint8_t> Staging {};                       // Records layout read buffer
+    std::mutex Mutex {};                                   // Reader state guard
+    std::condition_variable Changed {};                    // Reader state change notification
+    uint64_t Loaded {0}, Released {0};                     // Loaded chunks count, chunks released by caller
+    bool IsHolding {false}, IsStopping {false};            // Caller holds chunk 'Released' flag, stop request
+    std::exception_ptr Error {};                           // Reader error
+    uint64_t BytesRead {0};                                // Bytes read from file
+    double WaitTime {0};                                   // Caller waiting time, seconds
+    std::thread Reader {};                                 // Reader thread
+
+    /* File bytes reading function. Read range is dropped from page cache afterwards (where supported),
+     * so streaming a huge file does not evict everything else.
+     * ARGUMENTS:
+     *   - Buffer:
+     *       void *Buffer;
+     *   - Bytes count:
+     *       size_t Size;
+     *   - File offset:
+     *       uint64_t Offset;
+     * RETURNS: None.
+     */
+    void ReadAt( void *Buffer, size_t Size, uint64_t Offset )
+    {
+      uint8_t *Dst {static_cast<uint8_t *>(Buffer)};
+      [[maybe_unused]] const uint64_t Start {Offset};
+
+      BytesRead += Size;
+      while (Size > 0)
+      {
+#if defined(_WIN32)
+        OVERLAPPED Overlapped {};
+        DWORD Read {0};
+
+        Overlapped.Offset = (DWORD)Offset, Overlapped.OffsetHigh = (DWORD)(Offset >> 32);
+        if (!ReadFile(File, Dst, (DWORD)std::min<size_t>(Size, 1 << 30), &Read, &Overlapped) || Read == 0)
+          throw std::runtime_error {"Triangles file reading failed"};
+#else
+        const ssize_t Read {pread(File, Dst, Size, (off_t)Offset)};
+
+        if (Read <= 0)
+          throw std::runtime_error {"Triangles file reading failed"};
+#endif
+        Dst += Read, Size -= (size_t)Read, Offset += (uint64_t)Read;
+      }
+#if defined(POSIX_FADV_DONTNEED)
+      posix_fadvise(File, (off_t)Start, (off_t)(Offset - Start), POSIX_FADV_DONTNEED);
+#endif
+    } /* End of 'ReadAt' function */
+
+    /* Chunk loading function.
+     * ARGUMENTS:
+     *   - Chunk index:
+     *       uint64_t Chunk;
+     *   - Destination:
+     *       slot &Slot;
+     * RETURNS: None.
+     */
+    void Load( uint64_t Chunk, slot &Slot )
+    {
+      const uint64_t First {Chunk * ChunkSize};
+      const size_t Count {(size_t)std::min<uint64_t>(ChunkSize, Layout.Count - First)};
+      float *Streams {Slot.Streams.data()};
+
+      if (Layout.Stride != 0)
+        for (size_t k {0}; k < 9; k++)
+          ReadAt(Streams + k * Stride, Count * sizeof(float), Layout.Offset + (k * Layout.Stride + First) * sizeof(float));
+      else
+      {
+        ReadAt(Staging.data(), Count * Layout.RecordSize, Layout.Offset + First * Layout.RecordSize);
+        for (size_t i {0}; i < Count; i++)
+        {
+          float Coords[9];
+
+          std::memcpy(Coords, Staging.data() + i * Layout.RecordSize + Layout.CoordsOffset, sizeof Coords);
+          for (size_t k {0}; k < 9; k++)
+            Streams[k * Stride + i] = Coords[k];
+        }
+      }
+      for (size_t k {0}; k < 9; k++)
+        std::fill(Streams + k * Stride + Count, Streams + (k + 1) * Stride, 0.f);
+      Slot.Count = Count;
+    } /* End of 'Load' function */
+
+    /* Reader thread function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Read( void )
+    {
+      try
+      {
+        for (uint64_t Chunk {0}; Chunk < ChunksCount; Chunk++)
+        {
+          {
+            std::unique_lock Lock {Mutex};
+
+            Changed.wait(Lock, [&] { return IsStopping || Chunk < Released + 2; });
+            if (IsStopping)
+              return;
+          }
+          Load(Chunk, Slots[Chunk % 2]);
+          {
+            std::lock_guard Lock {Mutex};
+
+            Loaded = Chunk + 1;
+          }
+          Changed.notify_all();
+        }
+      }
+      catch (...)
+      {
+        {
+          std::lock_guard Lock {Mutex};
+
+          Error = std::current_exception();
+        }
+        Changed.notify_all();
+      }
+    } /* End of 'Read' function */
+
+    /* File closing function.
+     * ARGUMENTS: None.
+     * RETURNS: None.
+     */
+    void Close( void ) noexcept
+    {
+#if defined(_WIN32)
+      if (File != INVALID_HANDLE_VALUE)
+        CloseHandle(File);
+      File = INVALID_HANDLE_VALUE;
+#else
+      if (File >= 0)
+        close(File);
+      File = -1;
+#endif
+    } /* End of 'Close' function */
+
+  public:
+    /* Constructor, reading starts at once.
+     * ARGUMENTS:
+     *   - File path:
+     *       const std::filesystem::path &Path;
+     *   - Triangles placement (see 'GetRawStreamLayout', 'GetStlStreamLayout', 'GetMeshFileStreamLayout'):
+     *       const triangle_stream_layout &Layout;
+     *   - Buffers memory budget, bytes (default: 'DefaultStreamBudget'):
+     *       size_t MemoryBudget;
+     */
+    triangle_stream( const std::filesystem::path &Path, const triangle_stream_layout &Layout, size_t MemoryBudget = DefaultStreamBudget ) :
+      Layout {Layout}
+    {
+      if (Layout.Stride == 0 && Layout.RecordSize < Layout.CoordsOffset + 9 * sizeof(float))
+        throw std::out_of_range {"Triangle record is too small"};
+      if (Layout.Stride != 0 && Layout.Stride < Layout.Count)
+        throw std::out_of_range {"Triangle streams stride is less than triangles count"};
+
+      /* Two chunk buffers, staging buffer and caller indices output per triangle */
+      const size_t BytesPerTriangle {2 * 9 * sizeof(float) + (Layout.Stride == 0 ? Layout.RecordSize : 0) + sizeof(uint32_t)};
+      const size_t Padding {triangle_soa::Padding};
+
+      ChunkSize = MemoryBudget / BytesPerTriangle / Padding * Padding;
+      if (ChunkSize == 0)
+        throw std::out_of_range {"Streaming memory budget is too small"};
+      ChunkSize = (size_t)std::min<uint64_t>(ChunkSize, (Layout.Count + Padding - 1) / Padding * Padding);
+      ChunkSize = std::max(ChunkSize, Padding);
+      Stride = ChunkSize;
+      ChunksCount = (Layout.Count + ChunkSize - 1) / ChunkSize;
+      for (slot &Slot : Slots)
+        Slot.Streams.resize(9 * Stride);
+      if (Layout.Stride == 0)
+        Staging.resize(ChunkSize * Layout.RecordSize);
+
+#if defined(_WIN32)
+      File = CreateFileW(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+      if (File == INVALID_HANDLE_VALUE)
+        throw std::runtime_error {"Cannot open triangles file"};
+#else
+      File = open(Path.c_str(), O_RDONLY);
+      if (File < 0)
+        throw std::runtime_error {"Cannot open triangles file"};
+#  if defined(POSIX_FADV_SEQUENTIAL)
+      posix_fadvise(File, 0, 0, POSIX_FADV_SEQUENTIAL);
+#  endif
+#endif
+      Reader = std::thread {&triangle_stream::Read, this};
+    } /* End of constructor */
+
+    triangle_stream( const triangle_stream & ) = delete;
+    triangle_stream &operator=( const triangle_stream & ) = delete;
+
+    /* Destructor */
+    ~triangle_stream( void )
+    {
+      {
+        std::lock_guard Lock {Mutex};
+
+        IsStopping = true;
+      }
+      Changed.notify_all();
+      Reader.join();
+      Close();
+    } /* End of destructor */
+
+    /* Triangles per chunk getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) Chunk size.
+     */
+    size_t GetChunkSize( void ) const noexcept
+    {
+      return ChunkSize;
+    } /* End of 'GetChunkSize' function */
+
+    /* Chunks count getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (uint64_t) Chunks count.
+     */
+    uint64_t GetChunksCount( void ) const noexcept
+    {
+      return ChunksCount;
+    } /* End of 'GetChunksCount' function */
+
+    /* Read bytes count getting function (call when stream is over).
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (uint64_t) Bytes count.
+     */
+    uint64_t GetBytesRead( void ) const noexcept
+    {
+      return BytesRead;
+    } /* End of 'GetBytesRead' function */
+
+    /* Time spent in 'Next' waiting for reads getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (double) Waiting time, seconds.
+     */
+    double GetWaitTime( void ) const noexcept
+    {
+      return WaitTime;
+    } /* End of 'GetWaitTime' function */
+
+    /* Next chunk getting function, previous chunk buffer is given back to reader.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::optional<triangle_stream_chunk>) Chunk, std::nullopt when stream is over.
+     */
+    std::optional<triangle_stream_chunk> Next( void )
+    {
+      std::unique_lock Lock {Mutex};
+
+      if (IsHolding)
+      {
+        Released++, IsHolding = false;
+        Changed.notify_all();
+      }
+      if (Released == ChunksCount)
+        return std::nullopt;
+
+      const auto Start {std::chrono::steady_clock::now()};
+
+      Changed.wait(Lock, [&] { return Loaded > Released || Error != nullptr; });
+      WaitTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+      if (Loaded <= Released)
+        std::rethrow_exception(Error);
+
+      const float *Base {Slots[Released % 2].Streams.data()};
+
+      IsHolding = true;
+      return triangle_stream_chunk
+      {
+        Released * ChunkSize,
+        {
+          {Base, Base + Stride * 3, Base + Stride * 6},
+          {Base + Stride, Base + Stride * 4, Base + Stride * 7},
+          {Base + Stride * 2, Base + Stride * 5, Base + Stride * 8},
+          Slots[Released % 2].Count,
+        },
+      };
+    } /* End of 'Next' function */
+  }; /* end of 'triangle_stream' class */
+
+  /* Boxes against streamed triangles file overlap test function.
+   * Every chunk is tested against all boxes by the batch kernel while the next chunk is read.
+   * ARGUMENTS:
+   *   - File path:
+   *       const std::filesystem::path &Path;
+   *   - Triangles placement:
+   *       const triangle_stream_layout &Layout;
+   *   - Query boxes:
+   *       std::span<const aabb<float>> Boxes;
+   *   - Hits list, overlaps are appended to it (grouped by chunk, then by box, triangles ascending),
+   *     not counted in memory budget:
+   *       std::vector<stream_hit> &Hits;
+   *   - Buffers memory budget, bytes (default: 'DefaultStreamBudget'):
+   *       size_t MemoryBudget;
+   * RETURNS:
+   *   (stream_stats) Query statistics.
+   */
+  inline stream_stats StreamBoxesTrianglesOverlapTest( const std::filesystem::path &Path, const triangle_stream_layout &Layout,
+                                                       std::span<const aabb<float>> Boxes, std::vector<stream_hit> &Hits,
+                                                       size_t MemoryBudget = DefaultStreamBudget )
+  {
+    const auto Start {std::chrono::steady_clock::now()};
+    triangle_stream Stream {Path, Layout, MemoryBudget};
+    std::vector<uint32_t> Indices(Stream.GetChunkSize());
+
+    while (const std::optional<triangle_stream_chunk> Chunk {Stream.Next()})
+      for (size_t b {0}; b < Boxes.size(); b++)
+      {
+        const size_t Count {BoxTrianglesOverlapTest(Boxes[b], Chunk->Tris, std::span<uint32_t> {Indices})};
+
+        for (size_t i {0}; i < Count; i++)
+          Hits.push_back({Chunk->First + Indices[i], (uint32_t)b});
+      }
+
+    return
+    {
+      Stream.GetChunksCount(),
+      Stream.GetChunkSize(),
+      Stream.GetBytesRead(),
+      Stream.GetWaitTime(),
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count(),
+    };
+  } /* End of 'StreamBoxesTrianglesOverlapTest' function */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_stream_hpp__ */
+
+/* END OF 'overlap_stream.hpp' FILE */
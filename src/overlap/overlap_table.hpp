@@ -0,0 +1,65 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_table.hpp" - Batch kernels table, filled by every instruction set */
+
+#ifndef __overlap_table_hpp__
+#define __overlap_table_hpp__
+
+#include "overlap_base.hpp"
+#include "overlap_prepared.hpp"
+#include "overlap_grid.hpp"
+#include "overlap_buckets.hpp"
+#include "overlap_indexed.hpp"
+#include "overlap_quantized.hpp"
+#include "overlap_bvh_node.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Batch kernels table for a single instruction set.
+   * Masks outputs hold one bit per element, indices outputs receive compacted overlapping
+   * elements indices (plus index base) and must be at least elements count long.
+   * Classification outputs are overlap and containment masks (see 'overlap_class').
+   * Hierarchy queries pass overlapping triangles to a callback in batches (it may throw). */
+  struct overlap_kernels
+  {
+    isa Isa;          // Instruction set
+    axes_order Order; // Separating axes groups evaluation order
+
+    void (*BoxTriangles)( const aabb<float> &, const triangles_soa_view<float> &, std::span<uint8_t> ) noexcept;
+    size_t (*BoxTrianglesIndices)( const aabb<float> &, const triangles_soa_view<float> &, std::span<uint32_t>, uint32_t ) noexcept;
+    void (*BoxPreparedTriangles)( const aabb<float> &, const prepared_triangles_view &, std::span<uint8_t> ) noexcept;
+    size_t (*BoxPreparedTrianglesIndices)( const aabb<float> &, const prepared_triangles_view &, std::span<uint32_t>, uint32_t ) noexcept;
+    void (*BoxIndexedTriangles)( const aabb<float> &, const indexed_triangles_view &, std::span<uint8_t> ) noexcept;
+    size_t (*BoxIndexedTrianglesIndices)( const aabb<float> &, const indexed_triangles_view &, std::span<uint32_t>, uint32_t ) noexcept;
+    void (*BoxQuantizedTriangles)( const aabb<float> &, const quantized_triangles_view &, std::span<uint8_t> ) noexcept;
+    size_t (*BoxQuantizedTrianglesIndices)( const aabb<float> &, const quantized_triangles_view &, std::span<uint32_t>, uint32_t ) noexcept;
+    size_t (*BoxBucketedTrianglesIndices)( const aabb<float> &, const bucketed_triangles_view &, std::span<uint32_t>, uint32_t ) noexcept;
+    void (*TriangleBoxes)( const triangle_boxes_setup<float> &, const box_centers_soa_view<float> &, std::span<uint8_t> ) noexcept;
+    size_t (*TriangleBoxesIndices)( const triangle_boxes_setup<float> &, const box_centers_soa_view<float> &, std::span<uint32_t>, uint32_t ) noexcept;
+    void (*TriangleCells)( const triangle_cells_setup &, const cell_coords_soa_view &, std::span<uint8_t> ) noexcept;
+    size_t (*TriangleCellsIndices)( const triangle_cells_setup &, const cell_coords_soa_view &, std::span<uint32_t>, uint32_t ) noexcept;
+    void (*BoxTrianglesClasses)( const aabb<float> &, const triangles_soa_view<float> &, std::span<uint8_t>, std::span<uint8_t> ) noexcept;
+    void (*BoxPreparedTrianglesClasses)( const aabb<float> &, const prepared_triangles_view &, std::span<uint8_t>, std::span<uint8_t> ) noexcept;
+    void (*BoxBvh8Triangles)( const aabb<float> &, const bvh8_view &, bvh_hits_callback, void * );
+    void (*BoxQuantizedBvh8Triangles)( const aabb<float> &, const quantized_bvh8_view &, bvh_hits_callback, void * );
+    void (*BoxesBvhTriangles)( std::span<const aabb<float>>, const bvh_view &, bvh_pairs_callback, void * );
+  }; /* end of 'overlap_kernels' structure */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_table_hpp__ */
+
+/* END OF 'overlap_table.hpp' FILE */
@@ -0,0 +1,393 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_triangle_grid.hpp" - Uniform grid over triangles with exact (SAT) cell binning in compressed rows */
+
+#ifndef __overlap_triangle_grid_hpp__
+#define __overlap_triangle_grid_hpp__
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "../box_triangle_overlap_test.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Triangle cells enumerator: candidate cells come from triangle bounds, the batch SAT kernel confirms them */
+  class triangle_cells_binner
+  {
+    std::vector<int32_t> X {}, Y {}, Z {}; // Candidate cells coordinates
+    std::vector<uint32_t> Hits {};         // Overlapping candidates indices
+
+  public:
+    /* Triangle overlapping cells enumeration function.
+     * ARGUMENTS:
+     *   - Triangle:
+     *       const triangle<float> &Tri;
+     *   - Grid descriptor:
+     *       const grid_desc &Desc;
+     *   - Cells range to enumerate in, inclusive (coordinates within 2^24 by absolute value):
+     *       const std::array<int32_t, 3> &Min, &Max;
+     *   - Overlapping cell processing function, called as Func(X, Y, Z):
+     *       func &&Func;
+     * RETURNS: None.
+     */
+    template<class func>
+      void Bin( const triangle<float> &Tri, const grid_desc &Desc, const std::array<int32_t, 3> &Min, const std::array<int32_t, 3> &Max, func &&Func )
+      {
+        const vec3<float> P[3] {Desc.ToCells(Tri.V0), Desc.ToCells(Tri.V1), Desc.ToCells(Tri.V2)};
+        std::array<int32_t, 3> Lo, Hi;
+        bool IsSingle {true};
+
+        /* Candidate cells by bounds (cell centers are integer in cells space, cells span 0.5 around them) */
+        for (size_t a {0}; a < 3; a++)
+        {
+          const float
+            BoundMin {std::ceil(std::min({(&P[0].X)[a], (&P[1].X)[a], (&P[2].X)[a]}) - 0.5f)},
+            BoundMax {std::floor(std::max({(&P[0].X)[a], (&P[1].X)[a], (&P[2].X)[a]}) + 0.5f)};
+
+          if (!(BoundMin <= BoundMax && BoundMax >= (float)Min[a] && BoundMin <= (float)Max[a]))
+            return;
+          IsSingle &= BoundMin == BoundMax;
+          Lo[a] = (int32_t)std::max(BoundMin, (float)Min[a]), Hi[a] = (int32_t)std::min(BoundMax, (float)Max[a]);
+        }
+
+        /* Triangle inside one cell overlaps it, others go to the kernel */
+        if (IsSingle)
+        {
+          Func(Lo[0], Lo[1], Lo[2]);
+          return;
+        }
+        X.clear(), Y.clear(), Z.clear();
+        for (int32_t CellZ {Lo[2]}; CellZ <= Hi[2]; CellZ++)
+          for (int32_t CellY {Lo[1]}; CellY <= Hi[1]; CellY++)
+            for (int32_t CellX {Lo[0]}; CellX <= Hi[0]; CellX++)
+              X.push_back(CellX), Y.push_back(CellY), Z.push_back(CellZ);
+        Hits.resize(X.size());
+
+        const size_t HitsCount {TriangleCellsOverlapTest(triangle_cells_setup {Tri, Desc}, {X.data(), Y.data(), Z.data(), X.size()}, Hits)};
+
+        for (size_t h {0}; h < HitsCount; h++)
+          Func(X[Hits[h]], Y[Hits[h]], Z[Hits[h]]);
+      } /* End of 'Bin' function */
+  }; /* end of 'triangle_cells_binner' class */
+
+  /* Uniform grid over triangles set: every cell keeps indices of triangles, which overlap it by the exact
+   * separating axes test (not just by bounds), so there are no false candidates. Cells are stored in compressed
+   * rows (cell offsets and triangles indices), so cell triangles are a contiguous span. */
+  class triangle_grid
+  {
+  public:
+    static constexpr uint32_t MaxSize {1 << 24}; // Maximal cells count along an axis (cells space coordinates stay exact)
+
+  private:
+    /* Triangle overlapping cell reference */
+    struct reference
+    {
+      uint32_t Cell;     // Cell index
+      uint32_t Triangle; // Triangle index
+    }; /* end of 'reference' structure */
+
+    grid_desc Desc {};                // Grid descriptor, cell (0, 0, 0) is the first one
+    std::array<uint32_t, 3> Size {};  // Cells count along every axis
+    std::vector<uint32_t> Offsets {}; // First reference of every cell and references count (cells count + 1 elements)
+    std::vector<uint32_t> Indices {}; // Overlapping triangles indices cell by cell, ascending in every cell
+
+    /* Grid building function.
+     * Counting pass finds cells of every triangle (candidates by bounds, then the batch SAT kernel) and
+     * counts them per cell atomically, counts are prefix summed into offsets, then references are
+     * scattered into their cells. Every pass is split between all threads.
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Tris;
+     *   - Threads count (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     * RETURNS: None.
+     */
+    void Build( const triangles_soa_view<float> &Tris, size_t ThreadsCount )
+    {
+      if (Tris.Count > std::numeric_limits<uint32_t>::max())
+        throw std::out_of_range {"Too many triangles for grid"};
+      for (const uint32_t AxisSize : Size)
+        if (AxisSize == 0 || AxisSize > MaxSize)
+          throw std::out_of_range {"Grid size is out of range"};
+
+      /* Axes sizes are within 2^24, so the first product is exact, the second one is checked before multiplying */
+      const size_t LayerCellsCount {(size_t)Size[0] * Size[1]};
+
+      if (LayerCellsCount >= std::numeric_limits<uint32_t>::max() / Size[2])
+        throw std::out_of_range {"Too many grid cells"};
+
+      const size_t CellsCount {LayerCellsCount * Size[2]};
+
+      ThreadsCount = GetThreadsCount(ThreadsCount);
+
+      const size_t PartsCount {std::clamp<size_t>(Tris.Count / (1 << 12), 1, ThreadsCount)};
+      std::vector<std::vector<reference>> References(PartsCount);
+
+      Offsets.assign(CellsCount + 1, 0);
+      ParallelFor(Tris.Count, [&]( size_t Part, size_t First, size_t End )
+        {
+          triangle_cells_binner Binner {};
+
+          for (size_t i {First}; i < End; i++)
+            Binner.Bin(Tris[i], Desc, {0, 0, 0}, {(int32_t)Size[0] - 1, (int32_t)Size[1] - 1, (int32_t)Size[2] - 1},
+              [&]( int32_t X, int32_t Y, int32_t Z )
+              {
+                const uint32_t Cell {(uint32_t)GetCellIndex(X, Y, Z)};
+
+                References[Part].push_back({Cell, (uint32_t)i});
+                std::atomic_ref<uint32_t> {Offsets[Cell]}.fetch_add(1, std::memory_order_relaxed);
+              });
+        }, PartsCount);
+
+      /* Exclusive prefix sum: parts sums, their offsets, then parts */
+      const size_t ScanPartsCount {std::clamp<size_t>(CellsCount / (1 << 16), 1, ThreadsCount)};
+      std::vector<size_t> Sums(ScanPartsCount);
+
+      ParallelFor(CellsCount, [&]( size_t Part, size_t First, size_t End )
+        {
+          Sums[Part] = std::accumulate(Offsets.begin() + First, Offsets.begin() + End, size_t {0});
+        }, ScanPartsCount);
+
+      size_t Total {0};
+
+      for (size_t &Sum : Sums)
+        Total += std::exchange(Sum, Total);
+      if (Total > std::numeric_limits<uint32_t>::max())
+        throw std::out_of_range {"Too many grid references"};
+      ParallelFor(CellsCount, [&]( size_t Part, size_t First, size_t End )
+        {
+          size_t Sum {Sums[Part]};
+
+          for (size_t c {First}; c < End; c++)
+            Sum += std::exchange(Offsets[c], (uint32_t)Sum);
+        }, ScanPartsCount);
+      Offsets[CellsCount] = (uint32_t)Total;
+
+      /* Scatter, references of parts are interleaved in cells, so cells are sorted then */
+      std::vector<uint32_t> Cursors(Offsets.begin(), Offsets.end() - 1);
+
+      Indices.resize(Total);
+      ParallelFor(PartsCount, [&]( size_t Part, size_t, size_t )
+        {
+          for (const reference &Ref : References[Part])
+            Indices[std::atomic_ref<uint32_t> {Cursors[Ref.Cell]}.fetch_add(1, std::memory_order_relaxed)] = Ref.Triangle;
+          References[Part] = {};
+        }, PartsCount);
+      if (PartsCount > 1)
+        ParallelFor(CellsCount, [&]( size_t, size_t First, size_t End )
+          {
+            for (size_t c {First}; c < End; c++)
+              if (Offsets[c + 1] - Offsets[c] > 1)
+                std::sort(Indices.begin() + Offsets[c], Indices.begin() + Offsets[c + 1]);
+          }, ScanPartsCount);
+    } /* End of 'Build' function */
+
+  public:
+    /* Default constructor */
+    triangle_grid( void ) = default;
+
+    /* Constructor for a given grid.
+     * ARGUMENTS:
+     *   - Triangles (parts outside of grid are not binned):
+     *       const triangles_soa_view<float> &Tris;
+     *   - Grid descriptor:
+     *       const grid_desc &Desc;
+     *   - Cells count along every axis (from 1 to 'MaxSize'):
+     *       const std::array<uint32_t, 3> &Size;
+     *   - Threads count (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     */
+    triangle_grid( const triangles_soa_view<float> &Tris, const grid_desc &Desc, const std::array<uint32_t, 3> &Size, size_t ThreadsCount = 0 ) :
+      Desc {Desc}, Size {Size}
+    {
+      Build(Tris, ThreadsCount);
+    } /* End of constructor */
+
+    /* Constructor for a grid, fitted to triangles (see 'Fit').
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Tris;
+     *   - Cells count per triangle:
+     *       float CellsPerTriangle;
+     *   - Threads count (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     */
+    explicit triangle_grid( const triangles_soa_view<float> &Tris, float CellsPerTriangle = 1, size_t ThreadsCount = 0 )
+    {
+      Fit(Tris, CellsPerTriangle, Desc, Size);
+      Build(Tris, ThreadsCount);
+    } /* End of constructor */
+
+    /* Grid fitting function: cubic cells cover triangles bounds, their count is
+     * about triangles count times cells per triangle (flat axes get one cell).
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Tris;
+     *   - Cells count per triangle (positive):
+     *       float CellsPerTriangle;
+     *   - Fitted grid descriptor and cells count along every axis (stored):
+     *       grid_desc &Desc; std::array<uint32_t, 3> &Size;
+     * RETURNS: None.
+     */
+    static void Fit( const triangles_soa_view<float> &Tris, float CellsPerTriangle, grid_desc &Desc, std::array<uint32_t, 3> &Size )
+    {
+      if (!(CellsPerTriangle > 0))
+        throw std::invalid_argument {"Cells count per triangle must be positive"};
+
+      bvh_bounds Bounds {};
+
+      for (size_t i {0}; i < Tris.Count; i++)
+      {
+        const triangle<float> Tri {Tris[i]};
+
+        Bounds.Extend(Tri.V0), Bounds.Extend(Tri.V1), Bounds.Extend(Tri.V2);
+      }
+      Desc = {}, Size = {1, 1, 1};
+      if (Tris.Count == 0)
+        return;
+
+      /* Cell size from the volume (or area, or length) of non-flat axes */
+      const vec3<float> Extent {Bounds.Max - Bounds.Min};
+      const double Cells {std::clamp((double)Tris.Count * CellsPerTriangle, 1.0, (double)std::numeric_limits<uint32_t>::max() / 2)};
+      double Measure {1};
+      int Axes {0};
+
+      for (size_t a {0}; a < 3; a++)
+        if ((&Extent.X)[a] > 0)
+          Measure *= (&Extent.X)[a], Axes++;
+      if (Axes == 0)
+      {
+        Desc.Origin = Bounds.Min;
+        return;
+      }
+
+      float CellSize {(float)std::pow(Measure / Cells, 1.0 / Axes)};
+
+      /* Rounding may exceed cells count, then cells are enlarged */
+      for (;;)
+      {
+        double Count {1};
+
+        for (size_t a {0}; a < 3; a++)
+          Size[a] = (uint32_t)std::clamp(std::ceil((double)(&Extent.X)[a] / CellSize), 1.0, (double)MaxSize), Count *= Size[a];
+        if (Count <= Cells * 2)
+          break;
+        CellSize *= 1.1f;
+      }
+      Desc.Origin = Bounds.Min;
+      Desc.CellSize = {CellSize, CellSize, CellSize};
+    } /* End of 'Fit' function */
+
+    /* Grid descriptor getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const grid_desc &) Grid descriptor.
+     */
+    const grid_desc & GetDesc( void ) const noexcept
+    {
+      return Desc;
+    } /* End of 'GetDesc' function */
+
+    /* Cells count along every axis getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const std::array<uint32_t, 3> &) Cells count along X, Y, Z.
+     */
+    const std::array<uint32_t, 3> & GetSize( void ) const noexcept
+    {
+      return Size;
+    } /* End of 'GetSize' function */
+
+    /* Cell index getting function.
+     * ARGUMENTS:
+     *   - Cell integer coordinates (inside grid):
+     *       int32_t X, Y, Z;
+     * RETURNS:
+     *   (size_t) Cell index, X is the fastest changing coordinate.
+     */
+    size_t GetCellIndex( int32_t X, int32_t Y, int32_t Z ) const noexcept
+    {
+      return ((size_t)Z * Size[1] + (size_t)Y) * Size[0] + (size_t)X;
+    } /* End of 'GetCellIndex' function */
+
+    /* Cell triangles getting function.
+     * ARGUMENTS:
+     *   - Cell integer coordinates (inside grid):
+     *       int32_t X, Y, Z;
+     * RETURNS:
+     *   (std::span<const uint32_t>) Indices of triangles overlapping cell, ascending.
+     */
+    std::span<const uint32_t> GetCell( int32_t X, int32_t Y, int32_t Z ) const noexcept
+    {
+      const size_t Cell {GetCellIndex(X, Y, Z)};
+
+      return {Indices.data() + Offsets[Cell], Indices.data() + Offsets[Cell + 1]};
+    } /* End of 'GetCell' function */
+
+    /* Point cell triangles getting function.
+     * ARGUMENTS:
+     *   - Point:
+     *       const vec3<float> &P;
+     * RETURNS:
+     *   (std::span<const uint32_t>) Indices of triangles overlapping cell, containing point (empty outside of grid).
+     */
+    std::span<const uint32_t> GetCell( const vec3<float> &P ) const noexcept
+    {
+      const vec3<float> C {Desc.ToCells(P)};
+      std::array<int32_t, 3> Cell;
+
+      for (size_t a {0}; a < 3; a++)
+      {
+        const float Coord {std::floor((&C.X)[a] + 0.5f)};
+
+        if (!(Coord >= 0 && Coord < (float)Size[a]))
+          return {};
+        Cell[a] = (int32_t)Coord;
+      }
+      return GetCell(Cell[0], Cell[1], Cell[2]);
+    } /* End of 'GetCell' function */
+
+    /* Compressed rows offsets getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const uint32_t>) First reference of every cell, then references count (empty for empty grid).
+     */
+    std::span<const uint32_t> GetOffsets( void ) const noexcept
+    {
+      return Offsets;
+    } /* End of 'GetOffsets' function */
+
+    /* Compressed rows triangles indices getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const uint32_t>) Overlapping triangles indices cell by cell.
+     */
+    std::span<const uint32_t> GetIndices( void ) const noexcept
+    {
+      return Indices;
+    } /* End of 'GetIndices' function */
+  }; /* end of 'triangle_grid' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_triangle_grid_hpp__ */
+
+/* END OF 'overlap_triangle_grid.hpp' FILE */
@@ -0,0 +1,383 @@
+/* Copyright 2024 Fedor Borodulin
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* "overlap_voxelizer.hpp" - Conservative surface voxelization into dense bit grid */
+
+#ifndef __overlap_voxelizer_hpp__
+#define __overlap_voxelizer_hpp__
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "../box_triangle_overlap_test.hpp"
+
+/* Math namespace */
+namespace math
+{
+  /* Dense voxel grid, one bit per voxel: voxel is set if any triangle overlaps it by the exact separating
+   * axes test (conservative surface voxelization). Rows along X are packed into 64-bit words, X is the
+   * lowest bit. Building is split into 64 voxels tiles, every tile is written by one thread only. */
+  class voxel_grid
+  {
+  public:
+    static constexpr int32_t TileSize {64};      // Tile edge in voxels: tile row is exactly one word
+    static constexpr uint32_t MaxSize {1 << 24}; // Maximal voxels count along an axis (cells space coordinates stay exact)
+
+  private:
+    grid_desc Desc {};               // Grid descriptor, voxel (0, 0, 0) starts at origin
+    std::array<uint32_t, 3> Size {}; // Voxels count along every axis
+    size_t RowWords {0};             // Words count in a row (tiles count along X)
+    std::vector<uint64_t> Words {};  // Voxel bits, row by row (Y, then Z)
+
+    /* Triangle candidate voxels range getting function.
+     * ARGUMENTS:
+     *   - Triangle:
+     *       const triangle<float> &Tri;
+     *   - Candidate voxels range, inclusive, clipped by grid (stored):
+     *       std::array<int32_t, 3> &Lo, &Hi;
+     *   - Triangle bounds lie inside one voxel flag (stored):
+     *       bool &IsSingle;
+     * RETURNS:
+     *   (bool) false if triangle is outside of grid.
+     */
+    bool GetRange( const triangle<float> &Tri, std::array<int32_t, 3> &Lo, std::array<int32_t, 3> &Hi, bool &IsSingle ) const noexcept
+    {
+      const vec3<float> P[3] {Desc.ToCells(Tri.V0), Desc.ToCells(Tri.V1), Desc.ToCells(Tri.V2)};
+
+      IsSingle = true;
+      for (size_t a {0}; a < 3; a++)
+      {
+        const float
+          Min {std::ceil(std::min({(&P[0].X)[a], (&P[1].X)[a], (&P[2].X)[a]}) - 0.5f)},
+          Max {std::floor(std::max({(&P[0].X)[a], (&P[1].X)[a], (&P[2].X)[a]}) + 0.5f)};
+
+        if (!(Min <= Max && Max >= 0 && Min <= (float)(Size[a] - 1)))
+          return false;
+        IsSingle &= Min == Max;
+        Lo[a] = (int32_t)std::max(Min, 0.f), Hi[a] = (int32_t)std::min(Max, (float)(Size[a] - 1));
+      }
+      return true;
+    } /* End of 'GetRange' function */
+
+    /* Bits reading function.
+     * ARGUMENTS:
+     *   - Bits (8 readable bytes after the last used one):
+     *       const uint8_t *Bits;
+     *   - First bit:
+     *       size_t First;
+     *   - Bits count (from 1 to 64):
+     *       int32_t Count;
+     * RETURNS:
+     *   (uint64_t) Bits, the first one is the lowest.
+     */
+    static uint64_t ReadBits( const uint8_t *Bits, size_t First, int32_t Count ) noexcept
+    {
+      const size_t Shift {First % 8};
+      uint64_t Value;
+
+      std::memcpy(&Value, Bits + First / 8, sizeof Value);
+      Value >>= Shift;
+      if (Shift != 0 && Count + Shift > 64)
+        Value |= (uint64_t)Bits[First / 8 + 8] << (64 - Shift);
+      return Count == 64 ? Value : Value & ((1ull << Count) - 1);
+    } /* End of 'ReadBits' function */
+
+    /* Voxelization function.
+     * Triangles are counted per tile by candidate ranges (parts histograms), offsets are prefix summed tile
+     * by tile, then triangles are scattered into tiles (every part has own cursors). Tiles are taken by
+     * threads from a queue, the largest first: a thread tests tile triangles against candidate voxels
+     * inside tile by the batch SAT kernel and ORs rows of result bits into tile words, no atomics are needed.
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Tris;
+     *   - Threads count (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     * RETURNS: None.
+     */
+    void Build( const triangles_soa_view<float> &Tris, size_t ThreadsCount )
+    {
+      if (Tris.Count > std::numeric_limits<uint32_t>::max())
+        throw std::out_of_range {"Too many triangles for voxel grid"};
+      for (const uint32_t AxisSize : Size)
+        if (AxisSize == 0 || AxisSize > MaxSize)
+          throw std::out_of_range {"Voxel grid size is out of range"};
+
+      const std::array<size_t, 3> Tiles {(Size[0] + TileSize - 1) / TileSize, (Size[1] + TileSize - 1) / TileSize, (Size[2] + TileSize - 1) / TileSize};
+
+      /* Layer words count is within 2^42, so it is exact, the whole count is checked before multiplying (tiles are fewer than words) */
+      const size_t LayerWords {Tiles[0] * Size[1]};
+
+      if (LayerWords > Words.max_size() / Size[2])
+        throw std::out_of_range {"Too many voxels"};
+
+      const size_t TilesCount {Tiles[0] * Tiles[1] * Tiles[2]};
+
+      RowWords = Tiles[0];
+      Words.assign(LayerWords * Size[2], 0);
+      ThreadsCount = GetThreadsCount(ThreadsCount);
+
+      /* Triangle tiles walking */
+      const auto ForEachTile {[&]( size_t Index, auto &&Func )
+        {
+          std::array<int32_t, 3> Lo, Hi;
+          bool IsSingle;
+
+          if (GetRange(Tris[Index], Lo, Hi, IsSingle))
+            for (size_t Z {(size_t)Lo[2] / TileSize}; Z <= (size_t)Hi[2] / TileSize; Z++)
+              for (size_t Y {(size_t)Lo[1] / TileSize}; Y <= (size_t)Hi[1] / TileSize; Y++)
+                for (size_t X {(size_t)Lo[0] / TileSize}; X <= (size_t)Hi[0] / TileSize; X++)
+                  Func((Z * Tiles[1] + Y) * Tiles[0] + X);
+        }};
+
+      /* Counting, prefix sum tile by tile (triangles stay ascending in tiles), scattering */
+      const size_t PartsCount {std::clamp<size_t>(Tris.Count / (1 << 12), 1, ThreadsCount)};
+      std::vector<std::vector<size_t>> Cursors(PartsCount, std::vector<size_t>(TilesCount));
+      std::vector<size_t> TileOffsets(TilesCount + 1);
+
+      ParallelFor(Tris.Count, [&]( size_t Part, size_t First, size_t End )
+        {
+          for (size_t i {First}; i < End; i++)
+            ForEachTile(i, [&]( size_t Tile ) { Cursors[Part][Tile]++; });
+        }, PartsCount);
+      for (size_t t {0}, Offset {0}; t < TilesCount; t++)
+      {
+        TileOffsets[t] = Offset;
+        for (std::vector<size_t> &Part : Cursors)
+          Offset += std::exchange(Part[t], Offset);
+        TileOffsets[t + 1] = Offset;
+      }
+
+      std::vector<uint32_t> TileTriangles(TileOffsets[TilesCount]);
+
+      ParallelFor(Tris.Count, [&]( size_t Part, size_t First, size_t End )
+        {
+          for (size_t i {First}; i < End; i++)
+            ForEachTile(i, [&]( size_t Tile ) { TileTriangles[Cursors[Part][Tile]++] = (uint32_t)i; });
+        }, PartsCount);
+      Cursors = {};
+
+      /* Tiles, the most crowded ones are taken first */
+      std::vector<uint32_t> TilesOrder {};
+      std::atomic<size_t> NextTile {0};
+
+      for (size_t t {0}; t < TilesCount; t++)
+        if (TileOffsets[t + 1] != TileOffsets[t])
+          TilesOrder.push_back((uint32_t)t);
+      std::sort(TilesOrder.begin(), TilesOrder.end(), [&]( uint32_t A, uint32_t B )
+        {
+          return TileOffsets[A + 1] - TileOffsets[A] > TileOffsets[B + 1] - TileOffsets[B];
+        });
+      ParallelFor(ThreadsCount, [&]( size_t, size_t, size_t )
+        {
+          std::vector<int32_t> X {}, Y {}, Z {};
+          std::vector<uint8_t> Masks {};
+
+          for (size_t t; (t = NextTile.fetch_add(1, std::memory_order_relaxed)) < TilesOrder.size(); )
+          {
+            const size_t Tile {TilesOrder[t]}, Word {Tile % Tiles[0]};
+            const std::array<int32_t, 3> TileLo
+            {
+              (int32_t)Word * TileSize,
+              (int32_t)(Tile / Tiles[0] % Tiles[1]) * TileSize,
+              (int32_t)(Tile / Tiles[0] / Tiles[1]) * TileSize,
+            };
+
+            for (size_t r {TileOffsets[Tile]}; r < TileOffsets[Tile + 1]; r++)
+            {
+              const triangle<float> Tri {Tris[TileTriangles[r]]};
+              std::array<int32_t, 3> Lo, Hi;
+              bool IsSingle;
+
+              GetRange(Tri, Lo, Hi, IsSingle);
+
+              /* Triangle inside one voxel overlaps it */
+              if (IsSingle)
+              {
+                Words[((size_t)Lo[2] * Size[1] + Lo[1]) * RowWords + Word] |= 1ull << (Lo[0] - TileLo[0]);
+                continue;
+              }
+              for (size_t a {0}; a < 3; a++)
+                Lo[a] = std::max(Lo[a], TileLo[a]), Hi[a] = std::min(Hi[a], TileLo[a] + TileSize - 1);
+
+              X.clear(), Y.clear(), Z.clear();
+              for (int32_t CellZ {Lo[2]}; CellZ <= Hi[2]; CellZ++)
+                for (int32_t CellY {Lo[1]}; CellY <= Hi[1]; CellY++)
+                  for (int32_t CellX {Lo[0]}; CellX <= Hi[0]; CellX++)
+                    X.push_back(CellX), Y.push_back(CellY), Z.push_back(CellZ);
+              Masks.resize((X.size() + 7) / 8 + 9);
+              TriangleCellsOverlapTest(triangle_cells_setup {Tri, Desc}, {X.data(), Y.data(), Z.data(), X.size()}, Masks);
+
+              /* Candidate rows bits go to tile words as they are */
+              const int32_t Width {Hi[0] - Lo[0] + 1};
+              size_t Bit {0};
+
+              for (int32_t CellZ {Lo[2]}; CellZ <= Hi[2]; CellZ++)
+                for (int32_t CellY {Lo[1]}; CellY <= Hi[1]; CellY++, Bit += Width)
+                  Words[((size_t)CellZ * Size[1] + CellY) * RowWords + Word] |= ReadBits(Masks.data(), Bit, Width) << (Lo[0] - TileLo[0]);
+            }
+          }
+        }, std::min(ThreadsCount, std::max<size_t>(TilesOrder.size(), 1)));
+    } /* End of 'Build' function */
+
+  public:
+    /* Default constructor */
+    voxel_grid( void ) = default;
+
+    /* Constructor for a given grid.
+     * ARGUMENTS:
+     *   - Triangles (parts outside of grid are not voxelized):
+     *       const triangles_soa_view<float> &Tris;
+     *   - Grid descriptor:
+     *       const grid_desc &Desc;
+     *   - Voxels count along every axis (from 1 to 'MaxSize'):
+     *       const std::array<uint32_t, 3> &Size;
+     *   - Threads count (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     */
+    voxel_grid( const triangles_soa_view<float> &Tris, const grid_desc &Desc, const std::array<uint32_t, 3> &Size, size_t ThreadsCount = 0 ) :
+      Desc {Desc}, Size {Size}
+    {
+      Build(Tris, ThreadsCount);
+    } /* End of constructor */
+
+    /* Constructor for a grid, fitted to triangles (see 'Fit').
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Tris;
+     *   - Voxels count along the longest axis:
+     *       uint32_t Resolution;
+     *   - Threads count (0 - hardware concurrency):
+     *       size_t ThreadsCount;
+     */
+    voxel_grid( const triangles_soa_view<float> &Tris, uint32_t Resolution, size_t ThreadsCount = 0 )
+    {
+      Fit(Tris, Resolution, Desc, Size);
+      Build(Tris, ThreadsCount);
+    } /* End of constructor */
+
+    /* Grid fitting function: cubic voxels cover triangles bounds, 'Resolution' voxels along the longest axis.
+     * ARGUMENTS:
+     *   - Triangles:
+     *       const triangles_soa_view<float> &Tris;
+     *   - Voxels count along the longest axis (from 1 to 'MaxSize'):
+     *       uint32_t Resolution;
+     *   - Fitted grid descriptor and voxels count along every axis (stored):
+     *       grid_desc &Desc; std::array<uint32_t, 3> &Size;
+     * RETURNS: None.
+     */
+    static void Fit( const triangles_soa_view<float> &Tris, uint32_t Resolution, grid_desc &Desc, std::array<uint32_t, 3> &Size )
+    {
+      if (Resolution == 0 || Resolution > MaxSize)
+        throw std::out_of_range {"Voxel grid resolution is out of range"};
+
+      bvh_bounds Bounds {};
+
+      for (size_t i {0}; i < Tris.Count; i++)
+      {
+        const triangle<float> Tri {Tris[i]};
+
+        Bounds.Extend(Tri.V0), Bounds.Extend(Tri.V1), Bounds.Extend(Tri.V2);
+      }
+      Desc = {}, Size = {1, 1, 1};
+      if (Tris.Count == 0)
+        return;
+
+      const vec3<float> Extent {Bounds.Max - Bounds.Min};
+      const float Longest {std::max({Extent.X, Extent.Y, Extent.Z})};
+
+      if (Longest > 0)
+      {
+        const float VoxelSize {Longest / (float)Resolution};
+
+        for (size_t a {0}; a < 3; a++)
+          Size[a] = (uint32_t)std::clamp(std::ceil((&Extent.X)[a] / VoxelSize), 1.f, (float)Resolution);
+        Desc.CellSize = {VoxelSize, VoxelSize, VoxelSize};
+      }
+      Desc.Origin = Bounds.Min;
+    } /* End of 'Fit' function */
+
+    /* Grid descriptor getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const grid_desc &) Grid descriptor.
+     */
+    const grid_desc & GetDesc( void ) const noexcept
+    {
+      return Desc;
+    } /* End of 'GetDesc' function */
+
+    /* Voxels count along every axis getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (const std::array<uint32_t, 3> &) Voxels count along X, Y, Z.
+     */
+    const std::array<uint32_t, 3> & GetSize( void ) const noexcept
+    {
+      return Size;
+    } /* End of 'GetSize' function */
+
+    /* Voxel state getting function.
+     * ARGUMENTS:
+     *   - Voxel integer coordinates (inside grid):
+     *       int32_t X, Y, Z;
+     * RETURNS:
+     *   (bool) true if any triangle overlaps voxel.
+     */
+    bool IsSet( int32_t X, int32_t Y, int32_t Z ) const noexcept
+    {
+      return (GetRow(Y, Z)[(size_t)X / 64] >> (X % 64) & 1) != 0;
+    } /* End of 'IsSet' function */
+
+    /* Voxels row getting function.
+     * ARGUMENTS:
+     *   - Row integer coordinates (inside grid):
+     *       int32_t Y, Z;
+     * RETURNS:
+     *   (std::span<const uint64_t>) Row words, voxel X is bit X % 64 of word X / 64 (unused high bits are zero).
+     */
+    std::span<const uint64_t> GetRow( int32_t Y, int32_t Z ) const noexcept
+    {
+      return {Words.data() + ((size_t)Z * Size[1] + (size_t)Y) * RowWords, RowWords};
+    } /* End of 'GetRow' function */
+
+    /* All voxel words getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (std::span<const uint64_t>) Rows words, row by row (Y is the fastest changing).
+     */
+    std::span<const uint64_t> GetWords( void ) const noexcept
+    {
+      return Words;
+    } /* End of 'GetWords' function */
+
+    /* Set voxels count getting function.
+     * ARGUMENTS: None.
+     * RETURNS:
+     *   (size_t) Voxels count, overlapped by triangles.
+     */
+    size_t GetSetCount( void ) const noexcept
+    {
+      return std::accumulate(Words.begin(), Words.end(), size_t {0}, []( size_t Sum, uint64_t Word ) { return Sum + std::popcount(Word); });
+    } /* End of 'GetSetCount' function */
+  }; /* end of 'voxel_grid' class */
+} /* end of 'math' namespace */
+
+#endif /* __overlap_voxelizer_hpp__ */
+
+/* END OF 'overlap_voxelizer.hpp' FILE */